@@ -0,0 +1,239 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK BST
+ * Summary:
+ *    Performance measurements for the BST
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "bst.h"
+#include "benchmark.h"
+
+#include <cmath>      // for std::log2
+#include <string>     // for std::to_string
+#include <vector>     // for std::vector
+
+/***********************************************
+ * BENCHMARK BST
+ * Measurements for the BST class
+ ***********************************************/
+class BenchBST : public Benchmark
+{
+public:
+   BenchBST(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("BST");
+
+      bench_erase_heightBound();
+      bench_assignSorted_vsInsert();
+      bench_copy_skewed();
+      bench_memory_compactNode();
+   }
+
+   /***************************************
+    * ERASE
+    *    BST::erase(it)
+    ***************************************/
+
+   // after millions of mixed inserts and erases the tree is still balanced
+   void bench_erase_heightBound()
+   {
+      const size_t numKeys = size(1000000);
+      const size_t numOps  = size(4000000);
+      custom::BST <uint64_t> bst;
+      Random random;
+      int worst = 0;
+      double worstRatio = 0.0;
+
+      // fill, then churn around that size with erases biased to the left
+      // so an unbalanced erase would drift away from log n quickly
+      double seconds = time([&]()
+      {
+         while (bst.size() < numKeys)
+            bst.insert(random(4 * numKeys), true);
+         for (size_t i = 0; i < numOps; i++)
+         {
+            if (bst.size() < numKeys || random(2) == 0)
+               bst.insert(random(4 * numKeys), true);
+            else
+            {
+               auto it = bst.begin();
+               for (int skip = (int)random(4); skip > 0 && it != bst.end(); skip--)
+                  ++it;
+               bst.erase(it);
+            }
+
+            if (i % (numOps / 16 + 1) == 0)
+            {
+               int h = height(bst.root);
+               double bound = 2.0 * std::log2((double)bst.size() + 1.0);
+               if (h > worst)
+                  worst = h;
+               if (h / bound > worstRatio)
+                  worstRatio = h / bound;
+            }
+         }
+      });
+
+      int h = height(bst.root);
+      double bound = 2.0 * std::log2((double)bst.size() + 1.0);
+      record("fill then mixed insert/erase", numKeys + numOps, seconds);
+      check(h <= bound && worstRatio <= 1.0,
+            "height " + std::to_string(h) + " <= 2 log2(n+1) = " +
+            std::to_string((int)bound) + " for n = " + std::to_string(bst.size()) +
+            " (worst sampled height " + std::to_string(worst) + ")");
+   }
+
+   /***************************************
+    * ASSIGN SORTED
+    *    BST::assignSorted(first, last)
+    ***************************************/
+
+   // reloading pre-sorted keys should not pay for n rebalances
+   void bench_assignSorted_vsInsert()
+   {
+      const size_t numKeys = size(10000000);
+      std::vector<uint64_t> keys(numKeys);
+      for (size_t i = 0; i < numKeys; i++)
+         keys[i] = 3 * i + 1;
+
+      double secondsInsert;
+      {
+         custom::BST <uint64_t> bst;
+         secondsInsert = time([&]()
+         {
+            for (uint64_t key : keys)
+               bst.insert(key, true);
+         });
+      }
+      record("insert sorted keys one at a time", numKeys, secondsInsert);
+
+      custom::BST <uint64_t> bst;
+      double secondsBulk = time([&]()
+      {
+         bst.assignSorted(keys.begin(), keys.end());
+      });
+      record("assignSorted", numKeys, secondsBulk);
+
+      int h = height(bst.root);
+      int hMin = (int)std::floor(std::log2((double)numKeys)) + 1;
+      check(h == hMin && bst.size() == numKeys,
+            "bulk loaded height " + std::to_string(h) + " is the minimum " +
+            std::to_string(hMin) + " for n = " + std::to_string(numKeys));
+      check(secondsBulk * 2.0 < secondsInsert,
+            "assignSorted is at least twice as fast as inserting");
+   }
+
+   /***************************************
+    * COPY and CLEAR
+    *    BST::operator=(const BST &)
+    *    BST::clear()
+    ***************************************/
+
+   // a vine as deep as it is long copies and clears without recursion
+   void bench_copy_skewed()
+   {
+      const size_t numKeys = size(10000000);
+      custom::BST <uint64_t> bstSrc;
+      setupVine(bstSrc, numKeys);
+
+      custom::BST <uint64_t> bstDest;
+      double secondsCopy = time([&]()
+      {
+         bstDest = bstSrc;
+      });
+      record("copy a vine", numKeys, secondsCopy);
+
+      // walk the copy: every node should hang to the right of the last
+      size_t num = 0;
+      bool valid = true;
+      for (auto p = bstDest.root; p && valid; p = p->pRight)
+         valid = p->data == num++ && p->pLeft == nullptr;
+
+      double secondsClear = time([&]()
+      {
+         bstDest.clear();
+         bstSrc.clear();
+      });
+      record("clear two vines", 2 * numKeys, secondsClear);
+
+      check(valid && num == numKeys,
+            "copied a vine " + std::to_string(num) + " levels deep");
+   }
+
+   /***************************************
+    * MEMORY
+    *    BST::BNode
+    ***************************************/
+
+   // what each int in a tree costs with the color tucked in after the
+   // key, against what it cost with the color after the pointers
+   void bench_memory_compactNode()
+   {
+      typedef custom::BST <int> ::BNode Node;
+      const size_t numKeys = size(4000000);
+      custom::BST <int> bst;
+      Random random;
+      double seconds = time([&]()
+      {
+         while (bst.size() < numKeys)
+            bst.insert((int)random(), true);
+      });
+      record("insert random ints", numKeys, seconds);
+
+      recordMemory("nodes of ints, color after the key", numKeys,
+                   bst.pool.capacity() * sizeof(Node));
+      recordMemory("nodes of ints, color after the pointers", numKeys,
+                   bst.pool.capacity() * sizeof(LooseNode));
+
+      check(sizeof(Node) * 5 <= sizeof(LooseNode) * 4,
+            "a node of ints is a fifth smaller: " + std::to_string(sizeof(Node)) +
+            " bytes, not " + std::to_string(sizeof(LooseNode)));
+   }
+
+private:
+   // how BNode used to be laid out, for comparison
+   struct LooseNode
+   {
+      int    data;
+      void * pLeft;
+      void * pRight;
+      void * pParent;
+      bool   isRed;
+   };
+
+   // a degenerate tree where each key is the right child of the last
+   template <class T>
+   static void setupVine(custom::BST <T> & bst, size_t num)
+   {
+      typename custom::BST <T> ::BNode * pPrev = nullptr;
+      for (size_t i = 0; i < num; i++)
+      {
+         auto pNode = bst.pool.construct(T(i));
+         pNode->isRed = false;
+         if (pPrev)
+            pPrev->addRight(pNode);
+         else
+            bst.root = pNode;
+         pPrev = pNode;
+      }
+      bst.numElements = num;
+      bst.relink();
+   }
+
+   // the number of nodes on the longest path from the root to a leaf
+   template <class Node>
+   static int height(const Node * p)
+   {
+      if (p == nullptr)
+         return 0;
+      int left  = height(p->pLeft);
+      int right = height(p->pRight);
+      return 1 + (left > right ? left : right);
+   }
+};
@@ -0,0 +1,246 @@
+/***********************************************************************
+ * Header:
+ *    BENCH BTREE SET
+ * Summary:
+ *    The B-tree set against the red-black set and std::set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"   // benchmark baseclass
+#include "btreeSet.h"    // class under measurement
+#include "set.h"         // the red-black tree it replaces
+#include <set>           // for std::set
+#include <string>        // for std::to_string
+#include <utility>       // for std::swap
+#include <vector>        // for std::vector
+
+/***********************************************
+ * BENCHMARK BTREE SET
+ * Measurements for the btree_set class
+ ***********************************************/
+class BenchBTreeSet : public Benchmark
+{
+public:
+   BenchBTreeSet(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("BTreeSet");
+
+      bench_insert_random();
+      bench_find_random();
+      bench_iterate_fullScan();
+      bench_erase_random();
+   }
+
+   /***************************************
+    * INSERT
+    *    btree_set::insert(t)
+    ***************************************/
+
+   // fill each set from the same random keys
+   void bench_insert_random()
+   {
+      const std::vector <uint64_t> keys = randomKeys(size(2000000));
+
+      custom::btree_set <uint64_t> sBTree;
+      double secondsBTree = time([&]()
+      {
+         for (uint64_t key : keys)
+            sBTree.insert(key);
+      });
+      record("insert random keys, btree_set", keys.size(), secondsBTree);
+
+      custom::set <uint64_t> sRedBlack;
+      double secondsRedBlack = time([&]()
+      {
+         for (uint64_t key : keys)
+            sRedBlack.insert(key);
+      });
+      record("insert random keys, set", keys.size(), secondsRedBlack);
+
+      std::set <uint64_t> sStd;
+      double secondsStd = time([&]()
+      {
+         for (uint64_t key : keys)
+            sStd.insert(key);
+      });
+      record("insert random keys, std::set", keys.size(), secondsStd);
+
+      check(sBTree.size() == sRedBlack.size() && sBTree.size() == sStd.size(),
+            "all three hold the same " + std::to_string(sBTree.size()) + " elements");
+      check(secondsBTree < secondsRedBlack,
+            "the B-tree inserts faster than the red-black tree");
+   }
+
+   /***************************************
+    * FIND
+    *    btree_set::find(t)
+    ***************************************/
+
+   // half the probes hit, and none of them are in cache
+   void bench_find_random()
+   {
+      const size_t numKeys = size(2000000);
+      const size_t numProbes = size(2000000);
+      custom::btree_set <uint64_t> sBTree;
+      custom::set <uint64_t> sRedBlack;
+      std::set <uint64_t> sStd;
+      fill(numKeys, sBTree, sRedBlack, sStd);
+
+      std::vector <uint64_t> probes;
+      Random random;
+      for (size_t i = 0; i < numProbes; i++)
+         probes.push_back(random(2 * numKeys) * 0x9E3779B97F4A7C15ull);
+
+      size_t numFoundBTree = 0;
+      double secondsBTree = time([&]()
+      {
+         for (uint64_t probe : probes)
+            numFoundBTree += sBTree.find(probe) != sBTree.end();
+      });
+      record("find random keys, btree_set", numProbes, secondsBTree);
+
+      size_t numFoundRedBlack = 0;
+      double secondsRedBlack = time([&]()
+      {
+         for (uint64_t probe : probes)
+            numFoundRedBlack += sRedBlack.find(probe) != sRedBlack.end();
+      });
+      record("find random keys, set", numProbes, secondsRedBlack);
+
+      size_t numFoundStd = 0;
+      double secondsStd = time([&]()
+      {
+         for (uint64_t probe : probes)
+            numFoundStd += sStd.find(probe) != sStd.end();
+      });
+      record("find random keys, std::set", numProbes, secondsStd);
+
+      check(numFoundBTree == numFoundRedBlack && numFoundBTree == numFoundStd,
+            "all three find the same " + std::to_string(numFoundBTree) + " keys");
+      check(secondsBTree < secondsRedBlack,
+            "the B-tree finds faster than the red-black tree");
+   }
+
+   /***************************************
+    * ITERATE
+    *    btree_set::begin()
+    *    btree_set::iterator::operator++()
+    ***************************************/
+
+   // walk every element in order
+   void bench_iterate_fullScan()
+   {
+      const size_t numKeys = size(2000000);
+      custom::btree_set <uint64_t> sBTree;
+      custom::set <uint64_t> sRedBlack;
+      std::set <uint64_t> sStd;
+      fill(numKeys, sBTree, sRedBlack, sStd);
+
+      uint64_t sumBTree = 0;
+      double secondsBTree = time([&]()
+      {
+         for (auto it = sBTree.begin(); it != sBTree.end(); ++it)
+            sumBTree += *it;
+      });
+      record("iterate, btree_set", numKeys, secondsBTree);
+
+      uint64_t sumRedBlack = 0;
+      double secondsRedBlack = time([&]()
+      {
+         for (auto it = sRedBlack.begin(); it != sRedBlack.end(); ++it)
+            sumRedBlack += *it;
+      });
+      record("iterate, set", numKeys, secondsRedBlack);
+
+      uint64_t sumStd = 0;
+      double secondsStd = time([&]()
+      {
+         for (auto it = sStd.begin(); it != sStd.end(); ++it)
+            sumStd += *it;
+      });
+      record("iterate, std::set", numKeys, secondsStd);
+
+      check(sumBTree == sumRedBlack && sumBTree == sumStd,
+            "all three visit the same elements");
+      check(secondsBTree < secondsRedBlack,
+            "walking leaves beats walking nodes");
+   }
+
+   /***************************************
+    * ERASE
+    *    btree_set::erase(t)
+    ***************************************/
+
+   // take out every other key, in random order
+   void bench_erase_random()
+   {
+      const size_t numKeys = size(2000000);
+      custom::btree_set <uint64_t> sBTree;
+      custom::set <uint64_t> sRedBlack;
+      std::set <uint64_t> sStd;
+      fill(numKeys, sBTree, sRedBlack, sStd);
+      const std::vector <uint64_t> keys = randomKeys(numKeys / 2);
+
+      size_t numErasedBTree = 0;
+      double secondsBTree = time([&]()
+      {
+         for (uint64_t key : keys)
+            numErasedBTree += sBTree.erase(key);
+      });
+      record("erase random keys, btree_set", keys.size(), secondsBTree);
+
+      size_t numErasedRedBlack = 0;
+      double secondsRedBlack = time([&]()
+      {
+         for (uint64_t key : keys)
+            numErasedRedBlack += sRedBlack.erase(key);
+      });
+      record("erase random keys, set", keys.size(), secondsRedBlack);
+
+      size_t numErasedStd = 0;
+      double secondsStd = time([&]()
+      {
+         for (uint64_t key : keys)
+            numErasedStd += sStd.erase(key);
+      });
+      record("erase random keys, std::set", keys.size(), secondsStd);
+
+      check(numErasedBTree == numErasedRedBlack && numErasedBTree == numErasedStd,
+            "all three erase the same " + std::to_string(numErasedBTree) + " elements");
+      check(secondsBTree < secondsRedBlack,
+            "the B-tree erases faster than the red-black tree");
+   }
+
+private:
+
+   /*************************************************************
+    * RANDOM KEYS
+    * The first num keys of a spread-out sequence, shuffled
+    *************************************************************/
+   static std::vector <uint64_t> randomKeys(size_t num)
+   {
+      std::vector <uint64_t> keys;
+      for (uint64_t i = 0; i < num; i++)
+         keys.push_back(i * 0x9E3779B97F4A7C15ull);
+      Random random;
+      for (size_t i = num; i > 1; i--)
+         std::swap(keys[i - 1], keys[(size_t)random(i)]);
+      return keys;
+   }
+
+   /*************************************************************
+    * FILL
+    * Put the same numKeys keys in every set
+    *************************************************************/
+   template <class ... Sets>
+   static void fill(size_t numKeys, Sets & ... sets)
+   {
+      for (uint64_t key : randomKeys(numKeys))
+         (sets.insert(key), ...);
+   }
+};
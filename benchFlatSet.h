@@ -0,0 +1,134 @@
+/***********************************************************************
+ * Header:
+ *    BENCH FLAT SET
+ * Summary:
+ *    The sorted-vector set against the red-black set, for data
+ *    built once and then searched
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"   // benchmark baseclass
+#include "flatSet.h"     // class under measurement
+#include "set.h"         // the red-black tree it stands in for
+#include <algorithm>     // for std::lower_bound
+#include <string>        // for std::to_string
+#include <vector>        // for std::vector
+
+/***********************************************
+ * BENCHMARK FLAT SET
+ * Measurements for the flat_set class
+ ***********************************************/
+class BenchFlatSet : public Benchmark
+{
+public:
+   BenchFlatSet(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("FlatSet");
+
+      bench_construct_bulk();
+      bench_find_random();
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    flat_set::flat_set(first, last)
+    *    flat_set::to_set()
+    ***************************************/
+
+   // load a table of random keys, some of them repeated
+   void bench_construct_bulk()
+   {
+      const size_t numKeys = size(2000000);
+      std::vector <uint64_t> keys;
+      Random random;
+      for (size_t i = 0; i < numKeys; i++)
+         keys.push_back(random(numKeys) * 0x9E3779B97F4A7C15ull);
+
+      custom::set <uint64_t> sTree;
+      double secondsTree = time([&]()
+      {
+         for (uint64_t key : keys)
+            sTree.insert(key);
+      });
+      record("build a set one insert at a time", numKeys, secondsTree);
+
+      custom::flat_set <uint64_t> sFlat;
+      double secondsFlat = time([&]()
+      {
+         sFlat = custom::flat_set <uint64_t>(keys.begin(), keys.end());
+      });
+      record("build a flat_set with sort and dedup", numKeys, secondsFlat);
+
+      custom::set <uint64_t> sConverted;
+      double secondsConvert = time([&]()
+      {
+         sConverted = sFlat.to_set();
+      });
+      record("convert the flat_set to a set", sFlat.size(), secondsConvert);
+
+      check(sFlat.size() == sTree.size() && sConverted.size() == sTree.size(),
+            "all hold the same " + std::to_string(sFlat.size()) + " elements");
+      check(secondsFlat < secondsTree,
+            "sorting once beats inserting one at a time");
+   }
+
+   /***************************************
+    * FIND
+    *    flat_set::find(t)
+    ***************************************/
+
+   // half the probes hit
+   void bench_find_random()
+   {
+      const size_t numKeys = size(2000000);
+      const size_t numProbes = size(2000000);
+      std::vector <uint64_t> keys;
+      for (uint64_t i = 0; i < numKeys; i++)
+         keys.push_back(i * 0x9E3779B97F4A7C15ull);
+      custom::set <uint64_t> sTree(keys.begin(), keys.end());
+      custom::flat_set <uint64_t> sFlat(keys.begin(), keys.end());
+      const std::vector <uint64_t> sorted(sFlat.begin(), sFlat.end());
+
+      std::vector <uint64_t> probes;
+      Random random;
+      for (size_t i = 0; i < numProbes; i++)
+         probes.push_back(random(2 * numKeys) * 0x9E3779B97F4A7C15ull);
+
+      size_t numFoundTree = 0;
+      double secondsTree = time([&]()
+      {
+         for (uint64_t probe : probes)
+            numFoundTree += sTree.find(probe) != sTree.end();
+      });
+      record("find random keys, set", numProbes, secondsTree);
+
+      size_t numFoundStd = 0;
+      double secondsStd = time([&]()
+      {
+         for (uint64_t probe : probes)
+         {
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), probe);
+            numFoundStd += it != sorted.end() && *it == probe;
+         }
+      });
+      record("find random keys, std::lower_bound", numProbes, secondsStd);
+
+      size_t numFoundFlat = 0;
+      double secondsFlat = time([&]()
+      {
+         for (uint64_t probe : probes)
+            numFoundFlat += sFlat.find(probe) != sFlat.end();
+      });
+      record("find random keys, flat_set", numProbes, secondsFlat);
+
+      check(numFoundFlat == numFoundTree && numFoundFlat == numFoundStd,
+            "all find the same " + std::to_string(numFoundFlat) + " keys");
+      check(secondsFlat < secondsTree,
+            "the sorted vector finds faster than the tree");
+   }
+};
@@ -0,0 +1,170 @@
+/***********************************************************************
+ * Header:
+ *    BENCH INDEX SET
+ * Summary:
+ *    The index-linked red-black set against the pointer-linked one:
+ *    memory, search, and what it takes to save and restore a tree
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"   // benchmark baseclass
+#include "indexSet.h"    // class under measurement
+#include "set.h"         // the pointer-linked set it stands beside
+#include <cstdint>       // for uint32_t
+#include <string>        // for std::to_string
+#include <utility>       // for std::swap
+#include <vector>        // for std::vector
+
+/***********************************************
+ * BENCHMARK INDEX SET
+ * Measurements for the index_set class
+ ***********************************************/
+class BenchIndexSet : public Benchmark
+{
+public:
+   BenchIndexSet(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("IndexSet");
+
+      bench_memory_links();
+      bench_find_random();
+      bench_serialize_restore();
+   }
+
+   /***************************************
+    * MEMORY
+    *    index_set::Node
+    ***************************************/
+
+   // the same random ints in both, counting every slot each has room for
+   void bench_memory_links()
+   {
+      const size_t numKeys = size(4000000);
+      std::vector <int> keys = randomKeys(numKeys);
+
+      custom::set <int> sPointer;
+      double secondsPointer = time([&]()
+      {
+         for (int key : keys)
+            sPointer.insert(key);
+      });
+      record("insert random ints, set", numKeys, secondsPointer);
+
+      custom::index_set <int> sIndex;
+      double secondsIndex = time([&]()
+      {
+         for (int key : keys)
+            sIndex.insert(key);
+      });
+      record("insert random ints, index_set", numKeys, secondsIndex);
+
+      size_t bytesPointer = sPointer.capacity() * sizeof(custom::BST <int> ::BNode);
+      size_t bytesIndex = (sIndex.capacity() + 1) * sizeof(custom::index_set <int> ::Node);
+      recordMemory("nodes of ints, 64-bit pointers", sPointer.size(), bytesPointer);
+      recordMemory("nodes of ints, 32-bit indices", sIndex.size(), bytesIndex);
+
+      check(sIndex.size() == sPointer.size(),
+            "both hold the same " + std::to_string(sIndex.size()) + " elements");
+      check(bytesIndex < bytesPointer,
+            "indices take less room than pointers");
+   }
+
+   /***************************************
+    * FIND
+    *    index_set::find(t)
+    ***************************************/
+
+   // half the probes hit
+   void bench_find_random()
+   {
+      const size_t numKeys = size(2000000);
+      const size_t numProbes = size(2000000);
+      std::vector <int> keys;
+      for (size_t i = 0; i < numKeys; i++)
+         keys.push_back((int)(i * 2));
+      std::vector <int> shuffled = keys;
+      Random random;
+      for (size_t i = shuffled.size(); i > 1; i--)
+         std::swap(shuffled[i - 1], shuffled[random(i)]);
+      custom::set <int> sPointer(shuffled.begin(), shuffled.end());
+      custom::index_set <int> sIndex(shuffled.begin(), shuffled.end());
+
+      std::vector <int> probes;
+      for (size_t i = 0; i < numProbes; i++)
+         probes.push_back((int)random(2 * numKeys));
+
+      size_t numFoundPointer = 0;
+      double secondsPointer = time([&]()
+      {
+         for (int probe : probes)
+            numFoundPointer += sPointer.find(probe) != sPointer.end();
+      });
+      record("find random keys, set", numProbes, secondsPointer);
+
+      size_t numFoundIndex = 0;
+      double secondsIndex = time([&]()
+      {
+         for (int probe : probes)
+            numFoundIndex += sIndex.find(probe) != sIndex.end();
+      });
+      record("find random keys, index_set", numProbes, secondsIndex);
+
+      check(numFoundIndex == numFoundPointer,
+            "both find the same " + std::to_string(numFoundIndex) + " keys");
+   }
+
+   /***************************************
+    * SERIALIZE
+    *    index_set::serialize()
+    *    index_set::deserialize(p, n)
+    ***************************************/
+
+   // save a tree and get it back, against walking it out and inserting it again
+   void bench_serialize_restore()
+   {
+      const size_t numKeys = size(2000000);
+      std::vector <int> keys = randomKeys(numKeys);
+      custom::set <int> sPointer(keys.begin(), keys.end());
+      custom::index_set <int> sIndex(keys.begin(), keys.end());
+
+      custom::set <int> sRebuilt;
+      double secondsRebuild = time([&]()
+      {
+         std::vector <int> saved;
+         saved.reserve(sPointer.size());
+         for (auto it = sPointer.begin(); it != sPointer.end(); ++it)
+            saved.push_back(*it);
+         sRebuilt = custom::set <int>(saved.begin(), saved.end());
+      });
+      record("save and rebuild a set", sPointer.size(), secondsRebuild);
+
+      custom::index_set <int> sRestored;
+      double secondsRestore = time([&]()
+      {
+         std::vector <unsigned char> saved = sIndex.serialize();
+         sRestored = custom::index_set <int> ::deserialize(saved.data(), saved.size());
+      });
+      record("serialize and deserialize an index_set", sIndex.size(), secondsRestore);
+
+      check(sRestored.size() == sIndex.size() && sRebuilt.size() == sPointer.size(),
+            "both come back whole");
+      check(secondsRestore < secondsRebuild,
+            "copying the bytes beats rebuilding the tree");
+   }
+
+private:
+
+   std::vector <int> randomKeys(size_t num)
+   {
+      std::vector <int> keys;
+      Random random;
+      for (size_t i = 0; i < num; i++)
+         keys.push_back((int)random());
+      return keys;
+   }
+};
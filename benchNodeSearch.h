@@ -0,0 +1,102 @@
+/***********************************************************************
+ * Header:
+ *    BENCH NODE SEARCH
+ * Summary:
+ *    What it costs to search one B-tree node, with the vector
+ *    kernels and with std::lower_bound
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"    // benchmark baseclass
+#include "nodeSearch.h"   // class under measurement
+#include <algorithm>      // for std::lower_bound, std::sort
+#include <cstdint>        // for uint64_t
+#include <string>         // for std::string
+#include <vector>         // for std::vector
+
+/***********************************************
+ * BENCHMARK NODE SEARCH
+ * Measurements for the NodeSearch class
+ ***********************************************/
+class BenchNodeSearch : public Benchmark
+{
+public:
+   BenchNodeSearch(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("NodeSearch");
+
+#if defined(NODE_SEARCH_AVX2)
+      std::cout << "\tkernels: AVX2\n";
+#elif defined(NODE_SEARCH_SSE42)
+      std::cout << "\tkernels: SSE4.2\n";
+#elif defined(NODE_SEARCH_SSE2)
+      std::cout << "\tkernels: SSE2\n";
+#else
+      std::cout << "\tkernels: scalar\n";
+#endif
+
+      bench_search_node <int32_t>("int32_t");
+      bench_search_node <uint64_t>("uint64_t");
+      bench_search_node <float>("float");
+      bench_search_node <double>("double");
+   }
+
+   /***************************************
+    * SEARCH
+    *    NodeSearch::countLess(keys, num, t)
+    ***************************************/
+
+   // find the lower bound in a full leaf, a different leaf each time
+   // and all of them in cache, so the search is all that is measured
+   template <class T>
+   void bench_search_node(const std::string & name)
+   {
+      const size_t numKeys = (256 - 3 * sizeof(void *)) / sizeof(T);   // as in a btree_set leaf
+      const size_t numNodes = 256;
+      const size_t numProbes = size(20000000);
+      Random random;
+
+      std::vector <T> keys(numNodes * numKeys);
+      for (size_t node = 0; node < numNodes; node++)
+      {
+         for (size_t i = 0; i < numKeys; i++)
+            keys[node * numKeys + i] = (T)random(1000000);
+         std::sort(keys.begin() + node * numKeys, keys.begin() + (node + 1) * numKeys);
+      }
+      std::vector <T> probes;
+      for (size_t i = 0; i < 4096; i++)
+         probes.push_back((T)random(1000000));
+
+      size_t sumStd = 0;
+      double secondsStd = time([&]()
+      {
+         for (size_t i = 0; i < numProbes; i++)
+         {
+            const T * pNode = keys.data() + (i % numNodes) * numKeys;
+            sumStd += std::lower_bound(pNode, pNode + numKeys, probes[i % probes.size()]) - pNode;
+         }
+      });
+      record(name + " node of " + std::to_string(numKeys) + ", std::lower_bound", numProbes, secondsStd);
+
+      size_t sumCount = 0;
+      double secondsCount = time([&]()
+      {
+         for (size_t i = 0; i < numProbes; i++)
+         {
+            const T * pNode = keys.data() + (i % numNodes) * numKeys;
+            sumCount += custom::NodeSearch::countLess(pNode, numKeys, probes[i % probes.size()]);
+         }
+      });
+      record(name + " node of " + std::to_string(numKeys) + ", NodeSearch", numProbes, secondsCount);
+
+      check(sumStd == sumCount, name + ": both land on the same keys");
+      if (custom::NodeSearch::vectorized<T>())
+         check(secondsCount < secondsStd,
+               name + ": vector compares beat the binary search");
+   }
+};
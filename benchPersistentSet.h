@@ -0,0 +1,180 @@
+/***********************************************************************
+ * Header:
+ *    BENCH PERSISTENT SET
+ * Summary:
+ *    Keeping many versions of one large set: path copying against
+ *    a full copy of the tree for every version
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"       // benchmark baseclass
+#include "persistentSet.h"   // class under measurement
+#include "set.h"             // the set whose copies it stands in for
+#include <string>            // for std::to_string
+#include <unordered_set>     // for std::unordered_set
+#include <vector>            // for std::vector
+
+/***********************************************
+ * BENCHMARK PERSISTENT SET
+ * Measurements for the pset class
+ ***********************************************/
+class BenchPersistentSet : public Benchmark
+{
+public:
+   BenchPersistentSet(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("PersistentSet");
+
+      bench_versions_memory();
+      bench_find_random();
+   }
+
+   /***************************************
+    * VERSIONS
+    *    pset::insert(t)
+    *    pset::erase(t)
+    ***************************************/
+
+   // a chain of versions, each a few changes from the one before,
+   // all of them kept
+   void bench_versions_memory()
+   {
+      const size_t numKeys = size(200000);
+      const size_t numVersions = 64;
+      const size_t numChanges = 16;
+      std::vector <int> keys;
+      Random random;
+      for (size_t i = 0; i < numKeys; i++)
+         keys.push_back((int)random(4 * numKeys));
+      std::vector <int> changes;
+      for (size_t i = 0; i < numVersions * numChanges; i++)
+         changes.push_back((int)random(4 * numKeys));
+
+      std::vector <custom::set <int>> copies(1, custom::set <int>(keys.begin(), keys.end()));
+      double secondsCopy = time([&]()
+      {
+         for (size_t v = 0; v < numVersions; v++)
+         {
+            copies.push_back(copies.back());
+            for (size_t i = 0; i < numChanges; i++)
+            {
+               int t = changes[v * numChanges + i];
+               if (i % 2)
+                  copies.back().erase(t);
+               else
+                  copies.back().insert(t);
+            }
+         }
+      });
+      record("make " + std::to_string(numVersions) + " versions, set copies",
+             numVersions, secondsCopy);
+
+      std::vector <custom::pset <int>> versions(1, custom::pset <int>(keys.begin(), keys.end()));
+      double secondsPath = time([&]()
+      {
+         for (size_t v = 0; v < numVersions; v++)
+         {
+            custom::pset <int> s = versions.back();
+            for (size_t i = 0; i < numChanges; i++)
+            {
+               int t = changes[v * numChanges + i];
+               s = (i % 2) ? s.erase(t) : s.insert(t);
+            }
+            versions.push_back(s);
+         }
+      });
+      record("make " + std::to_string(numVersions) + " versions, pset",
+             numVersions, secondsPath);
+
+      size_t numElements = 0;
+      size_t bytesCopy = 0;
+      for (const custom::set <int> & s : copies)
+      {
+         numElements += s.size();
+         bytesCopy += s.capacity() * sizeof(custom::BST <int> ::BNode);
+      }
+      size_t bytesPath = numNodes(versions) * sizeof(custom::pset <int> ::Node);
+      recordMemory("all versions, set copies", numElements, bytesCopy);
+      recordMemory("all versions, pset", numElements, bytesPath);
+
+      bool same = true;
+      for (size_t v = 0; v < copies.size(); v++)
+         same = same && copies[v].size() == versions[v].size();
+      check(same, "every version holds the same number of elements");
+      check(bytesPath * 8 < bytesCopy,
+            "sharing nodes takes a fraction of the memory of copies");
+      check(secondsPath < secondsCopy,
+            "copying a path beats copying the tree");
+   }
+
+   /***************************************
+    * FIND
+    *    pset::contains(t)
+    ***************************************/
+
+   // half the probes hit; the nodes are no different to search
+   void bench_find_random()
+   {
+      const size_t numKeys = size(1000000);
+      const size_t numProbes = size(1000000);
+      std::vector <int> keys;
+      for (size_t i = 0; i < numKeys; i++)
+         keys.push_back((int)(i * 2));
+      custom::set <int> sTree(keys.begin(), keys.end());
+      custom::pset <int> sPersistent(keys.begin(), keys.end());
+
+      std::vector <int> probes;
+      Random random;
+      for (size_t i = 0; i < numProbes; i++)
+         probes.push_back((int)random(2 * numKeys));
+
+      size_t numFoundTree = 0;
+      double secondsTree = time([&]()
+      {
+         for (int probe : probes)
+            numFoundTree += sTree.find(probe) != sTree.end();
+      });
+      record("find random keys, set", numProbes, secondsTree);
+
+      size_t numFoundPersistent = 0;
+      double secondsPersistent = time([&]()
+      {
+         for (int probe : probes)
+            numFoundPersistent += sPersistent.contains(probe);
+      });
+      record("find random keys, pset", numProbes, secondsPersistent);
+
+      check(numFoundPersistent == numFoundTree,
+            "both find the same " + std::to_string(numFoundTree) + " keys");
+   }
+
+private:
+
+   // the nodes all the versions reach between them, each counted once
+   static size_t numNodes(const std::vector <custom::pset <int>> & versions)
+   {
+      typedef custom::pset <int> ::Node Node;
+      std::unordered_set <const Node *> found;
+      std::vector <const Node *> todo;
+      for (const custom::pset <int> & s : versions)
+         if (s.root)
+            todo.push_back(s.root.get());
+      while (!todo.empty())
+      {
+         const Node * p = todo.back();
+         todo.pop_back();
+         if (!found.insert(p).second)
+            continue;   // shared: its subtree is already counted
+         if (p->pLeft)
+            todo.push_back(p->pLeft.get());
+         if (p->pRight)
+            todo.push_back(p->pRight.get());
+      }
+      return found.size();
+   }
+};
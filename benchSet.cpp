@@ -0,0 +1,68 @@
+/***********************************************************************
+ * Source:
+ *    Benchmark
+ * Summary:
+ *    Driver to measure the performance of bst.h and set.h
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#include "benchBST.h"       // for the BST benchmarks
+#include "benchSet.h"       // for the set benchmarks
+#include "benchConcurrentSet.h" // for the concurrent set benchmarks
+#include "benchBTreeSet.h"  // for the B-tree set benchmarks
+#include "benchFlatSet.h"   // for the flat set benchmarks
+#include "benchNodeSearch.h" // for the in-node search benchmarks
+#include "benchIndexSet.h"  // for the index-linked set benchmarks
+#include "benchPersistentSet.h" // for the persistent set benchmarks
+
+#include <cstdlib>          // for std::atof
+
+/**********************************************************************
+ * MAIN
+ * Run every benchmark. The optional argument scales the problem sizes:
+ *    LabSetBench 0.1     a quick smoke run
+ *    LabSetBench 10      ten times the default sizes
+ ***********************************************************************/
+int main(int argc, char ** argv)
+{
+   double scale = (argc > 1) ? std::atof(argv[1]) : 1.0;
+   if (scale <= 0.0)
+      scale = 1.0;
+
+   int numFailed = 0;
+
+   BenchBST bst(scale);
+   bst.run();
+   numFailed += bst.failed();
+
+   BenchSet set(scale);
+   set.run();
+   numFailed += set.failed();
+
+   BenchConcurrentSet concurrentSet(scale);
+   concurrentSet.run();
+   numFailed += concurrentSet.failed();
+
+   BenchBTreeSet btreeSet(scale);
+   btreeSet.run();
+   numFailed += btreeSet.failed();
+
+   BenchFlatSet flatSet(scale);
+   flatSet.run();
+   numFailed += flatSet.failed();
+
+   BenchNodeSearch nodeSearch(scale);
+   nodeSearch.run();
+   numFailed += nodeSearch.failed();
+
+   BenchIndexSet indexSet(scale);
+   indexSet.run();
+   numFailed += indexSet.failed();
+
+   BenchPersistentSet persistentSet(scale);
+   persistentSet.run();
+   numFailed += persistentSet.failed();
+
+   return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,558 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK SET
+ * Summary:
+ *    Performance measurements for the set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "set.h"
+#include "benchmark.h"
+
+#include <string>     // for std::to_string
+#include <string_view> // for std::string_view
+#include <vector>     // for std::vector
+
+/***********************************************
+ * BENCHMARK SET
+ * Measurements for the set class
+ ***********************************************/
+class BenchSet : public Benchmark
+{
+public:
+   BenchSet(double scale = 1.0) : Benchmark(scale) { }
+
+   void run()
+   {
+      heading("Set");
+
+      bench_copy_large();
+      bench_insert_append();
+      bench_merge_shards();
+      bench_union_large();
+      bench_split_reshard();
+      bench_eraseRange_oldest();
+      bench_rank_ranked();
+      bench_find_transparent();
+      bench_iterate_fullScan();
+      bench_snapshot_views();
+   }
+
+   /***************************************
+    * COPY and DESTROY
+    *    set::set(const set &)
+    *    set::~set()
+    ***************************************/
+
+   // copying and destroying a big set costs time, not stack
+   void bench_copy_large()
+   {
+      const size_t numKeys = size(10000000);
+      custom::set <uint64_t> sSrc;
+      Random random;
+      while (sSrc.size() < numKeys)
+         sSrc.insert(random());
+
+      size_t numCopied = 0;
+      double secondsCopy;
+      double secondsDestroy;
+      {
+         custom::set <uint64_t> * pCopy = nullptr;
+         secondsCopy = time([&]()
+         {
+            pCopy = new custom::set <uint64_t>(sSrc);
+         });
+         numCopied = pCopy->size();
+         secondsDestroy = time([&]()
+         {
+            delete pCopy;
+         });
+      }
+      record("copy a random set", numKeys, secondsCopy);
+      record("destroy the copy", numKeys, secondsDestroy);
+
+      custom::set <std::string> sStrings;
+      for (size_t i = 0; i < numKeys / 10; i++)
+         sStrings.insert(std::to_string(random()));
+      double secondsStrings = time([&]()
+      {
+         custom::set <std::string> sCopy(sStrings);
+         sCopy.clear();
+      });
+      record("copy and clear a set of strings", sStrings.size(), secondsStrings);
+
+      check(numCopied == sSrc.size(),
+            "copied all " + std::to_string(numCopied) + " elements");
+   }
+
+   /***************************************
+    * INSERT
+    *    set::insert(t)
+    *    set::insert(hint, t)
+    ***************************************/
+
+   // keys that always land past the current maximum
+   void bench_insert_append()
+   {
+      const size_t numKeys = size(10000000);
+
+      custom::set <uint64_t> sPlain;
+      double secondsPlain = time([&]()
+      {
+         for (uint64_t i = 0; i < numKeys; i++)
+            sPlain.insert(i);
+      });
+      record("append without a hint", numKeys, secondsPlain);
+
+      custom::set <uint64_t> sHinted;
+      double secondsHinted = time([&]()
+      {
+         for (uint64_t i = 0; i < numKeys; i++)
+            sHinted.insert(sHinted.end(), i);
+      });
+      record("append with end() as the hint", numKeys, secondsHinted);
+
+      check(sPlain.size() == numKeys && sHinted.size() == numKeys,
+            "both sets hold all " + std::to_string(numKeys) + " elements");
+      check(secondsHinted < secondsPlain,
+            "the hint beats searching from the root");
+   }
+
+   /***************************************
+    * MERGE
+    *    set::merge(source)
+    *    set::erase(it) then set::insert(t)
+    ***************************************/
+
+   // move one shard of keys into another, by copying and by relinking
+   void bench_merge_shards()
+   {
+      const size_t numKeys = size(2000000);
+      custom::set <uint64_t> sSrcCopy;
+      custom::set <uint64_t> sDestCopy;
+      custom::set <uint64_t> sSrcMerge;
+      custom::set <uint64_t> sDestMerge;
+      Random random;
+      while (sSrcCopy.size() < numKeys)
+      {
+         uint64_t key = random();
+         sSrcCopy.insert(key);
+         sSrcMerge.insert(key);
+         key = random();
+         sDestCopy.insert(key);
+         sDestMerge.insert(key);
+      }
+
+      double secondsCopy = time([&]()
+      {
+         for (auto it = sSrcCopy.begin(); it != sSrcCopy.end(); )
+         {
+            sDestCopy.insert(*it);
+            it = sSrcCopy.erase(it);
+         }
+      });
+      record("move a shard with erase and insert", numKeys, secondsCopy);
+
+      double secondsMerge = time([&]()
+      {
+         sDestMerge.merge(sSrcMerge);
+      });
+      record("move a shard with merge", numKeys, secondsMerge);
+
+      check(sDestMerge.size() == sDestCopy.size() && sSrcMerge.size() == sSrcCopy.size(),
+            "both ways move the same " + std::to_string(sDestMerge.size()) + " elements");
+   }
+
+   /***************************************
+    * SET ALGEBRA
+    *    set_union(lhs, rhs)
+    *    set_intersection(lhs, rhs)
+    ***************************************/
+
+   // splitting and joining, copying only the result or relinking
+   // moved sets, against copying and inserting one at a time
+   void bench_union_large()
+   {
+      const size_t numKeys = size(2000000);
+      custom::set <uint64_t> sLHS;
+      custom::set <uint64_t> sRHS;
+      Random random;
+      while (sLHS.size() < numKeys)
+      {
+         sLHS.insert(random() % (4 * numKeys));
+         sRHS.insert(random() % (4 * numKeys));
+      }
+
+      size_t numInsert = 0;
+      double secondsInsert = time([&]()
+      {
+         custom::set <uint64_t> s(sLHS);
+         for (auto it = sRHS.begin(); it != sRHS.end(); ++it)
+            s.insert(*it);
+         numInsert = s.size();
+      });
+      record("union by copy and insert", sLHS.size() + sRHS.size(), secondsInsert);
+
+      size_t numWalk = 0;
+      double secondsWalk = time([&]()
+      {
+         numWalk = custom::set_union(sLHS, sRHS).size();
+      });
+      record("union by split and join, copying", sLHS.size() + sRHS.size(), secondsWalk);
+
+      custom::set <uint64_t> sLHSCopy(sLHS);
+      custom::set <uint64_t> sRHSCopy(sRHS);
+      size_t numJoin = 0;
+      double secondsJoin = time([&]()
+      {
+         numJoin = custom::set_union(std::move(sLHSCopy), std::move(sRHSCopy)).size();
+      });
+      record("union of moved sets by split and join, relinking", sLHS.size() + sRHS.size(), secondsJoin);
+
+      size_t numFind = 0;
+      double secondsFind = time([&]()
+      {
+         custom::set <uint64_t> s;
+         for (auto it = sLHS.begin(); it != sLHS.end(); ++it)
+            if (sRHS.contains(*it))
+               s.insert(s.end(), *it);
+         numFind = s.size();
+      });
+      record("intersection by find and append", sLHS.size() + sRHS.size(), secondsFind);
+
+      size_t numIntersect = 0;
+      double secondsIntersect = time([&]()
+      {
+         numIntersect = custom::set_intersection(sLHS, sRHS).size();
+      });
+      record("intersection by split and join, copying", sLHS.size() + sRHS.size(), secondsIntersect);
+
+      check(numInsert == numWalk && numInsert == numJoin && numFind == numIntersect,
+            "both ways agree on " + std::to_string(numJoin) + " and " +
+            std::to_string(numIntersect) + " elements");
+   }
+
+   /***************************************
+    * SPLIT and JOIN
+    *    set::split(t)
+    *    set::join(rhs)
+    ***************************************/
+
+   // move the top half of a shard to another shard and back
+   void bench_split_reshard()
+   {
+      const size_t numKeys = size(2000000);
+      custom::set <uint64_t> sErase;
+      custom::set <uint64_t> sSplit;
+      custom::set <uint64_t, std::less <uint64_t>, true> sRanked;
+      Random random;
+      while (sErase.size() < numKeys)
+      {
+         uint64_t key = random();
+         sErase.insert(key);
+         sSplit.insert(key);
+         sRanked.insert(key);
+      }
+      const uint64_t middle = UINT64_MAX / 2;
+
+      custom::set <uint64_t> sEraseHigh;
+      double secondsErase = time([&]()
+      {
+         auto itBegin = sErase.lower_bound(middle);
+         auto itEnd = sErase.end();
+         for (auto it = itBegin; it != itEnd; ++it)
+            sEraseHigh.insert(sEraseHigh.end(), *it);
+         sErase.erase(itBegin, itEnd);
+      });
+      record("move half a shard with insert and erase", sEraseHigh.size(), secondsErase);
+
+      custom::set <uint64_t> sSplitHigh;
+      double secondsSplit = time([&]()
+      {
+         sSplitHigh = sSplit.split(middle);
+      });
+      record("move half a shard with split", sSplitHigh.size(), secondsSplit);
+
+      // with subtree sizes both sides know their size right away
+      custom::set <uint64_t, std::less <uint64_t>, true> sRankedHigh;
+      double secondsRanked = time([&]()
+      {
+         sRankedHigh = sRanked.split(middle);
+      });
+      record("move half a Ranked shard with split", sRankedHigh.size(), secondsRanked);
+
+      size_t numMoved = sSplitHigh.size();
+      double secondsJoin = time([&]()
+      {
+         sSplit.join(sSplitHigh);
+      });
+      record("move it back with join", numMoved, secondsJoin);
+
+      check(sEraseHigh.size() + sErase.size() == numKeys && sSplit.size() == numKeys &&
+            sRankedHigh.size() == numMoved,
+            "split off " + std::to_string(sEraseHigh.size()) + " of " +
+            std::to_string(numKeys) + " and joined them back");
+      check(secondsSplit * 10.0 < secondsErase,
+            "split leaves the counting for later, so it beats moving elements");
+   }
+
+   /***************************************
+    * ERASE RANGE
+    *    set::erase(itBegin, itEnd)
+    ***************************************/
+
+   // drop the oldest fifth of a set of timestamps that arrived out of order
+   void bench_eraseRange_oldest()
+   {
+      const size_t numKeys = size(2000000);
+      custom::set <uint64_t> sSrc;
+      Random random;
+      while (sSrc.size() < numKeys)
+         sSrc.insert(random());
+      custom::set <uint64_t> sOne(sSrc);
+      custom::set <uint64_t> sRange(sSrc);
+      const uint64_t cutoff = UINT64_MAX / 5;
+
+      size_t numErased = 0;
+      double secondsOne = time([&]()
+      {
+         auto it = sOne.begin();
+         auto itEnd = sOne.lower_bound(cutoff);
+         for (; it != itEnd; numErased++)
+            it = sOne.erase(it);
+      });
+      record("erase the oldest fifth one at a time", numErased, secondsOne);
+
+      double secondsRange = time([&]()
+      {
+         auto itBegin = sRange.begin();
+         auto itEnd = sRange.lower_bound(cutoff);
+         sRange.erase(itBegin, itEnd);
+      });
+      record("erase the oldest fifth as a range", numErased, secondsRange);
+
+      check(sOne.size() == sRange.size() && sOne.size() + numErased == numKeys,
+            "both leave " + std::to_string(sRange.size()) + " elements");
+   }
+
+   /***************************************
+    * ORDER STATISTICS
+    *    set::rank(t)
+    *    set::select(k)
+    ***************************************/
+
+   // "how many are smaller" by walking versus by subtree sizes
+   void bench_rank_ranked()
+   {
+      const size_t numKeys = size(1000000);
+      const size_t numQueries = size(1000);
+      custom::set <uint64_t, std::less <uint64_t>, true> s;
+      Random random;
+      while (s.size() < numKeys)
+         s.insert(random());
+
+      std::vector <uint64_t> queries;
+      for (size_t i = 0; i < numQueries; i++)
+         queries.push_back(random());
+
+      size_t sumWalk = 0;
+      double secondsWalk = time([&]()
+      {
+         for (uint64_t query : queries)
+            for (auto it = s.begin(); it != s.end() && *it < query; ++it)
+               sumWalk++;
+      });
+      record("rank by walking the iterator", numQueries, secondsWalk);
+
+      size_t sumRank = 0;
+      double secondsRank = time([&]()
+      {
+         for (uint64_t query : queries)
+            sumRank += s.rank(query);
+      });
+      record("rank from subtree sizes", numQueries, secondsRank);
+
+      bool selectValid = true;
+      double secondsSelect = time([&]()
+      {
+         for (size_t i = 0; i < numQueries; i++)
+         {
+            size_t k = (size_t)random(numKeys);
+            selectValid = selectValid && s.rank(*s.select(k)) == k;
+         }
+      });
+      record("select then rank", numQueries, secondsSelect);
+
+      check(sumWalk == sumRank, "both ways rank the same");
+      check(selectValid, "rank undoes select");
+   }
+
+   /***************************************
+    * FIND
+    *    set::find(const T &)
+    *    set::find(const K &)
+    ***************************************/
+
+   // probe a set of strings with string_views, building a temporary
+   // std::string for each probe or comparing as is
+   void bench_find_transparent()
+   {
+      const size_t numKeys = size(200000);
+      const size_t numProbes = size(2000000);
+      custom::set <std::string> sPlain;
+      custom::set <std::string, std::less <>> sTransparent;
+      std::vector <std::string> probes;
+      Random random;
+      while (sPlain.size() < numKeys)
+      {
+         // long enough that a temporary std::string allocates
+         std::string key = "customer-account-" + std::to_string(random());
+         sPlain.insert(key);
+         sTransparent.insert(key);
+         if (probes.size() < 1000)
+            probes.push_back(key);
+      }
+      std::vector <std::string_view> views(probes.begin(), probes.end());
+
+      size_t numPlain = 0;
+      double secondsPlain = time([&]()
+      {
+         for (size_t i = 0; i < numProbes; i++)
+            numPlain += sPlain.find(std::string(views[i % views.size()])) != sPlain.end();
+      });
+      record("find(string_view) with std::less<std::string>", numProbes, secondsPlain);
+
+      size_t numTransparent = 0;
+      double secondsTransparent = time([&]()
+      {
+         for (size_t i = 0; i < numProbes; i++)
+            numTransparent += sTransparent.find(views[i % views.size()]) != sTransparent.end();
+      });
+      record("find(string_view) with std::less<>", numProbes, secondsTransparent);
+
+      check(numPlain == numProbes && numTransparent == numProbes,
+            "both find all " + std::to_string(numProbes) + " probes");
+   }
+
+   /***************************************
+    * ITERATE
+    *    set::iterator::operator++()
+    *    set::iterator::operator--()
+    ***************************************/
+
+   // walk every element front to back, then back to front
+   void bench_iterate_fullScan()
+   {
+      const size_t numKeys = size(10000000);
+      custom::set <uint64_t> s;
+      Random random;
+      while (s.size() < numKeys)
+         s.insert(random());
+
+      uint64_t sumForward = 0;
+      size_t numForward = 0;
+      double secondsForward = time([&]()
+      {
+         for (auto it = s.begin(); it != s.end(); ++it)
+         {
+            sumForward += *it;
+            numForward++;
+         }
+      });
+      record("scan forward", numForward, secondsForward);
+
+      uint64_t sumBackward = 0;
+      size_t numBackward = 0;
+      double secondsBackward = time([&]()
+      {
+         auto it = s.end();
+         while (it != s.begin())
+         {
+            --it;
+            sumBackward += *it;
+            numBackward++;
+         }
+      });
+      record("scan backward from end()", numBackward, secondsBackward);
+
+      check(numForward == numKeys && numBackward == numKeys && sumForward == sumBackward,
+            "both scans visit all " + std::to_string(numKeys) + " elements");
+   }
+
+   /***************************************
+    * SNAPSHOT
+    *    set::snapshot()
+    ***************************************/
+
+   // a writer that hands out a read view after every few changes,
+   // the last one still being read: copying the set for each view,
+   // against taking a snapshot
+   void bench_snapshot_views()
+   {
+      const size_t numKeys = size(1000000);
+      const size_t numViews = 20;
+      const size_t numChanges = 16;
+      std::vector <uint64_t> changes;
+      Random random;
+      for (size_t i = 0; i < numViews * numChanges; i++)
+         changes.push_back(random(4 * numKeys));
+
+      custom::set <uint64_t> sCopied;
+      while (sCopied.size() < numKeys)
+         sCopied.insert(random(4 * numKeys));
+      custom::set <uint64_t> sShared(sCopied);
+
+      size_t sizeCopied = 0;
+      double secondsCopy = time([&]()
+      {
+         for (size_t v = 0; v < numViews; v++)
+         {
+            for (size_t i = 0; i < numChanges; i++)
+               if (i % 2)
+                  sCopied.erase(changes[v * numChanges + i]);
+               else
+                  sCopied.insert(changes[v * numChanges + i]);
+            custom::set <uint64_t> view(sCopied);
+            sizeCopied += view.size();
+         }
+      });
+      record("a view every " + std::to_string(numChanges) + " changes, copying",
+             numViews, secondsCopy);
+
+      // a reader holds the latest view while the writer works
+      custom::set <uint64_t> ::snapshot_type view;
+      double secondsFirst = time([&]()
+      {
+         view = sShared.snapshot();   // shares the whole tree
+      });
+      size_t sizeFirst = view.size();
+      record("first snapshot, a reference count", 1, secondsFirst);
+
+      size_t sizeShared = 0;
+      double secondsSnapshot = time([&]()
+      {
+         for (size_t v = 0; v < numViews; v++)
+         {
+            for (size_t i = 0; i < numChanges; i++)
+               if (i % 2)
+                  sShared.erase(changes[v * numChanges + i]);
+               else
+                  sShared.insert(changes[v * numChanges + i]);
+            view = sShared.snapshot();
+            sizeShared += view.size();
+         }
+      });
+      record("a view every " + std::to_string(numChanges) + " changes, snapshot",
+             numViews, secondsSnapshot);
+
+      check(sizeFirst == numKeys && sizeShared == sizeCopied,
+            "every view holds what the set held when it was taken");
+      check(secondsFirst < secondsCopy / numViews / 100.0,
+            "the first snapshot copies nothing either");
+      check(secondsSnapshot < secondsCopy / 10.0,
+            "sharing nodes beats copying the set");
+   }
+};
@@ -0,0 +1,125 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK
+ * Summary:
+ *    The base class to all the benchmark classes
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <chrono>    // for std::chrono::steady_clock
+#include <cstdint>   // for uint64_t
+#include <iostream>  // for std::cout
+#include <iomanip>   // for std::setw
+#include <string>    // for std::string
+
+class Benchmark
+{
+public:
+   // scale multiplies every problem size so a quick run is easy
+   Benchmark(double scale = 1.0) : scale(scale), numFailed(0) { }
+
+protected:
+   /*************************************************************
+    * SIZE
+    * Scale a problem size, never going below one
+    *************************************************************/
+   size_t size(size_t base) const
+   {
+      double num = (double)base * scale;
+      return num < 1.0 ? 1 : (size_t)num;
+   }
+
+   /*************************************************************
+    * TIME
+    * How many seconds does it take to run f once?
+    *************************************************************/
+   template <class F>
+   static double time(F f)
+   {
+      auto start = std::chrono::steady_clock::now();
+      f();
+      auto finish = std::chrono::steady_clock::now();
+      return std::chrono::duration<double>(finish - start).count();
+   }
+
+   /*************************************************************
+    * RANDOM
+    * A small, fast, repeatable pseudo-random generator so every
+    * run of a benchmark sees the same sequence (xorshift64*)
+    *************************************************************/
+   class Random
+   {
+   public:
+      Random(uint64_t seed = 88172645463325252ull) : state(seed ? seed : 1) { }
+      uint64_t operator () ()
+      {
+         state ^= state >> 12;
+         state ^= state << 25;
+         state ^= state >> 27;
+         return state * 2685821657736338717ull;
+      }
+      uint64_t operator () (uint64_t n) { return (*this)() % n; }
+   private:
+      uint64_t state;
+   };
+
+   /*************************************************************
+    * RECORD
+    * Report one measurement: what was measured and how fast
+    *************************************************************/
+   void record(const std::string & name, size_t num, double seconds)
+   {
+      std::cout << "\t" << std::left << std::setw(48) << name
+                << std::right << std::setw(12) << num << " ops "
+                << std::fixed << std::setprecision(3) << std::setw(9)
+                << seconds * 1000.0 << " ms "
+                << std::setprecision(1) << std::setw(8)
+                << (seconds > 0.0 ? seconds * 1.0e9 / (double)num : 0.0)
+                << " ns/op\n";
+   }
+
+   /*************************************************************
+    * RECORD MEMORY
+    * Report how much memory num elements take, in all and each
+    *************************************************************/
+   void recordMemory(const std::string & name, size_t num, size_t bytes)
+   {
+      std::cout << "\t" << std::left << std::setw(48) << name
+                << std::right << std::setw(12) << num << " elts "
+                << std::fixed << std::setprecision(1) << std::setw(9)
+                << (double)bytes / 1048576.0 << " MB "
+                << std::setprecision(1) << std::setw(8)
+                << (num > 0 ? (double)bytes / (double)num : 0.0)
+                << " B/elt\n";
+   }
+
+   /*************************************************************
+    * CHECK
+    * Report a property the benchmark is meant to demonstrate
+    *************************************************************/
+   void check(bool condition, const std::string & description)
+   {
+      if (!condition)
+         numFailed++;
+      std::cout << "\t" << (condition ? "[pass] " : "[FAIL] ")
+                << description << "\n";
+   }
+
+   /*************************************************************
+    * HEADING
+    * Name the group of measurements that follow
+    *************************************************************/
+   static void heading(const char * name)
+   {
+      std::cout << name << ":\n";
+   }
+
+   double scale;        // multiplier on every problem size
+   int    numFailed;    // how many checks did not hold
+
+public:
+   int failed() const { return numFailed; }
+};
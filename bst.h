@@ -13,6 +13,8 @@
  *    This will contain the class definition of:
  *        BST                 : A class that represents a binary search tree
  *        BST::iterator       : An iterator through BST
+ *        BST::node_type      : A node taken out of a BST
+ *        BST::snapshot_type  : A read-only view of a BST as it was
  * Author
  *    Daniel Carr, Jarom Anderson, Arlo Jolly
  ************************************************************************/
@@ -29,34 +31,119 @@
 
 #include <cassert>
 #include <utility>
+#include <type_traits> // for std::is_trivially_destructible
 #include <memory>     // for std::allocator
+#include "pool.h"     // for Pool
 #include <functional> // for std::less
 #include <utility>    // for std::pair
+#include <iterator>   // for std::distance, std::iterator_traits, std::reverse_iterator
+#include <vector>     // for std::vector
+#include <future>     // for std::async
+#include <exception>  // for std::exception_ptr
+#include <atomic>     // for std::atomic
+#include <cstdint>    // for uint16_t
+#include <thread>     // for std::thread::hardware_concurrency
+#if defined(__cpp_lib_three_way_comparison) && __cpp_lib_three_way_comparison >= 201907L
+#include <compare>    // for std::three_way_comparable
+#endif
 
 class TestBST; // forward declaration for unit tests
 class TestSet;
 class TestMap;
+class BenchBST; // forward declaration for benchmarks
+class BenchIndexSet;
+class BenchPersistentSet;
 
 namespace custom
 {
 
-   template <typename TT>
+   template <typename TT, typename CC, bool RR>
    class set;
    template <typename KK, typename VV>
    class map;
 
 /*****************************************************************
- * BINARY SEARCH TREE
- * Create a Binary Search Tree
+ * USE THREE WAY
+ * Can a BST ordered by Compare find out "less, equal, or greater"
+ * with a single operator<=> instead of two calls to Compare? Only
+ * when Compare is plain std::less and T has a consistent <=>.
  *****************************************************************/
+template <typename T, typename Compare>
+struct useThreeWay : std::false_type { };
+#if defined(__cpp_lib_three_way_comparison) && __cpp_lib_three_way_comparison >= 201907L
+template <typename T>
+   requires std::three_way_comparable<T>
+struct useThreeWay <T, std::less<T>> : std::true_type { };
+
+template <typename T>
+auto compareThreeWay(const T & lhs, const T & rhs) { return lhs <=> rhs; }
+#else
+// never called: useThreeWay is always false before C++20
 template <typename T>
+int compareThreeWay(const T & lhs, const T & rhs) { return 0; }
+#endif
+
+/*****************************************************************
+ * FROM SORTED
+ * Tag promising that a range is already in strictly ascending
+ * order, so the tree can be built in one linear pass rather than
+ * one insert (and one rebalance) at a time:
+ *    custom::set <int> s(custom::from_sorted, v.begin(), v.end());
+ *****************************************************************/
+struct from_sorted_t { explicit from_sorted_t() = default; };
+inline constexpr from_sorted_t from_sorted{};
+
+/*****************************************************************
+ * IS TRANSPARENT
+ * Does Compare promise to order other types against T directly,
+ * the way std::less<> does, without building a T first?
+ *****************************************************************/
+template <typename Compare, typename = void>
+struct isTransparent : std::false_type { };
+template <typename Compare>
+struct isTransparent <Compare, std::void_t<typename Compare::is_transparent>> : std::true_type { };
+
+/*****************************************************************
+ * ENABLE LOOKUP
+ * Can a K be looked up as is in a tree of T ordered by Compare?
+ * Always when it is a T; anything else only through a transparent
+ * Compare, which saves building a temporary T for every probe.
+ *****************************************************************/
+template <typename K, typename T, typename Compare>
+using enableLookup = typename std::enable_if<
+   std::is_same<K, T>::value || isTransparent<Compare>::value>::type;
+
+/*****************************************************************
+ * SUBTREE SIZE
+ * The optional order-statistic field of a node: how many nodes
+ * are in the subtree it roots. An unranked node has no such field
+ * and is no bigger for it.
+ *****************************************************************/
+template <bool Ranked>
+struct SubtreeSize
+{
+   size_t size = 1;
+};
+template <>
+struct SubtreeSize <false> { };
+
+/*****************************************************************
+ * BINARY SEARCH TREE
+ * Create a Binary Search Tree. A Ranked tree also keeps subtree
+ * sizes so it can find the k-th element or the rank of a key in
+ * O(log n).
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>, bool Ranked = false>
 class BST
 {
    friend class ::TestBST; // give unit tests access to the privates
    friend class ::TestSet;
    friend class ::TestMap;
+   friend class ::BenchBST; // and benchmarks
+   friend class ::BenchIndexSet;
+   friend class ::BenchPersistentSet;
 
-   template <class TT>
+   template <class TT, class CC, bool RR>
    friend class custom::set;
 
    template <class KK, class VV>
@@ -67,9 +154,12 @@ public:
    //
 
    BST();
+   explicit BST(const Compare & compare);
    BST(const BST &  rhs);
    BST(      BST && rhs);
    BST(const std::initializer_list<T>& il);
+   template <class Iterator>
+   BST(from_sorted_t, Iterator first, Iterator last, const Compare & compare = Compare());
    ~BST();
 
    //
@@ -86,14 +176,51 @@ public:
    //
 
    class iterator;
-   iterator   begin() const noexcept;
-   iterator   end()   const noexcept { return iterator(nullptr); }
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+   iterator   begin()  const noexcept { return iterator(pLeftmost);   }
+   iterator   last()   const noexcept { return iterator(rightmost()); }
+   iterator   end()    const noexcept { return iterator(pHeader());   }
+   reverse_iterator rbegin() const noexcept { return reverse_iterator(end());   }
+   reverse_iterator rend()   const noexcept { return reverse_iterator(begin()); }
+
+   //
+   // Node handle
+   //
+
+   class node_type;
+
+   //
+   // Snapshot: a read-only view of the tree as it is now, that any
+   // thread can read while this one goes on changing the tree. It
+   // shares every node: taking one is a reference count, and a change
+   // while one is held copies only the nodes it would write. Call
+   // snapshot() from the thread that changes the tree
+   //
+
+   class snapshot_type;
+   snapshot_type snapshot();
 
    //
    // Access
    //
 
-   iterator find(const T& t);
+   iterator find      (const T & t) const { return find      <T>(t); }
+   iterator lowerBound(const T & t) const { return lowerBound<T>(t); }
+   iterator upperBound(const T & t) const { return upperBound<T>(t); }
+   std::pair<iterator, iterator> equalRange(const T & t) const { return equalRange<T>(t); }
+   size_t   count     (const T & t) const { return count     <T>(t); }
+
+   // with a transparent Compare, any key it can order against T
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator find(const K & key) const;
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator lowerBound(const K & key) const;
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator upperBound(const K & key) const;
+   template <class K, class = enableLookup<K, T, Compare>>
+   std::pair<iterator, iterator> equalRange(const K & key) const;
+   template <class K, class = enableLookup<K, T, Compare>>
+   size_t   count(const K & key) const;
 
    //
    // Insert
@@ -101,26 +228,222 @@ public:
 
    std::pair<iterator, bool> insert(const T&  t, bool keepUnique = false);
    std::pair<iterator, bool> insert(      T&& t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(iterator hint, const T&  t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(iterator hint,       T&& t, bool keepUnique = false);
+   template <class ... Args>
+   std::pair<iterator, bool> emplace(Args && ... args);
+   template <class ... Args>
+   std::pair<iterator, bool> emplaceUnique(Args && ... args);
+   template <class ... Args>
+   iterator emplaceHint(iterator hint, Args && ... args);
+   template <class ... Args>
+   std::pair<iterator, bool> emplaceHintUnique(iterator hint, Args && ... args);
+   template <class Iterator>
+   void assignSorted(Iterator first, Iterator last);
+   std::pair<iterator, bool> insert(node_type && nh, bool keepUnique = false);
+   void merge(BST & source, bool keepUnique = false);
 
    //
    // Remove
    //
 
    iterator erase(iterator& it);
+   iterator erase(iterator first, iterator last);
+   node_type extract(iterator it);
+   node_type extract(const T & t);
    void   clear() noexcept;
 
+   //
+   // Set algebra. Each consumes rhs, relinking its nodes into this
+   // tree or destroying them, and leaves it empty. Independent
+   // subtrees are combined on separate threads. Compare must not throw
+   //
+
+   void unionWith     (BST & rhs);
+   void intersectWith (BST & rhs);
+   void differenceWith(BST & rhs);
+
+   // The same, leaving both trees alone: the recursion forks the
+   // same way, copying only what the result keeps as it gets there
+   static BST unionOf       (const BST & lhs, const BST & rhs);
+   static BST intersectionOf(const BST & lhs, const BST & rhs);
+   static BST differenceOf  (const BST & lhs, const BST & rhs);
+
+   //
+   // Split and join. split() keeps everything less than key and
+   // returns the rest as a new tree; join() appends a tree whose
+   // elements all come after ours. Both relink nodes in O(log n).
+   // Only a Ranked tree knows the two sizes after a split; any
+   // other counts them the first time size() is asked, O(n)
+   //
+
+   BST  split(const T & t) { return split<T>(t); }
+   template <class K, class = enableLookup<K, T, Compare>>
+   BST  split(const K & key);
+   void join(BST & rhs, bool keepUnique = false);
+
+   //
+   // Order statistics: Ranked trees only
+   //
+
+   size_t   rank(const T & t) const;
+   iterator select(size_t k) const;
+   size_t   countRange(const T & lo, const T & hi) const;
+   size_t   indexOf(iterator it) const;
+   iterator advance(iterator it, std::ptrdiff_t n) const;
+
+   //
+   // Memory
+   //
+
+   void   reserve(size_t num) { pool.reserve(num); }
+   size_t capacity() const noexcept { return pool.capacity(); }
+
    //
    // Status
    //
 
-   bool   empty() const noexcept { return numElements == 0; }
-   size_t size()  const noexcept { return numElements; }
+   bool   empty() const noexcept { return root == nullptr; }
+   size_t size()  const noexcept;
 
 private:
 
    class BNode;
+   template <class K>
+   std::pair<BNode *, bool> findParent(const K & key, bool keepUnique, BNode * & pMatch) const;
+   template <class K>
+   std::pair<BNode *, bool> findParent(BNode * pHint, const K & key, bool keepUnique, BNode * & pMatch) const;
+   template <class ... Args>
+   std::pair<iterator, bool> emplaceNode(BNode * pHint, bool keepUnique, Args && ... args);
+   template <class K>
+   BNode * lowerBound(BNode * pNode, BNode * pBound, const K & key) const;
+   template <class K>
+   BNode * upperBound(BNode * pNode, BNode * pBound, const K & key) const;
+   void attach(BNode * pNew, BNode * pParent, bool goLeft);
+   BNode * detach(BNode * pNode);
+   void relink();
+   void findExtremes();
+   void hookRoot();
+   BNode * pHeader() const noexcept { return const_cast<BNode *>(&header.node); }
+   BNode * & rightmost()       noexcept { return header.node.pRight; }
+   BNode *   rightmost() const noexcept { return header.node.pRight; }
+   template <class Iterator>
+   static BNode * buildSorted(Iterator & it, size_t num, size_t depth, size_t redDepth,
+                              Pool <BNode> & pool);
+   void balanceErase(BNode * pNode, BNode * pParent);
+
+   //
+   // Copy on write. Once a snapshot is taken, a node may be in it as
+   // well as in the tree, and the tree makes it its own before changing
+   // its children: a copy with the same children, which gain a
+   // reference. Snapshots read only the data and the children, so the
+   // color, the size and pParent of a shared node are the tree's to
+   // write. Only this thread writes pParent, so it always leads up
+   // through the tree, never through a snapshot
+   //
+
+   struct Sharing;
+   struct Version;
+   BNode * own(BNode * pNode);
+   BNode * ownChild(BNode * pParent, BNode * pChild);
+   void    ownAll(BNode * pParent, BNode * pNode);
+   BNode * prepareInsert(BNode * pParent);
+   BNode * prepareErase(BNode * pNode);
+   void    unshare();
+   void    settle() noexcept;
+
+   // a red-black subtree cut loose from any tree, and how many black
+   // nodes are on every path down from its root, the root included
+   struct Subtree
+   {
+      BNode * pRoot;
+      size_t  blackHeight;
+   };
+   struct Split
+   {
+      Subtree left;          // everything less than the key
+      BNode * pMatch;        // the node equivalent to the key, if any
+      Subtree right;         // everything greater than the key
+   };
+   static Subtree cut(BNode * pNode, size_t blackHeight);
+   static size_t  blackHeight(const BNode * pNode);
+   static Subtree join(Subtree left, BNode * pMiddle, Subtree right);
+   static Subtree join(Subtree left, Subtree right);
+   static Subtree fixJoin(BNode * pNode, size_t blackHeight);
+   static Subtree splitLast(Subtree tree, BNode * & pLast);
+   template <class K>
+   Split split(Subtree tree, const K & key) const;
+   template <class K>
+   std::pair<Subtree, Subtree> partition(Subtree tree, const K & key) const;
+   static std::pair<Subtree, Subtree> partition(BNode * pAt);
+   static size_t addSizes(size_t lhs, size_t rhs) noexcept
+   {
+      return (lhs == unknownSize || rhs == unknownSize) ? unknownSize : lhs + rhs;
+   }
+   Subtree takeTree();
+   void    putTree(Subtree tree, size_t num);
+
+   // the join-based set algebra on detached subtrees. Nodes that
+   // drop out go on a garbage list linked through pParent
+   typedef Subtree (BST :: * Combine)(Subtree, Subtree, BNode * &, unsigned) const;
+   void    combine(BST & rhs, Combine op, unsigned depth);
+   Subtree unite    (Subtree lhs, Subtree rhs, BNode * & pGarbage, unsigned depth) const;
+   Subtree intersect(Subtree lhs, Subtree rhs, BNode * & pGarbage, unsigned depth) const;
+   Subtree subtract (Subtree lhs, Subtree rhs, BNode * & pGarbage, unsigned depth) const;
+   static void discard(BNode * pNode, BNode * & pGarbage);
+   static void splice (BNode * pList, BNode * & pGarbage);
+   template <class Left, class Right>
+   static void fork(bool parallel, Left left, Right right);
+   static unsigned parallelDepth();
+   static const size_t parallelHeight = 10; // fork only above about 2^10 nodes
+
+   // which elements the copying set algebra keeps
+   enum Keep { KEEP_EITHER, KEEP_BOTH, KEEP_LHS_ONLY };
+   static BST combined(const BST & lhs, const BST & rhs, Keep keep, unsigned depth);
+   Subtree copyCombine(const BNode * pLHS, size_t blackHeight, iterator itFirst, iterator itLast,
+                       Keep keep, Pool <BNode> & pool, unsigned depth) const;
+   static Subtree copyRange(iterator itFirst, iterator itLast, Pool <BNode> & pool);
+   static Subtree copySubtree(const BNode * pNode, size_t blackHeight, Pool <BNode> & pool);
+   static const size_t smallRange = 128;    // erase fewer than this one at a time
+   static bool isRed(const BNode * pNode) { return pNode != nullptr && pNode->isRed; }
+
+   // compare with a single <=> rather than Compare when we can
+   static constexpr bool threeWay = useThreeWay <T, Compare> ::value;
+
+   // can we look for a duplicate before building a node from args?
+   // Only when there is a single argument that Compare takes as is
+   template <class ... Args>
+   struct isKey : std::false_type { };
+   template <class K>
+   struct isKey <K> : std::integral_constant<bool,
+      std::is_same<typename std::decay<K>::type, T>::value ||
+      (isTransparent<Compare>::value &&
+       std::is_invocable<const Compare &, const K &, const T &>::value &&
+       std::is_invocable<const Compare &, const T &, const K &>::value)> { };
+
+   // The header sits above the root: the whole tree is its left
+   // subtree, so in order it comes right after the largest element
+   // and serves as end(). It never holds a value. Its right link is
+   // not a child but the largest element, or the header itself when
+   // the tree is empty, so --end() takes one step.
+   union Header
+   {
+      Header() : node(typename BNode::Sentinel()) { }
+      ~Header() { }
+      BNode node;
+   };
+
+   // what numElements is after a split, until size() counts
+   static const size_t unknownSize = static_cast<size_t>(-1);
+
    BNode * root;              // root node of the binary search tree
-   size_t numElements;        // number of elements currently in the tree
+   mutable size_t numElements;  // number of elements currently in the tree, or unknownSize
+   Header header;             // parent of the root, what end() points to, and the largest element
+   BNode * pLeftmost;         // smallest element, what begin() points to
+   mutable Pool <BNode> pool; // where every BNode in the tree comes from; size() settles its count
+   Compare compare;           // strict weak ordering of the elements
+   Sharing * pSharing = nullptr;  // what we share with our snapshots, while any may be held
+   Version * pVersion = nullptr;  // the tree as it is now, once a snapshot of it is taken
 };
 
 
@@ -129,36 +452,68 @@ private:
  * A single node in a binary tree. Note that the node does not know
  * anything about the properties of the tree so no validation can be done.
  *****************************************************************/
-template <typename T>
-class BST <T> :: BNode
+template <typename T, typename Compare, bool Ranked>
+class BST <T, Compare, Ranked> :: BNode : public SubtreeSize <Ranked>
 {
 public:
    //
    // Construct
    //
 
-   BNode() : pParent(nullptr), pLeft(nullptr), pRight(nullptr), isRed(true){ }
-   BNode(const T& t) : data(t), pParent(nullptr), pLeft(nullptr), pRight(nullptr), isRed(true) { }
-   BNode(T&& t) : data(std::move(t)), pParent(nullptr), pLeft(nullptr), pRight(nullptr), isRed(true) { }
+   BNode() : data(), isRed(true), numRefs(1), pLeft(nullptr), pRight(nullptr), pParent(nullptr) { }
+   BNode(const T& t) : data(t), isRed(true), numRefs(1), pLeft(nullptr), pRight(nullptr), pParent(nullptr) { }
+   BNode(T&& t) : data(std::move(t)), isRed(true), numRefs(1), pLeft(nullptr), pRight(nullptr), pParent(nullptr) { }
+   template <class ... Args>
+   explicit BNode(std::in_place_t, Args && ... args)
+      : data(std::forward<Args>(args)...), isRed(true), numRefs(1), pLeft(nullptr), pRight(nullptr), pParent(nullptr) { }
+   ~BNode() { data.~T(); }
+
+   // the header: its own parent, and with no data at all
+   struct Sentinel { };
+   explicit BNode(Sentinel) : isRed(false), numRefs(1), pLeft(nullptr), pRight(this), pParent(this) { }
 
    //
    // Insert
    //
    void addLeft (BNode * pNode);
    void addRight(BNode * pNode);
-   void addLeft (const T &  t);
-   void addRight(const T &  t);
-   void addLeft(       T && t);
-   void addRight(      T && t);
 
    //
    // Status
    //
    bool isRightChild(BNode* pNode) const { return (pParent->pRight == this) ? true : false; }
    bool isLeftChild(BNode* pNode) const  { return (pParent->pLeft  == this) ? true : false; }
+   bool isHeader() const { return pParent == this; }
+   bool isRoot()   const { return pParent == nullptr || pParent->isHeader(); }
+
+   // balance the tree: true when a red root had to turn black
+   bool balance();
+   BNode * rotateLeft();
+   BNode * rotateRight();
+
+   // a lone red node, linked to nothing
+   void isolate()
+   {
+      pParent = pLeft = pRight = nullptr;
+      isRed = true;
+      if constexpr (Ranked)
+         this->size = 1;
+   }
 
-   // balance the tree
-   void balance();
+   // subtree sizes, for a Ranked tree
+   static size_t count(const BNode * pNode) { return pNode ? pNode->size : 0; }
+   void resize() { this->size = 1 + count(pLeft) + count(pRight); }
+
+   //
+   // References: one from each parent in the tree and its snapshots,
+   // and one from each snapshot it is the root of. Only the tree's
+   // thread adds any; a snapshot only lets go of its root
+   //
+   static const uint16_t maxRefs = 0xFFFF; // a count this full sticks, and the node is never freed
+   bool isShared() const noexcept { return numRefs.load(std::memory_order_acquire) != 1; }
+   void retain() noexcept;
+   bool release() noexcept;
+   static void destroy(BNode * pList, Pool <BNode> & pool) noexcept;
 
 #ifdef DEBUG
    //
@@ -168,68 +523,36 @@ public:
    int findDepth() const;
    bool verifyRedBlack(int depth) const;
    int computeSize() const;
+   bool verifySize() const;
 #endif // DEBUG
 
    //
    // Data
    //
-   T data;                  // Actual data stored in the BNode
+   // The color and the count go right after the data, where a small
+   // T leaves padding before the first pointer anyway: a node of ints
+   // is 32 bytes rather than the 40 it takes with the color last
+   //
+   union { T data; };       // Actual data stored in the BNode, none in the header
+   bool isRed;              // Red-black balancing stuff
+   std::atomic<uint16_t> numRefs; // references to the node, 1 unless a snapshot shares it
    BNode* pLeft;          // Left child - smaller
    BNode* pRight;         // Right child - larger
    BNode* pParent;        // Parent
-   bool isRed;              // Red-black balancing stuff
-
-
-   void assign(BNode*& pDest, const BNode* pSrc)
-   {
-      if (pSrc == nullptr)
-      {
-         clear(pDest);  // Only clear if source is null
-         return;
-      }
-
-      if (pDest == nullptr)
-      {
-         pDest = new BNode(pSrc->data);
-         pDest->isRed = pSrc->isRed;
-      }
-      else
-      {
-         pDest->data = pSrc->data;
-         pDest->isRed = pSrc->isRed;
-      }
-
-      // Recursively assign left and right subtrees
-      assign(pDest->pLeft, pSrc->pLeft);
-      if (pDest->pLeft)
-         pDest->pLeft->pParent = pDest;
-
-      assign(pDest->pRight, pSrc->pRight);
-      if (pDest->pRight)
-         pDest->pRight->pParent = pDest;
-   }
 
 
-   void clear(BNode*& pThis)
-   {
-      if (pThis)
-      {
-         clear(pThis->pLeft);
-         clear(pThis->pRight);
-         delete pThis;
-         pThis = nullptr;
-      }
-   }
+   static void assign(BNode*& pDest, const BNode* pSrc, Pool <BNode> & pool);
+   static void clear(BNode*& pThis, Pool <BNode> & pool) noexcept;
 
-   friend class BST <T>;
+   friend class BST <T, Compare, Ranked>;
 };
 
 /**********************************************************
  * BINARY SEARCH TREE ITERATOR
  * Forward and reverse iterator through a BST
  *********************************************************/
-template <typename T>
-class BST <T> :: iterator
+template <typename T, typename Compare, bool Ranked>
+class BST <T, Compare, Ranked> :: iterator
 {
    friend class ::TestBST; // give unit tests access to the privates
    friend class ::TestSet;
@@ -238,6 +561,13 @@ class BST <T> :: iterator
    template <class KK, class VV>
    friend class custom::map;
 public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
    // constructors and assignment
    iterator(BNode* p = nullptr) : pNode(p) { }
    iterator(const iterator& rhs) : pNode(rhs.pNode) { }
@@ -253,6 +583,7 @@ public:
 
    // de-reference. Cannot change because it will invalidate the BST
    const T & operator * () const { return pNode->data; }
+   const T * operator -> () const { return &pNode->data; }
 
    // increment and decrement
    iterator & operator ++ ();
@@ -272,8 +603,8 @@ public:
       return pOld;
    }
 
-   // must give friend status to remove so it can call getNode() from it
-   friend BST <T> :: iterator BST <T> :: erase(iterator & it);
+   // must give friend status to the tree so it can call getNode() from it
+   friend class BST <T, Compare, Ranked>;
 
 private:
 
@@ -281,6 +612,312 @@ private:
     BNode * pNode;
 };
 
+/**********************************************************
+ * BINARY SEARCH TREE NODE HANDLE
+ * Owns a node that was extracted from a BST, so its value can
+ * move to another tree without being copied or reallocated
+ *********************************************************/
+template <typename T, typename Compare, bool Ranked>
+class BST <T, Compare, Ranked> :: node_type
+{
+   friend class ::TestBST; // give unit tests access to the privates
+   friend class ::TestSet;
+   friend class BST <T, Compare, Ranked>;
+public:
+   // constructors, destructor, and assignment
+   node_type() noexcept : pNode(nullptr) { }
+   node_type(node_type && rhs) noexcept : pNode(rhs.pNode), lease(std::move(rhs.lease))
+   {
+      rhs.pNode = nullptr;
+   }
+   node_type & operator = (node_type && rhs) noexcept
+   {
+      if (this != &rhs)
+      {
+         reset();
+         pNode = rhs.pNode;
+         lease = std::move(rhs.lease);
+         rhs.pNode = nullptr;
+      }
+      return *this;
+   }
+   node_type(const node_type & rhs) = delete;
+   node_type & operator = (const node_type & rhs) = delete;
+   ~node_type() { reset(); }
+   void swap(node_type & rhs) noexcept
+   {
+      std::swap(pNode, rhs.pNode);
+      lease.swap(rhs.lease);
+   }
+
+   // status and access. Out of the tree, the value may change
+   bool empty() const noexcept { return pNode == nullptr; }
+   explicit operator bool () const noexcept { return pNode != nullptr; }
+   T & value() const { return pNode->data; }
+
+private:
+   node_type(BNode * pNode, typename Pool <BNode> ::Lease && lease) noexcept
+      : pNode(pNode), lease(std::move(lease)) { }
+
+   // a node never inserted anywhere is destroyed here; its slot
+   // goes back to its slab for the next pool that needs one
+   void reset() noexcept
+   {
+      if (pNode)
+         Pool <BNode> ::destroy(pNode, std::move(lease));
+      pNode = nullptr;
+   }
+
+   BNode * pNode;                         // the node, out of any tree
+   typename Pool <BNode> ::Lease lease;   // keeps the node's slab alive
+};
+
+/**********************************************************
+ * BINARY SEARCH TREE SHARING
+ * What a tree shares with its snapshots. Nodes a snapshot
+ * was the last to hold wait here for the tree to destroy
+ * them. If the tree goes first, its pool comes here too,
+ * so the slabs live as long as the last snapshot
+ *********************************************************/
+template <typename T, typename Compare, bool Ranked>
+struct BST <T, Compare, Ranked> :: Sharing
+{
+   Sharing() : numRefs(1), pOrphans(nullptr) { }
+   ~Sharing() { BNode::destroy(pOrphans.load(std::memory_order_acquire), pool); }
+
+   // a node nobody holds any more, from any thread
+   void orphan(BNode * pNode) noexcept
+   {
+      BNode * pHead = pOrphans.load(std::memory_order_relaxed);
+      do
+         pNode->pParent = pHead;
+      while (!pOrphans.compare_exchange_weak(pHead, pNode, std::memory_order_release,
+                                             std::memory_order_relaxed));
+   }
+   static void release(Sharing * p) noexcept
+   {
+      if (p->numRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+         delete p;
+   }
+
+   std::atomic<size_t>  numRefs;    // the tree, until it lets go, and each version
+   std::atomic<BNode *> pOrphans;   // linked through pParent
+   Pool <BNode> pool;               // the tree's, once the tree lets go
+};
+
+/**********************************************************
+ * BINARY SEARCH TREE VERSION
+ * The tree as it was when a snapshot was taken: the root
+ * it had, which it holds a reference to, and its size.
+ * Every snapshot of the same version shares this
+ *********************************************************/
+template <typename T, typename Compare, bool Ranked>
+struct BST <T, Compare, Ranked> :: Version
+{
+   Version(BNode * pRoot, size_t numElements, const Compare & compare, Sharing * pSharing) :
+      numRefs(1), pRoot(pRoot), numElements(numElements), pSharing(pSharing), compare(compare) { }
+
+   // the last one out lets go of the root
+   static void release(Version * p) noexcept
+   {
+      if (p == nullptr || p->numRefs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+         return;
+      Sharing * pSharing = p->pSharing;
+      if (p->pRoot && p->pRoot->release())
+         pSharing->orphan(p->pRoot);
+      delete p;
+      Sharing::release(pSharing);
+   }
+
+   std::atomic<size_t> numRefs;   // its snapshots, and the tree until it changes
+   BNode * pRoot;
+   size_t numElements;
+   Sharing * pSharing;
+   Compare compare;
+};
+
+/**********************************************************
+ * BINARY SEARCH TREE SNAPSHOT
+ * A read-only view of the tree as it was. Copying one is
+ * a reference count. Its nodes may be shared with the
+ * tree, whose parent pointers are no use here, so the
+ * iterator keeps the path from the root instead
+ *********************************************************/
+template <typename T, typename Compare, bool Ranked>
+class BST <T, Compare, Ranked> :: snapshot_type
+{
+   friend class ::TestBST; // give unit tests access to the privates
+   friend class ::TestSet;
+   friend class BST <T, Compare, Ranked>;
+public:
+   class iterator;
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+
+   // constructors, destructor, and assignment
+   snapshot_type() noexcept : pVersion(nullptr) { }
+   snapshot_type(const snapshot_type & rhs) noexcept : pVersion(rhs.pVersion)
+   {
+      if (pVersion)
+         pVersion->numRefs.fetch_add(1, std::memory_order_relaxed);
+   }
+   snapshot_type(snapshot_type && rhs) noexcept : pVersion(rhs.pVersion)
+   {
+      rhs.pVersion = nullptr;
+   }
+   ~snapshot_type() { Version::release(pVersion); }
+   snapshot_type & operator = (snapshot_type rhs) noexcept
+   {
+      swap(rhs);
+      return *this;
+   }
+   void swap(snapshot_type & rhs) noexcept { std::swap(pVersion, rhs.pVersion); }
+   void clear() noexcept { snapshot_type().swap(*this); }
+
+   // iterator
+   iterator begin() const noexcept;
+   iterator end()   const noexcept;
+   reverse_iterator rbegin() const noexcept { return reverse_iterator(end());   }
+   reverse_iterator rend()   const noexcept { return reverse_iterator(begin()); }
+
+   // access
+   iterator find(const T & t) const
+   {
+      iterator it = lower_bound(t);
+      return (it != end() && !pVersion->compare(t, *it)) ? it : end();
+   }
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const;
+   bool     contains(const T & t) const { return find(t) != end(); }
+   size_t   count   (const T & t) const { return contains(t) ? 1 : 0; }
+
+   // status
+   bool   empty() const noexcept { return size() == 0; }
+   size_t size()  const noexcept { return pVersion ? pVersion->numElements : 0; }
+
+   // how many snapshots share this version, and the tree if it
+   // has not changed since. 0 for a snapshot of nothing at all
+   size_t use_count() const noexcept
+   {
+      return pVersion ? pVersion->numRefs.load(std::memory_order_relaxed) : 0;
+   }
+
+private:
+   explicit snapshot_type(Version * pVersion) noexcept : pVersion(pVersion) { }
+   const BNode * root() const noexcept { return pVersion ? pVersion->pRoot : nullptr; }
+
+   Version * pVersion;
+};
+
+/**********************************************************
+ * BINARY SEARCH TREE SNAPSHOT ITERATOR
+ * Keeps every node from the root down to the one it is
+ * on. A red-black tree is at most twice as deep as a
+ * full one, which bounds the path
+ *********************************************************/
+template <typename T, typename Compare, bool Ranked>
+class BST <T, Compare, Ranked> :: snapshot_type :: iterator
+{
+   friend class BST <T, Compare, Ranked> :: snapshot_type;
+public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
+   // constructors and assignment
+   iterator() : pRoot(nullptr), depth(0) { }
+   iterator(const iterator & rhs) : pRoot(rhs.pRoot), depth(rhs.depth)
+   {
+      for (int i = 0; i < depth; i++)
+         path[i] = rhs.path[i];
+   }
+   iterator & operator = (const iterator & rhs)
+   {
+      pRoot = rhs.pRoot;
+      depth = rhs.depth;
+      for (int i = 0; i < depth; i++)
+         path[i] = rhs.path[i];
+      return *this;
+   }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return current() == rhs.current(); }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs); }
+
+   // de-reference
+   const T & operator * () const { return current()->data; }
+   const T * operator -> () const { return &current()->data; }
+
+   // the smallest on the right, or up to the first
+   // ancestor we are to the left of
+   iterator & operator ++ ()
+   {
+      const BNode * p = current();
+      if (p->pRight)
+         pushLeft(p->pRight);
+      else
+      {
+         depth--;
+         while (depth > 0 && path[depth - 1]->pRight == p)
+            p = path[--depth];
+      }
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld = *this;
+      ++(*this);
+      return itOld;
+   }
+
+   // back from end() is the largest
+   iterator & operator -- ()
+   {
+      const BNode * p = current();
+      if (p == nullptr)
+         pushRight(pRoot);
+      else if (p->pLeft)
+         pushRight(p->pLeft);
+      else
+      {
+         depth--;
+         while (depth > 0 && path[depth - 1]->pLeft == p)
+            p = path[--depth];
+      }
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator itOld = *this;
+      --(*this);
+      return itOld;
+   }
+
+private:
+   static const int maxDepth = 2 * 8 * sizeof(size_t);
+
+   explicit iterator(const BNode * pRoot) : pRoot(pRoot), depth(0) { }
+
+   const BNode * current() const noexcept { return depth ? path[depth - 1] : nullptr; }
+   void push(const BNode * p) noexcept { path[depth++] = p; }
+   void pushLeft(const BNode * p) noexcept
+   {
+      for (; p; p = p->pLeft)
+         push(p);
+   }
+   void pushRight(const BNode * p) noexcept
+   {
+      for (; p; p = p->pRight)
+         push(p);
+   }
+
+   const BNode * pRoot;
+   const BNode * path[maxDepth];
+   int depth;                     // 0 is end()
+};
+
 
 /*********************************************
  *********************************************
@@ -294,19 +931,28 @@ private:
  /*********************************************
   * BST :: DEFAULT CONSTRUCTOR
   ********************************************/
-template <typename T>
-BST <T> ::BST() : numElements(0), root(nullptr)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> ::BST() : numElements(0), root(nullptr), pLeftmost(pHeader())
 {
    numElements = 0;
    root = nullptr;
 }
 
+/*********************************************
+ * BST :: COMPARE CONSTRUCTOR
+ * An empty tree ordered by a given comparison
+ ********************************************/
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> ::BST(const Compare & compare) : numElements(0), root(nullptr), pLeftmost(pHeader()), compare(compare)
+{
+}
+
 /*********************************************
  * BST :: COPY CONSTRUCTOR
  * Copy one tree to another
  ********************************************/
-template <typename T>
-BST <T> ::BST(const BST<T>& rhs) : numElements(0), root(nullptr)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> ::BST(const BST <T, Compare, Ranked>& rhs) : numElements(0), root(nullptr), pLeftmost(pHeader()), compare(rhs.compare)
 {
    root = nullptr;
    numElements = 0;
@@ -317,33 +963,55 @@ BST <T> ::BST(const BST<T>& rhs) : numElements(0), root(nullptr)
  * BST :: MOVE CONSTRUCTOR
  * Move one tree to another
  ********************************************/
-template <typename T>
-BST <T> ::BST(BST <T>&& rhs) : numElements(0), root(nullptr)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> ::BST(BST <T, Compare, Ranked>&& rhs) : numElements(0), root(nullptr), pLeftmost(pHeader()), pool(std::move(rhs.pool)), compare(rhs.compare)
 {
    root = rhs.root;
    numElements = rhs.numElements;
+   pLeftmost = rhs.pLeftmost;
+   rightmost() = rhs.rightmost();
+   hookRoot();
+
+   pSharing = rhs.pSharing;
+   pVersion = rhs.pVersion;
 
    rhs.root = nullptr;
    rhs.numElements = 0;
+   rhs.hookRoot();
+   rhs.pSharing = nullptr;
+   rhs.pVersion = nullptr;
 }
 
 /*********************************************
  * BST :: INITIALIZER LIST CONSTRUCTOR
  * Create a BST from an initializer list
  ********************************************/
-template <typename T>
-BST <T> ::BST(const std::initializer_list<T>& il) : numElements(0), root(nullptr)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> ::BST(const std::initializer_list<T>& il) : numElements(0), root(nullptr), pLeftmost(pHeader())
 {
    root = nullptr;
    numElements = 0;
    *this = il;
 }
 
+/*********************************************
+ * BST :: SORTED RANGE CONSTRUCTOR
+ * Build a balanced tree straight from a range
+ * already in ascending order
+ ********************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class Iterator>
+BST <T, Compare, Ranked> ::BST(from_sorted_t, Iterator first, Iterator last, const Compare & compare)
+   : numElements(0), root(nullptr), pLeftmost(pHeader()), compare(compare)
+{
+   assignSorted(first, last);
+}
+
 /*********************************************
  * BST :: DESTRUCTOR
  ********************************************/
-template <typename T>
-BST <T> :: ~BST()
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> :: ~BST()
 {
    clear();
 }
@@ -353,14 +1021,31 @@ BST <T> :: ~BST()
  * BST :: ASSIGNMENT OPERATOR
  * Copy one tree to another
  ********************************************/
-template <typename T>
-BST <T> & BST <T> :: operator = (const BST <T> & rhs)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> & BST <T, Compare, Ranked> :: operator = (const BST <T, Compare, Ranked> & rhs)
 {
    if(this != &rhs)
    {
+      // nodes a snapshot shares cannot be written over
+      settle();
+      if (pSharing != nullptr)
+         clear();
+
       // Assign new values
-      root->assign(root, rhs.root);
-      numElements = rhs.numElements;
+      try
+      {
+         BNode::assign(root, rhs.root, pool);
+      }
+      catch (...)
+      {
+         // a half-copied tree is no use to anyone
+         clear();
+         throw;
+      }
+      numElements = rhs.size();
+      pool.disown(pool.live() - numElements);   // ours may not have been known
+      compare = rhs.compare;
+      relink();
    }
    return *this;
 }
@@ -369,8 +1054,8 @@ BST <T> & BST <T> :: operator = (const BST <T> & rhs)
  * BST :: ASSIGNMENT OPERATOR with INITIALIZATION LIST
  * Copy nodes onto a BTree
  ********************************************/
-template <typename T>
-BST <T> & BST <T> :: operator = (const std::initializer_list<T>& il)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> & BST <T, Compare, Ranked> :: operator = (const std::initializer_list<T>& il)
 {
    clear();
    for (const T& t : il) // Iterate through each element in the initializer list
@@ -382,8 +1067,8 @@ BST <T> & BST <T> :: operator = (const std::initializer_list<T>& il)
  * BST :: ASSIGN-MOVE OPERATOR
  * Move one tree to another
  ********************************************/
-template <typename T>
-BST <T> & BST <T> :: operator = (BST <T> && rhs)
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> & BST <T, Compare, Ranked> :: operator = (BST <T, Compare, Ranked> && rhs)
 {
    clear();
    swap(rhs);
@@ -394,8 +1079,8 @@ BST <T> & BST <T> :: operator = (BST <T> && rhs)
  * BST :: SWAP
  * Swap two trees
  ********************************************/
-template <typename T>
-void BST <T> :: swap (BST <T>& rhs)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: swap (BST <T, Compare, Ranked>& rhs)
 {
    BNode* tempRoot = rhs.root;
    rhs.root = root;
@@ -404,287 +1089,2153 @@ void BST <T> :: swap (BST <T>& rhs)
    size_t tempNumElements = rhs.numElements;
    rhs.numElements = numElements;
    numElements = tempNumElements;
+
+   std::swap(pLeftmost,  rhs.pLeftmost);
+   std::swap(rightmost(), rhs.rightmost());
+   hookRoot();
+   rhs.hookRoot();
+
+   pool.swap(rhs.pool);
+   std::swap(compare, rhs.compare);
+   std::swap(pSharing, rhs.pSharing);
+   std::swap(pVersion, rhs.pVersion);
 }
 
 /*****************************************************
  * BST :: INSERT
  * Insert a node at a given location in the tree
  ****************************************************/
-template <typename T>
-std::pair<typename BST <T> :: iterator, bool> BST <T> :: insert(const T & t, bool keepUnique)
+template <typename T, typename Compare, bool Ranked>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: insert(const T & t, bool keepUnique)
 {
-   std::pair<iterator, bool> pairReturn(end(), false);
-
-   // If empty, just insert at the root and return
-   if (empty()) {
-      root = new BNode(t);
-      numElements = 1;
-      root->balance();
-      pairReturn.first = iterator(root);
-      pairReturn.second = true;
-      return pairReturn;
-   }
+   return emplaceNode(nullptr, keepUnique, t);
+}
 
-   // Find insertion point
-   BNode* current = root;
-   BNode* parent = nullptr;
-   bool goLeft = false;
+template <typename T, typename Compare, bool Ranked>
+std::pair<typename BST <T, Compare, Ranked> ::iterator, bool> BST <T, Compare, Ranked> ::insert(T && t, bool keepUnique)
+{
+   return emplaceNode(nullptr, keepUnique, std::move(t));
+}
 
-   while (current != nullptr) {
-      parent = current;
-      if (keepUnique) {
-         if (t == current->data) {
-            pairReturn.first = iterator(current);
-            pairReturn.second = false;
-            return pairReturn;
-         }
-      }
-      if (t < current->data) {
-         goLeft = true;
-         current = current->pLeft;
-      }
-      else {
-         goLeft = false;
-         current = current->pRight;
-      }
-   }
+/*****************************************************
+ * BST :: INSERT with a HINT
+ * Insert t just before hint if that is where it belongs.
+ * Appending in order with end() as the hint costs one
+ * comparison plus the rebalance
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: insert(iterator hint, const T & t, bool keepUnique)
+{
+   return emplaceNode(hint.pNode, keepUnique, t);
+}
 
-   // Insert new node
-   BNode* newNode = new BNode(t);
-   // Insert red
-   newNode->isRed = true;
+template <typename T, typename Compare, bool Ranked>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: insert(iterator hint, T && t, bool keepUnique)
+{
+   return emplaceNode(hint.pNode, keepUnique, std::move(t));
+}
 
-   if (goLeft) {
-      parent->addLeft(newNode);
-   }
-   else {
-      parent->addRight(newNode);
-   }
+/*****************************************************
+ * BST :: INSERT a NODE HANDLE
+ * Hang an extracted node in this tree as is. If it is
+ * a duplicate, the handle keeps the node
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: insert(node_type && nh, bool keepUnique)
+{
+   if (nh.empty())
+      return std::pair<iterator, bool>(end(), false);
+
+   BNode* match;
+   auto spot = findParent(nh.pNode->data, keepUnique, match);
+   if (match != nullptr)
+      return std::pair<iterator, bool>(iterator(match), false);
+
+   spot.first = prepareInsert(spot.first);
+   pool.keep(std::move(nh.lease));
+   BNode* pNode = nh.pNode;
+   nh.pNode = nullptr;
+   attach(pNode, spot.first, spot.second);
+   return std::pair<iterator, bool>(iterator(pNode), true);
+}
+
+/*****************************************************
+ * BST :: MERGE
+ * Move every node of source into this tree by relinking
+ * it, never copying or reallocating. With keepUnique,
+ * duplicates stay behind in source. Source comes out in
+ * order, so each node is tried first just before where
+ * the last one went: moving a range that does not
+ * interleave with ours needs no search from the root
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: merge(BST & source, bool keepUnique)
+{
+   if (&source == this || source.empty())
+      return;
+   unshare();
+   source.unshare();
+
+   BNode* pHint = nullptr;
+   BNode* pNode = source.pLeftmost;
+   while (pNode != source.pHeader())
+   {
+      BNode* match;
+      auto spot = findParent(pHint, pNode->data, keepUnique, match);
+      if (match != nullptr)
+      {
+         // a duplicate stays where it is
+         pHint = (++iterator(match)).pNode;
+         pNode = (++iterator(pNode)).pNode;
+         continue;
+      }
 
-   numElements++;
-   pairReturn.first = iterator(newNode);
-   pairReturn.second = true;
+      pool.take(source.pool, pNode);
+      BNode* pNext = source.detach(pNode);
+      attach(pNode, spot.first, spot.second);
+      pHint = (++iterator(pNode)).pNode;
+      pNode = pNext;
+   }
+}
 
-   // Balance tree
-   newNode->balance();
+/*****************************************************
+ * BST :: EMPLACE
+ * Build a new element right inside its node from whatever
+ * arguments its constructor takes. emplace() allows
+ * duplicates like insert(); emplaceUnique() does not
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class ... Args>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: emplace(Args && ... args)
+{
+   return emplaceNode(nullptr, false, std::forward<Args>(args)...);
+}
 
-   // Ensure root is set properly
-   BNode* head = newNode;
-   while (head->pParent != nullptr)
-      head = head->pParent;
-   root = head;
+template <typename T, typename Compare, bool Ranked>
+template <class ... Args>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: emplaceUnique(Args && ... args)
+{
+   return emplaceNode(nullptr, true, std::forward<Args>(args)...);
+}
+
+/*****************************************************
+ * BST :: EMPLACE HINT
+ * Same, but start looking next to hint: the new element
+ * goes just before it. When the hint is right, no search
+ * from the root is needed
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class ... Args>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: emplaceHint(iterator hint, Args && ... args)
+{
+   return emplaceNode(hint.pNode, false, std::forward<Args>(args)...).first;
+}
 
-   return pairReturn;
+template <typename T, typename Compare, bool Ranked>
+template <class ... Args>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool> BST <T, Compare, Ranked> :: emplaceHintUnique(iterator hint, Args && ... args)
+{
+   return emplaceNode(hint.pNode, true, std::forward<Args>(args)...);
 }
 
-template <typename T>
-std::pair<typename BST <T> ::iterator, bool> BST <T> ::insert(T && t, bool keepUnique)
+/*****************************************************
+ * BST :: EMPLACE NODE
+ * Everything that adds an element comes through here.
+ * When the arguments already are a key we can compare,
+ * we look for a duplicate first and only build the node
+ * if it is needed. Otherwise the node has to be built
+ * to find out what its key is.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class ... Args>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, bool>
+BST <T, Compare, Ranked> :: emplaceNode(BNode * pHint, bool keepUnique, Args && ... args)
 {
-    std::pair<iterator, bool> pairReturn(end(), false);
+   BNode* match;
+   if constexpr (isKey<Args...>::value)
+   {
+      auto spot = findParent(pHint, args..., keepUnique, match);
+      if (match != nullptr)
+         return std::pair<iterator, bool>(iterator(match), false);
+
+      spot.first = prepareInsert(spot.first);
+      BNode* newNode = pool.construct(std::in_place, std::forward<Args>(args)...);
+      attach(newNode, spot.first, spot.second);
+      return std::pair<iterator, bool>(iterator(newNode), true);
+   }
+   else
+   {
+      BNode* newNode = pool.construct(std::in_place, std::forward<Args>(args)...);
+      std::pair<BNode*, bool> spot;
+      try
+      {
+         spot = findParent(pHint, newNode->data, keepUnique, match);
+         if (match == nullptr)
+            spot.first = prepareInsert(spot.first);
+      }
+      catch (...)
+      {
+         pool.destroy(newNode);
+         throw;
+      }
+      if (match != nullptr)
+      {
+         pool.destroy(newNode);
+         return std::pair<iterator, bool>(iterator(match), false);
+      }
 
-   // If empty, just insert at the root and return
-   if (empty()) {
-      root = new BNode(std::move(t));
-      numElements = 1;
-      root->balance();
-      pairReturn.first = iterator(root);
-      pairReturn.second = true;
-      return pairReturn;
+      attach(newNode, spot.first, spot.second);
+      return std::pair<iterator, bool>(iterator(newNode), true);
    }
+}
 
-   // Find insertion point
+/*****************************************************
+ * BST :: FIND PARENT
+ * Walk down to where t belongs. Returns the node it would
+ * hang from and whether it goes on the left. When keepUnique
+ * is set and t is already here, pMatch is the node holding it.
+ *
+ * Each level costs one comparison. Rather than asking "equal?"
+ * on the way down we remember the last node we went right at:
+ * that is the only node t could be equal to, so one more
+ * comparison at the bottom settles it.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K>
+std::pair<typename BST <T, Compare, Ranked> :: BNode *, bool>
+BST <T, Compare, Ranked> :: findParent(const K & t, bool keepUnique, BNode * & pMatch) const
+{
    BNode* current = root;
    BNode* parent = nullptr;
    bool goLeft = false;
+   pMatch = nullptr;
 
-   while (current != nullptr) {
-      parent = current;
-      if (keepUnique)
+   if constexpr (threeWay && std::is_same<K, T>::value)
+   {
+      while (current != nullptr)
+      {
+         parent = current;
+         auto order = compareThreeWay(t, current->data);
+         if (keepUnique && order == 0)
+         {
+            pMatch = current;
+            break;
+         }
+         goLeft = order < 0;
+         current = goLeft ? current->pLeft : current->pRight;
+      }
+   }
+   else
+   {
+      BNode* candidate = nullptr;
+      while (current != nullptr)
       {
-         if (t == current->data)
+         parent = current;
+         goLeft = compare(t, current->data);
+         if (goLeft)
+            current = current->pLeft;
+         else
          {
-            pairReturn.first = iterator(current);
-            pairReturn.second = false;
-            return pairReturn;
+            candidate = current;
+            current = current->pRight;
          }
       }
-      if (t < current->data) {
-         goLeft = true;
-         current = current->pLeft;
-      } else {
-         goLeft = false;
-         current = current->pRight;
+      if (keepUnique && candidate != nullptr && !compare(candidate->data, t))
+         pMatch = candidate;
+   }
+
+   return std::pair<BNode*, bool>(parent, goLeft);
+}
+
+/*****************************************************
+ * BST :: FIND PARENT with a HINT
+ * The caller thinks key goes just before pHint. If the
+ * neighbors on either side of the hint agree, the spot is
+ * found with two comparisons; if not, search from the root.
+ * A hint of end() checks against the largest element, so
+ * appending in order never searches at all.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K>
+std::pair<typename BST <T, Compare, Ranked> :: BNode *, bool>
+BST <T, Compare, Ranked> :: findParent(BNode * pHint, const K & key, bool keepUnique, BNode * & pMatch) const
+{
+   pMatch = nullptr;
+   if (pHint == nullptr || root == nullptr)
+      return findParent(key, keepUnique, pMatch);
+
+   if (pHint == pHeader())
+   {
+      // after everything: hang to the right of the largest element
+      if (compare(rightmost()->data, key))
+         return std::pair<BNode*, bool>(rightmost(), false);
+   }
+   else if (compare(key, pHint->data))
+   {
+      // before the hint, so it must also come after its predecessor
+      if (pHint == pLeftmost)
+         return std::pair<BNode*, bool>(pLeftmost, true);
+      iterator before(pHint);
+      --before;
+      if (compare(before.pNode->data, key))
+      {
+         // between the two there is exactly one empty slot
+         if (before.pNode->pRight == nullptr)
+            return std::pair<BNode*, bool>(before.pNode, false);
+         return std::pair<BNode*, bool>(pHint, true);
+      }
+   }
+   else if (compare(pHint->data, key))
+   {
+      // after the hint, so it must also come before its successor
+      if (pHint == rightmost())
+         return std::pair<BNode*, bool>(rightmost(), false);
+      iterator after(pHint);
+      ++after;
+      if (compare(key, after.pNode->data))
+      {
+         if (pHint->pRight == nullptr)
+            return std::pair<BNode*, bool>(pHint, false);
+         return std::pair<BNode*, bool>(after.pNode, true);
       }
    }
+   else if (keepUnique)
+   {
+      // neither is less: the hint is the duplicate
+      pMatch = pHint;
+      return std::pair<BNode*, bool>(nullptr, false);
+   }
 
-   // Insert new node
-   BNode* newNode = new BNode(std::move(t));
-   // Insert red
-   newNode->isRed = true;
+   // a bad hint costs a couple of comparisons, then we search normally
+   return findParent(key, keepUnique, pMatch);
+}
 
-   if (goLeft) {
-      parent->addLeft(newNode);
-   } else {
-      parent->addRight(newNode);
+/*****************************************************
+ * BST :: ATTACH
+ * Hang a new red node under pParent and rebalance
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: attach(BNode * pNew, BNode * pParent, bool goLeft)
+{
+   if (pParent == nullptr)
+   {
+      pHeader()->addLeft(pNew);
+      root = pLeftmost = rightmost() = pNew;
+   }
+   else if (goLeft)
+   {
+      pParent->addLeft(pNew);
+      if (pParent == pLeftmost)
+         pLeftmost = pNew;
+   }
+   else
+   {
+      pParent->addRight(pNew);
+      if (pParent == rightmost())
+         rightmost() = pNew;
    }
+   if (numElements != unknownSize)
+      numElements++;
 
-   numElements++;
-   pairReturn.first = iterator(newNode);
-   pairReturn.second = true;
+   // every subtree on the way up grew by one
+   if constexpr (Ranked)
+      for (BNode* p = pParent; p != nullptr && !p->isHeader(); p = p->pParent)
+         p->size++;
 
    // Balance tree
-   newNode->balance();
+   pNew->balance();
+
+   // A rotation at the top hangs a new root under the header
+   root = header.node.pLeft;
+}
+
+/*****************************************************
+ * BST :: RELINK
+ * Hang the root under the header and walk down both sides
+ * to find the smallest and largest nodes again, after the
+ * tree was built some other way than one insert at a time.
+ * A Ranked tree also counts its subtrees again, children
+ * before parents, in O(n) time and O(1) space
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: relink()
+{
+   hookRoot();
+   if (root == nullptr)
+      return;
+   findExtremes();
+
+   if constexpr (Ranked)
+   {
+      BNode* p = root;
+      BNode* pFrom = root->pParent;
+      while (!p->isHeader())
+      {
+         if (pFrom == p->pParent && p->pLeft)
+         {
+            pFrom = p;
+            p = p->pLeft;
+         }
+         else if (pFrom != p->pRight && p->pRight)
+         {
+            pFrom = p;
+            p = p->pRight;
+         }
+         else
+         {
+            p->resize();
+            pFrom = p;
+            p = p->pParent;
+         }
+      }
+   }
+}
+
+/*****************************************************
+ * BST :: FIND EXTREMES
+ * Walk down both sides of a non-empty tree to find the
+ * smallest and largest nodes
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: findExtremes()
+{
+   BNode* pMax = root;
+   pLeftmost = root;
+   while (pLeftmost->pLeft)
+      pLeftmost = pLeftmost->pLeft;
+   while (pMax->pRight)
+      pMax = pMax->pRight;
+   rightmost() = pMax;
+}
+
+/*****************************************************
+ * BST :: HOOK ROOT
+ * Point the header and the root at each other. An empty
+ * tree begins and ends at the header.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: hookRoot()
+{
+   pHeader()->addLeft(root);
+   if (root == nullptr)
+      pLeftmost = rightmost() = pHeader();
+}
+
+/*****************************************************
+ * BST :: ASSIGN SORTED
+ * Replace the contents with a range that is already in
+ * strictly ascending order. Rather than n inserts and
+ * their rotations, the nodes are laid down in order with
+ * the middle element at the root of every subtree: O(n)
+ * and no rebalancing at all.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class Iterator>
+void BST <T, Compare, Ranked> :: assignSorted(Iterator first, Iterator last)
+{
+   using Category = typename std::iterator_traits<Iterator>::iterator_category;
+
+   // we need the count up front; a single-pass range is buffered first
+   if constexpr (!std::is_base_of<std::forward_iterator_tag, Category>::value)
+   {
+      std::vector<T> buffer(first, last);
+      assignSorted(std::make_move_iterator(buffer.begin()),
+                   std::make_move_iterator(buffer.end()));
+   }
+   else
+   {
+      clear();
+      size_t num = static_cast<size_t>(std::distance(first, last));
+      if (num == 0)
+         return;
+      pool.reserve(num);
+
+      // every level is full except perhaps the last, which is red
+      size_t redDepth = 0;
+      while ((size_t(2) << redDepth) <= num)
+         redDepth++;
+
+      root = buildSorted(first, num, 0, redDepth, pool);
+      root->isRed = false;
+      numElements = num;
+      relink();
+   }
+}
 
-   // Ensure root is set properly
-   BNode* head = newNode;
-      while (head->pParent != nullptr)
-         head = head->pParent;
-      root = head;
+/*****************************************************
+ * BST :: BUILD SORTED
+ * Build a subtree from the next num elements of a sorted
+ * range, advancing it past them. Nodes at redDepth are red
+ * so every path has the same number of black nodes. A
+ * Ranked node is sized once its children are built.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class Iterator>
+typename BST <T, Compare, Ranked> :: BNode *
+BST <T, Compare, Ranked> :: buildSorted(Iterator & it, size_t num, size_t depth, size_t redDepth,
+                                        Pool <BNode> & pool)
+{
+   if (num == 0)
+      return nullptr;
+
+   size_t numLeft = (num - 1) / 2;
+   BNode * pLeft = buildSorted(it, numLeft, depth + 1, redDepth, pool);
 
+   BNode * pNode;
+   try
+   {
+      pNode = pool.construct(*it);
+   }
+   catch (...)
+   {
+      if (pLeft)
+         BNode::clear(pLeft, pool);
+      throw;
+   }
+   ++it;
+   pNode->isRed = (depth == redDepth);
+   pNode->addLeft(pLeft);
 
-   return pairReturn;
+   try
+   {
+      pNode->addRight(buildSorted(it, num - 1 - numLeft, depth + 1, redDepth, pool));
+   }
+   catch (...)
+   {
+      BNode::clear(pNode, pool);
+      throw;
+   }
+   if constexpr (Ranked)
+      pNode->resize();
+   return pNode;
 }
 
 /*************************************************
  * BST :: ERASE
  * Remove a given node as specified by the iterator
  ************************************************/
-template <typename T>
-typename BST<T>::iterator BST<T>::erase(iterator& it)
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked>::iterator BST <T, Compare, Ranked>::erase(iterator& it)
+{
+   BNode* nodeToDelete = it.pNode; // Access the node through the iterator's pNode member
+
+   // Check if the node to delete is nullptr or end()
+   if (nodeToDelete == nullptr || nodeToDelete == pHeader())
+      return end();
+
+   nodeToDelete = prepareErase(nodeToDelete);
+   iterator returnValue(detach(nodeToDelete));
+   pool.destroy(nodeToDelete);
+   return returnValue;
+}
+
+/*************************************************
+ * BST :: EXTRACT
+ * Take a node out of the tree without destroying it.
+ * The handle keeps the node's slab alive even if
+ * this tree goes away first
+ ************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: node_type BST <T, Compare, Ranked> :: extract(iterator it)
+{
+   if (it.pNode == nullptr || it.pNode == pHeader())
+      return node_type();
+
+   BNode* pNode = prepareErase(it.pNode);
+   detach(pNode);
+   return node_type(pNode, pool.lend(pNode));
+}
+
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: node_type BST <T, Compare, Ranked> :: extract(const T & t)
+{
+   return extract(find(t));
+}
+
+/*************************************************
+ * BST :: DETACH
+ * Unlink a node from the tree and rebalance, leaving
+ * the node itself alone. Returns what came after it
+ ************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: detach(BNode * nodeToDelete)
+{
+   iterator returnValue(nodeToDelete);
+   ++returnValue; // Move to the next node in in-order traversal
+
+   BNode* replacement;    // what takes our place under our parent
+   BNode* child;          // what fills the hole left in the tree (may be null)
+   BNode* childParent;    // where that hole is
+   bool   removedRed;     // the color that left the tree
+
+   if (nodeToDelete->pLeft == nullptr || nodeToDelete->pRight == nullptr)
+   {
+      // Case 1 and 2: Node to delete has at most one child, which takes its place
+      child = (nodeToDelete->pLeft != nullptr) ? nodeToDelete->pLeft : nodeToDelete->pRight;
+      childParent = nodeToDelete->pParent;
+      removedRed = nodeToDelete->isRed;
+      replacement = child;
+
+      // Only a node missing a child can be the smallest or largest,
+      // and its neighbor is either that child's far end or its parent
+      if (nodeToDelete == pLeftmost)
+         pLeftmost = returnValue.pNode;
+      if (nodeToDelete == rightmost())
+      {
+         rightmost() = nodeToDelete->pParent;
+         for (BNode* p = nodeToDelete->pLeft; p; p = p->pRight)
+            rightmost() = p;
+      }
+   }
+   else
+   {
+      // Case 3: Node to delete has two children
+      // Find the in-order successor (smallest node in the right subtree)
+      BNode* successor = nodeToDelete->pRight;
+      while (successor->pLeft != nullptr)
+         successor = successor->pLeft;
+
+      // The successor leaves its old spot, so its color is the one we lose
+      removedRed = successor->isRed;
+      child = successor->pRight;
+
+      // If the successor is not the direct right child, its right child
+      // moves up to fill its spot and it adopts our right subtree
+      if (successor != nodeToDelete->pRight)
+      {
+         childParent = successor->pParent;
+         childParent->addLeft(child);
+         successor->addRight(nodeToDelete->pRight);
+      }
+      else
+         childParent = successor;
+
+      // The successor takes over our left subtree and our color
+      successor->addLeft(nodeToDelete->pLeft);
+      successor->isRed = nodeToDelete->isRed;
+      replacement = successor;
+   }
+
+   // Update the parent of the node to delete to point to its replacement.
+   // The root's parent is the header, so there is no special case
+   if (nodeToDelete->pParent->pLeft == nodeToDelete)
+      nodeToDelete->pParent->pLeft = replacement;
+   else
+      nodeToDelete->pParent->pRight = replacement;
+   if (replacement != nullptr)
+      replacement->pParent = nodeToDelete->pParent;
+   root = header.node.pLeft;
+   if (numElements != unknownSize)
+      --numElements; // Decrement the number of elements
+
+   // every subtree from the hole up lost one. A successor that moved
+   // up is on that path and starts from the size of the spot it took
+   if constexpr (Ranked)
+   {
+      if (replacement != nullptr && replacement != child)
+         replacement->size = nodeToDelete->size;
+      for (BNode* p = childParent; !p->isHeader(); p = p->pParent)
+         p->size--;
+   }
+
+   // Losing a black node leaves one path short: fix up the double black
+   if (!removedRed)
+      balanceErase(child, childParent);
+
+   // the node leaves as a fresh red leaf, ready to be attached elsewhere
+   nodeToDelete->isolate();
+   return returnValue.pNode;
+}
+
+/*****************************************************
+ * BST :: ERASE a RANGE
+ * Remove [first, last). Rather than taking the nodes out
+ * one at a time, the tree is split just before first and
+ * just before last, the two outer pieces are joined back,
+ * and the piece in between goes to the pool whole:
+ * O(log n + k) to erase k elements. Splitting costs a
+ * few microseconds, so a short range is quicker to
+ * erase one node at a time
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: erase(iterator first, iterator last)
+{
+   if (first == last)
+      return last;
+   if (first == begin() && last == end())
+   {
+      clear();
+      return end();
+   }
+   iterator it = first;
+   size_t numSmall = 0;
+   for (; numSmall < smallRange && it != last; numSmall++)
+      ++it;
+   if (it == last)
+   {
+      // count rather than look for last: while a snapshot is held,
+      // an erase may copy the node last is on
+      while (numSmall--)
+         first = erase(first);
+      return first;
+   }
+
+   // the nodes are about to be relinked: none may be a snapshot's
+   settle();
+   if (pSharing != nullptr)
+   {
+      first.pNode = own(first.pNode);
+      last.pNode = own(last.pNode);
+      unshare();
+   }
+
+   size_t num = numElements;
+   Subtree tree = takeTree();
+   std::pair<Subtree, Subtree> after(tree, Subtree{ nullptr, 0 });
+   if (last != end())
+      after = partition(last.pNode);
+   std::pair<Subtree, Subtree> before = partition(first.pNode);
+
+   size_t numLive = pool.live();
+   BNode::clear(before.second.pRoot, pool);
+   if (num != unknownSize)
+      num -= numLive - pool.live();
+   putTree(join(before.first, after.second), num);
+   return last;
+}
+
+/*****************************************************
+ * BST :: SIZE
+ * How many elements are in the tree. After a split of a
+ * tree that is not Ranked, neither side knows until it is
+ * asked: the first call counts, O(n), and later ones don't
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+size_t BST <T, Compare, Ranked> :: size() const noexcept
+{
+   if (numElements == unknownSize)
+   {
+      size_t num = 0;
+      for (iterator it = begin(); it != end(); ++it)
+         num++;
+      numElements = num;
+      pool.disown(pool.live() - num);   // its count was left for now too
+   }
+   return numElements;
+}
+
+/*****************************************************
+ * BST :: CLEAR
+ * Removes all the BNodes from a tree. The values still
+ * need their destructors, but the memory goes back to
+ * the system a slab at a time rather than node by node
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> ::clear() noexcept
+{
+   settle();
+   if (root != nullptr && (pSharing != nullptr || !std::is_trivially_destructible<T>::value))
+      BNode::clear(root, pool);
+
+   // nodes a snapshot still holds keep their slabs: those go with
+   // what we share, and the last snapshot out lets go of them
+   if (pSharing != nullptr)
+   {
+      pSharing->pool.swap(pool);
+      Sharing::release(pSharing);
+      pSharing = nullptr;
+   }
+   root = nullptr;
+   hookRoot();
+   pool.release();
+   numElements = 0;
+}
+
+/*****************************************************
+ * BST :: SNAPSHOT
+ * The tree as it is now, for any thread to read. The
+ * snapshot holds the root, and through it every node:
+ * nothing is copied now, and a change copies only the
+ * nodes it would write. Until the tree changes, every
+ * snapshot shares the same version of it
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: snapshot_type BST <T, Compare, Ranked> :: snapshot()
+{
+   static_assert(std::is_copy_constructible<T>::value,
+                 "a snapshot needs elements the tree can copy when it changes");
+   if (pVersion == nullptr)
+   {
+      if (pSharing == nullptr)
+         pSharing = new Sharing;
+      pVersion = new Version(root, size(), compare, pSharing);
+      pSharing->numRefs.fetch_add(1, std::memory_order_relaxed);
+      if (root != nullptr)
+         root->retain();
+   }
+   pVersion->numRefs.fetch_add(1, std::memory_order_relaxed);
+   return snapshot_type(pVersion);
+}
+
+/*****************************************************
+ * BST :: SNAPSHOT :: BEGIN and END
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: snapshot_type :: iterator
+BST <T, Compare, Ranked> :: snapshot_type :: begin() const noexcept
+{
+   iterator it(root());
+   it.pushLeft(root());
+   return it;
+}
+
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: snapshot_type :: iterator
+BST <T, Compare, Ranked> :: snapshot_type :: end() const noexcept
+{
+   return iterator(root());
+}
+
+/*****************************************************
+ * BST :: SNAPSHOT :: LOWER BOUND and UPPER BOUND
+ * Down from the root, keeping the path. Where we last
+ * went left is the answer, so the path is cut back there
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: snapshot_type :: iterator
+BST <T, Compare, Ranked> :: snapshot_type :: lower_bound(const T & t) const
+{
+   iterator it(root());
+   int depth = 0;
+   for (const BNode * p = root(); p; )
+   {
+      it.push(p);
+      if (pVersion->compare(p->data, t))
+         p = p->pRight;
+      else
+      {
+         depth = it.depth;
+         p = p->pLeft;
+      }
+   }
+   it.depth = depth;
+   return it;
+}
+
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: snapshot_type :: iterator
+BST <T, Compare, Ranked> :: snapshot_type :: upper_bound(const T & t) const
+{
+   iterator it(root());
+   int depth = 0;
+   for (const BNode * p = root(); p; )
+   {
+      it.push(p);
+      if (!pVersion->compare(t, p->data))
+         p = p->pRight;
+      else
+      {
+         depth = it.depth;
+         p = p->pLeft;
+      }
+   }
+   it.depth = depth;
+   return it;
+}
+
+/*****************************************************
+ * BST :: SETTLE
+ * Before any change: the version the last snapshot saw
+ * is no longer the tree, and nodes the snapshots let go
+ * of are destroyed. Once no snapshot is left, the tree
+ * stops sharing and changes go back to copying nothing
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: settle() noexcept
+{
+   if (pSharing == nullptr)
+      return;
+   Version::release(pVersion);
+   pVersion = nullptr;
+
+   // no snapshot left means no more orphans on the way
+   bool alone = pSharing->numRefs.load(std::memory_order_acquire) == 1;
+
+   // they left our count when they left the tree
+   size_t numLive = pool.live();
+   BNode::destroy(pSharing->pOrphans.exchange(nullptr, std::memory_order_acquire), pool);
+   pool.adopt(numLive - pool.live());
+
+   if (alone)
+   {
+      delete pSharing;
+      pSharing = nullptr;
+   }
+}
+
+/*****************************************************
+ * BST :: OWN
+ * Make pNode and everything above it ours to change,
+ * copying down from the root whatever is shared.
+ * Returns where pNode is now
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: own(BNode * pNode)
+{
+   if (pNode == pHeader())
+      return pNode;
+   return ownChild(own(pNode->pParent), pNode);
+}
+
+/*****************************************************
+ * BST :: OWN CHILD
+ * pParent is already ours. If a snapshot shares pChild,
+ * put a copy in its place that holds the same children,
+ * and let go of pChild. Returns the one in the tree
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: ownChild(BNode * pParent, BNode * pChild)
+{
+   if (pChild == nullptr || !pChild->isShared())
+      return pChild;
+
+   if constexpr (std::is_copy_constructible<T>::value)
+   {
+      BNode * pCopy = pool.construct(pChild->data);
+      pCopy->isRed = pChild->isRed;
+      if constexpr (Ranked)
+         pCopy->size = pChild->size;
+      pCopy->addLeft(pChild->pLeft);
+      pCopy->addRight(pChild->pRight);
+      for (BNode * p : { pCopy->pLeft, pCopy->pRight })
+         if (p != nullptr)
+            p->retain();
+
+      if (pParent->pLeft == pChild)
+         pParent->pLeft = pCopy;
+      else
+         pParent->pRight = pCopy;
+      pCopy->pParent = pParent;
+      if (pLeftmost == pChild)
+         pLeftmost = pCopy;
+      if (rightmost() == pChild)
+         rightmost() = pCopy;
+      root = header.node.pLeft;
+
+      // a snapshot may have let go while we copied
+      if (pChild->release())
+      {
+         pChild->pParent = nullptr;
+         BNode::destroy(pChild, pool);
+      }
+      else
+         pool.disown();
+      return pCopy;
+   }
+   else
+      return pChild;
+}
+
+/*****************************************************
+ * BST :: OWN ALL
+ * Make the whole subtree at pNode ours, O(n)
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: ownAll(BNode * pParent, BNode * pNode)
+{
+   if (pNode == nullptr)
+      return;
+   pNode = ownChild(pParent, pNode);
+   ownAll(pNode, pNode->pLeft);
+   ownAll(pNode, pNode->pRight);
+}
+
+/*****************************************************
+ * BST :: PREPARE INSERT
+ * A new node is about to hang under pParent. Insertion
+ * only rotates nodes on the path up from it, and only
+ * recolors any other, so owning that path is enough.
+ * Returns where pParent is now
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: prepareInsert(BNode * pParent)
+{
+   settle();
+   if (pSharing == nullptr || pParent == nullptr)
+      return pParent;
+   return own(pParent);
+}
+
+/*****************************************************
+ * BST :: PREPARE ERASE
+ * pNode is about to be detached. Own the path down to
+ * the node that actually leaves its spot, and walk up
+ * the way balanceErase() will, owning each sibling it
+ * is going to rotate. The tree is read before anything
+ * moves: above a successor that moves up, pNode stands
+ * in for it, with the color it will take.
+ * Returns where pNode is now
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: prepareErase(BNode * pNode)
+{
+   settle();
+   if (pSharing == nullptr)
+      return pNode;
+   pNode = own(pNode);
+
+   // the node that leaves its spot, where, and what fills it
+   BNode * pGone = pNode;
+   BNode * pUp = pNode->pParent;
+   bool isLeft = (pUp->pLeft == pNode);
+   BNode * pChild = pNode->pLeft ? pNode->pLeft : pNode->pRight;
+   if (pNode->pLeft != nullptr && pNode->pRight != nullptr)
+   {
+      pGone = ownChild(pNode, pNode->pRight);
+      pUp = pNode;
+      isLeft = false;
+      while (pGone->pLeft != nullptr)
+      {
+         pUp = pGone;
+         pGone = ownChild(pGone, pGone->pLeft);
+         isLeft = true;
+      }
+      pChild = pGone->pRight;
+   }
+   if (pGone->isRed || isRed(pChild))
+      return pNode;
+
+   // up from the hole, as long as it is short a black
+   while (pUp != pHeader())
+   {
+      BNode * pSibling = isLeft ? pUp->pRight : pUp->pLeft;
+      BNode * pOwner = pUp;
+      if (pSibling->isRed)
+      {
+         // the sibling rotates up, and its near child is the new sibling
+         pOwner = ownChild(pUp, pSibling);
+         pSibling = isLeft ? pOwner->pLeft : pOwner->pRight;
+      }
+      BNode * pNear = isLeft ? pSibling->pLeft  : pSibling->pRight;
+      BNode * pFar  = isLeft ? pSibling->pRight : pSibling->pLeft;
+      if (isRed(pNear) || isRed(pFar))
+      {
+         pSibling = ownChild(pOwner, pSibling);
+         if (!isRed(pFar))
+            ownChild(pSibling, isLeft ? pSibling->pLeft : pSibling->pRight);
+         break;
+      }
+      if (pOwner != pUp || pUp->isRed)
+         break;
+      isLeft = (pUp->pParent->pLeft == pUp);
+      pUp = pUp->pParent;
+   }
+   return pNode;
+}
+
+/*****************************************************
+ * BST :: UNSHARE
+ * Before relinking nodes in bulk: make every node
+ * ours, copying whatever a snapshot still shares, O(n)
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: unshare()
+{
+   settle();
+   if (pSharing != nullptr)
+      ownAll(pHeader(), root);
+}
+
+/*****************************************************
+ * BST :: UNION WITH
+ * Everything in either tree. Where both hold an
+ * equivalent element, ours stays and rhs's is destroyed
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: unionWith(BST & rhs)
+{
+   if (this != &rhs)
+      combine(rhs, &BST::unite, parallelDepth());
+}
+
+/*****************************************************
+ * BST :: INTERSECT WITH
+ * Only what is in both trees, keeping our elements
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: intersectWith(BST & rhs)
+{
+   if (this != &rhs)
+      combine(rhs, &BST::intersect, parallelDepth());
+}
+
+/*****************************************************
+ * BST :: DIFFERENCE WITH
+ * Only what is in this tree but not in rhs
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: differenceWith(BST & rhs)
+{
+   if (this == &rhs)
+      clear();
+   else
+      combine(rhs, &BST::subtract, parallelDepth());
+}
+
+/*****************************************************
+ * BST :: UNION OF
+ * Everything in either tree, as a new tree. Where both
+ * hold an equivalent element, lhs's is the one copied
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> BST <T, Compare, Ranked> :: unionOf(const BST & lhs, const BST & rhs)
+{
+   return combined(lhs, rhs, KEEP_EITHER, parallelDepth());
+}
+
+/*****************************************************
+ * BST :: INTERSECTION OF
+ * Only what is in both trees, copied from lhs
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> BST <T, Compare, Ranked> :: intersectionOf(const BST & lhs, const BST & rhs)
+{
+   return combined(lhs, rhs, KEEP_BOTH, parallelDepth());
+}
+
+/*****************************************************
+ * BST :: DIFFERENCE OF
+ * Only what is in lhs but not in rhs
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked> BST <T, Compare, Ranked> :: differenceOf(const BST & lhs, const BST & rhs)
+{
+   return combined(lhs, rhs, KEEP_LHS_ONLY, parallelDepth());
+}
+
+/*****************************************************
+ * BST :: SPLIT
+ * Everything from key on moves to a new tree, which
+ * shares our slabs rather than copying. A Ranked tree
+ * knows how many move in O(log n); any other tree leaves
+ * both sizes, and the pools' counts, for size() to count
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K, class>
+BST <T, Compare, Ranked> BST <T, Compare, Ranked> :: split(const K & key)
+{
+   BST rhs(compare);
+   if (root == nullptr)
+      return rhs;
+
+   iterator itSplit = lowerBound(key);
+   if (itSplit == end())
+      return rhs;
+   if (itSplit == begin())
+   {
+      swap(rhs);
+      return rhs;
+   }
+
+   // relinked nodes must be ours alone, and copies are new nodes
+   if (pSharing != nullptr)
+   {
+      unshare();
+      itSplit = lowerBound(key);
+   }
+
+   size_t numLeft = unknownSize;
+   size_t numRight = unknownSize;
+   rhs.pool.keep(pool);
+   if constexpr (Ranked)
+   {
+      numLeft = indexOf(itSplit);
+      numRight = numElements - numLeft;
+      pool.disown(numRight);
+      rhs.pool.adopt(numRight);
+   }
+
+   std::pair<Subtree, Subtree> parts = partition(takeTree(), key);
+   putTree(parts.first, numLeft);
+   rhs.putTree(parts.second, numRight);
+   return rhs;
+}
+
+/*****************************************************
+ * BST :: JOIN
+ * Append rhs when everything in it comes after us, or
+ * prepend it when everything comes before: the two
+ * trees are joined in O(log n), nothing is copied.
+ * When they interleave this is just merge(), and with
+ * keepUnique duplicates stay behind in rhs the same way
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: join(BST & rhs, bool keepUnique)
+{
+   if (&rhs == this || rhs.empty())
+      return;
+   if (empty())
+   {
+      swap(rhs);
+      return;
+   }
+
+   // keepUnique needs a strict gap; otherwise equal ends are fine
+   bool append  = keepUnique ? compare(rightmost()->data, rhs.pLeftmost->data)
+                             : !compare(rhs.pLeftmost->data, rightmost()->data);
+   bool prepend = keepUnique ? compare(rhs.rightmost()->data, pLeftmost->data)
+                             : !compare(pLeftmost->data, rhs.rightmost()->data);
+   if (!append && !prepend)
+   {
+      merge(rhs, keepUnique);
+      return;
+   }
+
+   unshare();
+   rhs.unshare();
+   size_t num = addSizes(numElements, rhs.numElements);
+   size_t numMoved = rhs.pool.live();
+   pool.keep(rhs.pool);
+   rhs.pool.disown(numMoved);
+   pool.adopt(numMoved);
+
+   Subtree lhsTree = takeTree();
+   Subtree rhsTree = rhs.takeTree();
+   rhs.clear();
+   putTree(append ? join(lhsTree, rhsTree) : join(rhsTree, lhsTree), num);
+}
+
+/*****************************************************
+ * BST :: COMBINE
+ * Take both trees apart, put them back together with
+ * op, and destroy whatever op left over. Nodes of rhs
+ * move over as they are, so their slabs move too. The
+ * pool is not touched until op is done, which is what
+ * lets op run on several threads at once
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: combine(BST & rhs, Combine op, unsigned depth)
+{
+   unshare();
+   rhs.unshare();
+   size_t num = addSizes(numElements, rhs.numElements);
+   size_t numMoved = rhs.pool.live();
+   pool.keep(rhs.pool);
+   rhs.pool.disown(numMoved);
+   pool.adopt(numMoved);
+
+   Subtree lhsTree = takeTree();
+   Subtree rhsTree = rhs.takeTree();
+   rhs.clear();
+
+   BNode * pGarbage = nullptr;
+   Subtree tree = (this->*op)(lhsTree, rhsTree, pGarbage, depth);
+
+   while (pGarbage)
+   {
+      BNode * pNext = pGarbage->pParent;
+      pGarbage->pParent = nullptr;
+      size_t numLive = pool.live();
+      BNode::clear(pGarbage, pool);
+      if (num != unknownSize)
+         num -= numLive - pool.live();
+      pGarbage = pNext;
+   }
+   putTree(tree, num);
+}
+
+/*****************************************************
+ * BST :: UNITE
+ * Split rhs around our root, unite the two halves on
+ * either side (in parallel when they are big enough),
+ * and join them back with our root in the middle.
+ * O(m log(n/m + 1)) work for trees of m <= n nodes
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: unite(Subtree lhs, Subtree rhs, BNode * & pGarbage, unsigned depth) const
+{
+   if (rhs.pRoot == nullptr)
+      return lhs;
+   if (lhs.pRoot == nullptr)
+      return rhs;
+
+   BNode * pMiddle = lhs.pRoot;
+   size_t blackHeight = lhs.blackHeight - (pMiddle->isRed ? 0 : 1);
+   Subtree lhsLeft  = cut(pMiddle->pLeft,  blackHeight);
+   Subtree lhsRight = cut(pMiddle->pRight, blackHeight);
+   pMiddle->isolate();
+
+   Split parts = split(rhs, pMiddle->data);
+   if (parts.pMatch)
+      discard(parts.pMatch, pGarbage);
+
+   BNode * pGarbageRight = nullptr;
+   Subtree left, right;
+   fork(depth > 0 && blackHeight >= parallelHeight,
+        [&]() { left  = unite(lhsLeft,  parts.left,  pGarbage,      depth ? depth - 1 : 0); },
+        [&]() { right = unite(lhsRight, parts.right, pGarbageRight, depth ? depth - 1 : 0); });
+   splice(pGarbageRight, pGarbage);
+
+   return join(left, pMiddle, right);
+}
+
+/*****************************************************
+ * BST :: INTERSECT
+ * Like unite, but our root only goes back in the
+ * middle when rhs had it too
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: intersect(Subtree lhs, Subtree rhs, BNode * & pGarbage, unsigned depth) const
+{
+   if (lhs.pRoot == nullptr || rhs.pRoot == nullptr)
+   {
+      discard(lhs.pRoot, pGarbage);
+      discard(rhs.pRoot, pGarbage);
+      return Subtree{ nullptr, 0 };
+   }
+
+   BNode * pMiddle = lhs.pRoot;
+   size_t blackHeight = lhs.blackHeight - (pMiddle->isRed ? 0 : 1);
+   Subtree lhsLeft  = cut(pMiddle->pLeft,  blackHeight);
+   Subtree lhsRight = cut(pMiddle->pRight, blackHeight);
+   pMiddle->isolate();
+
+   Split parts = split(rhs, pMiddle->data);
+
+   BNode * pGarbageRight = nullptr;
+   Subtree left, right;
+   fork(depth > 0 && blackHeight >= parallelHeight,
+        [&]() { left  = intersect(lhsLeft,  parts.left,  pGarbage,      depth ? depth - 1 : 0); },
+        [&]() { right = intersect(lhsRight, parts.right, pGarbageRight, depth ? depth - 1 : 0); });
+   splice(pGarbageRight, pGarbage);
+
+   if (parts.pMatch)
+   {
+      discard(parts.pMatch, pGarbage);
+      return join(left, pMiddle, right);
+   }
+   discard(pMiddle, pGarbage);
+   return join(left, right);
+}
+
+/*****************************************************
+ * BST :: SUBTRACT
+ * Like unite, but our root only goes back in the
+ * middle when rhs did not have it
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: subtract(Subtree lhs, Subtree rhs, BNode * & pGarbage, unsigned depth) const
+{
+   if (lhs.pRoot == nullptr || rhs.pRoot == nullptr)
+   {
+      discard(rhs.pRoot, pGarbage);
+      return lhs;
+   }
+
+   BNode * pMiddle = lhs.pRoot;
+   size_t blackHeight = lhs.blackHeight - (pMiddle->isRed ? 0 : 1);
+   Subtree lhsLeft  = cut(pMiddle->pLeft,  blackHeight);
+   Subtree lhsRight = cut(pMiddle->pRight, blackHeight);
+   pMiddle->isolate();
+
+   Split parts = split(rhs, pMiddle->data);
+
+   BNode * pGarbageRight = nullptr;
+   Subtree left, right;
+   fork(depth > 0 && blackHeight >= parallelHeight,
+        [&]() { left  = subtract(lhsLeft,  parts.left,  pGarbage,      depth ? depth - 1 : 0); },
+        [&]() { right = subtract(lhsRight, parts.right, pGarbageRight, depth ? depth - 1 : 0); });
+   splice(pGarbageRight, pGarbage);
+
+   if (parts.pMatch)
+   {
+      discard(parts.pMatch, pGarbage);
+      discard(pMiddle, pGarbage);
+      return join(left, right);
+   }
+   return join(left, pMiddle, right);
+}
+
+/*****************************************************
+ * BST :: DISCARD
+ * Put a detached node, and the subtree it roots, on
+ * the garbage list
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: discard(BNode * pNode, BNode * & pGarbage)
+{
+   if (pNode == nullptr)
+      return;
+   pNode->pParent = pGarbage;
+   pGarbage = pNode;
+}
+
+/*****************************************************
+ * BST :: SPLICE
+ * Put a whole garbage list on another one
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: splice(BNode * pList, BNode * & pGarbage)
+{
+   if (pList == nullptr)
+      return;
+   BNode * pLast = pList;
+   while (pLast->pParent)
+      pLast = pLast->pParent;
+   pLast->pParent = pGarbage;
+   pGarbage = pList;
+}
+
+/*****************************************************
+ * BST :: COMBINED
+ * Build a new tree from copies of what keep wants out
+ * of lhs and rhs. Neither is changed, so both can be
+ * read from several threads at once
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+BST <T, Compare, Ranked>
+BST <T, Compare, Ranked> :: combined(const BST & lhs, const BST & rhs, Keep keep, unsigned depth)
+{
+   BST result(lhs.compare);
+   Subtree tree = rhs.copyCombine(lhs.root, blackHeight(lhs.root), rhs.begin(), rhs.end(),
+                                  keep, result.pool, depth);
+   result.putTree(tree, result.pool.live());
+   return result;
+}
+
+/*****************************************************
+ * BST :: COPY COMBINE
+ * The copying twin of unite, intersect and subtract.
+ * pLHS is a subtree of the left tree, [itFirst, itLast)
+ * the elements of this tree within the same bounds.
+ * Find where pLHS's element falls among them, combine
+ * the halves on either side (in parallel when they are
+ * big enough), and join them around a copy of pLHS's
+ * element if keep wants it. Whatever one side alone
+ * holds is copied a subtree at a time, and what the
+ * result drops is never copied at all
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: copyCombine(const BNode * pLHS, size_t blackHeight,
+                                        iterator itFirst, iterator itLast,
+                                        Keep keep, Pool <BNode> & pool, unsigned depth) const
+{
+   if (pLHS == nullptr)
+      return keep == KEEP_EITHER ? copyRange(itFirst, itLast, pool) : Subtree{ nullptr, 0 };
+   if (itFirst == itLast)
+      return keep == KEEP_BOTH ? Subtree{ nullptr, 0 } : copySubtree(pLHS, blackHeight, pool);
+
+   iterator itSplit = lowerBound(pLHS->data);
+   bool match = itSplit != itLast && !compare(pLHS->data, *itSplit);
+   iterator itAfter = itSplit;
+   if (match)
+      ++itAfter;
+   size_t childHeight = blackHeight - (pLHS->isRed ? 0 : 1);
+
+   // a forked right side builds into a pool of its own, so the
+   // two threads never allocate from the same one
+   bool parallel = depth > 0 && blackHeight >= parallelHeight;
+   Pool <BNode> poolFork;
+   Pool <BNode> * pPoolRight = parallel ? &poolFork : &pool;
+   Subtree left  = { nullptr, 0 };
+   Subtree right = { nullptr, 0 };
+   std::exception_ptr errLeft;
+   std::exception_ptr errRight;
+   fork(parallel,
+        [&]()
+        {
+           try
+           {
+              left = copyCombine(pLHS->pLeft, childHeight, itFirst, itSplit,
+                                 keep, pool, depth ? depth - 1 : 0);
+           }
+           catch (...)
+           {
+              errLeft = std::current_exception();
+           }
+        },
+        [&]()
+        {
+           try
+           {
+              right = copyCombine(pLHS->pRight, childHeight, itAfter, itLast,
+                                  keep, *pPoolRight, depth ? depth - 1 : 0);
+           }
+           catch (...)
+           {
+              errRight = std::current_exception();
+           }
+        });
+
+   BNode * pMiddle = nullptr;
+   try
+   {
+      if (parallel)
+      {
+         size_t numMoved = poolFork.live();
+         pool.keep(poolFork);
+         poolFork.disown(numMoved);
+         pool.adopt(numMoved);
+         pPoolRight = &pool;
+      }
+      if (errLeft || errRight)
+         std::rethrow_exception(errLeft ? errLeft : errRight);
+      if (keep == KEEP_EITHER || match == (keep == KEEP_BOTH))
+         pMiddle = pool.construct(pLHS->data);
+   }
+   catch (...)
+   {
+      BNode::clear(left.pRoot, pool);
+      BNode::clear(right.pRoot, *pPoolRight);
+      throw;
+   }
+   return pMiddle ? join(left, pMiddle, right) : join(left, right);
+}
+
+/*****************************************************
+ * BST :: COPY RANGE
+ * Copy a sorted range into a balanced subtree
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: copyRange(iterator itFirst, iterator itLast, Pool <BNode> & pool)
+{
+   size_t num = 0;
+   for (iterator it = itFirst; it != itLast; ++it)
+      num++;
+   if (num == 0)
+      return Subtree{ nullptr, 0 };
+
+   // as in assignSorted, only the last level is red
+   size_t redDepth = 0;
+   while ((size_t(2) << redDepth) <= num)
+      redDepth++;
+   BNode * pRoot = buildSorted(itFirst, num, 0, redDepth, pool);
+   return Subtree{ pRoot, redDepth };
+}
+
+/*****************************************************
+ * BST :: COPY SUBTREE
+ * Copy a whole subtree, colors and all, so its black
+ * height carries over
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: copySubtree(const BNode * pNode, size_t blackHeight, Pool <BNode> & pool)
+{
+   BNode * pCopy = nullptr;
+   try
+   {
+      BNode::assign(pCopy, pNode, pool);
+   }
+   catch (...)
+   {
+      BNode::clear(pCopy, pool);
+      throw;
+   }
+   return Subtree{ pCopy, blackHeight };
+}
+
+/*****************************************************
+ * BST :: FORK
+ * Run left and right, on two threads when asked. If no
+ * thread can be had, they just run one after the other
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class Left, class Right>
+void BST <T, Compare, Ranked> :: fork(bool parallel, Left left, Right right)
+{
+   if (parallel)
+   {
+      std::future<void> future;
+      try
+      {
+         future = std::async(std::launch::async, right);
+      }
+      catch (const std::system_error &)
+      {
+         parallel = false;
+      }
+      left();
+      if (parallel)
+      {
+         future.get();
+         return;
+      }
+   }
+   else
+      left();
+   right();
+}
+
+/*****************************************************
+ * BST :: PARALLEL DEPTH
+ * How many levels of the recursion fork: enough to
+ * give every core some work, none on a single core
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+unsigned BST <T, Compare, Ranked> :: parallelDepth()
+{
+   unsigned numCores = std::thread::hardware_concurrency();
+   if (numCores <= 1)
+      return 0;
+   unsigned depth = 1;
+   while ((1u << depth) < numCores)
+      depth++;
+   return depth + 1;
+}
+
+/*****************************************************
+ * BST :: TAKE TREE
+ * Unhook every node from this tree as one subtree,
+ * leaving the tree empty
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree BST <T, Compare, Ranked> :: takeTree()
+{
+   Subtree tree = cut(root, blackHeight(root));
+   root = nullptr;
+   numElements = 0;
+   hookRoot();
+   return tree;
+}
+
+/*****************************************************
+ * BST :: PUT TREE
+ * Make a subtree of num nodes the whole tree. Its
+ * sizes are already right, so only the extremes
+ * need finding
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: putTree(Subtree tree, size_t num)
+{
+   root = tree.pRoot;
+   numElements = num;
+   hookRoot();
+   if (root)
+   {
+      root->isRed = false;
+      findExtremes();
+   }
+}
+
+/*****************************************************
+ * BST :: CUT
+ * Let go of a subtree's parent
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: cut(BNode * pNode, size_t blackHeight)
+{
+   if (pNode)
+      pNode->pParent = nullptr;
+   return Subtree{ pNode, blackHeight };
+}
+
+/*****************************************************
+ * BST :: BLACK HEIGHT
+ * Count the black nodes down one side. In a red-black
+ * tree every path has the same count
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+size_t BST <T, Compare, Ranked> :: blackHeight(const BNode * pNode)
+{
+   size_t height = 0;
+   for (; pNode; pNode = pNode->pLeft)
+      if (!pNode->isRed)
+         height++;
+   return height;
+}
+
+/*****************************************************
+ * BST :: JOIN
+ * Join two subtrees with pMiddle between them. Every
+ * element on the left must come before pMiddle and
+ * every one on the right after it. The shorter tree
+ * hangs from the taller one's inside edge, where the
+ * black heights match, so only that spine has to be
+ * walked and rebalanced: O(difference in height)
+ *
+ *          (a)                      (a)
+ *         /   \                    /   \
+ *        b    (c)     +  m  + r   b    (c)
+ *            /   \                    /   \
+ *           d     e                  d    [m]
+ *                                         /  \
+ *                                        e    r
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: join(Subtree left, BNode * pMiddle, Subtree right)
+{
+   // start with black roots so the tops never need fixing
+   if (isRed(left.pRoot))
+   {
+      left.pRoot->isRed = false;
+      left.blackHeight++;
+   }
+   if (isRed(right.pRoot))
+   {
+      right.pRoot->isRed = false;
+      right.blackHeight++;
+   }
+
+   // the same height: pMiddle is the new root
+   if (left.blackHeight == right.blackHeight)
+   {
+      pMiddle->isRed = false;
+      pMiddle->addLeft(left.pRoot);
+      pMiddle->addRight(right.pRoot);
+      if constexpr (Ranked)
+         pMiddle->resize();
+      return Subtree{ pMiddle, left.blackHeight + 1 };
+   }
+
+   // walk down the inside edge of the taller tree
+   bool goLeft = left.blackHeight < right.blackHeight;
+   Subtree & taller  = goLeft ? right : left;
+   Subtree & shorter = goLeft ? left  : right;
+   BNode * pParent = nullptr;
+   BNode * pNode = taller.pRoot;
+   size_t height = taller.blackHeight;
+   while (pNode && (pNode->isRed || height > shorter.blackHeight))
+   {
+      if (!pNode->isRed)
+         height--;
+      pParent = pNode;
+      pNode = goLeft ? pNode->pLeft : pNode->pRight;
+   }
+
+   // hang pMiddle there, red so no black height changes
+   pMiddle->isRed = true;
+   if (goLeft)
+   {
+      pParent->addLeft(pMiddle);
+      pMiddle->addLeft(shorter.pRoot);
+      pMiddle->addRight(pNode);
+   }
+   else
+   {
+      pParent->addRight(pMiddle);
+      pMiddle->addLeft(pNode);
+      pMiddle->addRight(shorter.pRoot);
+   }
+   if constexpr (Ranked)
+   {
+      pMiddle->resize();
+      size_t grown = 1 + BNode::count(shorter.pRoot);
+      for (BNode * p = pParent; p; p = p->pParent)
+         p->size += grown;
+   }
+
+   // only a red parent needs fixing, as on insert
+   if (pMiddle->balance())
+      taller.blackHeight++;
+   BNode * pRoot = pMiddle;
+   while (pRoot->pParent)
+      pRoot = pRoot->pParent;
+   return Subtree{ pRoot, taller.blackHeight };
+}
+
+/*****************************************************
+ * BST :: JOIN with no MIDDLE
+ * Join two subtrees, the left all before the right,
+ * by pulling the largest node out of the left one to
+ * go between them
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: join(Subtree left, Subtree right)
+{
+   if (left.pRoot == nullptr)
+      return right;
+   BNode * pLast = nullptr;
+   Subtree rest = splitLast(left, pLast);
+   return join(rest, pLast, right);
+}
+
+/*****************************************************
+ * BST :: SPLIT LAST
+ * Take the largest node off a subtree, leaving it as a
+ * lone node in pLast. Returns the rest of the subtree
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: Subtree
+BST <T, Compare, Ranked> :: splitLast(Subtree tree, BNode * & pLast)
+{
+   BNode * pRoot = tree.pRoot;
+   size_t blackHeight = tree.blackHeight - (pRoot->isRed ? 0 : 1);
+   Subtree left  = cut(pRoot->pLeft,  blackHeight);
+   Subtree right = cut(pRoot->pRight, blackHeight);
+   pRoot->isolate();
+
+   if (right.pRoot == nullptr)
+   {
+      pLast = pRoot;
+      return left;
+   }
+   Subtree rest = splitLast(right, pLast);
+   return join(left, pRoot, rest);
+}
+
+/*****************************************************
+ * BST :: PARTITION
+ * Like split, but in two: everything before key, and
+ * everything else. Elements equivalent to key, however
+ * many there are, all go in the second
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K>
+std::pair<typename BST <T, Compare, Ranked> :: Subtree, typename BST <T, Compare, Ranked> :: Subtree>
+BST <T, Compare, Ranked> :: partition(Subtree tree, const K & key) const
+{
+   BNode * pRoot = tree.pRoot;
+   if (pRoot == nullptr)
+      return std::make_pair(tree, tree);
+
+   size_t blackHeight = tree.blackHeight - (pRoot->isRed ? 0 : 1);
+   Subtree left  = cut(pRoot->pLeft,  blackHeight);
+   Subtree right = cut(pRoot->pRight, blackHeight);
+   pRoot->isolate();
+
+   if (compare(pRoot->data, key))
+   {
+      std::pair<Subtree, Subtree> parts = partition(right, key);
+      parts.first = join(left, pRoot, parts.first);
+      return parts;
+   }
+   std::pair<Subtree, Subtree> parts = partition(left, key);
+   parts.second = join(parts.second, pRoot, right);
+   return parts;
+}
+
+/*****************************************************
+ * BST :: PARTITION at a NODE
+ * Split the detached tree holding pAt into everything
+ * before pAt, and pAt with everything after it. No
+ * comparisons: we climb from pAt to the root, and each
+ * node on the way joins the side it lies on along with
+ * its other subtree. Equal keys split exactly where pAt is
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+std::pair<typename BST <T, Compare, Ranked> :: Subtree, typename BST <T, Compare, Ranked> :: Subtree>
+BST <T, Compare, Ranked> :: partition(BNode * pAt)
+{
+   // pAt goes right, its left subtree left
+   size_t height = blackHeight(pAt);
+   size_t childHeight = height - (pAt->isRed ? 0 : 1);
+   BNode * pUp = pAt->pParent;
+   bool fromLeft = pUp && pUp->pLeft == pAt;
+   Subtree left  = cut(pAt->pLeft,  childHeight);
+   Subtree right = cut(pAt->pRight, childHeight);
+   pAt->isolate();
+   right = join(Subtree{ nullptr, 0 }, pAt, right);
+
+   // every ancestor and its other subtree go on one side
+   while (pUp)
+   {
+      BNode * pNode = pUp;
+      childHeight = height;
+      height += pNode->isRed ? 0 : 1;
+      pUp = pNode->pParent;
+      bool nextFromLeft = pUp && pUp->pLeft == pNode;
+      if (fromLeft)
+      {
+         Subtree other = cut(pNode->pRight, childHeight);
+         pNode->isolate();
+         right = join(right, pNode, other);
+      }
+      else
+      {
+         Subtree other = cut(pNode->pLeft, childHeight);
+         pNode->isolate();
+         left = join(other, pNode, left);
+      }
+      fromLeft = nextFromLeft;
+   }
+   return std::make_pair(left, right);
+}
+
+/*****************************************************
+ * BST :: SPLIT
+ * Take a subtree apart into what comes before key,
+ * the node equivalent to key if there is one, and what
+ * comes after. Walking down toward key, every subtree
+ * we step away from is joined onto one side or the
+ * other: O(log n)
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K>
+typename BST <T, Compare, Ranked> :: Split
+BST <T, Compare, Ranked> :: split(Subtree tree, const K & key) const
 {
-   BNode* nodeToDelete = it.pNode; // Access the node through the iterator's pNode member
+   BNode * pRoot = tree.pRoot;
+   if (pRoot == nullptr)
+      return Split{ Subtree{ nullptr, 0 }, nullptr, Subtree{ nullptr, 0 } };
 
-   // Check if the node to delete is nullptr
-   if (nodeToDelete == nullptr)
-      return end();
+   size_t blackHeight = tree.blackHeight - (pRoot->isRed ? 0 : 1);
+   Subtree left  = cut(pRoot->pLeft,  blackHeight);
+   Subtree right = cut(pRoot->pRight, blackHeight);
+   pRoot->isolate();
 
-   iterator returnValue = it;
-   ++returnValue; // Move to the next node in in-order traversal
+   if (compare(key, pRoot->data))
+   {
+      Split parts = split(left, key);
+      parts.right = join(parts.right, pRoot, right);
+      return parts;
+   }
+   if (compare(pRoot->data, key))
+   {
+      Split parts = split(right, key);
+      parts.left = join(left, pRoot, parts.left);
+      return parts;
+   }
+   return Split{ left, pRoot, right };
+}
 
-   if (nodeToDelete->pLeft == nullptr && nodeToDelete->pRight == nullptr)
+/****************************************************
+ * BST :: FIND
+ * Return the node corresponding to a given value.
+ * Like findParent, one comparison per level
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K, class>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: find(const K & t) const
+{
+   BNode* p = root;
+   if constexpr (threeWay && std::is_same<K, T>::value)
    {
-      // Case 1: Node to delete has no children
-      if (nodeToDelete->pParent != nullptr)
+      while (p)
       {
-         if (nodeToDelete->pParent->pLeft == nodeToDelete)
-            nodeToDelete->pParent->pLeft = nullptr;
-         else
-            nodeToDelete->pParent->pRight = nullptr;
+         auto order = compareThreeWay(t, p->data);
+         if (order == 0)
+            return iterator(p);
+         p = (order < 0) ? p->pLeft : p->pRight;
       }
-      delete nodeToDelete;
+      return end();
    }
-   else if (nodeToDelete->pLeft == nullptr || nodeToDelete->pRight == nullptr)
+   else
    {
-      // Case 2: Node to delete has one child
-      BNode* child = (nodeToDelete->pLeft != nullptr) ? nodeToDelete->pLeft : nodeToDelete->pRight;
-      if (nodeToDelete->pParent != nullptr)
+      BNode* candidate = nullptr;
+      while (p)
       {
-         if (nodeToDelete->pParent->pLeft == nodeToDelete)
-            nodeToDelete->pParent->pLeft = child;
+         if (compare(t, p->data))
+            p = p->pLeft;
          else
-            nodeToDelete->pParent->pRight = child;
+         {
+            candidate = p;
+            p = p->pRight;
+         }
       }
-      child->pParent = nodeToDelete->pParent;
-      delete nodeToDelete;
+      if (candidate != nullptr && !compare(candidate->data, t))
+         return iterator(candidate);
+      return end();
    }
-   else
-   {
-      // Case 3: Node to delete has two children
-      // Find the in-order successor (smallest node in the right subtree)
-      BNode* successor = nodeToDelete->pRight;
-      while (successor->pLeft != nullptr)
-         successor = successor->pLeft;
+}
 
-      // If the successor is not the direct right child
-      if (successor != nodeToDelete->pRight)
+/****************************************************
+ * BST :: LOWER BOUND and UPPER BOUND
+ * The first element not less than t, and the first
+ * element greater than t. One comparison per level
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K, class>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: lowerBound(const K & t) const
+{
+   return iterator(lowerBound(root, pHeader(), t));
+}
+
+template <typename T, typename Compare, bool Ranked>
+template <class K, class>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: upperBound(const K & t) const
+{
+   return iterator(upperBound(root, pHeader(), t));
+}
+
+/****************************************************
+ * BST :: LOWER BOUND and UPPER BOUND in a SUBTREE
+ * Search below pNode; if nothing there qualifies, the
+ * answer is pBound, the last node we went left at above
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K>
+typename BST <T, Compare, Ranked> :: BNode *
+BST <T, Compare, Ranked> :: lowerBound(BNode * pNode, BNode * pBound, const K & t) const
+{
+   while (pNode != nullptr)
+      if (compare(pNode->data, t))
+         pNode = pNode->pRight;
+      else
       {
-         // Update the successor's parent's left or right pointer
-         if (successor->pRight != nullptr)
-            successor->pRight->pParent = successor->pParent;
-         if (successor->pParent->pLeft == successor)
-            successor->pParent->pLeft = successor->pRight;
-         else
-            successor->pParent->pRight = successor->pRight;
-         // Move the successor's right child to the node to delete's right child
-         successor->pRight = nodeToDelete->pRight;
-         if (nodeToDelete->pRight != nullptr)
-            nodeToDelete->pRight->pParent = successor;
+         pBound = pNode;
+         pNode = pNode->pLeft;
       }
+   return pBound;
+}
 
-      // Update the parent of the node to delete to point to the successor
-      if (nodeToDelete->pParent != nullptr)
+template <typename T, typename Compare, bool Ranked>
+template <class K>
+typename BST <T, Compare, Ranked> :: BNode *
+BST <T, Compare, Ranked> :: upperBound(BNode * pNode, BNode * pBound, const K & t) const
+{
+   while (pNode != nullptr)
+      if (compare(t, pNode->data))
       {
-         if (nodeToDelete->pParent->pLeft == nodeToDelete)
-            nodeToDelete->pParent->pLeft = successor;
-         else
-            nodeToDelete->pParent->pRight = successor;
+         pBound = pNode;
+         pNode = pNode->pLeft;
       }
-      // If the node to delete is the root, update the root pointer
       else
-         root = successor;
-
-      // Update the successor's parent pointer and left child pointer
-      successor->pParent = nodeToDelete->pParent;
-      successor->pLeft = nodeToDelete->pLeft;
-      if (nodeToDelete->pLeft != nullptr)
-         nodeToDelete->pLeft->pParent = successor;
+         pNode = pNode->pRight;
+   return pBound;
+}
 
-      delete nodeToDelete;
+/****************************************************
+ * BST :: EQUAL RANGE
+ * Every element equivalent to t. The two bounds share
+ * one descent until it reaches an equal element, then
+ * each finishes in its own subtree below it
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+template <class K, class>
+std::pair<typename BST <T, Compare, Ranked> :: iterator, typename BST <T, Compare, Ranked> :: iterator>
+BST <T, Compare, Ranked> :: equalRange(const K & t) const
+{
+   BNode* pNode = root;
+   BNode* pBound = pHeader();
+   while (pNode != nullptr)
+   {
+      if (compare(pNode->data, t))
+         pNode = pNode->pRight;
+      else if (compare(t, pNode->data))
+      {
+         pBound = pNode;
+         pNode = pNode->pLeft;
+      }
+      else
+         return std::pair<iterator, iterator>(iterator(lowerBound(pNode->pLeft, pNode, t)),
+                                              iterator(upperBound(pNode->pRight, pBound, t)));
    }
-
-   --numElements; // Decrement the number of elements
-   return returnValue;
+   return std::pair<iterator, iterator>(iterator(pBound), iterator(pBound));
 }
 
-/*****************************************************
- * BST :: CLEAR
- * Removes all the BNodes from a tree
+/****************************************************
+ * BST :: COUNT
+ * How many elements are equivalent to t? A Ranked
+ * tree subtracts positions rather than walking
  ****************************************************/
-template <typename T>
-void BST <T> ::clear() noexcept
+template <typename T, typename Compare, bool Ranked>
+template <class K, class>
+size_t BST <T, Compare, Ranked> :: count(const K & t) const
 {
-   if(root != nullptr)
+   auto range = equalRange(t);
+   if constexpr (Ranked)
+      return indexOf(range.second) - indexOf(range.first);
+   else
    {
-      root->clear(root);
-      root = nullptr;
+      size_t num = 0;
+      for (iterator it = range.first; it != range.second; ++it)
+         num++;
+      return num;
    }
-   numElements = 0;
 }
 
-/*****************************************************
- * BST :: BEGIN
- * Return the first node (left-most) in a binary search tree
+/****************************************************
+ * BST :: RANK
+ * How many elements are less than t? Every time we go
+ * right, the node and its left subtree are all smaller
  ****************************************************/
-template <typename T>
-typename BST <T> :: iterator custom :: BST <T> :: begin() const noexcept
+template <typename T, typename Compare, bool Ranked>
+size_t BST <T, Compare, Ranked> :: rank(const T & t) const
 {
-   if (empty())
-      return end();
-   BNode* p = root; // help
-   while (p->pLeft)
-      p = p->pLeft;
-   return iterator(p);
+   static_assert(Ranked, "rank() needs a Ranked tree");
+   size_t num = 0;
+   for (BNode* p = root; p != nullptr; )
+      if (compare(p->data, t))
+      {
+         num += BNode::count(p->pLeft) + 1;
+         p = p->pRight;
+      }
+      else
+         p = p->pLeft;
+   return num;
 }
 
-
 /****************************************************
- * BST :: FIND
- * Return the node corresponding to a given value
+ * BST :: SELECT
+ * The element with k elements before it, or end()
  ****************************************************/
-template <typename T>
-typename BST <T> :: iterator BST<T> :: find(const T & t)
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: select(size_t k) const
 {
+   static_assert(Ranked, "select() needs a Ranked tree");
+   if (k >= numElements)
+      return end();
    BNode* p = root;
-   while (p)
+   while (true)
    {
-      if (p->data == t)
-         return iterator(p);
-      else if (t < p->data)
+      size_t numLeft = BNode::count(p->pLeft);
+      if (k < numLeft)
          p = p->pLeft;
+      else if (k == numLeft)
+         return iterator(p);
       else
+      {
+         k -= numLeft + 1;
          p = p->pRight;
+      }
    }
-   return end();
+}
+
+/****************************************************
+ * BST :: COUNT RANGE
+ * How many elements are in [lo, hi)?
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+size_t BST <T, Compare, Ranked> :: countRange(const T & lo, const T & hi) const
+{
+   static_assert(Ranked, "countRange() needs a Ranked tree");
+   if (!compare(lo, hi))
+      return 0;
+   return rank(hi) - rank(lo);
+}
+
+/****************************************************
+ * BST :: INDEX OF
+ * How many elements come before it? Climb to the root,
+ * counting the left side of every node we come up from
+ * the right of. end() comes after everything
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+size_t BST <T, Compare, Ranked> :: indexOf(iterator it) const
+{
+   static_assert(Ranked, "indexOf() needs a Ranked tree");
+   BNode* p = it.pNode;
+   if (p == nullptr || p->isHeader())
+      return numElements;
+   size_t index = BNode::count(p->pLeft);
+   for (; !p->isRoot(); p = p->pParent)
+      if (p->pParent->pRight == p)
+         index += BNode::count(p->pParent->pLeft) + 1;
+   return index;
+}
+
+/****************************************************
+ * BST :: ADVANCE
+ * Move an iterator n elements either way in O(log n)
+ * rather than n steps. Going past either end gives end()
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: iterator BST <T, Compare, Ranked> :: advance(iterator it, std::ptrdiff_t n) const
+{
+   static_assert(Ranked, "advance() needs a Ranked tree");
+   size_t index = indexOf(it);
+   if (n < 0 && static_cast<size_t>(-n) > index)
+      return end();
+   return select(index + n);
 }
 
 /******************************************************
@@ -700,8 +3251,8 @@ typename BST <T> :: iterator BST<T> :: find(const T & t)
  * BINARY NODE :: ADD LEFT
  * Add a node to the left of the current node
  ******************************************************/
-template <typename T>
-void BST <T> :: BNode :: addLeft (BNode * pNode)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: BNode :: addLeft (BNode * pNode)
 {
    this->pLeft = pNode;
    if(pNode)
@@ -709,59 +3260,166 @@ void BST <T> :: BNode :: addLeft (BNode * pNode)
 }
 
 /******************************************************
- * BINARY NODE :: ADD RIGHT
- * Add a node to the right of the current node
+ * BINARY NODE :: ASSIGN
+ * Make the subtree at pDest a copy of the one at pSrc,
+ * reusing whatever nodes pDest already has. The two trees
+ * are walked in step using the parent pointers, so the
+ * copy takes O(1) extra space however deep the tree is.
  ******************************************************/
-template <typename T>
-void BST <T> :: BNode :: addRight (BNode * pNode)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: BNode :: assign(BNode*& pDest, const BNode* pSrc, Pool <BNode> & pool)
 {
-   this->pRight = pNode;
-   if(pNode)
-      pNode->pParent = this;
+   if (pSrc == nullptr)
+   {
+      clear(pDest, pool);  // Only clear if source is null
+      return;
+   }
+
+   // copy one node into the matching spot under pParent
+   auto copyNode = [&pool](BNode*& pTo, const BNode* pFrom, BNode* pParent)
+   {
+      if (pTo == nullptr)
+         pTo = pool.construct(pFrom->data);
+      else
+         pTo->data = pFrom->data;
+      pTo->isRed = pFrom->isRed;
+      pTo->pParent = pParent;
+      if constexpr (Ranked)
+         pTo->size = pFrom->size;
+   };
+
+   copyNode(pDest, pSrc, pDest ? pDest->pParent : nullptr);
+   const BNode* src = pSrc;
+   BNode* dest = pDest;
+   while (true)
+   {
+      // go down the left first
+      if (src->pLeft)
+      {
+         copyNode(dest->pLeft, src->pLeft, dest);
+         src = src->pLeft;
+         dest = dest->pLeft;
+         continue;
+      }
+      clear(dest->pLeft, pool);
+
+      // then down the right
+      if (src->pRight)
+      {
+         copyNode(dest->pRight, src->pRight, dest);
+         src = src->pRight;
+         dest = dest->pRight;
+         continue;
+      }
+      clear(dest->pRight, pool);
+
+      // climb until we come up out of a left subtree whose
+      // parent still has a right subtree to copy
+      while (true)
+      {
+         if (src == pSrc)
+            return;
+         bool fromLeft = (src->pParent->pLeft == src);
+         src = src->pParent;
+         dest = dest->pParent;
+         if (!fromLeft)
+            continue;
+         if (src->pRight)
+         {
+            copyNode(dest->pRight, src->pRight, dest);
+            src = src->pRight;
+            dest = dest->pRight;
+            break;
+         }
+         clear(dest->pRight, pool);
+      }
+   }
 }
 
 /******************************************************
- * BINARY NODE :: ADD LEFT
- * Add a node to the left of the current node
+ * BINARY NODE :: CLEAR
+ * Let go of the subtree at pThis. Every node nobody else
+ * holds is destroyed; one a snapshot still holds is left
+ * to it, along with everything below it
  ******************************************************/
- template <typename T>
-void BST<T> :: BNode :: addLeft (const T & t)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: BNode :: clear(BNode*& pThis, Pool <BNode> & pool) noexcept
 {
-   pLeft = new BNode(t);
-   pLeft->pParent = this;
+   if (pThis != nullptr && pThis->release())
+   {
+      pThis->pParent = nullptr;
+      destroy(pThis, pool);
+   }
+   pThis = nullptr;
 }
 
 /******************************************************
- * BINARY NODE :: ADD LEFT
- * Add a node to the left of the current node
+ * BINARY NODE :: RETAIN
+ * One more parent or snapshot holds us. Only the tree's
+ * thread gets here, but a snapshot may be letting go
  ******************************************************/
- template <typename T>
-void BST<T> ::BNode::addLeft(T && t)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: BNode :: retain() noexcept
 {
-   pLeft = new BNode (std::move(t));
-   pLeft->pParent = this;
+   uint16_t num = numRefs.load(std::memory_order_relaxed);
+   while (num != maxRefs &&
+          !numRefs.compare_exchange_weak(num, num + 1, std::memory_order_relaxed))
+      ;
 }
 
 /******************************************************
- * BINARY NODE :: ADD RIGHT
- * Add a node to the right of the current node
+ * BINARY NODE :: RELEASE
+ * One less holds us. Returns whether that was the last,
+ * so the caller is now the only one who can reach us.
+ * The last holder need not write the count at all
+ ******************************************************/
+template <typename T, typename Compare, bool Ranked>
+bool BST <T, Compare, Ranked> :: BNode :: release() noexcept
+{
+   uint16_t num = numRefs.load(std::memory_order_acquire);
+   if (num == 1)
+      return true;
+   while (num != maxRefs)
+      if (numRefs.compare_exchange_weak(num, num - 1, std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+         return num == 1;
+   return false;
+}
+
+/******************************************************
+ * BINARY NODE :: DESTROY
+ * Destroy a list of nodes nobody holds, linked through
+ * pParent. Each lets go of its children first, and any
+ * child that was the last of joins the list, so there
+ * is no recursion and no stack to overflow
  ******************************************************/
- template <typename T>
-void BST <T> :: BNode :: addRight (const T & t)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: BNode :: destroy(BNode * pList, Pool <BNode> & pool) noexcept
 {
-   pRight = new BNode(t);
-   pRight->pParent = this;
+   while (pList != nullptr)
+   {
+      BNode * p = pList;
+      pList = p->pParent;
+      for (BNode * pChild : { p->pLeft, p->pRight })
+         if (pChild != nullptr && pChild->release())
+         {
+            pChild->pParent = pList;
+            pList = pChild;
+         }
+      pool.destroy(p);
+   }
 }
 
 /******************************************************
  * BINARY NODE :: ADD RIGHT
  * Add a node to the right of the current node
  ******************************************************/
- template <typename T>
-void BST <T> ::BNode::addRight(T && t)
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: BNode :: addRight (BNode * pNode)
 {
-   pRight = new BNode (std::move(t));
-   pRight->pParent = this;
+   this->pRight = pNode;
+   if(pNode)
+      pNode->pParent = this;
 }
 
 #ifdef DEBUG
@@ -770,8 +3428,8 @@ void BST <T> ::BNode::addRight(T && t)
  * Find the depth of the black nodes. This is useful for
  * verifying that a given red-black tree is valid
  ****************************************************/
-template <typename T>
-int BST <T> :: BNode :: findDepth() const
+template <typename T, typename Compare, bool Ranked>
+int BST <T, Compare, Ranked> :: BNode :: findDepth() const
 {
    // if there are no children, the depth is ourselves
    if (pRight == nullptr && pLeft == nullptr)
@@ -788,8 +3446,8 @@ int BST <T> :: BNode :: findDepth() const
  * BINARY NODE :: VERIFY RED BLACK
  * Do all four red-black rules work here?
  ***************************************************/
-template <typename T>
-bool BST <T> :: BNode :: verifyRedBlack(int depth) const
+template <typename T, typename Compare, bool Ranked>
+bool BST <T, Compare, Ranked> :: BNode :: verifyRedBlack(int depth) const
 {
    bool fReturn = true;
    depth -= (isRed == false) ? 1 : 0;
@@ -798,7 +3456,7 @@ bool BST <T> :: BNode :: verifyRedBlack(int depth) const
    assert(isRed == true || isRed == false); // this feels silly
 
    // Rule b) The root is black
-   if (pParent == nullptr)
+   if (isRoot())
       if (isRed == true)
          fReturn = false;
 
@@ -833,8 +3491,8 @@ bool BST <T> :: BNode :: verifyRedBlack(int depth) const
  * VERIFY B TREE
  * Verify that the tree is correctly formed
  ******************************************************/
-template <typename T>
-std::pair <T, T> BST <T> :: BNode :: verifyBTree() const
+template <typename T, typename Compare, bool Ranked>
+std::pair <T, T> BST <T, Compare, Ranked> :: BNode :: verifyBTree() const
 {
    // largest and smallest values
    std::pair <T, T> extremes;
@@ -877,38 +3535,195 @@ std::pair <T, T> BST <T> :: BNode :: verifyBTree() const
  * COMPUTE SIZE
  * Verify that the BST is as large as we think it is
  ********************************************/
-template <typename T>
-int BST <T> :: BNode :: computeSize() const
+template <typename T, typename Compare, bool Ranked>
+int BST <T, Compare, Ranked> :: BNode :: computeSize() const
 {
    return 1 +
       (pLeft  == nullptr ? 0 : pLeft->computeSize()) +
       (pRight == nullptr ? 0 : pRight->computeSize());
 }
+
+/*********************************************
+ * VERIFY SIZE
+ * Does every node in a Ranked tree know how big
+ * its subtree is?
+ ********************************************/
+template <typename T, typename Compare, bool Ranked>
+bool BST <T, Compare, Ranked> :: BNode :: verifySize() const
+{
+   if ((int)this->size != computeSize())
+      return false;
+   return (pLeft  == nullptr || pLeft->verifySize()) &&
+          (pRight == nullptr || pRight->verifySize());
+}
 #endif // DEBUG
 
+/*****************************************************
+ * BST :: BALANCE ERASE
+ * Fix the tree after a black node was removed. pNode is
+ * "double black": every path through it is one black short.
+ * pParent is passed separately because pNode may be null.
+ ****************************************************/
+template <typename T, typename Compare, bool Ranked>
+void BST <T, Compare, Ranked> :: balanceErase(BNode * pNode, BNode * pParent)
+{
+   while (pNode != root && !isRed(pNode))
+   {
+      bool isLeft = (pParent->pLeft == pNode);
+      BNode* pSibling = isLeft ? pParent->pRight : pParent->pLeft;
+
+      // Case 1: the sibling is red. Rotate it above the parent so that
+      // we get a black sibling and fall into one of the other cases
+      if (pSibling->isRed)
+      {
+         pSibling->isRed = false;
+         pParent->isRed = true;
+         if (isLeft)
+            pParent->rotateLeft();
+         else
+            pParent->rotateRight();
+         if (root == pParent)
+            root = pSibling;
+         pSibling = isLeft ? pParent->pRight : pParent->pLeft;
+      }
+
+      BNode* pNear = isLeft ? pSibling->pLeft  : pSibling->pRight;
+      BNode* pFar  = isLeft ? pSibling->pRight : pSibling->pLeft;
+
+      // Case 2: the sibling has two black children. Make the sibling red,
+      // so the parent is now the one that is short a black
+      if (!isRed(pNear) && !isRed(pFar))
+      {
+         pSibling->isRed = true;
+         pNode = pParent;
+         pParent = pNode->pParent;
+         continue;
+      }
+
+      // Case 3: only the near nephew is red. Rotate it into the sibling spot
+      if (!isRed(pFar))
+      {
+         pNear->isRed = false;
+         pSibling->isRed = true;
+         if (isLeft)
+            pSibling->rotateRight();
+         else
+            pSibling->rotateLeft();
+         pFar = pSibling;
+         pSibling = pNear;
+      }
+
+      // Case 4: the far nephew is red. Rotate the sibling above the parent
+      // and recolor: the extra black is absorbed and we are done
+      pSibling->isRed = pParent->isRed;
+      pParent->isRed = false;
+      pFar->isRed = false;
+      if (isLeft)
+         pParent->rotateLeft();
+      else
+         pParent->rotateRight();
+      if (root == pParent)
+         root = pSibling;
+      pNode = root;
+   }
+
+   if (pNode != nullptr)
+      pNode->isRed = false;
+}
+
+/******************************************************
+ * BINARY NODE :: ROTATE LEFT
+ * Our right child takes our place and we become its left
+ *
+ *        (this)                (right)
+ *        /    \                /     \
+ *       a   (right)   ==>   (this)    c
+ *           /     \         /    \
+ *          b       c       a      b
+ ******************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: BNode :: rotateLeft()
+{
+   BNode* pHead = pParent;
+   BNode* pUp = pRight;
+
+   addRight(pUp->pLeft);
+   if (pHead == nullptr)
+      pUp->pParent = nullptr;
+   else if (pHead->pLeft == this)
+      pHead->addLeft(pUp);
+   else
+      pHead->addRight(pUp);
+   pUp->addLeft(this);
+
+   // the same nodes hang below the top, only we lost some
+   if constexpr (Ranked)
+   {
+      pUp->size = this->size;
+      resize();
+   }
+   return pUp;
+}
+
+/******************************************************
+ * BINARY NODE :: ROTATE RIGHT
+ * Our left child takes our place and we become its right
+ *
+ *          (this)          (left)
+ *          /    \           /    \
+ *       (left)   c   ==>   a   (this)
+ *       /    \                 /    \
+ *      a      b               b      c
+ ******************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: BNode * BST <T, Compare, Ranked> :: BNode :: rotateRight()
+{
+   BNode* pHead = pParent;
+   BNode* pUp = pLeft;
+
+   addLeft(pUp->pRight);
+   if (pHead == nullptr)
+      pUp->pParent = nullptr;
+   else if (pHead->pLeft == this)
+      pHead->addLeft(pUp);
+   else
+      pHead->addRight(pUp);
+   pUp->addRight(this);
+
+   if constexpr (Ranked)
+   {
+      pUp->size = this->size;
+      resize();
+   }
+   return pUp;
+}
+
 /******************************************************
  * BINARY NODE :: BALANCE
- * Balance the tree from a given location
+ * Balance the tree from a given location. Returns whether
+ * the root turned from red to black, which makes every
+ * path one black node longer
  ******************************************************/
-template <typename T>
-void BST<T>::BNode::balance()
+template <typename T, typename Compare, bool Ranked>
+bool BST <T, Compare, Ranked>::BNode::balance()
 {
    // Case 1: if we are the root, then color ourselves black and call it a day.
-   if (pParent == nullptr)
+   if (isRoot())
    {
+      bool grew = isRed;
       isRed = false;
-      return;
+      return grew;
    }
 
    // Case 2: if the parent is black, then there is nothing left to do
    if (!pParent->isRed)
-      return;
+      return false;
 
    // Case 3: if the aunt is red, then just recolor
 
    BNode* pGranny = pParent->pParent;
-   if (pGranny == nullptr)
-      return;
+   if (pParent->isRoot())
+      return false;
 
    BNode* pAunt = (pGranny->pLeft == pParent) ? pGranny->pRight : pGranny->pLeft;
 
@@ -917,125 +3732,54 @@ void BST<T>::BNode::balance()
       pParent->isRed = false;
       pAunt->isRed = false;
       pGranny->isRed = true;
-      pGranny->balance();  // recursively balance
-      return;
+      return pGranny->balance();  // recursively balance
    }
 
    // Case 4: if the aunt is black or non-existent, then we need to rotate
-   BNode* pMom = this->pParent;
-   BNode* pNew = this;
-   BNode* pHead = pGranny->pParent;
-   BNode* pSibbling;
 
    // Case 4a: We are mom's left and mom is granny's left
    // Rotate Right
    if (pParent->pLeft == this && pGranny->pLeft == pParent)
    {
-      // Sibbling is mom's right
-      pSibbling = pParent->pRight;
-      // Perform the rotation
-      // Add sibling to granny's left
-      pGranny->addLeft(pSibbling);
-
-      pParent->addRight(pGranny);
-      pParent->pParent = pHead;
-
-      // Fix Parent pointers
-      // pHead is not root
-      if (pHead != nullptr)
-      {
-         if (pHead->pLeft == pGranny)
-            pHead->addLeft(pParent);
-         else
-            pHead->addRight(pParent);
-      }
-
+      pGranny->rotateRight();
 
       // Recolor
       pGranny->isRed = true;
       pParent->isRed = false;
-      return;
    }
    // Case 4b: We are mom's right and mom is granny's right
    // Left Rotation
    else if (pParent->pRight == this && pGranny->pRight == pParent)
    {
-      // Perform the rotation
-      if (pParent->pLeft != nullptr)
-         pGranny->addRight(pParent->pLeft);
-      else
-         pGranny->addRight(nullptr);
-
-      pParent->addLeft(pGranny);
-      pParent->pParent = pHead;
-
-      // Fix parent pointers
-      if (pHead != nullptr)
-      {
-         if (pHead->pLeft == pGranny)
-            pHead->addLeft(pParent);
-         else
-            pHead->addRight(pParent);
-      }
+      pGranny->rotateLeft();
 
       // Recolor
       pGranny->isRed = true;
       pParent->isRed = false;
-      return;
    }
    // Case 4c: We are mom's right and mom is granny's left
    // Double Right Rotation
    else if (pParent->pRight == this && pGranny->pLeft == pParent)
    {
-      // Perform the rotations
-      pGranny->addLeft(pNew->pRight);
-      pParent->addRight(pNew->pLeft);
-
-      pNew->addLeft(pParent);
-      pNew->addRight(pGranny);
-      pNew->pParent = pHead;
-
-      if (pHead != nullptr)
-      {
-         if (pHead->pLeft == pGranny)
-            pHead->addLeft(pNew);
-         else
-            pHead->addRight(pNew);
-      }
-
+      pParent->rotateLeft();
+      pGranny->rotateRight();
 
       // Recolor
       pGranny->isRed = true;
-      pNew->isRed = false;
-      return;
+      isRed = false;
    }
    // Case 4d: we are mom's left and mom is granny's right
    // Double Left Rotation
    else if (pParent->pLeft == this && pGranny->pRight == pParent)
    {
-      // Perform the rotations
-
-      pGranny->addRight(pNew->pLeft);
-      pParent->addLeft(pNew->pRight);
-
-      pNew->addRight(pParent);
-      pNew->addLeft(pGranny);
-
-      pNew->pParent = pHead;
-
-      if (pHead != nullptr)
-      {
-         if (pHead->pLeft == pGranny)
-            pHead->addLeft(pNew);
-         else
-            pHead->addRight(pNew);
-      }
+      pParent->rotateRight();
+      pGranny->rotateLeft();
 
       // Recolor
       pGranny->isRed = true;
-      pNew->isRed = false;
-      return;
+      isRed = false;
    }
+   return false;
 }
 
 /*************************************************
@@ -1048,65 +3792,58 @@ void BST<T>::BNode::balance()
 
 /**************************************************
  * BST ITERATOR :: INCREMENT PREFIX
- * advance by one
+ * advance by one. Every climb ends at the header at the
+ * latest: the root is the header's left child, and the
+ * header is its own parent, so there is nothing to check
+ * for null. The header's right link is no child, so
+ * ++end() stays at end() rather than following it
  *************************************************/
-template <typename T>
-typename BST <T> :: iterator & BST <T> :: iterator :: operator ++ ()
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: iterator & BST <T, Compare, Ranked> :: iterator :: operator ++ ()
 {
-   if (!pNode)
+   if (pNode->pParent == pNode)
       return *this;
    if (pNode->pRight)
    {
       pNode = pNode->pRight;
       while (pNode->pLeft)
          pNode = pNode->pLeft;
-      return *this;
-   }
-   if (pNode->pRight == nullptr && pNode->pParent->pLeft == pNode)
-   {
-      pNode = pNode->pParent;
-      return *this;
    }
-   if (pNode->pRight == nullptr && pNode->pParent->pRight == pNode)
+   else
    {
-      while (pNode->pParent && pNode->pParent->pRight == pNode)
+      // climb out of right subtrees
+      while (pNode == pNode->pParent->pRight)
          pNode = pNode->pParent;
       pNode = pNode->pParent;
-      return *this;
    }
    return *this;
 }
 
 /**************************************************
  * BST ITERATOR :: DECREMENT PREFIX
- * advance by one
+ * back up by one. The header keeps the largest element
+ * in its right link, so --end() takes it from there
+ * rather than walking down the right spine
  *************************************************/
-template <typename T>
-typename BST <T> :: iterator & BST <T> :: iterator :: operator -- ()
+template <typename T, typename Compare, bool Ranked>
+typename BST <T, Compare, Ranked> :: iterator & BST <T, Compare, Ranked> :: iterator :: operator -- ()
 {
-   if (!pNode)
-      return *this;
-   if (pNode->pLeft)
+   if (pNode->pParent == pNode)
+      pNode = pNode->pRight;
+   else if (pNode->pLeft)
    {
       pNode = pNode->pLeft;
       while (pNode->pRight)
          pNode = pNode->pRight;
-      return *this;
-   }
-   if (pNode->pLeft == nullptr && pNode->pParent->pRight == pNode)
-   {
-      pNode = pNode->pParent;
-      return *this;
    }
-   if (pNode->pLeft == nullptr && pNode->pParent->pLeft == pNode)
+   else
    {
-      while (pNode->pParent && pNode->pParent->pLeft == pNode)
+      // climb out of left subtrees
+      while (pNode == pNode->pParent->pLeft)
          pNode = pNode->pParent;
       pNode = pNode->pParent;
-      return *this;
    }
    return *this;
-
 }
 
 
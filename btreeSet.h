@@ -0,0 +1,1108 @@
+/***********************************************************************
+ * Header:
+ *    BTREE SET
+ * Summary:
+ *    A set kept in a B+ tree, so that each step of a search is one
+ *    node of many keys rather than one key per cache miss
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        btree_set           : A cache-friendly ordered set
+ *        btree_set::iterator : An iterator through the set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "nodeSearch.h"      // for NodeSearch
+#include <cstddef>           // for size_t and ptrdiff_t
+#include <cstdint>           // for uint16_t
+#include <cstring>           // for std::memmove
+#include <functional>        // for std::less
+#include <initializer_list>  // for std::initializer_list
+#include <iterator>          // for std::bidirectional_iterator_tag, std::reverse_iterator
+#include <new>               // for placement new
+#include <type_traits>       // for std::is_trivially_copyable
+#include <utility>           // for std::pair, std::move, std::swap
+
+class TestBTreeSet;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * BTREE SET
+ * A B+ tree: every element lives in a leaf, the leaves are linked
+ * in order, and the inner nodes above them hold only separators.
+ * Nodes are sized from sizeof(T) to fill a few cache lines, so a
+ * leaf of ints holds 58 of them and an inner node fans out 20 ways.
+ * A search touches one node per level instead of one per key, and
+ * walking the set in order reads the leaves end to end.
+ *
+ * The price is that inserting or erasing shifts elements within a
+ * node, and can move them to another, so either one invalidates
+ * every iterator. T's move constructor must not throw.
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>>
+class btree_set
+{
+   friend class ::TestBTreeSet; // give unit tests access to the privates
+
+   struct Node;
+   struct Leaf;
+   struct Inner;
+
+public:
+
+   //
+   // Construct
+   //
+
+   btree_set() : btree_set(Compare()) { }
+   explicit btree_set(const Compare & compare) :
+      pRoot(nullptr), pFirst(nullptr), pLast(nullptr), numElements(0), compare(compare) { }
+   btree_set(const btree_set & rhs);
+   btree_set(btree_set && rhs) noexcept : btree_set(rhs.compare) { swap(rhs); }
+   btree_set(const std::initializer_list<T> & il) : btree_set() { insert(il); }
+   template <class Iterator>
+   btree_set(Iterator first, Iterator last) : btree_set() { insert(first, last); }
+   ~btree_set() { clear(); }
+
+   //
+   // Assign
+   //
+
+   btree_set & operator = (const btree_set & rhs);
+   btree_set & operator = (btree_set && rhs) noexcept;
+   btree_set & operator = (const std::initializer_list<T> & il);
+   void swap(btree_set & rhs) noexcept;
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+   iterator begin() const noexcept { return iterator(pFirst, 0); }
+   iterator last()  const noexcept { return empty() ? end() : iterator(pLast, pLast->count - 1); }
+   iterator end()   const noexcept { return iterator(pLast, pLast ? pLast->count : 0); }
+   reverse_iterator rbegin() const noexcept { return reverse_iterator(end());   }
+   reverse_iterator rend()   const noexcept { return reverse_iterator(begin()); }
+
+   //
+   // Access
+   //
+
+   iterator find       (const T & t) const;
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const;
+   std::pair<iterator, iterator> equal_range(const T & t) const
+   {
+      iterator it = lower_bound(t);
+      iterator itNext = it;
+      if (it != end() && !compare(t, *it))
+         ++itNext;
+      return std::pair<iterator, iterator>(it, itNext);
+   }
+   size_t count   (const T & t) const { return contains(t) ? 1 : 0; }
+   bool   contains(const T & t) const { return find(t) != end(); }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return numElements == 0; }
+   size_t size()  const noexcept { return numElements; }
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t) { return insertUnique(t, t); }
+   std::pair<iterator, bool> insert(      T && t) { return insertUnique(t, std::move(t)); }
+   template <class ... Args>
+   std::pair<iterator, bool> emplace(Args && ... args)
+   {
+      T t(std::forward<Args>(args)...);
+      return insertUnique(t, std::move(t));
+   }
+   void insert(const std::initializer_list<T> & il)
+   {
+      for (const T & t : il)
+         insert(t);
+   }
+   template <class Iterator>
+   void insert(Iterator first, Iterator last)
+   {
+      for (; first != last; ++first)
+         insert(*first);
+   }
+
+   //
+   // Remove
+   //
+
+   void     clear() noexcept;
+   iterator erase(const iterator & it);
+   size_t   erase(const T & t);
+   iterator erase(const iterator & itBegin, const iterator & itEnd);
+
+private:
+
+   //
+   // Node sizes: four cache lines, as many keys as fit
+   //
+
+   static const size_t cacheLine = 64;
+   static const size_t nodeBytes = 4 * cacheLine;
+   static const size_t leafFit   = (nodeBytes - 3 * sizeof(void *)) / sizeof(T);
+   static const size_t leafSlots = leafFit > 4 ? leafFit : 4;
+   static const size_t innerFit  = (nodeBytes - 2 * sizeof(void *)) / (sizeof(T) + sizeof(void *));
+   static const size_t innerSlots = innerFit > 3 ? innerFit - (innerFit % 2 == 0 ? 1 : 0) : 3; // odd, so splits are even
+   static const size_t minLeaf   = leafSlots / 2;   // fewer, and a leaf borrows or merges
+   static const size_t minInner  = innerSlots / 2;
+   static const size_t maxDepth  = 48;              // far more than 2^64 elements need
+
+   // what every node starts with
+   struct Node
+   {
+      uint16_t count;     // keys in use
+      bool     isLeaf;
+   };
+
+   // elements, with links to the leaves on either side
+   struct alignas(cacheLine) Leaf : Node
+   {
+      Leaf * pPrev;
+      Leaf * pNext;
+      alignas(T) unsigned char raw[leafSlots * sizeof(T)];
+
+      T *       keys()       { return reinterpret_cast<T *>(raw); }
+      const T * keys() const { return reinterpret_cast<const T *>(raw); }
+   };
+
+   // separators: everything in children[i] is before keys[i],
+   // and nothing in children[i + 1] is
+   struct alignas(cacheLine) Inner : Node
+   {
+      Node * children[innerSlots + 1];
+      alignas(T) unsigned char raw[innerSlots * sizeof(T)];
+
+      T *       keys()       { return reinterpret_cast<T *>(raw); }
+      const T * keys() const { return reinterpret_cast<const T *>(raw); }
+   };
+
+   // the inner nodes and child slots a search went through
+   struct Path
+   {
+      Inner * nodes[maxDepth];
+      size_t  slots[maxDepth];
+      size_t  depth;
+   };
+
+   //
+   // Search within a node
+   //
+
+   size_t lowerBoundIn(const T * keys, size_t num, const T & t) const;
+   size_t upperBoundIn(const T * keys, size_t num, const T & t) const;
+   Leaf * descend(const T & t, Path * pPath) const;
+
+   //
+   // Change the tree
+   //
+
+   template <class V>
+   std::pair<iterator, bool> insertUnique(const T & t, V && value);
+   iterator splitInsert(Path & path, Leaf * pLeaf, size_t pos, T && element);
+   void rebalance(Path & path, Node * pNode, iterator * follow = nullptr, size_t numFollow = 0);
+   void mergeLeaves(Inner * pParent, size_t i);
+   void mergeInners(Inner * pParent, size_t i);
+   static void removeChild(Inner * pParent, size_t i);
+   static void relocate(T * pDest, T * pSrc, size_t num) noexcept;
+
+   //
+   // Build and free nodes
+   //
+
+   static Leaf *  newLeaf();
+   static Inner * newInner();
+   static void    freeNode(Node * p) noexcept;
+   Node * clone(const Node * pSrc, Leaf *& pPrev);
+
+   Node *   pRoot;         // null when nothing has been inserted
+   Leaf *   pFirst;        // leftmost leaf, where begin() is
+   Leaf *   pLast;         // rightmost leaf, where end() is
+   size_t   numElements;
+   Compare  compare;
+};
+
+/**************************************************
+ * BTREE SET ITERATOR
+ * A leaf and a slot within it. end() is one past
+ * the last slot of the last leaf
+ *************************************************/
+template <typename T, typename Compare>
+class btree_set <T, Compare> :: iterator
+{
+   friend class ::TestBTreeSet; // give unit tests access to the privates
+   friend class custom::btree_set<T, Compare>;
+public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
+   // constructors, destructors, and assignment operator
+   iterator() : pLeaf(nullptr), slot(0) { }
+   iterator(const iterator & rhs) = default;
+   iterator & operator = (const iterator & rhs) = default;
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const { return pLeaf == rhs.pLeaf && slot == rhs.slot; }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs); }
+
+   // dereference operator
+   const T & operator * () const { return pLeaf->keys()[slot]; }
+   const T * operator -> () const { return pLeaf->keys() + slot; }
+
+   // prefix increment: past the end of a leaf is the start of the next
+   iterator & operator ++ ()
+   {
+      if (++slot == pLeaf->count && pLeaf->pNext)
+      {
+         pLeaf = pLeaf->pNext;
+         slot = 0;
+      }
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld = *this;
+      ++(*this);
+      return itOld;
+   }
+
+   // prefix decrement
+   iterator & operator -- ()
+   {
+      if (slot == 0)
+      {
+         pLeaf = pLeaf->pPrev;
+         slot = pLeaf->count;
+      }
+      slot--;
+      return *this;
+   }
+
+   // postfix decrement
+   iterator operator -- (int postfix)
+   {
+      iterator itOld = *this;
+      --(*this);
+      return itOld;
+   }
+
+private:
+   iterator(Leaf * pLeaf, size_t slot) : pLeaf(pLeaf), slot(slot) { }
+
+   Leaf * pLeaf;
+   size_t slot;
+};
+
+/*********************************************
+ * BTREE SET :: COPY CONSTRUCTOR
+ * Copy the tree node for node, relinking the leaves
+ ********************************************/
+template <typename T, typename Compare>
+btree_set <T, Compare> :: btree_set(const btree_set & rhs) :
+   pRoot(nullptr), pFirst(nullptr), pLast(nullptr), numElements(0), compare(rhs.compare)
+{
+   if (!rhs.pRoot)
+      return;
+   Leaf * pPrev = nullptr;
+   pRoot = clone(rhs.pRoot, pPrev);
+   pLast = pPrev;
+   numElements = rhs.numElements;
+}
+
+/*********************************************
+ * BTREE SET :: ASSIGN
+ ********************************************/
+template <typename T, typename Compare>
+btree_set <T, Compare> & btree_set <T, Compare> :: operator = (const btree_set & rhs)
+{
+   if (this != &rhs)
+   {
+      btree_set copy(rhs);
+      swap(copy);
+   }
+   return *this;
+}
+
+template <typename T, typename Compare>
+btree_set <T, Compare> & btree_set <T, Compare> :: operator = (btree_set && rhs) noexcept
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+template <typename T, typename Compare>
+btree_set <T, Compare> & btree_set <T, Compare> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   insert(il);
+   return *this;
+}
+
+/*********************************************
+ * BTREE SET :: SWAP
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: swap(btree_set & rhs) noexcept
+{
+   std::swap(pRoot, rhs.pRoot);
+   std::swap(pFirst, rhs.pFirst);
+   std::swap(pLast, rhs.pLast);
+   std::swap(numElements, rhs.numElements);
+   std::swap(compare, rhs.compare);
+}
+
+/*********************************************
+ * BTREE SET :: LOWER BOUND IN
+ * The first of num sorted keys not before t. Numbers
+ * in their natural order are counted with vector
+ * compares; anything else is a binary search
+ ********************************************/
+template <typename T, typename Compare>
+size_t btree_set <T, Compare> :: lowerBoundIn(const T * keys, size_t num, const T & t) const
+{
+   if constexpr (NodeSearch::supports<T, Compare>())
+      return NodeSearch::countLess(keys, num, t);
+
+   size_t lo = 0;
+   while (num > 0)
+   {
+      size_t half = num / 2;
+      if (compare(keys[lo + half], t))
+      {
+         lo += half + 1;
+         num -= half + 1;
+      }
+      else
+         num = half;
+   }
+   return lo;
+}
+
+/*********************************************
+ * BTREE SET :: UPPER BOUND IN
+ * The first of num sorted keys after t
+ ********************************************/
+template <typename T, typename Compare>
+size_t btree_set <T, Compare> :: upperBoundIn(const T * keys, size_t num, const T & t) const
+{
+   if constexpr (NodeSearch::supports<T, Compare>())
+      return num - NodeSearch::countGreater(keys, num, t);
+
+   size_t lo = 0;
+   while (num > 0)
+   {
+      size_t half = num / 2;
+      if (!compare(t, keys[lo + half]))
+      {
+         lo += half + 1;
+         num -= half + 1;
+      }
+      else
+         num = half;
+   }
+   return lo;
+}
+
+/*********************************************
+ * BTREE SET :: DESCEND
+ * Go down to the leaf where t belongs, noting
+ * the way in pPath if asked to
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: Leaf *
+btree_set <T, Compare> :: descend(const T & t, Path * pPath) const
+{
+   Node * p = pRoot;
+   size_t depth = 0;
+   while (!p->isLeaf)
+   {
+      Inner * pInner = static_cast<Inner *>(p);
+      size_t i = upperBoundIn(pInner->keys(), pInner->count, t);
+      if (pPath)
+      {
+         pPath->nodes[depth] = pInner;
+         pPath->slots[depth] = i;
+      }
+      depth++;
+      p = pInner->children[i];
+   }
+   if (pPath)
+      pPath->depth = depth;
+   return static_cast<Leaf *>(p);
+}
+
+/*********************************************
+ * BTREE SET :: FIND
+ * The element equivalent to t, or end()
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: iterator
+btree_set <T, Compare> :: find(const T & t) const
+{
+   if (!pRoot)
+      return end();
+   Leaf * pLeaf = descend(t, nullptr);
+   size_t i = lowerBoundIn(pLeaf->keys(), pLeaf->count, t);
+   if (i == pLeaf->count || compare(t, pLeaf->keys()[i]))
+      return end();
+   return iterator(pLeaf, i);
+}
+
+/*********************************************
+ * BTREE SET :: LOWER BOUND
+ * The first element not before t. Past the end
+ * of one leaf is the start of the next
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: iterator
+btree_set <T, Compare> :: lower_bound(const T & t) const
+{
+   if (!pRoot)
+      return end();
+   Leaf * pLeaf = descend(t, nullptr);
+   size_t i = lowerBoundIn(pLeaf->keys(), pLeaf->count, t);
+   if (i == pLeaf->count && pLeaf->pNext)
+      return iterator(pLeaf->pNext, 0);
+   return iterator(pLeaf, i);
+}
+
+/*********************************************
+ * BTREE SET :: UPPER BOUND
+ * The first element after t
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: iterator
+btree_set <T, Compare> :: upper_bound(const T & t) const
+{
+   if (!pRoot)
+      return end();
+   Leaf * pLeaf = descend(t, nullptr);
+   size_t i = upperBoundIn(pLeaf->keys(), pLeaf->count, t);
+   if (i == pLeaf->count && pLeaf->pNext)
+      return iterator(pLeaf->pNext, 0);
+   return iterator(pLeaf, i);
+}
+
+/*********************************************
+ * BTREE SET :: INSERT UNIQUE
+ * Find where t goes. If it is not there yet and
+ * the leaf has room, build value in place; a full
+ * leaf takes the slow path and splits
+ ********************************************/
+template <typename T, typename Compare>
+template <class V>
+std::pair<typename btree_set <T, Compare> :: iterator, bool>
+btree_set <T, Compare> :: insertUnique(const T & t, V && value)
+{
+   if (!pRoot)
+      pRoot = pFirst = pLast = newLeaf();
+
+   Path path;
+   Leaf * pLeaf = descend(t, &path);
+   size_t pos = lowerBoundIn(pLeaf->keys(), pLeaf->count, t);
+   if (pos < pLeaf->count && !compare(t, pLeaf->keys()[pos]))
+      return std::pair<iterator, bool>(iterator(pLeaf, pos), false);
+
+   if (pLeaf->count == leafSlots)
+   {
+      iterator it = splitInsert(path, pLeaf, pos, T(std::forward<V>(value)));
+      numElements++;
+      return std::pair<iterator, bool>(it, true);
+   }
+
+   T * keys = pLeaf->keys();
+   relocate(keys + pos + 1, keys + pos, pLeaf->count - pos);
+   try
+   {
+      new (keys + pos) T(std::forward<V>(value));
+   }
+   catch (...)
+   {
+      relocate(keys + pos, keys + pos + 1, pLeaf->count - pos);
+      throw;
+   }
+   pLeaf->count++;
+   numElements++;
+   return std::pair<iterator, bool>(iterator(pLeaf, pos), true);
+}
+
+/*********************************************
+ * BTREE SET :: SPLIT INSERT
+ * Put element in a full leaf by splitting it in
+ * two, then hand the new right half up to the
+ * parent, splitting every full node on the way.
+ * Everything that can throw happens first: the new
+ * nodes and the one separator we must copy. After
+ * that it is only moves
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: iterator
+btree_set <T, Compare> :: splitInsert(Path & path, Leaf * pLeft, size_t pos, T && element)
+{
+   // how many nodes will split?
+   size_t numFull = 0;
+   while (numFull < path.depth && path.nodes[path.depth - 1 - numFull]->count == innerSlots)
+      numFull++;
+   bool growRoot = numFull == path.depth;
+
+   // allocate them all before touching the tree
+   Leaf * pRight = newLeaf();
+   Inner * spares[maxDepth + 1];
+   size_t numSpares = 0;
+   try
+   {
+      while (numSpares < numFull + (growRoot ? 1 : 0))
+         spares[numSpares++] = newInner();
+   }
+   catch (...)
+   {
+      freeNode(pRight);
+      while (numSpares > 0)
+         freeNode(spares[--numSpares]);
+      throw;
+   }
+
+   // the first key of the right leaf, copied into the parent
+   const size_t keep = (leafSlots + 1) / 2;   // left keeps this many
+   T * keys = pLeft->keys();
+   T separator(pos == keep ? element : keys[pos < keep ? keep - 1 : keep]);
+
+   // split the leaf, and put element in its half
+   iterator itResult;
+   if (pos < keep)
+   {
+      relocate(pRight->keys(), keys + keep - 1, leafSlots - keep + 1);
+      pRight->count = leafSlots - keep + 1;
+      relocate(keys + pos + 1, keys + pos, keep - 1 - pos);
+      new (keys + pos) T(std::move(element));
+      pLeft->count = keep;
+      itResult = iterator(pLeft, pos);
+   }
+   else
+   {
+      relocate(pRight->keys(), keys + keep, leafSlots - keep);
+      T * rightKeys = pRight->keys();
+      relocate(rightKeys + pos - keep + 1, rightKeys + pos - keep, leafSlots - pos);
+      new (rightKeys + pos - keep) T(std::move(element));
+      pRight->count = leafSlots - keep + 1;
+      pLeft->count = keep;
+      itResult = iterator(pRight, pos - keep);
+   }
+   pRight->pPrev = pLeft;
+   pRight->pNext = pLeft->pNext;
+   if (pLeft->pNext)
+      pLeft->pNext->pPrev = pRight;
+   else
+      pLast = pRight;
+   pLeft->pNext = pRight;
+
+   // hand (separator, pUp) to each parent in turn
+   Node * pUp = pRight;
+   for (size_t d = path.depth; d-- > 0;)
+   {
+      Inner * pInner = path.nodes[d];
+      size_t i = path.slots[d];
+      T * innerKeys = pInner->keys();
+      Node ** children = pInner->children;
+
+      // room here: this is the last stop
+      if (pInner->count < innerSlots)
+      {
+         relocate(innerKeys + i + 1, innerKeys + i, pInner->count - i);
+         new (innerKeys + i) T(std::move(separator));
+         std::memmove(children + i + 2, children + i + 1, (pInner->count - i) * sizeof(Node *));
+         children[i + 1] = pUp;
+         pInner->count++;
+         return itResult;
+      }
+
+      // full: the left keeps half, the middle key goes up, the right
+      // gets the rest. The new key and child land in whichever half
+      Inner * pNew = spares[--numSpares];
+      const size_t keepKeys = (innerSlots + 1) / 2;
+      T * newKeys = pNew->keys();
+      Node ** newChildren = pNew->children;
+      T middle(std::move(i < keepKeys ? innerKeys[keepKeys - 1] :
+                         i == keepKeys ? separator : innerKeys[keepKeys]));
+      if (i < keepKeys)
+      {
+         innerKeys[keepKeys - 1].~T();
+         relocate(newKeys, innerKeys + keepKeys, innerSlots - keepKeys);
+         std::memcpy(newChildren, children + keepKeys, (innerSlots - keepKeys + 1) * sizeof(Node *));
+         relocate(innerKeys + i + 1, innerKeys + i, keepKeys - 1 - i);
+         new (innerKeys + i) T(std::move(separator));
+         std::memmove(children + i + 2, children + i + 1, (keepKeys - 1 - i) * sizeof(Node *));
+         children[i + 1] = pUp;
+      }
+      else if (i == keepKeys)
+      {
+         relocate(newKeys, innerKeys + keepKeys, innerSlots - keepKeys);
+         newChildren[0] = pUp;
+         std::memcpy(newChildren + 1, children + keepKeys + 1, (innerSlots - keepKeys) * sizeof(Node *));
+      }
+      else
+      {
+         innerKeys[keepKeys].~T();
+         size_t at = i - keepKeys - 1;   // where the new key goes in the right
+         relocate(newKeys, innerKeys + keepKeys + 1, at);
+         new (newKeys + at) T(std::move(separator));
+         relocate(newKeys + at + 1, innerKeys + i, innerSlots - i);
+         std::memcpy(newChildren, children + keepKeys + 1, (at + 1) * sizeof(Node *));
+         newChildren[at + 1] = pUp;
+         std::memcpy(newChildren + at + 2, children + i + 1, (innerSlots - i) * sizeof(Node *));
+      }
+      separator.~T();
+      new (&separator) T(std::move(middle));
+      pInner->count = keepKeys;
+      pNew->count = innerSlots - keepKeys;
+      pUp = pNew;
+   }
+
+   // the root split too: grow a new one above it
+   Inner * pNewRoot = spares[--numSpares];
+   new (pNewRoot->keys()) T(std::move(separator));
+   pNewRoot->children[0] = pRoot;
+   pNewRoot->children[1] = pUp;
+   pNewRoot->count = 1;
+   pRoot = pNewRoot;
+   return itResult;
+}
+
+/*********************************************
+ * BTREE SET :: ERASE
+ * Take t out of its leaf, then fix any node left
+ * too empty on the way back up
+ ********************************************/
+template <typename T, typename Compare>
+size_t btree_set <T, Compare> :: erase(const T & t)
+{
+   if (!pRoot)
+      return 0;
+   Path path;
+   Leaf * pLeaf = descend(t, &path);
+   size_t pos = lowerBoundIn(pLeaf->keys(), pLeaf->count, t);
+   if (pos == pLeaf->count || compare(t, pLeaf->keys()[pos]))
+      return 0;
+
+   T * keys = pLeaf->keys();
+   keys[pos].~T();
+   relocate(keys + pos, keys + pos + 1, pLeaf->count - pos - 1);
+   pLeaf->count--;
+   numElements--;
+   rebalance(path, pLeaf);
+   return 1;
+}
+
+/*********************************************
+ * BTREE SET :: ERASE ITERATOR
+ * A range of one: the element it is on
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: iterator
+btree_set <T, Compare> :: erase(const iterator & it)
+{
+   if (it == end())
+      return end();
+   iterator itNext = it;
+   ++itNext;
+   return erase(it, itNext);
+}
+
+/*********************************************
+ * BTREE SET :: ERASE RANGE
+ * Erase from itBegin up to, but not including, the
+ * element itEnd is on, a leaf at a time: take out
+ * everything in the range that is in this leaf at
+ * once, then rebalance. The search down to the leaf
+ * only finds the path for rebalance, and no element
+ * is copied. Rebalancing moves elements between
+ * leaves, so it carries both ends of what is left
+ * of the range along with them
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: iterator
+btree_set <T, Compare> :: erase(const iterator & itBegin, const iterator & itEnd)
+{
+   iterator follow[2] = { itBegin, itEnd };   // where we are, where we stop
+   iterator & it = follow[0];
+   iterator & itStop = follow[1];
+   while (it != itStop)
+   {
+      Leaf * pLeaf = it.pLeaf;
+      T * keys = pLeaf->keys();
+      size_t from = it.slot;
+      size_t to = itStop.pLeaf == pLeaf ? itStop.slot : pLeaf->count;
+      Path path;
+      descend(keys[from], &path);
+
+      for (size_t i = from; i < to; i++)
+         keys[i].~T();
+      relocate(keys + from, keys + to, pLeaf->count - to);
+      pLeaf->count -= uint16_t(to - from);
+      numElements -= to - from;
+
+      // both ends now sit where the hole was, or on the next leaf
+      it.slot = from;
+      if (itStop.pLeaf == pLeaf)
+         itStop.slot -= to - from;
+      for (iterator & itEnd : follow)
+         if (itEnd.pLeaf == pLeaf && itEnd.slot == pLeaf->count && pLeaf->pNext)
+            itEnd = iterator(pLeaf->pNext, 0);
+      rebalance(path, pLeaf, follow, 2);
+   }
+   return it;
+}
+
+/*********************************************
+ * BTREE SET :: REBALANCE
+ * pNode just lost a key. While it has too few,
+ * borrow one from a sibling with keys to spare,
+ * or merge with a sibling and take one from the
+ * parent, which may leave that too few in turn.
+ * The numFollow iterators in follow stay on their
+ * elements as the leaf elements move
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: rebalance(Path & path, Node * pNode,
+                                         iterator * follow, size_t numFollow)
+{
+   for (size_t d = path.depth; d-- > 0; pNode = path.nodes[d])
+   {
+      Inner * pParent = path.nodes[d];
+      size_t i = path.slots[d];
+      T * parentKeys = pParent->keys();
+
+      if (pNode->isLeaf)
+      {
+         if (pNode->count >= minLeaf)
+            return;
+         Leaf * pLeaf = static_cast<Leaf *>(pNode);
+         Leaf * pLeft  = i > 0 ? static_cast<Leaf *>(pParent->children[i - 1]) : nullptr;
+         Leaf * pRight = i < pParent->count ? static_cast<Leaf *>(pParent->children[i + 1]) : nullptr;
+
+         // a range erase can leave it more than one short
+         size_t num = minLeaf - pLeaf->count;
+         if (pLeft && pLeft->count >= minLeaf + num)
+         {
+            T * keys = pLeaf->keys();
+            relocate(keys + num, keys, pLeaf->count);
+            relocate(keys, pLeft->keys() + pLeft->count - num, num);
+            pLeft->count -= uint16_t(num);
+            pLeaf->count += uint16_t(num);
+            parentKeys[i - 1] = keys[0];
+            for (size_t f = 0; f < numFollow; f++)
+               if (follow[f].pLeaf == pLeaf)
+                  follow[f].slot += num;
+            return;
+         }
+         if (pRight && pRight->count >= minLeaf + num)
+         {
+            T * rightKeys = pRight->keys();
+            relocate(pLeaf->keys() + pLeaf->count, rightKeys, num);
+            relocate(rightKeys, rightKeys + num, pRight->count - num);
+            pRight->count -= uint16_t(num);
+            for (size_t f = 0; f < numFollow; f++)
+               if (follow[f].pLeaf == pRight)
+               {
+                  if (follow[f].slot < num)
+                     follow[f] = iterator(pLeaf, pLeaf->count + follow[f].slot);
+                  else
+                     follow[f].slot -= num;
+               }
+            pLeaf->count += uint16_t(num);
+            parentKeys[i] = rightKeys[0];
+            return;
+         }
+
+         // the right of the two is emptied into the left
+         Leaf * pInto = pLeft ? pLeft : pLeaf;
+         Leaf * pFrom = pLeft ? pLeaf : pRight;
+         for (size_t f = 0; f < numFollow; f++)
+            if (follow[f].pLeaf == pFrom)
+               follow[f] = iterator(pInto, pInto->count + follow[f].slot);
+         mergeLeaves(pParent, pLeft ? i - 1 : i);
+      }
+      else
+      {
+         if (pNode->count >= minInner)
+            return;
+         Inner * pInner = static_cast<Inner *>(pNode);
+         Inner * pLeft  = i > 0 ? static_cast<Inner *>(pParent->children[i - 1]) : nullptr;
+         Inner * pRight = i < pParent->count ? static_cast<Inner *>(pParent->children[i + 1]) : nullptr;
+
+         // rotate through the parent
+         if (pLeft && pLeft->count > minInner)
+         {
+            T * keys = pInner->keys();
+            relocate(keys + 1, keys, pInner->count);
+            new (keys) T(std::move(parentKeys[i - 1]));
+            parentKeys[i - 1] = std::move(pLeft->keys()[pLeft->count - 1]);
+            pLeft->keys()[pLeft->count - 1].~T();
+            std::memmove(pInner->children + 1, pInner->children, (pInner->count + 1) * sizeof(Node *));
+            pInner->children[0] = pLeft->children[pLeft->count];
+            pLeft->count--;
+            pInner->count++;
+            return;
+         }
+         if (pRight && pRight->count > minInner)
+         {
+            T * rightKeys = pRight->keys();
+            new (pInner->keys() + pInner->count) T(std::move(parentKeys[i]));
+            parentKeys[i] = std::move(rightKeys[0]);
+            rightKeys[0].~T();
+            relocate(rightKeys, rightKeys + 1, pRight->count - 1);
+            pInner->children[pInner->count + 1] = pRight->children[0];
+            std::memmove(pRight->children, pRight->children + 1, pRight->count * sizeof(Node *));
+            pRight->count--;
+            pInner->count++;
+            return;
+         }
+         mergeInners(pParent, pLeft ? i - 1 : i);
+      }
+   }
+
+   // the root ran out of separators: its only child takes over
+   if (!pRoot->isLeaf && pRoot->count == 0)
+   {
+      Inner * pOld = static_cast<Inner *>(pRoot);
+      pRoot = pOld->children[0];
+      pOld->count = 0;
+      ::operator delete(pOld, std::align_val_t(alignof(Inner)));
+   }
+}
+
+/*********************************************
+ * BTREE SET :: MERGE LEAVES
+ * Move children[i + 1] of pParent onto the end of
+ * children[i], and drop it and its separator
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: mergeLeaves(Inner * pParent, size_t i)
+{
+   Leaf * pLeft  = static_cast<Leaf *>(pParent->children[i]);
+   Leaf * pRight = static_cast<Leaf *>(pParent->children[i + 1]);
+   relocate(pLeft->keys() + pLeft->count, pRight->keys(), pRight->count);
+   pLeft->count += pRight->count;
+   pRight->count = 0;
+
+   pLeft->pNext = pRight->pNext;
+   if (pRight->pNext)
+      pRight->pNext->pPrev = pLeft;
+   else
+      pLast = pLeft;
+
+   removeChild(pParent, i);
+   freeNode(pRight);
+}
+
+/*********************************************
+ * BTREE SET :: MERGE INNERS
+ * Pull separator i down between children[i] and
+ * children[i + 1], and make them one node
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: mergeInners(Inner * pParent, size_t i)
+{
+   Inner * pLeft  = static_cast<Inner *>(pParent->children[i]);
+   Inner * pRight = static_cast<Inner *>(pParent->children[i + 1]);
+   T * leftKeys = pLeft->keys();
+   new (leftKeys + pLeft->count) T(std::move(pParent->keys()[i]));
+   relocate(leftKeys + pLeft->count + 1, pRight->keys(), pRight->count);
+   std::memcpy(pLeft->children + pLeft->count + 1, pRight->children,
+               (pRight->count + 1) * sizeof(Node *));
+   pLeft->count += pRight->count + 1;
+   pRight->count = 0;
+
+   removeChild(pParent, i);
+   ::operator delete(pRight, std::align_val_t(alignof(Inner)));
+}
+
+/*********************************************
+ * BTREE SET :: REMOVE CHILD
+ * Drop separator i and the child after it
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: removeChild(Inner * pParent, size_t i)
+{
+   T * keys = pParent->keys();
+   keys[i].~T();
+   relocate(keys + i, keys + i + 1, pParent->count - i - 1);
+   std::memmove(pParent->children + i + 1, pParent->children + i + 2,
+                (pParent->count - i - 1) * sizeof(Node *));
+   pParent->count--;
+}
+
+/*********************************************
+ * BTREE SET :: RELOCATE
+ * Move num keys from pSrc to the raw memory at
+ * pDest, leaving pSrc raw. The two may overlap.
+ * Plain data moves as bytes
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: relocate(T * pDest, T * pSrc, size_t num) noexcept
+{
+   if (num == 0 || pDest == pSrc)
+      return;
+   if constexpr (std::is_trivially_copyable<T>::value)
+      std::memmove(static_cast<void *>(pDest), static_cast<const void *>(pSrc), num * sizeof(T));
+   else if (pDest < pSrc)
+      for (size_t i = 0; i < num; i++)
+      {
+         new (pDest + i) T(std::move(pSrc[i]));
+         pSrc[i].~T();
+      }
+   else
+      for (size_t i = num; i-- > 0;)
+      {
+         new (pDest + i) T(std::move(pSrc[i]));
+         pSrc[i].~T();
+      }
+}
+
+/*********************************************
+ * BTREE SET :: NEW LEAF / NEW INNER
+ * Empty nodes, aligned to a cache line
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: Leaf * btree_set <T, Compare> :: newLeaf()
+{
+   Leaf * p = static_cast<Leaf *>(::operator new(sizeof(Leaf), std::align_val_t(alignof(Leaf))));
+   p->count = 0;
+   p->isLeaf = true;
+   p->pPrev = p->pNext = nullptr;
+   return p;
+}
+
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: Inner * btree_set <T, Compare> :: newInner()
+{
+   Inner * p = static_cast<Inner *>(::operator new(sizeof(Inner), std::align_val_t(alignof(Inner))));
+   p->count = 0;
+   p->isLeaf = false;
+   p->children[0] = nullptr;
+   return p;
+}
+
+/*********************************************
+ * BTREE SET :: FREE NODE
+ * Destroy a node's keys and everything under it
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: freeNode(Node * p) noexcept
+{
+   if (!p)
+      return;
+   if (p->isLeaf)
+   {
+      Leaf * pLeaf = static_cast<Leaf *>(p);
+      for (size_t i = 0; i < pLeaf->count; i++)
+         pLeaf->keys()[i].~T();
+      ::operator delete(pLeaf, std::align_val_t(alignof(Leaf)));
+   }
+   else
+   {
+      Inner * pInner = static_cast<Inner *>(p);
+      for (size_t i = 0; i < pInner->count; i++)
+         pInner->keys()[i].~T();
+      for (size_t i = 0; i <= pInner->count; i++)
+         freeNode(pInner->children[i]);
+      ::operator delete(pInner, std::align_val_t(alignof(Inner)));
+   }
+}
+
+/*********************************************
+ * BTREE SET :: CLONE
+ * Copy the subtree at pSrc. pPrev is the last leaf
+ * copied so far, so the new leaves link up in order.
+ * If a copy throws, what was built is freed
+ ********************************************/
+template <typename T, typename Compare>
+typename btree_set <T, Compare> :: Node *
+btree_set <T, Compare> :: clone(const Node * pSrc, Leaf *& pPrev)
+{
+   if (pSrc->isLeaf)
+   {
+      const Leaf * pFrom = static_cast<const Leaf *>(pSrc);
+      Leaf * pTo = newLeaf();
+      try
+      {
+         for (; pTo->count < pFrom->count; pTo->count++)
+            new (pTo->keys() + pTo->count) T(pFrom->keys()[pTo->count]);
+      }
+      catch (...)
+      {
+         freeNode(pTo);
+         throw;
+      }
+      pTo->pPrev = pPrev;
+      if (pPrev)
+         pPrev->pNext = pTo;
+      else
+         pFirst = pTo;
+      pPrev = pTo;
+      return pTo;
+   }
+
+   const Inner * pFrom = static_cast<const Inner *>(pSrc);
+   Inner * pTo = newInner();
+   try
+   {
+      pTo->children[0] = clone(pFrom->children[0], pPrev);
+      for (size_t i = 0; i < pFrom->count; i++)
+      {
+         new (pTo->keys() + i) T(pFrom->keys()[i]);
+         pTo->children[i + 1] = nullptr;
+         pTo->count++;
+         pTo->children[i + 1] = clone(pFrom->children[i + 1], pPrev);
+      }
+   }
+   catch (...)
+   {
+      freeNode(pTo);
+      throw;
+   }
+   return pTo;
+}
+
+/*********************************************
+ * BTREE SET :: CLEAR
+ * Free every node
+ ********************************************/
+template <typename T, typename Compare>
+void btree_set <T, Compare> :: clear() noexcept
+{
+   freeNode(pRoot);
+   pRoot = nullptr;
+   pFirst = pLast = nullptr;
+   numElements = 0;
+}
+
+} // namespace custom
@@ -0,0 +1,276 @@
+/***********************************************************************
+ * Header:
+ *    CONCURRENT SET
+ * Summary:
+ *    A set that many threads can use at the same time
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        concurrent_set      : A set that is safe to share between threads
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint64_t
+#include <functional>   // for std::less and std::hash
+#include <memory>       // for std::unique_ptr
+#include <mutex>        // for std::unique_lock
+#include <shared_mutex> // for std::shared_mutex and std::shared_lock
+#include <thread>       // for std::thread::hardware_concurrency
+#include <utility>      // for std::move
+#include "set.h"
+
+class TestConcurrentSet;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * CONCURRENT SET
+ * A set split into stripes by the hash of each element. Every
+ * stripe is an ordinary set behind its own reader/writer lock, on
+ * its own cache line. Readers of a stripe share its lock, so they
+ * never wait on each other; a writer only locks the one stripe its
+ * element lives in, so writers to different stripes never wait
+ * either. With many more stripes than threads, two threads rarely
+ * meet at all.
+ *
+ * Equivalent elements must hash the same. There are no iterators,
+ * since an element could be erased out from under one; snapshot()
+ * gives an ordered copy of everything instead.
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>, typename Hash = std::hash<T>>
+class concurrent_set
+{
+   friend class ::TestConcurrentSet; // give unit tests access to the privates
+public:
+
+   //
+   // Construct
+   //
+
+   concurrent_set() : concurrent_set(defaultStripes()) { }
+   explicit concurrent_set(size_t numStripes);
+   concurrent_set(const concurrent_set & rhs) = delete;
+   concurrent_set & operator = (const concurrent_set & rhs) = delete;
+   ~concurrent_set() { }
+
+   //
+   // Access
+   //
+
+   bool   contains(const T & t) const;
+   size_t count   (const T & t) const { return contains(t) ? 1 : 0; }
+   template <class Visit>
+   bool   visit(const T & t, Visit visitor) const;
+   set <T, Compare> snapshot() const;
+
+   //
+   // Insert
+   //
+
+   bool insert(const T &  t);
+   bool insert(      T && t);
+   template <class ... Args>
+   bool emplace(Args && ... args) { return insert(T(std::forward<Args>(args)...)); }
+
+   //
+   // Remove
+   //
+
+   size_t erase(const T & t);
+   void   clear();
+
+   //
+   // Status: exact only when no one else is writing
+   //
+
+   size_t size()  const;
+   bool   empty() const { return size() == 0; }
+   size_t stripes() const noexcept { return numStripes; }
+
+private:
+
+   // one lock and the elements it guards, alone on a cache line
+   // so that locking one stripe does not slow down its neighbors
+   struct alignas(64) Stripe
+   {
+      mutable std::shared_mutex lock;
+      set <T, Compare> elements;
+   };
+
+   Stripe & stripeOf(const T & t) const;
+   static size_t defaultStripes();
+
+   std::unique_ptr<Stripe[]> pStripes;   // every stripe
+   size_t   numStripes;                  // always a power of two
+   unsigned shift;                       // top bits of the mixed hash pick the stripe
+   Hash     hash;                        // spreads elements across stripes
+};
+
+/*********************************************
+ * CONCURRENT SET :: CONSTRUCTOR
+ * Start with at least numStripes empty stripes
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+concurrent_set <T, Compare, Hash> :: concurrent_set(size_t numStripes) :
+   numStripes(1), shift(64), hash()
+{
+   while (this->numStripes < numStripes)
+   {
+      this->numStripes *= 2;
+      shift--;
+   }
+   pStripes.reset(new Stripe[this->numStripes]);
+}
+
+/*********************************************
+ * CONCURRENT SET :: DEFAULT STRIPES
+ * Eight stripes for every core, so that two
+ * threads rarely want the same one
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+size_t concurrent_set <T, Compare, Hash> :: defaultStripes()
+{
+   size_t numCores = std::thread::hardware_concurrency();
+   return 8 * (numCores == 0 ? 1 : numCores);
+}
+
+/*********************************************
+ * CONCURRENT SET :: STRIPE OF
+ * Which stripe does t live in? The hash is mixed
+ * first, since std::hash of an integer is itself
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+typename concurrent_set <T, Compare, Hash> :: Stripe &
+concurrent_set <T, Compare, Hash> :: stripeOf(const T & t) const
+{
+   uint64_t mixed = static_cast<uint64_t>(hash(t)) * 0x9E3779B97F4A7C15ull;
+   return pStripes[shift == 64 ? 0 : static_cast<size_t>(mixed >> shift)];
+}
+
+/*********************************************
+ * CONCURRENT SET :: CONTAINS
+ * Is t in the set? Shares the lock of its stripe
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+bool concurrent_set <T, Compare, Hash> :: contains(const T & t) const
+{
+   Stripe & stripe = stripeOf(t);
+   std::shared_lock<std::shared_mutex> guard(stripe.lock);
+   return stripe.elements.contains(t);
+}
+
+/*********************************************
+ * CONCURRENT SET :: VISIT
+ * Hand the element equivalent to t to visitor, if
+ * there is one, while no one can erase it
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+template <class Visit>
+bool concurrent_set <T, Compare, Hash> :: visit(const T & t, Visit visitor) const
+{
+   Stripe & stripe = stripeOf(t);
+   std::shared_lock<std::shared_mutex> guard(stripe.lock);
+   auto it = stripe.elements.find(t);
+   if (it == stripe.elements.end())
+      return false;
+   visitor(*it);
+   return true;
+}
+
+/*********************************************
+ * CONCURRENT SET :: SNAPSHOT
+ * Copy every stripe, one at a time, into one
+ * ordinary set. Each stripe is copied as it was
+ * at some moment, but the stripes are not all
+ * copied at the same moment
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+set <T, Compare> concurrent_set <T, Compare, Hash> :: snapshot() const
+{
+   set <T, Compare> all;
+   for (size_t i = 0; i < numStripes; i++)
+   {
+      set <T, Compare> copy;
+      {
+         std::shared_lock<std::shared_mutex> guard(pStripes[i].lock);
+         copy = pStripes[i].elements;
+      }
+      all.merge(copy);
+   }
+   return all;
+}
+
+/*********************************************
+ * CONCURRENT SET :: INSERT
+ * Add t if it is not already there. Only its
+ * own stripe is locked
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+bool concurrent_set <T, Compare, Hash> :: insert(const T & t)
+{
+   Stripe & stripe = stripeOf(t);
+   std::unique_lock<std::shared_mutex> guard(stripe.lock);
+   return stripe.elements.insert(t).second;
+}
+
+template <typename T, typename Compare, typename Hash>
+bool concurrent_set <T, Compare, Hash> :: insert(T && t)
+{
+   Stripe & stripe = stripeOf(t);
+   std::unique_lock<std::shared_mutex> guard(stripe.lock);
+   return stripe.elements.insert(std::move(t)).second;
+}
+
+/*********************************************
+ * CONCURRENT SET :: ERASE
+ * Remove t if it is there
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+size_t concurrent_set <T, Compare, Hash> :: erase(const T & t)
+{
+   Stripe & stripe = stripeOf(t);
+   std::unique_lock<std::shared_mutex> guard(stripe.lock);
+   return stripe.elements.erase(t);
+}
+
+/*********************************************
+ * CONCURRENT SET :: CLEAR
+ * Empty every stripe, one at a time
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+void concurrent_set <T, Compare, Hash> :: clear()
+{
+   for (size_t i = 0; i < numStripes; i++)
+   {
+      std::unique_lock<std::shared_mutex> guard(pStripes[i].lock);
+      pStripes[i].elements.clear();
+   }
+}
+
+/*********************************************
+ * CONCURRENT SET :: SIZE
+ * Add up the stripes, one at a time
+ ********************************************/
+template <typename T, typename Compare, typename Hash>
+size_t concurrent_set <T, Compare, Hash> :: size() const
+{
+   size_t num = 0;
+   for (size_t i = 0; i < numStripes; i++)
+   {
+      std::shared_lock<std::shared_mutex> guard(pStripes[i].lock);
+      num += pStripes[i].elements.size();
+   }
+   return num;
+}
+
+} // namespace custom
@@ -0,0 +1,697 @@
+/***********************************************************************
+ * Header:
+ *    CONCURRENT SKIPLIST SET
+ * Summary:
+ *    An ordered set that many threads can use without any locks
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        concurrent_skiplist_set           : A lock-free ordered set
+ *        concurrent_skiplist_set::iterator : Walks the elements in order
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>       // for std::atomic
+#include <cstddef>      // for size_t and ptrdiff_t
+#include <cstdint>      // for uintptr_t and uint64_t
+#include <functional>   // for std::less
+#include <new>          // for placement new
+#include <utility>      // for std::pair and std::forward
+#include "epoch.h"
+
+class TestConcurrentSkiplistSet;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * CONCURRENT SKIPLIST SET
+ * A skip list whose links are only ever changed by compare-and-swap.
+ * Each node sits on a random number of levels; every level is a
+ * sorted linked list, and each one up skips about half of the one
+ * below it, so a search takes about log n steps.
+ *
+ * To erase a node, its links are marked first, from the top level
+ * down. Marking the bottom link is what takes the element out of the
+ * set; after that, any search that passes the node unlinks it. The
+ * low bit of each link is the mark, so that marking a node and
+ * linking past it can never both succeed.
+ *
+ * A node is handed to the Epoch once both the thread that put it in
+ * and the thread that took it out are done with it, and freed once
+ * no reader can still be looking at it. Iterators hold an
+ * Epoch::Guard, so the node they are on is never freed under them;
+ * they see the elements in order, but not all at the same moment.
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>>
+class concurrent_skiplist_set
+{
+   friend class ::TestConcurrentSkiplistSet; // give unit tests access to the privates
+
+   struct Node;
+
+public:
+
+   //
+   // Construct
+   //
+
+   concurrent_skiplist_set() : concurrent_skiplist_set(Compare()) { }
+   explicit concurrent_skiplist_set(const Compare & compare);
+   concurrent_skiplist_set(const concurrent_skiplist_set & rhs) = delete;
+   concurrent_skiplist_set & operator = (const concurrent_skiplist_set & rhs) = delete;
+   ~concurrent_skiplist_set();
+
+   //
+   // Iterator: use it on the thread that made it
+   //
+
+   class iterator;
+   iterator begin() const;
+   iterator end()   const { return iterator(); }
+
+   //
+   // Access
+   //
+
+   iterator find       (const T & t) const;
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const;
+   std::pair<iterator, iterator> equal_range(const T & t) const;
+   bool     contains   (const T & t) const;
+   size_t   count      (const T & t) const { return contains(t) ? 1 : 0; }
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t);
+   std::pair<iterator, bool> insert(      T && t);
+   template <class ... Args>
+   std::pair<iterator, bool> emplace(Args && ... args);
+
+   //
+   // Remove
+   //
+
+   size_t   erase(const T & t);
+   iterator erase(const iterator & it);
+   void     clear();
+
+   //
+   // Status: exact only when no one else is writing
+   //
+
+   size_t size()  const noexcept;
+   bool   empty() const noexcept { return size() == 0; }
+
+private:
+
+   static const int maxHeight = 32;   // enough for 2^32 elements
+
+   // one element and its links on each level it sits on.
+   // Only the first `height` links are allocated
+   struct Node
+   {
+      union { T data; };              // the head has none
+      int height;                     // how many levels this node is on
+      std::atomic<int> numOwners;     // inserter and eraser, until they are done
+      std::atomic<uintptr_t> next[1]; // marked pointer to the next node on each level
+
+      ~Node() { }
+   };
+
+   // links carry the mark in their low bit
+   static Node * pointer(uintptr_t link) { return reinterpret_cast<Node *>(link & ~uintptr_t(1)); }
+   static bool   marked (uintptr_t link) { return (link & 1) != 0; }
+   static uintptr_t linkTo(Node * p)     { return reinterpret_cast<uintptr_t>(p); }
+
+   template <class ... Args>
+   static Node * create(int height, Args && ... args);
+   static Node * createHead();
+   static void   destroy(void * p);
+   static void   release(Node * p);
+   static int    randomHeight();
+
+   bool   search(const T & t, Node * preds[], Node * succs[]) const;
+   std::pair<iterator, bool> link(Node * pNew, Node * preds[], Node * succs[], bool searched);
+   bool   mark(Node * pVictim);
+   Node * peek(const T & t) const;
+
+   Node *              pHead;        // on every level, holds no element
+   std::atomic<size_t> numElements;  // only counts finished operations
+   Compare             compare;      // orders the elements
+};
+
+/**************************************************
+ * CONCURRENT SKIPLIST SET ITERATOR
+ * Walks the bottom level, stepping over nodes that
+ * have been erased. Holds a guard so the node it is
+ * on stays allocated
+ *************************************************/
+template <typename T, typename Compare>
+class concurrent_skiplist_set <T, Compare> :: iterator
+{
+   friend class ::TestConcurrentSkiplistSet; // give unit tests access to the privates
+   friend class custom::concurrent_skiplist_set<T, Compare>;
+public:
+   iterator() : p(nullptr) { }
+   iterator(const iterator & rhs) = default;
+   iterator & operator = (const iterator & rhs) = default;
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   const T & operator * () const { return p->data; }
+   const T * operator -> () const { return &p->data; }
+
+   // prefix increment
+   iterator & operator ++ ()
+   {
+      p = live(pointer(p->next[0].load()));
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator itReturn = *this;
+      ++(*this);
+      return itReturn;
+   }
+
+private:
+   explicit iterator(Node * p) : p(p) { }
+
+   // the first node from p on that has not been erased
+   static Node * live(Node * p)
+   {
+      while (p && marked(p->next[0].load()))
+         p = pointer(p->next[0].load());
+      return p;
+   }
+
+   Epoch::Guard guard;
+   Node * p;
+};
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: CONSTRUCTOR
+ * Start with nothing but the head
+ ********************************************/
+template <typename T, typename Compare>
+concurrent_skiplist_set <T, Compare> :: concurrent_skiplist_set(const Compare & compare) :
+   pHead(createHead()), numElements(0), compare(compare)
+{
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: DESTRUCTOR
+ * No other thread may be using the set. Every node
+ * still on the bottom level is freed now; the
+ * erased ones were already given to the Epoch
+ ********************************************/
+template <typename T, typename Compare>
+concurrent_skiplist_set <T, Compare> :: ~concurrent_skiplist_set()
+{
+   Node * p = pointer(pHead->next[0].load());
+   while (p)
+   {
+      Node * pNext = pointer(p->next[0].load());
+      destroy(p);
+      p = pNext;
+   }
+   ::operator delete(pHead);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: CREATE
+ * Allocate a node with room for height links
+ ********************************************/
+template <typename T, typename Compare>
+template <class ... Args>
+typename concurrent_skiplist_set <T, Compare> :: Node *
+concurrent_skiplist_set <T, Compare> :: create(int height, Args && ... args)
+{
+   void * pMemory = ::operator new(sizeof(Node) + (height - 1) * sizeof(std::atomic<uintptr_t>));
+   Node * p = static_cast<Node *>(pMemory);
+   try
+   {
+      new (&p->data) T(std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      ::operator delete(pMemory);
+      throw;
+   }
+   p->height = height;
+   new (&p->numOwners) std::atomic<int>(2);
+   for (int i = 0; i < height; i++)
+      new (&p->next[i]) std::atomic<uintptr_t>(0);
+   return p;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: CREATE HEAD
+ * The head is on every level and has no element
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: Node *
+concurrent_skiplist_set <T, Compare> :: createHead()
+{
+   void * pMemory = ::operator new(sizeof(Node) + (maxHeight - 1) * sizeof(std::atomic<uintptr_t>));
+   Node * p = static_cast<Node *>(pMemory);
+   p->height = maxHeight;
+   new (&p->numOwners) std::atomic<int>(1);
+   for (int i = 0; i < maxHeight; i++)
+      new (&p->next[i]) std::atomic<uintptr_t>(0);
+   return p;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: DESTROY
+ * Free a node and its element. Takes void * so
+ * the Epoch can call it
+ ********************************************/
+template <typename T, typename Compare>
+void concurrent_skiplist_set <T, Compare> :: destroy(void * pMemory)
+{
+   Node * p = static_cast<Node *>(pMemory);
+   p->data.~T();
+   ::operator delete(pMemory);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: RELEASE
+ * The inserter or the eraser is done with p; the
+ * second one to finish retires it
+ ********************************************/
+template <typename T, typename Compare>
+void concurrent_skiplist_set <T, Compare> :: release(Node * p)
+{
+   if (p->numOwners.fetch_sub(1) == 1)
+      Epoch::retire(p, &destroy);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: RANDOM HEIGHT
+ * One level, plus one more with a chance of a
+ * half, and so on
+ ********************************************/
+template <typename T, typename Compare>
+int concurrent_skiplist_set <T, Compare> :: randomHeight()
+{
+   static thread_local uint64_t state =
+      0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&state);
+   state ^= state << 13;
+   state ^= state >> 7;
+   state ^= state << 17;
+   int height = 1;
+   for (uint64_t bits = state; (bits & 1) && height < maxHeight; bits >>= 1)
+      height++;
+   return height;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: SEARCH
+ * On every level, find the last node before t and
+ * the one after it, unlinking any erased nodes on
+ * the way. Returns whether the bottom one is t.
+ * The caller must hold a guard
+ ********************************************/
+template <typename T, typename Compare>
+bool concurrent_skiplist_set <T, Compare> :: search(const T & t,
+                                                    Node * preds[], Node * succs[]) const
+{
+retry:
+   Node * pPred = pHead;
+   for (int level = maxHeight - 1; level >= 0; level--)
+   {
+      Node * pCurr = pointer(pPred->next[level].load());
+      while (pCurr)
+      {
+         uintptr_t succ = pCurr->next[level].load();
+
+         // unlink erased nodes, starting over if pPred was erased too
+         while (marked(succ))
+         {
+            uintptr_t expected = linkTo(pCurr);
+            if (!pPred->next[level].compare_exchange_strong(expected, succ & ~uintptr_t(1)))
+               goto retry;
+            pCurr = pointer(succ);
+            if (!pCurr)
+               break;
+            succ = pCurr->next[level].load();
+         }
+
+         if (!pCurr || !compare(pCurr->data, t))
+            break;
+         pPred = pCurr;
+         pCurr = pointer(succ);
+      }
+      preds[level] = pPred;
+      succs[level] = pCurr;
+   }
+   return succs[0] && !compare(t, succs[0]->data);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: PEEK
+ * The first node not before t that has not been
+ * erased, without changing any links. The caller
+ * must hold a guard
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: Node *
+concurrent_skiplist_set <T, Compare> :: peek(const T & t) const
+{
+   Node * pPred = pHead;
+   Node * pCurr = nullptr;
+   for (int level = maxHeight - 1; level >= 0; level--)
+   {
+      pCurr = pointer(pPred->next[level].load());
+      while (pCurr)
+      {
+         uintptr_t succ = pCurr->next[level].load();
+         if (marked(succ))
+            pCurr = pointer(succ);
+         else if (compare(pCurr->data, t))
+         {
+            pPred = pCurr;
+            pCurr = pointer(succ);
+         }
+         else
+            break;
+      }
+   }
+   return pCurr;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: BEGIN
+ * The first element that has not been erased
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: iterator
+concurrent_skiplist_set <T, Compare> :: begin() const
+{
+   iterator it;
+   it.p = iterator::live(pointer(pHead->next[0].load()));
+   return it;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: FIND
+ * The element equivalent to t, or end()
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: iterator
+concurrent_skiplist_set <T, Compare> :: find(const T & t) const
+{
+   iterator it;
+   Node * p = peek(t);
+   if (p && !compare(t, p->data))
+      it.p = p;
+   return it;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: LOWER BOUND
+ * The first element not before t, or end()
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: iterator
+concurrent_skiplist_set <T, Compare> :: lower_bound(const T & t) const
+{
+   iterator it;
+   it.p = peek(t);
+   return it;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: UPPER BOUND
+ * The first element after t, or end()
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: iterator
+concurrent_skiplist_set <T, Compare> :: upper_bound(const T & t) const
+{
+   iterator it = lower_bound(t);
+   if (it.p && !compare(t, it.p->data))
+      ++it;
+   return it;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: EQUAL RANGE
+ * The elements equivalent to t: none or one
+ ********************************************/
+template <typename T, typename Compare>
+std::pair<typename concurrent_skiplist_set <T, Compare> :: iterator,
+          typename concurrent_skiplist_set <T, Compare> :: iterator>
+concurrent_skiplist_set <T, Compare> :: equal_range(const T & t) const
+{
+   iterator itFirst = lower_bound(t);
+   iterator itLast = itFirst;
+   if (itLast.p && !compare(t, itLast.p->data))
+      ++itLast;
+   return std::pair<iterator, iterator>(itFirst, itLast);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: CONTAINS
+ * Is t in the set? Never writes to shared memory
+ * beyond announcing this thread's epoch
+ ********************************************/
+template <typename T, typename Compare>
+bool concurrent_skiplist_set <T, Compare> :: contains(const T & t) const
+{
+   Epoch::Guard guard;
+   Node * p = peek(t);
+   return p && !compare(t, p->data);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: INSERT
+ * Look before building a node: a duplicate then
+ * costs no allocation, and a new element is only
+ * searched for once
+ ********************************************/
+template <typename T, typename Compare>
+std::pair<typename concurrent_skiplist_set <T, Compare> :: iterator, bool>
+concurrent_skiplist_set <T, Compare> :: insert(const T & t)
+{
+   Epoch::Guard guard;
+   Node * preds[maxHeight];
+   Node * succs[maxHeight];
+   if (search(t, preds, succs))
+      return std::pair<iterator, bool>(iterator(succs[0]), false);
+   return link(create(randomHeight(), t), preds, succs, true /*searched*/);
+}
+
+template <typename T, typename Compare>
+std::pair<typename concurrent_skiplist_set <T, Compare> :: iterator, bool>
+concurrent_skiplist_set <T, Compare> :: insert(T && t)
+{
+   Epoch::Guard guard;
+   Node * preds[maxHeight];
+   Node * succs[maxHeight];
+   if (search(t, preds, succs))
+      return std::pair<iterator, bool>(iterator(succs[0]), false);
+   return link(create(randomHeight(), std::move(t)), preds, succs, true /*searched*/);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: EMPLACE
+ * Build the element first, since we need it to
+ * know where it goes
+ ********************************************/
+template <typename T, typename Compare>
+template <class ... Args>
+std::pair<typename concurrent_skiplist_set <T, Compare> :: iterator, bool>
+concurrent_skiplist_set <T, Compare> :: emplace(Args && ... args)
+{
+   Epoch::Guard guard;
+   Node * preds[maxHeight];
+   Node * succs[maxHeight];
+   return link(create(randomHeight(), std::forward<Args>(args)...), preds, succs, false /*searched*/);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: LINK
+ * Link pNew into the bottom level, which puts its
+ * element in the set, then into the levels above.
+ * If it is erased while the upper levels are still
+ * being linked, stop, and make sure nothing we
+ * linked is left behind. If preds and succs are
+ * already searched, the first search is skipped.
+ * The caller must hold a guard
+ ********************************************/
+template <typename T, typename Compare>
+std::pair<typename concurrent_skiplist_set <T, Compare> :: iterator, bool>
+concurrent_skiplist_set <T, Compare> :: link(Node * pNew, Node * preds[], Node * succs[],
+                                             bool searched)
+{
+   const T & t = pNew->data;
+
+   // the bottom level: after this, t is in the set
+   while (true)
+   {
+      if (!searched && search(t, preds, succs))
+      {
+         destroy(pNew);
+         return std::pair<iterator, bool>(iterator(succs[0]), false);
+      }
+      searched = false;
+      for (int level = 0; level < pNew->height; level++)
+         pNew->next[level].store(linkTo(succs[level]), std::memory_order_relaxed);
+
+      uintptr_t expected = linkTo(succs[0]);
+      if (preds[0]->next[0].compare_exchange_strong(expected, linkTo(pNew)))
+         break;
+   }
+   numElements++;
+
+   // the levels above, for as long as no one erases it
+   for (int level = 1; level < pNew->height; level++)
+      while (true)
+      {
+         uintptr_t next = pNew->next[level].load();
+         if (marked(next))
+            goto linked;
+         if (pointer(next) != succs[level] &&
+             !pNew->next[level].compare_exchange_strong(next, linkTo(succs[level])))
+            goto linked;
+
+         uintptr_t expected = linkTo(succs[level]);
+         if (preds[level]->next[level].compare_exchange_strong(expected, linkTo(pNew)))
+            break;
+         if (!search(t, preds, succs) || succs[0] != pNew)
+            goto linked;
+      }
+linked:
+
+   // erased already? make sure no level still leads to it
+   if (marked(pNew->next[0].load()))
+      search(t, preds, succs);
+   iterator it(pNew);
+   release(pNew);
+   return std::pair<iterator, bool>(it, true);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: MARK
+ * Mark every link of pVictim from the top down.
+ * Whoever marks the bottom link erased it, and
+ * gets true back. The caller must hold a guard
+ ********************************************/
+template <typename T, typename Compare>
+bool concurrent_skiplist_set <T, Compare> :: mark(Node * pVictim)
+{
+   for (int level = pVictim->height - 1; level >= 1; level--)
+   {
+      uintptr_t next = pVictim->next[level].load();
+      while (!marked(next))
+         pVictim->next[level].compare_exchange_weak(next, next | 1);
+   }
+
+   uintptr_t next = pVictim->next[0].load();
+   do
+      if (marked(next))
+         return false;   // someone else erased it first
+   while (!pVictim->next[0].compare_exchange_weak(next, next | 1));
+   numElements--;
+   return true;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: ERASE
+ * Mark t's node, then unlink it from the nodes
+ * the search found before it; if any level has
+ * changed since, or was never linked, search
+ * again instead
+ ********************************************/
+template <typename T, typename Compare>
+size_t concurrent_skiplist_set <T, Compare> :: erase(const T & t)
+{
+   Epoch::Guard guard;
+   Node * preds[maxHeight];
+   Node * succs[maxHeight];
+   if (!search(t, preds, succs))
+      return 0;
+   Node * pVictim = succs[0];
+   if (!mark(pVictim))
+      return 0;
+
+   bool unlinked = true;
+   for (int level = pVictim->height - 1; level >= 0 && unlinked; level--)
+   {
+      uintptr_t expected = linkTo(pVictim);
+      unlinked = succs[level] == pVictim &&
+         preds[level]->next[level].compare_exchange_strong(
+            expected, pVictim->next[level].load() & ~uintptr_t(1));
+   }
+   if (!unlinked)
+      search(t, preds, succs);
+   release(pVictim);
+   return 1;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: ERASE
+ * Erase the very node it is on, not just one
+ * equivalent to it, and return the next element.
+ * If another thread erased it first, this does
+ * nothing. Its guard keeps the node readable
+ ********************************************/
+template <typename T, typename Compare>
+typename concurrent_skiplist_set <T, Compare> :: iterator
+concurrent_skiplist_set <T, Compare> :: erase(const iterator & it)
+{
+   Node * pVictim = it.p;
+   iterator itNext = it;
+   ++itNext;
+   if (mark(pVictim))
+   {
+      Node * preds[maxHeight];
+      Node * succs[maxHeight];
+      search(pVictim->data, preds, succs);   // unlinks it on the way
+      release(pVictim);
+   }
+   return itNext;
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: CLEAR
+ * Erase the elements one at a time. Elements
+ * inserted meanwhile may survive
+ ********************************************/
+template <typename T, typename Compare>
+void concurrent_skiplist_set <T, Compare> :: clear()
+{
+   Epoch::Guard guard;
+   for (Node * p = iterator::live(pointer(pHead->next[0].load())); p;
+        p = iterator::live(pointer(p->next[0].load())))
+      erase(p->data);
+}
+
+/*********************************************
+ * CONCURRENT SKIPLIST SET :: SIZE
+ * How many inserts have finished, less how many
+ * erases have
+ ********************************************/
+template <typename T, typename Compare>
+size_t concurrent_skiplist_set <T, Compare> :: size() const noexcept
+{
+   return numElements.load();
+}
+
+} // namespace custom
@@ -0,0 +1,293 @@
+/***********************************************************************
+ * Header:
+ *    EPOCH
+ * Summary:
+ *    Epoch-based reclamation for lock-free containers
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        Epoch               : Frees memory once no thread can still see it
+ *        Epoch::Guard        : Keeps what the current thread sees alive
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>     // for std::atomic
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t
+#include <mutex>      // for std::mutex
+#include <vector>     // for std::vector
+
+class TestEpoch;      // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * EPOCH
+ * A node unlinked from a lock-free structure may still be in the
+ * hands of a thread that found it a moment ago, so it cannot be
+ * freed right away. Instead it is retired, stamped with the global
+ * epoch. Every thread reading the structure holds a Guard, which
+ * announces the epoch it started in. The epoch only moves forward
+ * once every guarded thread has caught up with it, so once it has
+ * moved twice past a retired node, no thread can still see it.
+ *****************************************************************/
+class Epoch
+{
+   friend class ::TestEpoch; // give unit tests access to the privates
+public:
+
+   //
+   // Guard: hold one while touching anything that could be retired.
+   // Guards nest, and copies are more of the same; each must be
+   // destroyed on the thread that made it
+   //
+
+   class Guard
+   {
+   public:
+      Guard()                    { enter(); }
+      Guard(const Guard &)       { enter(); }
+      ~Guard()                   { leave(); }
+      Guard & operator = (const Guard &) { return *this; }
+   };
+
+   //
+   // Retire: free p with destroy(p) once no thread can still see it
+   //
+
+   static void retire(void * p, void (* destroy)(void *));
+
+   //
+   // Status
+   //
+
+   static uint64_t epoch() { return domain().global.load(); }
+
+private:
+
+   // something waiting to be freed
+   struct Retired
+   {
+      void * p;
+      void (* destroy)(void *);
+      uint64_t epoch;          // the global epoch when it was retired
+   };
+
+   // what one thread announces, and what it has retired
+   struct Record
+   {
+      Record() : local(idle), inUse(true), pNext(nullptr), depth(0) { }
+      std::atomic<uint64_t> local;   // the epoch this thread is reading in, or idle
+      std::atomic<bool>     inUse;   // does a thread own this record?
+      Record *              pNext;   // every record ever made
+      size_t                depth;   // how many guards are nested
+      std::vector<Retired>  retired; // waiting for the epoch to move on
+   };
+
+   // everything shared between threads
+   struct Domain
+   {
+      Domain() : global(2), pRecords(nullptr) { }
+      ~Domain();
+      std::atomic<uint64_t> global;   // starts at 2 so epoch - 2 never wraps
+      std::atomic<Record *> pRecords; // pushed, never popped
+      std::mutex            lock;     // guards orphans
+      std::vector<Retired>  orphans;  // left behind by threads that ended
+   };
+
+   // gives this thread's record back when the thread ends
+   struct Handle
+   {
+      Handle();
+      ~Handle();
+      Record * pRecord;
+   };
+
+   static const size_t   collectEvery = 64; // retire this many between collects
+   static const uint64_t idle = 0;          // not inside a guard
+
+   static Domain & domain();
+   static Record & record();
+   static void enter();
+   static void leave();
+   static bool advance();
+   static void collect(std::vector<Retired> & retired, uint64_t global);
+};
+
+/*********************************************
+ * EPOCH :: DOMAIN
+ * The one set of epochs every container shares
+ ********************************************/
+inline Epoch::Domain & Epoch::domain()
+{
+   static Domain domain;
+   return domain;
+}
+
+/*********************************************
+ * EPOCH :: RECORD
+ * This thread's record, claimed on first use
+ ********************************************/
+inline Epoch::Record & Epoch::record()
+{
+   domain();   // built first, so it is torn down last
+   static thread_local Handle handle;
+   return *handle.pRecord;
+}
+
+/*********************************************
+ * EPOCH :: HANDLE
+ * Reuse the record of a thread that has ended,
+ * or push a new one onto the list
+ ********************************************/
+inline Epoch::Handle::Handle() : pRecord(nullptr)
+{
+   Domain & shared = domain();
+   for (Record * p = shared.pRecords.load(); p; p = p->pNext)
+   {
+      bool expected = false;
+      if (p->inUse.compare_exchange_strong(expected, true))
+      {
+         pRecord = p;
+         return;
+      }
+   }
+
+   pRecord = new Record;
+   Record * pHead = shared.pRecords.load();
+   do
+      pRecord->pNext = pHead;
+   while (!shared.pRecords.compare_exchange_weak(pHead, pRecord));
+}
+
+/*********************************************
+ * EPOCH :: HANDLE DESTRUCTOR
+ * The thread is ending: free what we can, leave
+ * the rest for whoever collects next
+ ********************************************/
+inline Epoch::Handle::~Handle()
+{
+   Domain & shared = domain();
+   advance();
+   collect(pRecord->retired, shared.global.load());
+   {
+      std::lock_guard<std::mutex> guard(shared.lock);
+      shared.orphans.insert(shared.orphans.end(),
+                            pRecord->retired.begin(), pRecord->retired.end());
+   }
+   pRecord->retired.clear();
+   pRecord->depth = 0;
+   pRecord->local.store(idle);
+   pRecord->inUse.store(false);
+}
+
+/*********************************************
+ * EPOCH :: DOMAIN DESTRUCTOR
+ * Every thread is gone: free everything left
+ ********************************************/
+inline Epoch::Domain::~Domain()
+{
+   for (const Retired & retired : orphans)
+      retired.destroy(retired.p);
+   Record * p = pRecords.load();
+   while (p)
+   {
+      Record * pDead = p;
+      p = p->pNext;
+      delete pDead;
+   }
+}
+
+/*********************************************
+ * EPOCH :: ENTER
+ * Announce the epoch we are reading in. Only
+ * the outermost guard does anything. This store
+ * is the one fence a guard costs: nothing we
+ * read next may be read before it is seen
+ ********************************************/
+inline void Epoch::enter()
+{
+   Record & mine = record();
+   if (mine.depth++ > 0)
+      return;
+   mine.local.store(domain().global.load());
+}
+
+/*********************************************
+ * EPOCH :: LEAVE
+ * We no longer hold anything that could be retired
+ ********************************************/
+inline void Epoch::leave()
+{
+   Record & mine = record();
+   if (--mine.depth == 0)
+      mine.local.store(idle, std::memory_order_release);
+}
+
+/*********************************************
+ * EPOCH :: RETIRE
+ * Stamp p with the epoch and set it aside. Now
+ * and then, try to move the epoch on and free
+ * what is old enough
+ ********************************************/
+inline void Epoch::retire(void * p, void (* destroy)(void *))
+{
+   Domain & shared = domain();
+   Record & mine = record();
+   mine.retired.push_back(Retired{ p, destroy, shared.global.load() });
+   if (mine.retired.size() % collectEvery != 0)
+      return;
+
+   advance();
+   uint64_t global = shared.global.load();
+   collect(mine.retired, global);
+
+   std::unique_lock<std::mutex> guard(shared.lock, std::try_to_lock);
+   if (guard.owns_lock())
+      collect(shared.orphans, global);
+}
+
+/*********************************************
+ * EPOCH :: ADVANCE
+ * Move the epoch on if every thread in a guard
+ * has seen the current one
+ ********************************************/
+inline bool Epoch::advance()
+{
+   Domain & shared = domain();
+   uint64_t global = shared.global.load();
+   for (Record * p = shared.pRecords.load(); p; p = p->pNext)
+   {
+      uint64_t local = p->local.load();
+      if (local != idle && local != global)
+         return false;
+   }
+   return shared.global.compare_exchange_strong(global, global + 1);
+}
+
+/*********************************************
+ * EPOCH :: COLLECT
+ * Free whatever was retired at least two epochs
+ * ago, keeping the rest in the order it came
+ ********************************************/
+inline void Epoch::collect(std::vector<Retired> & retired, uint64_t global)
+{
+   size_t numKept = 0;
+   for (size_t i = 0; i < retired.size(); i++)
+      if (retired[i].epoch + 2 <= global)
+         retired[i].destroy(retired[i].p);
+      else
+         retired[numKept++] = retired[i];
+   retired.resize(numKept);
+}
+
+} // namespace custom
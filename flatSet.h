@@ -0,0 +1,454 @@
+/***********************************************************************
+ * Header:
+ *    FLAT SET
+ * Summary:
+ *    A set kept in one sorted array, for data that is built once
+ *    and then mostly searched
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        flat_set            : An ordered set in a sorted vector
+ *        flat_set::iterator  : An iterator through the set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "set.h"             // for custom::set, from_sorted, enableLookup
+#include <algorithm>         // for std::stable_sort, std::unique, std::inplace_merge
+#include <cstddef>           // for size_t and ptrdiff_t
+#include <functional>        // for std::less
+#include <initializer_list>  // for std::initializer_list
+#include <iterator>          // for std::bidirectional_iterator_tag, std::reverse_iterator
+#include <type_traits>       // for std::enable_if
+#include <utility>           // for std::pair, std::move, std::swap
+#include <vector>            // for std::vector
+
+class TestFlatSet;     // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * FLAT SET
+ * The elements sit in one std::vector in ascending order: no
+ * nodes, no links, and a search touches about log2(n) elements
+ * that are all in the same block of memory. The search is
+ * branchless, so the processor never guesses which half is next.
+ *
+ * Building from a range sorts once and drops the duplicates, so
+ * that is the way to fill one. Inserting or erasing a single
+ * element shifts everything after it: O(n) rather than O(log n),
+ * and it invalidates every iterator.
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>>
+class flat_set
+{
+   friend class ::TestFlatSet; // give unit tests access to the privates
+
+public:
+
+   //
+   // Construct
+   //
+
+   flat_set() : flat_set(Compare()) { }
+   explicit flat_set(const Compare & compare) : elements(), compare(compare) { }
+   flat_set(const flat_set & rhs) = default;
+   flat_set(flat_set && rhs) noexcept : elements(std::move(rhs.elements)), compare(rhs.compare) { }
+   flat_set(const std::initializer_list<T> & il, const Compare & compare = Compare()) :
+      elements(il), compare(compare)
+   {
+      sortUnique();
+   }
+   template <class Iterator>
+   flat_set(Iterator first, Iterator last, const Compare & compare = Compare()) :
+      elements(first, last), compare(compare)
+   {
+      sortUnique();
+   }
+   template <class Iterator>
+   flat_set(from_sorted_t, Iterator first, Iterator last, const Compare & compare = Compare()) :
+      elements(first, last), compare(compare) { }
+   template <bool Ranked>
+   explicit flat_set(const set<T, Compare, Ranked> & rhs) : flat_set(Compare())
+   {
+      // already in order: one pass, one allocation
+      elements.reserve(rhs.size());
+      for (auto it = rhs.begin(); it != rhs.end(); ++it)
+         elements.push_back(*it);
+   }
+   ~flat_set() { }
+
+   //
+   // Assign
+   //
+
+   flat_set & operator = (const flat_set & rhs) = default;
+   flat_set & operator = (flat_set && rhs) noexcept
+   {
+      elements = std::move(rhs.elements);
+      compare = rhs.compare;
+      return *this;
+   }
+   flat_set & operator = (const std::initializer_list<T> & il)
+   {
+      elements.assign(il.begin(), il.end());
+      sortUnique();
+      return *this;
+   }
+   void swap(flat_set & rhs) noexcept
+   {
+      elements.swap(rhs.elements);
+      std::swap(compare, rhs.compare);
+   }
+
+   //
+   // Convert: the elements are already in order, so the tree is
+   // built in one pass rather than one insert at a time
+   //
+
+   template <bool Ranked = false>
+   set<T, Compare, Ranked> to_set() const
+   {
+      return set<T, Compare, Ranked>(from_sorted, elements.begin(), elements.end(), compare);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+   iterator begin() const noexcept { return iterator(elements.data()); }
+   iterator last()  const noexcept { return empty() ? end() : iterator(elements.data() + size() - 1); }
+   iterator end()   const noexcept { return iterator(elements.data() + size()); }
+   reverse_iterator rbegin() const noexcept { return reverse_iterator(end());   }
+   reverse_iterator rend()   const noexcept { return reverse_iterator(begin()); }
+
+   //
+   // Access
+   //
+   //
+   // With a transparent Compare such as std::less<>, each of these
+   // also takes anything Compare orders against T, with no temporary T
+   //
+
+   iterator find(const T & t) const
+   {
+      return findIn(t);
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator find(const K & key) const
+   {
+      return findIn(key);
+   }
+   iterator lower_bound(const T & t) const
+   {
+      return iterator(lowerBound(t));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator lower_bound(const K & key) const
+   {
+      return iterator(lowerBound(key));
+   }
+   iterator upper_bound(const T & t) const
+   {
+      return iterator(upperBound(t));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator upper_bound(const K & key) const
+   {
+      return iterator(upperBound(key));
+   }
+   std::pair<iterator, iterator> equal_range(const T & t) const
+   {
+      return std::pair<iterator, iterator>(lower_bound(t), upper_bound(t));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   std::pair<iterator, iterator> equal_range(const K & key) const
+   {
+      return std::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+   }
+   size_t count(const T & t) const
+   {
+      return find(t) != end() ? 1 : 0;  // no duplicates in a set
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   size_t count(const K & key) const
+   {
+      return upperBound(key) - lowerBound(key); // a transparent key may match several
+   }
+   bool contains(const T & t) const
+   {
+      return find(t) != end();
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   bool contains(const K & key) const
+   {
+      return find(key) != end();
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return elements.empty(); }
+   size_t size()  const noexcept { return elements.size(); }
+
+   //
+   // Memory
+   //
+
+   void   reserve(size_t num)      { elements.reserve(num); }
+   size_t capacity() const noexcept { return elements.capacity(); }
+   void   shrink_to_fit()          { elements.shrink_to_fit(); }
+
+   //
+   // Insert: each one shifts what comes after it
+   //
+
+   std::pair<iterator, bool> insert(const T &  t) { return insertUnique(t, t); }
+   std::pair<iterator, bool> insert(      T && t) { return insertUnique(t, std::move(t)); }
+   iterator insert(iterator hint, const T & t)
+   {
+      return insertHint(hint, t);
+   }
+   iterator insert(iterator hint, T && t)
+   {
+      return insertHint(hint, std::move(t));
+   }
+   template <class ... Args>
+   std::pair<iterator, bool> emplace(Args && ... args)
+   {
+      T t(std::forward<Args>(args)...);
+      return insertUnique(t, std::move(t));
+   }
+   void insert(const std::initializer_list<T> & il)
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   void insert(Iterator first, Iterator last)
+   {
+      // sort just the new ones, then merge them in: one pass, not one shift each
+      size_t numOld = size();
+      elements.insert(elements.end(), first, last);
+      auto itMiddle = elements.begin() + numOld;
+      std::stable_sort(itMiddle, elements.end(), compare);
+      std::inplace_merge(elements.begin(), itMiddle, elements.end(), compare);
+      removeDuplicates();
+   }
+
+   //
+   // Remove
+   //
+
+   void clear() noexcept
+   {
+      elements.clear();
+   }
+   iterator erase(const iterator & it)
+   {
+      auto itElement = elements.erase(elements.begin() + index(it));
+      return iterator(elements.data() + (itElement - elements.begin()));
+   }
+   size_t erase(const T & t)
+   {
+      iterator it = find(t);
+      if (it == end())
+         return 0;
+      erase(it);
+      return 1;
+   }
+   template <class K, class = enableLookup<K, T, Compare>,
+             class = typename std::enable_if<!std::is_convertible<K, iterator>::value>::type>
+   size_t erase(const K & key)
+   {
+      // a transparent key may be equivalent to several elements
+      std::pair<iterator, iterator> range = equal_range(key);
+      size_t num = range.second.p - range.first.p;
+      erase(range.first, range.second);
+      return num;
+   }
+   iterator erase(const iterator & itBegin, const iterator & itEnd)
+   {
+      auto itElement = elements.erase(elements.begin() + index(itBegin),
+                                      elements.begin() + index(itEnd));
+      return iterator(elements.data() + (itElement - elements.begin()));
+   }
+
+private:
+
+   //
+   // Branchless search: halve the range by moving its start or not,
+   // which compiles to a conditional move rather than a jump
+   //
+
+   template <class K>
+   const T * lowerBound(const K & key) const
+   {
+      const T * pBase = elements.data();
+      size_t num = elements.size();
+      if (num == 0)
+         return pBase;
+      while (num > 1)
+      {
+         size_t half = num / 2;
+         pBase = compare(pBase[half], key) ? pBase + half : pBase;
+         num -= half;
+      }
+      return pBase + (compare(*pBase, key) ? 1 : 0);
+   }
+   template <class K>
+   const T * upperBound(const K & key) const
+   {
+      const T * pBase = elements.data();
+      size_t num = elements.size();
+      if (num == 0)
+         return pBase;
+      while (num > 1)
+      {
+         size_t half = num / 2;
+         pBase = !compare(key, pBase[half]) ? pBase + half : pBase;
+         num -= half;
+      }
+      return pBase + (!compare(key, *pBase) ? 1 : 0);
+   }
+
+   template <class K>
+   iterator findIn(const K & key) const
+   {
+      const T * p = lowerBound(key);
+      return (p != elements.data() + size() && !compare(key, *p)) ? iterator(p) : end();
+   }
+
+   // where an iterator is in the vector
+   size_t index(const iterator & it) const { return it.p - elements.data(); }
+
+   // put the elements in order and drop all but the first of each
+   // run of equivalent ones, as inserting them one at a time would
+   void sortUnique()
+   {
+      if (!isSortedUnique())
+         std::stable_sort(elements.begin(), elements.end(), compare);
+      removeDuplicates();
+   }
+
+   bool isSortedUnique() const
+   {
+      return std::adjacent_find(elements.begin(), elements.end(),
+                                [this](const T & lhs, const T & rhs)
+                                { return !compare(lhs, rhs); }) == elements.end();
+   }
+
+   void removeDuplicates()
+   {
+      elements.erase(std::unique(elements.begin(), elements.end(),
+                                 [this](const T & lhs, const T & rhs)
+                                 { return !compare(lhs, rhs); }),
+                     elements.end());
+   }
+
+   template <class V>
+   std::pair<iterator, bool> insertUnique(const T & t, V && value)
+   {
+      size_t pos = lowerBound(t) - elements.data();
+      if (pos != size() && !compare(t, elements[pos]))
+         return std::pair<iterator, bool>(iterator(elements.data() + pos), false);
+      elements.insert(elements.begin() + pos, std::forward<V>(value));
+      return std::pair<iterator, bool>(iterator(elements.data() + pos), true);
+   }
+
+   // a right hint skips the search, which makes appending in order cheap
+   template <class V>
+   iterator insertHint(iterator hint, V && value)
+   {
+      size_t pos = index(hint);
+      bool afterPrev = pos == 0 || compare(elements[pos - 1], value);
+      bool beforeHint = pos == size() || compare(value, elements[pos]);
+      if (!afterPrev || !beforeHint)
+         return insertUnique(value, std::forward<V>(value)).first;
+      elements.insert(elements.begin() + pos, std::forward<V>(value));
+      return iterator(elements.data() + pos);
+   }
+
+   std::vector<T> elements;   // ascending, no two equivalent
+   Compare        compare;
+};
+
+/**************************************************
+ * FLAT SET ITERATOR
+ * A pointer into the vector. It has the same
+ * interface as set::iterator, so code that only
+ * walks and compares can use either container
+ *************************************************/
+template <typename T, typename Compare>
+class flat_set <T, Compare> :: iterator
+{
+   friend class ::TestFlatSet; // give unit tests access to the privates
+   friend class custom::flat_set<T, Compare>;
+public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
+   // constructors, destructors, and assignment operator
+   iterator() : p(nullptr) { }
+   iterator(const iterator & rhs) = default;
+   iterator & operator = (const iterator & rhs) = default;
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   // dereference operator
+   const T & operator * () const { return *p; }
+   const T * operator -> () const { return p; }
+
+   // prefix increment
+   iterator & operator ++ ()
+   {
+      ++p;
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld = *this;
+      ++p;
+      return itOld;
+   }
+
+   // prefix decrement
+   iterator & operator -- ()
+   {
+      --p;
+      return *this;
+   }
+
+   // postfix decrement
+   iterator operator -- (int postfix)
+   {
+      iterator itOld = *this;
+      --p;
+      return itOld;
+   }
+
+private:
+   explicit iterator(const T * p) : p(p) { }
+
+   const T * p;
+};
+
+} // namespace custom
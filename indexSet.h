@@ -0,0 +1,1138 @@
+/***********************************************************************
+ * Header:
+ *    INDEX SET
+ * Summary:
+ *    A red-black tree whose nodes live in one array and link to
+ *    each other by 32-bit index rather than by pointer
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        index_set           : An ordered set of index-linked nodes
+ *        index_set::iterator : An iterator through the set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>           // for size_t and ptrdiff_t
+#include <cstdint>           // for uint8_t and uint32_t
+#include <cstring>           // for std::memcpy
+#include <functional>        // for std::less
+#include <initializer_list>  // for std::initializer_list
+#include <iterator>          // for std::bidirectional_iterator_tag, std::reverse_iterator
+#include <memory>            // for std::allocator
+#include <new>               // for placement new
+#include <stdexcept>         // for std::length_error, std::invalid_argument
+#include <type_traits>       // for std::is_trivially_copyable
+#include <utility>           // for std::pair, std::move, std::swap
+#include <vector>            // for std::vector
+
+class TestIndexSet;    // forward declaration for unit tests
+class BenchIndexSet;   // forward declaration for benchmarks
+
+namespace custom
+{
+
+/*****************************************************************
+ * INDEX SET
+ * The same red-black tree as BST, with set's lookups, inserts,
+ * erases and iterators, but not its node handles, merge, split,
+ * join, or set algebra. Every node sits in one growing array and
+ * names its parent and children by their place in it. A 32-bit
+ * index is half a 64-bit pointer, so a node of ints is 20 bytes
+ * rather than 32, and the nodes are next to each other in memory.
+ *
+ * Nothing in the array is an address, so the whole tree can be
+ * moved anywhere. For a trivially copyable T it is written out and
+ * read back with one memcpy: see serialize() and deserialize().
+ *
+ * Slot 0 is the nil node every missing child points to, so a set
+ * holds at most 2^32 - 2 elements. Erased slots are reused by later
+ * inserts. An iterator holds the set and an index, so inserting,
+ * even when the array grows, invalidates none of them. Growing moves
+ * every element, so T's move constructor must not throw.
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>>
+class index_set
+{
+   friend class ::TestIndexSet;  // give unit tests access to the privates
+   friend class ::BenchIndexSet; // and benchmarks
+
+public:
+
+   typedef uint32_t Index;
+
+   //
+   // Construct
+   //
+
+   index_set() : index_set(Compare()) { }
+   explicit index_set(const Compare & compare);
+   index_set(const index_set & rhs);
+   index_set(index_set && rhs) noexcept : index_set(rhs.compare) { swap(rhs); }
+   index_set(const std::initializer_list<T> & il) : index_set() { insert(il); }
+   template <class Iterator>
+   index_set(Iterator first, Iterator last) : index_set() { insert(first, last); }
+   ~index_set();
+
+   //
+   // Assign
+   //
+
+   index_set & operator = (const index_set & rhs)
+   {
+      if (this != &rhs)
+      {
+         index_set copy(rhs);
+         swap(copy);
+      }
+      return *this;
+   }
+   index_set & operator = (index_set && rhs) noexcept
+   {
+      if (this != &rhs)
+      {
+         clear();
+         swap(rhs);
+      }
+      return *this;
+   }
+   index_set & operator = (const std::initializer_list<T> & il)
+   {
+      clear();
+      insert(il);
+      return *this;
+   }
+   void swap(index_set & rhs) noexcept;
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+   iterator begin() const noexcept { return iterator(this, leftmost);  }
+   iterator last()  const noexcept { return iterator(this, rightmost); }
+   iterator end()   const noexcept { return iterator(this, nil);       }
+   reverse_iterator rbegin() const noexcept { return reverse_iterator(end());   }
+   reverse_iterator rend()   const noexcept { return reverse_iterator(begin()); }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const
+   {
+      Index i = lowerBound(t);
+      return iterator(this, (i != nil && !compare(t, data(i))) ? i : nil);
+   }
+   iterator lower_bound(const T & t) const { return iterator(this, lowerBound(t)); }
+   iterator upper_bound(const T & t) const { return iterator(this, upperBound(t)); }
+   std::pair<iterator, iterator> equal_range(const T & t) const
+   {
+      return std::pair<iterator, iterator>(lower_bound(t), upper_bound(t));
+   }
+   size_t count   (const T & t) const { return contains(t) ? 1 : 0; }
+   bool   contains(const T & t) const { return find(t) != end(); }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return numElements == 0; }
+   size_t size()  const noexcept { return numElements; }
+
+   //
+   // Memory
+   //
+
+   void   reserve(size_t num);
+   size_t capacity() const noexcept { return numCapacity - 1; }
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t) { return insertUnique(t, t); }
+   std::pair<iterator, bool> insert(      T && t) { return insertUnique(t, std::move(t)); }
+   template <class ... Args>
+   std::pair<iterator, bool> emplace(Args && ... args)
+   {
+      T t(std::forward<Args>(args)...);
+      return insertUnique(t, std::move(t));
+   }
+   void insert(const std::initializer_list<T> & il)
+   {
+      for (const T & t : il)
+         insert(t);
+   }
+   template <class Iterator>
+   void insert(Iterator first, Iterator last)
+   {
+      for (; first != last; ++first)
+         insert(*first);
+   }
+
+   //
+   // Remove
+   //
+
+   void     clear() noexcept;
+   iterator erase(const iterator & it);
+   size_t   erase(const T & t);
+   iterator erase(const iterator & itBegin, const iterator & itEnd);
+
+   //
+   // Serialize: the bytes of the array, and the few indices that say
+   // where in it the tree starts. Only for a trivially copyable T
+   //
+
+   std::vector<unsigned char> serialize() const;
+   static index_set deserialize(const void * pBytes, size_t numBytes,
+                                const Compare & compare = Compare());
+
+private:
+
+   static const Index nil = 0;                 // every missing child, and end()
+   static const Index maxSlots = UINT32_MAX;   // nil included
+   static const size_t minSlots = 16;          // the first array holds this many
+
+   enum Color : uint8_t { black, red, vacant }; // vacant: erased, on the free list
+
+   // links and color, then the element. A vacant slot links to
+   // the next vacant one through left
+   struct Node
+   {
+      Index left;
+      Index right;
+      Index parent;
+      Color color;
+      alignas(T) unsigned char raw[sizeof(T)];
+   };
+
+   // what serialize() puts in front of the nodes
+   struct Image
+   {
+      uint32_t sizeofNode;
+      Index    numSlots;
+      Index    root;
+      Index    freeList;
+      Index    leftmost;
+      Index    rightmost;
+      uint32_t numElements;
+   };
+
+   //
+   // Get at the nodes
+   //
+
+   Node &       node(Index i)       noexcept { return pNodes[i]; }
+   const Node & node(Index i) const noexcept { return pNodes[i]; }
+   T &          data(Index i)       noexcept { return *reinterpret_cast<T *>(pNodes[i].raw); }
+   const T &    data(Index i) const noexcept { return *reinterpret_cast<const T *>(pNodes[i].raw); }
+   bool         isRed(Index i) const noexcept { return pNodes[i].color == red; }
+
+   //
+   // Search
+   //
+
+   Index lowerBound(const T & t) const;
+   Index upperBound(const T & t) const;
+   Index minimum(Index i) const noexcept;
+   Index maximum(Index i) const noexcept;
+   Index next(Index i) const noexcept;
+   Index prev(Index i) const noexcept;
+
+   //
+   // Change the tree
+   //
+
+   template <class V>
+   std::pair<iterator, bool> insertUnique(const T & t, V && value);
+   void  balanceInsert(Index i) noexcept;
+   void  eraseNode(Index i) noexcept;
+   void  balanceErase(Index i) noexcept;
+   void  rotateLeft(Index i) noexcept;
+   void  rotateRight(Index i) noexcept;
+   void  transplant(Index iOld, Index iNew) noexcept;
+
+   //
+   // Slots
+   //
+
+   template <class V>
+   Index allocate(V && value);
+   void  release(Index i) noexcept;
+   void  grow(size_t num);
+   static Node * newArray(size_t num);
+   static void   deleteArray(Node * p, size_t num) noexcept;
+   bool  wellFormed() const noexcept;
+
+   Node *   pNodes;        // the array: slot 0 is nil
+   Index    numSlots;      // slots in use or vacant, nil included
+   Index    numCapacity;   // slots the array has room for
+   Index    root;          // nil when empty
+   Index    freeList;      // vacant slots, linked through left
+   Index    leftmost;      // smallest element, what begin() is
+   Index    rightmost;     // largest element, what last() is
+   size_t   numElements;
+   Compare  compare;
+};
+
+/**************************************************
+ * INDEX SET ITERATOR
+ * The set and an index into its array. Going
+ * through the set rather than a pointer into the
+ * array means growing the array moves nothing
+ *************************************************/
+template <typename T, typename Compare>
+class index_set <T, Compare> :: iterator
+{
+   friend class ::TestIndexSet; // give unit tests access to the privates
+   friend class custom::index_set<T, Compare>;
+public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
+   // constructors, destructors, and assignment operator
+   iterator() : pSet(nullptr), i(nil) { }
+   iterator(const iterator & rhs) = default;
+   iterator & operator = (const iterator & rhs) = default;
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const { return i == rhs.i && pSet == rhs.pSet; }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs); }
+
+   // dereference operator
+   const T & operator * () const { return pSet->data(i); }
+   const T * operator -> () const { return &pSet->data(i); }
+
+   // prefix increment
+   iterator & operator ++ ()
+   {
+      i = pSet->next(i);
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld = *this;
+      ++(*this);
+      return itOld;
+   }
+
+   // prefix decrement: back from end() is the largest
+   iterator & operator -- ()
+   {
+      i = (i == nil) ? pSet->rightmost : pSet->prev(i);
+      return *this;
+   }
+
+   // postfix decrement
+   iterator operator -- (int postfix)
+   {
+      iterator itOld = *this;
+      --(*this);
+      return itOld;
+   }
+
+private:
+   iterator(const index_set * pSet, Index i) : pSet(pSet), i(i) { }
+
+   const index_set * pSet;
+   Index i;
+};
+
+/*********************************************
+ * INDEX SET :: CONSTRUCTOR
+ * Nothing but nil
+ ********************************************/
+template <typename T, typename Compare>
+index_set <T, Compare> :: index_set(const Compare & compare) :
+   pNodes(nullptr), numSlots(1), numCapacity(0), root(nil), freeList(nil),
+   leftmost(nil), rightmost(nil), numElements(0), compare(compare)
+{
+   pNodes = newArray(1);
+   numCapacity = 1;
+}
+
+/*********************************************
+ * INDEX SET :: COPY CONSTRUCTOR
+ * Slot for slot, so every index means the same
+ * thing in the copy. A trivially copyable T goes
+ * across in one memcpy
+ ********************************************/
+template <typename T, typename Compare>
+index_set <T, Compare> :: index_set(const index_set & rhs) :
+   pNodes(nullptr), numSlots(1), numCapacity(0), root(rhs.root), freeList(rhs.freeList),
+   leftmost(rhs.leftmost), rightmost(rhs.rightmost), numElements(rhs.numElements),
+   compare(rhs.compare)
+{
+   pNodes = newArray(rhs.numSlots);
+   numCapacity = rhs.numSlots;
+   if constexpr (std::is_trivially_copyable<T>::value)
+   {
+      std::memcpy(pNodes, rhs.pNodes, rhs.numSlots * sizeof(Node));
+      numSlots = rhs.numSlots;
+   }
+   else
+   {
+      pNodes[nil] = rhs.pNodes[nil];
+      try
+      {
+         // numSlots counts what is built, so clear() destroys
+         // just that if a copy throws
+         for (; numSlots < rhs.numSlots; numSlots++)
+         {
+            const Node & src = rhs.node(numSlots);
+            Node & dest = node(numSlots);
+            dest.left = src.left;
+            dest.right = src.right;
+            dest.parent = src.parent;
+            dest.color = vacant;
+            if (src.color != vacant)
+            {
+               new (dest.raw) T(rhs.data(numSlots));
+               dest.color = src.color;
+            }
+         }
+      }
+      catch (...)
+      {
+         clear();
+         deleteArray(pNodes, numCapacity);
+         throw;
+      }
+   }
+}
+
+/*********************************************
+ * INDEX SET :: DESTRUCTOR
+ ********************************************/
+template <typename T, typename Compare>
+index_set <T, Compare> :: ~index_set()
+{
+   clear();
+   deleteArray(pNodes, numCapacity);
+}
+
+/*********************************************
+ * INDEX SET :: SWAP
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: swap(index_set & rhs) noexcept
+{
+   std::swap(pNodes,      rhs.pNodes);
+   std::swap(numSlots,    rhs.numSlots);
+   std::swap(numCapacity, rhs.numCapacity);
+   std::swap(root,        rhs.root);
+   std::swap(freeList,    rhs.freeList);
+   std::swap(leftmost,    rhs.leftmost);
+   std::swap(rightmost,   rhs.rightmost);
+   std::swap(numElements, rhs.numElements);
+   std::swap(compare,     rhs.compare);
+}
+
+/*********************************************
+ * INDEX SET :: RESERVE
+ * Room for num elements without growing again
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: reserve(size_t num)
+{
+   if (num + 1 > numCapacity)
+      grow(num + 1);
+}
+
+/*********************************************
+ * INDEX SET :: LOWER BOUND
+ * The first element not before t, or nil
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: lowerBound(const T & t) const
+{
+   Index iBound = nil;
+   Index i = root;
+   while (i != nil)
+   {
+      if (compare(data(i), t))
+         i = node(i).right;
+      else
+      {
+         iBound = i;
+         i = node(i).left;
+      }
+   }
+   return iBound;
+}
+
+/*********************************************
+ * INDEX SET :: UPPER BOUND
+ * The first element after t, or nil
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: upperBound(const T & t) const
+{
+   Index iBound = nil;
+   Index i = root;
+   while (i != nil)
+   {
+      if (compare(t, data(i)))
+      {
+         iBound = i;
+         i = node(i).left;
+      }
+      else
+         i = node(i).right;
+   }
+   return iBound;
+}
+
+/*********************************************
+ * INDEX SET :: MINIMUM and MAXIMUM
+ * The ends of the subtree at i
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: minimum(Index i) const noexcept
+{
+   while (node(i).left != nil)
+      i = node(i).left;
+   return i;
+}
+
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: maximum(Index i) const noexcept
+{
+   while (node(i).right != nil)
+      i = node(i).right;
+   return i;
+}
+
+/*********************************************
+ * INDEX SET :: NEXT
+ * The element after i in order, or nil
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: next(Index i) const noexcept
+{
+   if (node(i).right != nil)
+      return minimum(node(i).right);
+   Index iParent = node(i).parent;
+   while (iParent != nil && i == node(iParent).right)
+   {
+      i = iParent;
+      iParent = node(i).parent;
+   }
+   return iParent;
+}
+
+/*********************************************
+ * INDEX SET :: PREV
+ * The element before i in order, or nil
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: prev(Index i) const noexcept
+{
+   if (node(i).left != nil)
+      return maximum(node(i).left);
+   Index iParent = node(i).parent;
+   while (iParent != nil && i == node(iParent).left)
+   {
+      i = iParent;
+      iParent = node(i).parent;
+   }
+   return iParent;
+}
+
+/*********************************************
+ * INDEX SET :: INSERT UNIQUE
+ * Find where t goes, then build the node there
+ * from value. Indices survive the array growing,
+ * so the search does not have to be redone
+ ********************************************/
+template <typename T, typename Compare>
+template <class V>
+std::pair<typename index_set <T, Compare> :: iterator, bool>
+index_set <T, Compare> :: insertUnique(const T & t, V && value)
+{
+   Index iParent = nil;
+   Index i = root;
+   bool goLeft = false;
+   while (i != nil)
+   {
+      iParent = i;
+      if (compare(t, data(i)))
+      {
+         goLeft = true;
+         i = node(i).left;
+      }
+      else if (compare(data(i), t))
+      {
+         goLeft = false;
+         i = node(i).right;
+      }
+      else
+         return std::pair<iterator, bool>(iterator(this, i), false);
+   }
+
+   Index iNew = allocate(std::forward<V>(value));
+   Node & n = node(iNew);
+   n.left = n.right = nil;
+   n.parent = iParent;
+   n.color = red;
+   if (iParent == nil)
+   {
+      root = leftmost = rightmost = iNew;
+   }
+   else if (goLeft)
+   {
+      node(iParent).left = iNew;
+      if (iParent == leftmost)
+         leftmost = iNew;
+   }
+   else
+   {
+      node(iParent).right = iNew;
+      if (iParent == rightmost)
+         rightmost = iNew;
+   }
+   numElements++;
+   balanceInsert(iNew);
+   return std::pair<iterator, bool>(iterator(this, iNew), true);
+}
+
+/*********************************************
+ * INDEX SET :: BALANCE INSERT
+ * A red node was just added below i's parent:
+ * recolor while its uncle is red, then rotate
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: balanceInsert(Index i) noexcept
+{
+   while (isRed(node(i).parent))
+   {
+      Index iParent = node(i).parent;
+      Index iGranny = node(iParent).parent;
+      if (iParent == node(iGranny).left)
+      {
+         Index iAunt = node(iGranny).right;
+         if (isRed(iAunt))
+         {
+            node(iParent).color = black;
+            node(iAunt).color = black;
+            node(iGranny).color = red;
+            i = iGranny;
+         }
+         else
+         {
+            if (i == node(iParent).right)
+            {
+               i = iParent;
+               rotateLeft(i);
+               iParent = node(i).parent;
+            }
+            node(iParent).color = black;
+            node(iGranny).color = red;
+            rotateRight(iGranny);
+         }
+      }
+      else
+      {
+         Index iAunt = node(iGranny).left;
+         if (isRed(iAunt))
+         {
+            node(iParent).color = black;
+            node(iAunt).color = black;
+            node(iGranny).color = red;
+            i = iGranny;
+         }
+         else
+         {
+            if (i == node(iParent).left)
+            {
+               i = iParent;
+               rotateRight(i);
+               iParent = node(i).parent;
+            }
+            node(iParent).color = black;
+            node(iGranny).color = red;
+            rotateLeft(iGranny);
+         }
+      }
+   }
+   node(root).color = black;
+}
+
+/*********************************************
+ * INDEX SET :: ROTATE LEFT
+ * i's right child takes its place
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: rotateLeft(Index i) noexcept
+{
+   Index iChild = node(i).right;
+   node(i).right = node(iChild).left;
+   if (node(iChild).left != nil)
+      node(node(iChild).left).parent = i;
+   transplant(i, iChild);
+   node(iChild).left = i;
+   node(i).parent = iChild;
+}
+
+/*********************************************
+ * INDEX SET :: ROTATE RIGHT
+ * i's left child takes its place
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: rotateRight(Index i) noexcept
+{
+   Index iChild = node(i).left;
+   node(i).left = node(iChild).right;
+   if (node(iChild).right != nil)
+      node(node(iChild).right).parent = i;
+   transplant(i, iChild);
+   node(iChild).right = i;
+   node(i).parent = iChild;
+}
+
+/*********************************************
+ * INDEX SET :: TRANSPLANT
+ * iNew takes iOld's place under iOld's parent.
+ * iNew may be nil, whose parent is then set so
+ * balanceErase can climb from it
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: transplant(Index iOld, Index iNew) noexcept
+{
+   Index iParent = node(iOld).parent;
+   if (iParent == nil)
+      root = iNew;
+   else if (iOld == node(iParent).left)
+      node(iParent).left = iNew;
+   else
+      node(iParent).right = iNew;
+   node(iNew).parent = iParent;
+}
+
+/*********************************************
+ * INDEX SET :: ERASE
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: iterator
+index_set <T, Compare> :: erase(const iterator & it)
+{
+   if (it.i == nil)
+      return end();
+   Index iNext = next(it.i);
+   eraseNode(it.i);
+   return iterator(this, iNext);
+}
+
+template <typename T, typename Compare>
+size_t index_set <T, Compare> :: erase(const T & t)
+{
+   iterator it = find(t);
+   if (it == end())
+      return 0;
+   eraseNode(it.i);
+   return 1;
+}
+
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: iterator
+index_set <T, Compare> :: erase(const iterator & itBegin, const iterator & itEnd)
+{
+   iterator it = itBegin;
+   while (it != itEnd)
+      it = erase(it);
+   return it;
+}
+
+/*********************************************
+ * INDEX SET :: ERASE NODE
+ * Unlink i, moving its successor into its place
+ * when it has two children, so no element moves
+ * to a different slot and no iterator but i's
+ * is invalidated
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: eraseNode(Index i) noexcept
+{
+   if (i == leftmost)
+      leftmost = next(i);
+   if (i == rightmost)
+      rightmost = prev(i);
+
+   Index iMoved = i;                      // the node that leaves its spot
+   bool movedRed = isRed(iMoved);
+   Index iFill;                           // what takes iMoved's spot
+   if (node(i).left == nil)
+   {
+      iFill = node(i).right;
+      transplant(i, iFill);
+   }
+   else if (node(i).right == nil)
+   {
+      iFill = node(i).left;
+      transplant(i, iFill);
+   }
+   else
+   {
+      iMoved = minimum(node(i).right);
+      movedRed = isRed(iMoved);
+      iFill = node(iMoved).right;
+      if (node(iMoved).parent == i)
+         node(iFill).parent = iMoved;
+      else
+      {
+         transplant(iMoved, iFill);
+         node(iMoved).right = node(i).right;
+         node(node(iMoved).right).parent = iMoved;
+      }
+      transplant(i, iMoved);
+      node(iMoved).left = node(i).left;
+      node(node(iMoved).left).parent = iMoved;
+      node(iMoved).color = node(i).color;
+   }
+
+   if (!movedRed)
+      balanceErase(iFill);
+   node(nil).parent = nil;
+   release(i);
+   numElements--;
+}
+
+/*********************************************
+ * INDEX SET :: BALANCE ERASE
+ * A black node left from above i, so i's side
+ * is one black short. Push the shortage up, or
+ * borrow a node from the sibling's side
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: balanceErase(Index i) noexcept
+{
+   while (i != root && !isRed(i))
+   {
+      Index iParent = node(i).parent;
+      if (i == node(iParent).left)
+      {
+         Index iSibling = node(iParent).right;
+         if (isRed(iSibling))
+         {
+            node(iSibling).color = black;
+            node(iParent).color = red;
+            rotateLeft(iParent);
+            iSibling = node(iParent).right;
+         }
+         if (!isRed(node(iSibling).left) && !isRed(node(iSibling).right))
+         {
+            node(iSibling).color = red;
+            i = iParent;
+         }
+         else
+         {
+            if (!isRed(node(iSibling).right))
+            {
+               node(node(iSibling).left).color = black;
+               node(iSibling).color = red;
+               rotateRight(iSibling);
+               iSibling = node(iParent).right;
+            }
+            node(iSibling).color = node(iParent).color;
+            node(iParent).color = black;
+            node(node(iSibling).right).color = black;
+            rotateLeft(iParent);
+            i = root;
+         }
+      }
+      else
+      {
+         Index iSibling = node(iParent).left;
+         if (isRed(iSibling))
+         {
+            node(iSibling).color = black;
+            node(iParent).color = red;
+            rotateRight(iParent);
+            iSibling = node(iParent).left;
+         }
+         if (!isRed(node(iSibling).left) && !isRed(node(iSibling).right))
+         {
+            node(iSibling).color = red;
+            i = iParent;
+         }
+         else
+         {
+            if (!isRed(node(iSibling).left))
+            {
+               node(node(iSibling).right).color = black;
+               node(iSibling).color = red;
+               rotateLeft(iSibling);
+               iSibling = node(iParent).left;
+            }
+            node(iSibling).color = node(iParent).color;
+            node(iParent).color = black;
+            node(node(iSibling).left).color = black;
+            rotateRight(iParent);
+            i = root;
+         }
+      }
+   }
+   node(i).color = black;
+}
+
+/*********************************************
+ * INDEX SET :: CLEAR
+ * Destroy every element, keeping the array
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: clear() noexcept
+{
+   if constexpr (!std::is_trivially_destructible<T>::value)
+      for (Index i = 1; i < numSlots; i++)
+         if (node(i).color != vacant)
+            data(i).~T();
+   numSlots = 1;
+   root = freeList = leftmost = rightmost = nil;
+   numElements = 0;
+}
+
+/*********************************************
+ * INDEX SET :: ALLOCATE
+ * A vacant slot if there is one, else the next
+ * one in the array, growing it when it is full
+ ********************************************/
+template <typename T, typename Compare>
+template <class V>
+typename index_set <T, Compare> :: Index
+index_set <T, Compare> :: allocate(V && value)
+{
+   Index i;
+   if (freeList != nil)
+   {
+      i = freeList;
+      new (node(i).raw) T(std::forward<V>(value));
+      freeList = node(i).left;
+      return i;
+   }
+
+   if (numSlots == maxSlots)
+      throw std::length_error("index_set: more elements than 32-bit indices can name");
+   if (numSlots == numCapacity)
+      grow(numCapacity < maxSlots / 2 ? 2 * (size_t)numCapacity : (size_t)maxSlots);
+   i = numSlots;
+   new (node(i).raw) T(std::forward<V>(value));
+   numSlots++;
+   return i;
+}
+
+/*********************************************
+ * INDEX SET :: RELEASE
+ * Destroy the element in slot i, and put the
+ * slot on the free list
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: release(Index i) noexcept
+{
+   data(i).~T();
+   node(i).color = vacant;
+   node(i).left = freeList;
+   freeList = i;
+}
+
+/*********************************************
+ * INDEX SET :: GROW
+ * Move every slot to an array of num. Indices
+ * are places, not addresses, so no link changes
+ ********************************************/
+template <typename T, typename Compare>
+void index_set <T, Compare> :: grow(size_t num)
+{
+   if (num < minSlots)
+      num = minSlots;
+   if (num > maxSlots)
+      num = maxSlots;
+   Node * pNew = newArray(num);
+   if constexpr (std::is_trivially_copyable<T>::value)
+      std::memcpy(pNew, pNodes, numSlots * sizeof(Node));
+   else
+   {
+      // the move must not throw, or a half-moved tree is lost
+      static_assert(std::is_nothrow_move_constructible<T>::value,
+                    "index_set needs a T whose move constructor does not throw");
+      for (Index i = 0; i < numSlots; i++)
+      {
+         pNew[i].left = pNodes[i].left;
+         pNew[i].right = pNodes[i].right;
+         pNew[i].parent = pNodes[i].parent;
+         pNew[i].color = pNodes[i].color;
+         if (i != nil && pNodes[i].color != vacant)
+         {
+            new (pNew[i].raw) T(std::move(data(i)));
+            data(i).~T();
+         }
+      }
+   }
+   deleteArray(pNodes, numCapacity);
+   pNodes = pNew;
+   numCapacity = (Index)num;
+}
+
+/*********************************************
+ * INDEX SET :: NEW ARRAY and DELETE ARRAY
+ * Raw slots: elements are built in them one at
+ * a time. Slot 0 starts out as nil
+ ********************************************/
+template <typename T, typename Compare>
+typename index_set <T, Compare> :: Node *
+index_set <T, Compare> :: newArray(size_t num)
+{
+   Node * p = std::allocator<Node>().allocate(num);
+   p[nil].left = p[nil].right = p[nil].parent = nil;
+   p[nil].color = black;
+   return p;
+}
+
+template <typename T, typename Compare>
+void index_set <T, Compare> :: deleteArray(Node * p, size_t num) noexcept
+{
+   if (p)
+      std::allocator<Node>().deallocate(p, num);
+}
+
+/*********************************************
+ * INDEX SET :: SERIALIZE
+ * An Image of the indices, then the array as is
+ ********************************************/
+template <typename T, typename Compare>
+std::vector<unsigned char> index_set <T, Compare> :: serialize() const
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "only a set of trivially copyable elements can be copied out as bytes");
+   Image image { (uint32_t)sizeof(Node), numSlots, root, freeList,
+                 leftmost, rightmost, (uint32_t)numElements };
+   std::vector<unsigned char> bytes(sizeof(Image) + numSlots * sizeof(Node));
+   std::memcpy(bytes.data(), &image, sizeof(Image));
+   std::memcpy(bytes.data() + sizeof(Image), pNodes, numSlots * sizeof(Node));
+   return bytes;
+}
+
+/*********************************************
+ * INDEX SET :: WELL FORMED
+ * Can the array just read in be used as it is?
+ * Every index is in the array, every color is one
+ * of the three, each element's children name it as
+ * their parent, walking in order from leftmost ends
+ * at rightmost after every element, and the free
+ * list holds every vacant slot and ends at nil.
+ * The order of the elements is not checked
+ ********************************************/
+template <typename T, typename Compare>
+bool index_set <T, Compare> :: wellFormed() const noexcept
+{
+   if (numElements >= numSlots || root >= numSlots || freeList >= numSlots ||
+       leftmost >= numSlots || rightmost >= numSlots || node(nil).color != black)
+      return false;
+
+   // the links of each slot
+   size_t numLive = 0;
+   for (Index i = 0; i < numSlots; i++)
+   {
+      const Node & n = node(i);
+      if (n.left >= numSlots || n.right >= numSlots || n.parent >= numSlots ||
+          (n.color != black && n.color != red && n.color != vacant))
+         return false;
+      if (i == nil || n.color == vacant)
+         continue;
+      numLive++;
+      for (Index iChild : { n.left, n.right })
+         if (iChild != nil && (node(iChild).color == vacant || node(iChild).parent != i))
+            return false;
+      if (i == root ? n.parent != nil
+                    : n.parent == nil || node(n.parent).color == vacant ||
+                      (node(n.parent).left == i) == (node(n.parent).right == i))
+         return false;
+   }
+   if (numLive != numElements || (root == nil) != (numElements == 0))
+      return false;
+
+   // the tree, in order
+   if (root != nil)
+   {
+      Index i = minimum(root);
+      if (i != leftmost)
+         return false;
+      for (size_t num = 1; num < numElements; num++)
+         i = next(i);
+      if (i != rightmost || next(i) != nil)
+         return false;
+   }
+   else if (leftmost != nil || rightmost != nil)
+      return false;
+
+   // the free list
+   Index i = freeList;
+   for (size_t num = numSlots - 1 - numElements; num > 0; num--)
+   {
+      if (i == nil || node(i).color != vacant)
+         return false;
+      i = node(i).left;
+   }
+   return i == nil;
+}
+
+/*********************************************
+ * INDEX SET :: DESERIALIZE
+ * Take back what serialize() wrote. Bytes that
+ * are the wrong size for their Image, or whose
+ * nodes do not make a tree, are rejected
+ ********************************************/
+template <typename T, typename Compare>
+index_set <T, Compare> index_set <T, Compare> :: deserialize(const void * pBytes, size_t numBytes,
+                                                             const Compare & compare)
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "only a set of trivially copyable elements can be read in as bytes");
+   Image image;
+   if (numBytes < sizeof(Image))
+      throw std::invalid_argument("index_set: too few bytes for a serialized set");
+   std::memcpy(&image, pBytes, sizeof(Image));
+   if (image.sizeofNode != sizeof(Node) || image.numSlots == 0 ||
+       numBytes != sizeof(Image) + (size_t)image.numSlots * sizeof(Node))
+      throw std::invalid_argument("index_set: bytes are not a serialized set of this type");
+
+   index_set s(compare);
+   s.grow(image.numSlots);
+   std::memcpy(s.pNodes, static_cast<const unsigned char *>(pBytes) + sizeof(Image),
+               image.numSlots * sizeof(Node));
+   s.numSlots    = image.numSlots;
+   s.root        = image.root;
+   s.freeList    = image.freeList;
+   s.leftmost    = image.leftmost;
+   s.rightmost   = image.rightmost;
+   s.numElements = image.numElements;
+   if (!s.wellFormed())
+   {
+      s.clear();
+      throw std::invalid_argument("index_set: serialized nodes do not make a tree");
+   }
+   return s;
+}
+
+} // namespace custom
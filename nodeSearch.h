@@ -0,0 +1,317 @@
+/***********************************************************************
+ * Header:
+ *    NODE SEARCH
+ * Summary:
+ *    Search the sorted keys of one B-tree node with vector compares
+ *    rather than one branch per key
+ *
+ *    This will contain the class definition of:
+ *        NodeSearch          : Compare-and-count kernels for a node
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t
+#include <functional>    // for std::less
+#include <type_traits>   // for std::is_integral, std::is_same, std::make_unsigned
+
+// which instructions the compiler was told it may use
+#if defined(__AVX2__)
+#define NODE_SEARCH_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NODE_SEARCH_SSE2
+#endif
+#if defined(__SSE4_2__) || defined(__AVX__)
+#define NODE_SEARCH_SSE42
+#endif
+
+#if defined(NODE_SEARCH_AVX2) || defined(NODE_SEARCH_SSE2)
+#include <immintrin.h>   // for the _mm_ and _mm256_ intrinsics
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>      // for _BitScanForward64
+#endif
+
+namespace custom
+{
+
+/*****************************************************************
+ * NODE SEARCH
+ * A node's keys are sorted, so the first key not before t sits
+ * after exactly the keys that are less than t. Rather than halving
+ * the node one unpredictable branch at a time, compare t against
+ * every key, a whole register of them at once, and count the
+ * matches from the compare mask. A 256-byte node is eight AVX2
+ * compares, whatever the key size.
+ *
+ * Kernels are picked at compile time from T: signed and unsigned
+ * integers of 1, 2, 4, and 8 bytes, float, and double. AVX2 is used
+ * when the build allows it, then SSE (SSE4.2 for 64-bit integers),
+ * and otherwise, as on ARM, a plain loop without branches.
+ *****************************************************************/
+class NodeSearch
+{
+public:
+
+   // can a node of T ordered by Compare be searched this way?
+   template <typename T, typename Compare>
+   static constexpr bool supports()
+   {
+      return isKey<T>() &&
+             (std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value);
+   }
+
+   // are the searches for T done with vector instructions in this build?
+   template <typename T>
+   static constexpr bool vectorized()
+   {
+#if defined(NODE_SEARCH_AVX2) || defined(NODE_SEARCH_SSE42)
+      return isKey<T>();
+#elif defined(NODE_SEARCH_SSE2)
+      return isKey<T>() && !(std::is_integral<T>::value && sizeof(T) == 8);
+#else
+      return false;
+#endif
+   }
+
+   // how many of the num keys are less than t: where lower_bound is
+   template <typename T>
+   static size_t countLess(const T * keys, size_t num, T t) noexcept
+   {
+      return count<false>(keys, num, t);
+   }
+
+   // how many of the num keys are greater than t: upper_bound is num less this
+   template <typename T>
+   static size_t countGreater(const T * keys, size_t num, T t) noexcept
+   {
+      return count<true>(keys, num, t);
+   }
+
+private:
+
+   template <typename T>
+   static constexpr bool isKey()
+   {
+      return (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+              (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+             std::is_same<T, float>::value || std::is_same<T, double>::value;
+   }
+
+   /*************************************************************
+    * COUNT
+    * The widest kernel this build has for T takes whole
+    * registers; the loop finishes whatever is left over
+    *************************************************************/
+   template <bool Greater, typename T>
+   static size_t count(const T * keys, size_t num, T t) noexcept
+   {
+      size_t i = 0;
+      size_t numFound = 0;
+#if defined(NODE_SEARCH_AVX2)
+      numFound += countAVX2<Greater>(keys, num, t, i);
+#endif
+#if defined(NODE_SEARCH_SSE2)
+      numFound += countSSE<Greater>(keys, num, t, i);
+#endif
+      for (; i < num; i++)
+         numFound += Greater ? (t < keys[i]) : (keys[i] < t);
+      return numFound;
+   }
+
+   /*************************************************************
+    * MATCHED
+    * How many lanes of a compare mask are set. The keys are sorted,
+    * so the set lanes are one run at the bottom (less) or at the top
+    * (greater), and finding where the run ends takes one bit scan,
+    * which every x86 has, where a popcount instruction may not be
+    *************************************************************/
+   template <bool Greater>
+   static size_t matched(uint64_t mask, unsigned width) noexcept
+   {
+      if (Greater)
+         return width - lowestBit(mask | (uint64_t(1) << width));
+      else
+         return lowestBit(~mask);
+   }
+
+   static unsigned lowestBit(uint64_t bits) noexcept
+   {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward64(&index, bits);
+      return (unsigned)index;
+#else
+      return (unsigned)__builtin_ctzll(bits);
+#endif
+   }
+
+#if defined(NODE_SEARCH_AVX2)
+   /*************************************************************
+    * COUNT AVX2
+    * 32 bytes of keys per compare. There are only signed integer
+    * compares, so unsigned keys have their top bit flipped first
+    *************************************************************/
+   template <bool Greater, typename T>
+   static size_t countAVX2(const T * keys, size_t num, T t, size_t & i) noexcept
+   {
+      const size_t lanes = 32 / sizeof(T);
+      size_t numFound = 0;
+      if constexpr (std::is_same<T, float>::value)
+      {
+         __m256 tt = _mm256_set1_ps(t);
+         for (; i + lanes <= num; i += lanes)
+         {
+            __m256 k = _mm256_loadu_ps(keys + i);
+            __m256 mask = Greater ? _mm256_cmp_ps(k, tt, _CMP_GT_OQ) : _mm256_cmp_ps(k, tt, _CMP_LT_OQ);
+            numFound += matched<Greater>((unsigned)_mm256_movemask_ps(mask), 8);
+         }
+      }
+      else if constexpr (std::is_same<T, double>::value)
+      {
+         __m256d tt = _mm256_set1_pd(t);
+         for (; i + lanes <= num; i += lanes)
+         {
+            __m256d k = _mm256_loadu_pd(keys + i);
+            __m256d mask = Greater ? _mm256_cmp_pd(k, tt, _CMP_GT_OQ) : _mm256_cmp_pd(k, tt, _CMP_LT_OQ);
+            numFound += matched<Greater>((unsigned)_mm256_movemask_pd(mask), 4);
+         }
+      }
+      else if constexpr (isKey<T>())
+      {
+         __m256i bias = std::is_signed<T>::value ? _mm256_setzero_si256() : splat256<T>(topBit<T>());
+         __m256i tt = _mm256_xor_si256(splat256<T>(t), bias);
+         for (; i + lanes <= num; i += lanes)
+         {
+            __m256i k = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias);
+            __m256i mask = Greater ? greater256<T>(k, tt) : greater256<T>(tt, k);
+            numFound += matched<Greater>((unsigned)_mm256_movemask_epi8(mask), 32) / sizeof(T);
+         }
+      }
+      return numFound;
+   }
+
+   template <typename T>
+   static __m256i splat256(T t) noexcept
+   {
+      if constexpr (sizeof(T) == 1)
+         return _mm256_set1_epi8((char)t);
+      else if constexpr (sizeof(T) == 2)
+         return _mm256_set1_epi16((short)t);
+      else if constexpr (sizeof(T) == 4)
+         return _mm256_set1_epi32((int)t);
+      else
+         return _mm256_set1_epi64x((long long)t);
+   }
+
+   template <typename T>
+   static __m256i greater256(__m256i lhs, __m256i rhs) noexcept
+   {
+      if constexpr (sizeof(T) == 1)
+         return _mm256_cmpgt_epi8(lhs, rhs);
+      else if constexpr (sizeof(T) == 2)
+         return _mm256_cmpgt_epi16(lhs, rhs);
+      else if constexpr (sizeof(T) == 4)
+         return _mm256_cmpgt_epi32(lhs, rhs);
+      else
+         return _mm256_cmpgt_epi64(lhs, rhs);
+   }
+#endif // NODE_SEARCH_AVX2
+
+#if defined(NODE_SEARCH_SSE2)
+   /*************************************************************
+    * COUNT SSE
+    * 16 bytes of keys per compare. Comparing 64-bit integers
+    * takes SSE4.2; without it they are left to the loop
+    *************************************************************/
+   template <bool Greater, typename T>
+   static size_t countSSE(const T * keys, size_t num, T t, size_t & i) noexcept
+   {
+      const size_t lanes = 16 / sizeof(T);
+      size_t numFound = 0;
+      if constexpr (std::is_same<T, float>::value)
+      {
+         __m128 tt = _mm_set1_ps(t);
+         for (; i + lanes <= num; i += lanes)
+         {
+            __m128 k = _mm_loadu_ps(keys + i);
+            __m128 mask = Greater ? _mm_cmpgt_ps(k, tt) : _mm_cmplt_ps(k, tt);
+            numFound += matched<Greater>((unsigned)_mm_movemask_ps(mask), 4);
+         }
+      }
+      else if constexpr (std::is_same<T, double>::value)
+      {
+         __m128d tt = _mm_set1_pd(t);
+         for (; i + lanes <= num; i += lanes)
+         {
+            __m128d k = _mm_loadu_pd(keys + i);
+            __m128d mask = Greater ? _mm_cmpgt_pd(k, tt) : _mm_cmplt_pd(k, tt);
+            numFound += matched<Greater>((unsigned)_mm_movemask_pd(mask), 2);
+         }
+      }
+      else if constexpr (isKey<T>())
+      {
+#if !defined(NODE_SEARCH_SSE42)
+         if constexpr (sizeof(T) == 8)
+            return 0;
+         else
+#endif
+         {
+            __m128i bias = std::is_signed<T>::value ? _mm_setzero_si128() : splat128<T>(topBit<T>());
+            __m128i tt = _mm_xor_si128(splat128<T>(t), bias);
+            for (; i + lanes <= num; i += lanes)
+            {
+               __m128i k = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), bias);
+               __m128i mask = Greater ? greater128<T>(k, tt) : greater128<T>(tt, k);
+               numFound += matched<Greater>((unsigned)_mm_movemask_epi8(mask), 16) / sizeof(T);
+            }
+         }
+      }
+      return numFound;
+   }
+
+   template <typename T>
+   static __m128i splat128(T t) noexcept
+   {
+      if constexpr (sizeof(T) == 1)
+         return _mm_set1_epi8((char)t);
+      else if constexpr (sizeof(T) == 2)
+         return _mm_set1_epi16((short)t);
+      else if constexpr (sizeof(T) == 4)
+         return _mm_set1_epi32((int)t);
+      else
+         return _mm_set1_epi64x((long long)t);
+   }
+
+   template <typename T>
+   static __m128i greater128(__m128i lhs, __m128i rhs) noexcept
+   {
+      if constexpr (sizeof(T) == 1)
+         return _mm_cmpgt_epi8(lhs, rhs);
+      else if constexpr (sizeof(T) == 2)
+         return _mm_cmpgt_epi16(lhs, rhs);
+      else if constexpr (sizeof(T) == 4)
+         return _mm_cmpgt_epi32(lhs, rhs);
+#if defined(NODE_SEARCH_SSE42)
+      else
+         return _mm_cmpgt_epi64(lhs, rhs);
+#else
+      else
+         return lhs;   // never used: 64-bit keys go to the loop
+#endif
+   }
+#endif // NODE_SEARCH_SSE2
+
+   // the sign bit of an integer the size of T
+   template <typename T>
+   static constexpr T topBit() noexcept
+   {
+      return (T)((typename std::make_unsigned<T>::type)1 << (sizeof(T) * 8 - 1));
+   }
+};
+
+} // namespace custom
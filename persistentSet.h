@@ -0,0 +1,753 @@
+/***********************************************************************
+ * Header:
+ *    PERSISTENT SET
+ * Summary:
+ *    An immutable red-black set: insert and erase give back a new
+ *    version that shares every node they did not have to change
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        pset                : An ordered set that never changes
+ *        pset::iterator      : An iterator through the set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include "bst.h"             // for from_sorted
+#include <algorithm>         // for std::stable_sort, std::unique
+#include <atomic>            // for std::atomic
+#include <cstddef>           // for size_t and ptrdiff_t
+#include <cstdint>           // for uint32_t
+#include <functional>        // for std::less
+#include <initializer_list>  // for std::initializer_list
+#include <iterator>          // for std::bidirectional_iterator_tag, std::reverse_iterator
+#include <utility>           // for std::pair, std::move, std::swap
+#include <vector>            // for std::vector
+
+class TestPersistentSet;    // forward declaration for unit tests
+class BenchPersistentSet;   // forward declaration for benchmarks
+
+namespace custom
+{
+
+/*****************************************************************
+ * PSET
+ * A set that is never changed once built. insert() and erase()
+ * leave this version alone and return another. They copy only the
+ * nodes on the path from the root down to the change, plus the few
+ * that rebalancing touches: O(log n) new nodes. The new version
+ * points at every other subtree of the old one. Copying a pset is
+ * O(1), so keeping many versions of one large set costs little
+ * more than keeping one.
+ *
+ * Nodes are reference counted. A node goes away when the last
+ * version or node that points to it does. The counts are atomic, so
+ * versions can be read, copied, and dropped on any thread without a
+ * lock.
+ *
+ * There are no parent pointers, since a shared node has a different
+ * parent in each version. The balancing is done functionally on the
+ * way back up, as in Kahrs' red-black trees, and an iterator keeps
+ * the path from the root to where it is.
+ *****************************************************************/
+template <typename T, typename Compare = std::less<T>>
+class pset
+{
+   friend class ::TestPersistentSet;  // give unit tests access to the privates
+   friend class ::BenchPersistentSet; // and benchmarks
+
+   class Node;
+   class NodePtr;
+
+public:
+
+   //
+   // Construct
+   //
+
+   pset() : pset(Compare()) { }
+   explicit pset(const Compare & compare) : root(), numElements(0), compare(compare) { }
+   pset(const pset & rhs) = default;
+   pset(pset && rhs) noexcept :
+      root(std::move(rhs.root)), numElements(rhs.numElements), compare(rhs.compare)
+   {
+      rhs.numElements = 0;
+   }
+   pset(const std::initializer_list<T> & il, const Compare & compare = Compare()) :
+      pset(il.begin(), il.end(), compare) { }
+   template <class Iterator>
+   pset(Iterator first, Iterator last, const Compare & compare = Compare());
+   template <class Iterator>
+   pset(from_sorted_t, Iterator first, Iterator last, const Compare & compare = Compare());
+
+   //
+   // Assign: which version this names, not what is in it
+   //
+
+   pset & operator = (const pset & rhs) = default;
+   pset & operator = (pset && rhs) noexcept
+   {
+      root = std::move(rhs.root);
+      numElements = rhs.numElements;
+      compare = rhs.compare;
+      rhs.numElements = 0;
+      return *this;
+   }
+   void swap(pset & rhs) noexcept
+   {
+      std::swap(root, rhs.root);
+      std::swap(numElements, rhs.numElements);
+      std::swap(compare, rhs.compare);
+   }
+   void clear() noexcept
+   {
+      root = NodePtr();
+      numElements = 0;
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+   iterator begin() const noexcept;
+   iterator last()  const noexcept;
+   iterator end()   const noexcept { return iterator(root.get()); }
+   reverse_iterator rbegin() const noexcept { return reverse_iterator(end());   }
+   reverse_iterator rend()   const noexcept { return reverse_iterator(begin()); }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const
+   {
+      iterator it = lower_bound(t);
+      return (it != end() && !compare(t, *it)) ? it : end();
+   }
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const;
+   size_t   count   (const T & t) const { return contains(t) ? 1 : 0; }
+   bool     contains(const T & t) const;
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return numElements == 0; }
+   size_t size()  const noexcept { return numElements; }
+
+   // how many psets share this version, 0 when it is empty
+   size_t use_count() const noexcept
+   {
+      return root ? root->numRefs.load(std::memory_order_relaxed) : 0;
+   }
+
+   //
+   // New versions: this one is left as it was
+   //
+
+   pset insert(const T & t) const;
+   pset erase (const T & t) const;
+
+private:
+
+   /**************************************************
+    * NODE PTR
+    * One counted reference to a node. Copying one adds
+    * a reference and destroying one drops it, so a
+    * subtree lives as long as anything points to it
+    *************************************************/
+   class NodePtr
+   {
+   public:
+      NodePtr() noexcept : p(nullptr) { }
+      explicit NodePtr(Node * p) noexcept : p(p) { }   // adopts a new node's first reference
+      NodePtr(const NodePtr & rhs) noexcept : p(rhs.p) { retain(); }
+      NodePtr(NodePtr && rhs) noexcept : p(rhs.p) { rhs.p = nullptr; }
+      ~NodePtr() { release(); }
+      NodePtr & operator = (NodePtr rhs) noexcept
+      {
+         std::swap(p, rhs.p);
+         return *this;
+      }
+
+      Node * operator -> () const noexcept { return p; }
+      Node * get() const noexcept { return p; }
+      explicit operator bool () const noexcept { return p != nullptr; }
+
+   private:
+      void retain() noexcept
+      {
+         if (p)
+            p->numRefs.fetch_add(1, std::memory_order_relaxed);
+      }
+      // the last one out sees every write made through the others
+      void release() noexcept
+      {
+         if (p && p->numRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete p;
+      }
+
+      Node * p;
+   };
+
+   /**************************************************
+    * NODE
+    * The element and its color first, so a small T
+    * packs beside them. 32 bits of count is room for
+    * more parents than fit in memory
+    *************************************************/
+   class Node
+   {
+   public:
+      Node(NodePtr pLeft, const T & t, NodePtr pRight, bool isRed) :
+         data(t), isRed(isRed), numRefs(1), pLeft(std::move(pLeft)), pRight(std::move(pRight)) { }
+
+      const T data;
+      bool isRed;                       // only ever changed before the node is shared
+      std::atomic<uint32_t> numRefs;
+      const NodePtr pLeft;
+      const NodePtr pRight;
+   };
+
+   //
+   // Make nodes
+   //
+
+   static NodePtr red  (NodePtr a, const T & x, NodePtr b)
+   {
+      return NodePtr(new Node(std::move(a), x, std::move(b), true));
+   }
+   static NodePtr black(NodePtr a, const T & x, NodePtr b)
+   {
+      return NodePtr(new Node(std::move(a), x, std::move(b), false));
+   }
+   static bool isRed  (const NodePtr & n) noexcept { return n && n->isRed;  }
+   static bool isBlack(const NodePtr & n) noexcept { return n && !n->isRed; }   // a node, not nil
+   static NodePtr blacken(NodePtr n);
+   static NodePtr build(const std::vector <T> & elements);
+   static NodePtr build(const T * p, size_t num, int depth, int redDepth);
+
+   //
+   // Rebalance
+   //
+
+   static NodePtr balance (const NodePtr & a, const T & x, const NodePtr & b);
+   static NodePtr balanceLeft (const NodePtr & a, const T & x, const NodePtr & b);
+   static NodePtr balanceRight(const NodePtr & a, const T & x, const NodePtr & b);
+   static NodePtr redden(const NodePtr & n);
+   static NodePtr join(const NodePtr & a, const NodePtr & b);
+
+   //
+   // Insert and erase below n
+   //
+
+   NodePtr insertBelow(const NodePtr & n, const T & t) const;
+   NodePtr eraseBelow (const NodePtr & n, const T & t) const;
+
+   NodePtr  root;          // nil when empty
+   size_t   numElements;
+   Compare  compare;
+};
+
+/**************************************************
+ * PSET ITERATOR
+ * Nodes have no parent pointer, so the iterator
+ * keeps every node from the root down to the one
+ * it is on. A red-black tree is at most twice as
+ * deep as a full one, which bounds the path
+ *************************************************/
+template <typename T, typename Compare>
+class pset <T, Compare> :: iterator
+{
+   friend class ::TestPersistentSet; // give unit tests access to the privates
+   friend class custom::pset<T, Compare>;
+public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
+   // constructors, destructors, and assignment operator
+   iterator() : pRoot(nullptr), depth(0) { }
+   iterator(const iterator & rhs) : pRoot(rhs.pRoot), depth(rhs.depth)
+   {
+      for (int i = 0; i < depth; i++)
+         path[i] = rhs.path[i];
+   }
+   iterator & operator = (const iterator & rhs)
+   {
+      pRoot = rhs.pRoot;
+      depth = rhs.depth;
+      for (int i = 0; i < depth; i++)
+         path[i] = rhs.path[i];
+      return *this;
+   }
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const { return current() == rhs.current(); }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs); }
+
+   // dereference operator
+   const T & operator * () const { return current()->data; }
+   const T * operator -> () const { return &current()->data; }
+
+   // prefix increment: the smallest on the right, or
+   // up to the first ancestor we are to the left of
+   iterator & operator ++ ()
+   {
+      const Node * p = current();
+      if (p->pRight)
+         pushLeft(p->pRight.get());
+      else
+      {
+         depth--;
+         while (depth > 0 && path[depth - 1]->pRight.get() == p)
+            p = path[--depth];
+      }
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld = *this;
+      ++(*this);
+      return itOld;
+   }
+
+   // prefix decrement: back from end() is the largest
+   iterator & operator -- ()
+   {
+      const Node * p = current();
+      if (p == nullptr)
+         pushRight(pRoot);
+      else if (p->pLeft)
+         pushRight(p->pLeft.get());
+      else
+      {
+         depth--;
+         while (depth > 0 && path[depth - 1]->pLeft.get() == p)
+            p = path[--depth];
+      }
+      return *this;
+   }
+
+   // postfix decrement
+   iterator operator -- (int postfix)
+   {
+      iterator itOld = *this;
+      --(*this);
+      return itOld;
+   }
+
+private:
+   static const int maxDepth = 2 * 8 * sizeof(size_t);
+
+   explicit iterator(const Node * pRoot) : pRoot(pRoot), depth(0) { }
+
+   const Node * current() const noexcept { return depth ? path[depth - 1] : nullptr; }
+   void push(const Node * p) noexcept { path[depth++] = p; }
+   void pushLeft(const Node * p) noexcept
+   {
+      for (; p; p = p->pLeft.get())
+         push(p);
+   }
+   void pushRight(const Node * p) noexcept
+   {
+      for (; p; p = p->pRight.get())
+         push(p);
+   }
+
+   const Node * pRoot;
+   const Node * path[maxDepth];
+   int depth;                     // 0 is end()
+};
+
+/*********************************************
+ * PSET :: RANGE CONSTRUCTOR
+ * Sort, keep the first of each run of equals,
+ * and build a balanced tree in one pass
+ ********************************************/
+template <typename T, typename Compare>
+template <class Iterator>
+pset <T, Compare> :: pset(Iterator first, Iterator last, const Compare & compare) :
+   root(), numElements(0), compare(compare)
+{
+   std::vector <T> elements(first, last);
+   std::stable_sort(elements.begin(), elements.end(), compare);
+   elements.erase(std::unique(elements.begin(), elements.end(),
+                              [&compare](const T & lhs, const T & rhs)
+                              {
+                                 return !compare(lhs, rhs) && !compare(rhs, lhs);
+                              }),
+                  elements.end());
+   root = build(elements);
+   numElements = elements.size();
+}
+
+/*********************************************
+ * PSET :: FROM SORTED CONSTRUCTOR
+ * The range is already ascending with no two
+ * equal, as a set's is: build without sorting
+ ********************************************/
+template <typename T, typename Compare>
+template <class Iterator>
+pset <T, Compare> :: pset(from_sorted_t, Iterator first, Iterator last, const Compare & compare) :
+   root(), numElements(0), compare(compare)
+{
+   std::vector <T> elements;
+   for (; first != last; ++first)
+      elements.push_back(*first);
+   root = build(elements);
+   numElements = elements.size();
+}
+
+/*********************************************
+ * PSET :: BUILD
+ * A balanced tree of sorted, unique elements.
+ * A full tree is all black; otherwise the
+ * partial bottom row is red
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: build(const std::vector <T> & elements)
+{
+   size_t num = elements.size();
+   int redDepth = -1;
+   if ((num & (num + 1)) != 0)
+      for (size_t n = num; n > 0; n >>= 1)
+         redDepth++;
+   return build(elements.data(), num, 0, redDepth);
+}
+
+/*********************************************
+ * PSET :: BUILD
+ * The middle element over a tree of each half
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: build(const T * p, size_t num, int depth, int redDepth)
+{
+   if (num == 0)
+      return NodePtr();
+   size_t middle = num / 2;
+   NodePtr pLeft = build(p, middle, depth + 1, redDepth);
+   NodePtr pRight = build(p + middle + 1, num - middle - 1, depth + 1, redDepth);
+   return NodePtr(new Node(std::move(pLeft), p[middle], std::move(pRight), depth == redDepth));
+}
+
+/*********************************************
+ * PSET :: BEGIN and LAST
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: iterator
+pset <T, Compare> :: begin() const noexcept
+{
+   iterator it(root.get());
+   it.pushLeft(root.get());
+   return it;
+}
+
+template <typename T, typename Compare>
+typename pset <T, Compare> :: iterator
+pset <T, Compare> :: last() const noexcept
+{
+   iterator it(root.get());
+   it.pushRight(root.get());
+   return it;
+}
+
+/*********************************************
+ * PSET :: LOWER BOUND
+ * Walk down keeping the path; the bound is the
+ * last node we went left from, and the path up
+ * to it is its ancestors
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: iterator
+pset <T, Compare> :: lower_bound(const T & t) const
+{
+   iterator it(root.get());
+   int depthBound = 0;
+   for (const Node * p = root.get(); p; )
+   {
+      it.push(p);
+      if (compare(p->data, t))
+         p = p->pRight.get();
+      else
+      {
+         depthBound = it.depth;
+         p = p->pLeft.get();
+      }
+   }
+   it.depth = depthBound;
+   return it;
+}
+
+/*********************************************
+ * PSET :: UPPER BOUND
+ * As lower_bound, for the first after t
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: iterator
+pset <T, Compare> :: upper_bound(const T & t) const
+{
+   iterator it(root.get());
+   int depthBound = 0;
+   for (const Node * p = root.get(); p; )
+   {
+      it.push(p);
+      if (compare(t, p->data))
+      {
+         depthBound = it.depth;
+         p = p->pLeft.get();
+      }
+      else
+         p = p->pRight.get();
+   }
+   it.depth = depthBound;
+   return it;
+}
+
+/*********************************************
+ * PSET :: CONTAINS
+ * A plain search, without keeping the path
+ ********************************************/
+template <typename T, typename Compare>
+bool pset <T, Compare> :: contains(const T & t) const
+{
+   const Node * p = root.get();
+   while (p)
+   {
+      if (compare(t, p->data))
+         p = p->pLeft.get();
+      else if (compare(p->data, t))
+         p = p->pRight.get();
+      else
+         return true;
+   }
+   return false;
+}
+
+/*********************************************
+ * PSET :: INSERT
+ * A new version with t in it, or this version
+ * again if t was already there
+ ********************************************/
+template <typename T, typename Compare>
+pset <T, Compare> pset <T, Compare> :: insert(const T & t) const
+{
+   if (contains(t))
+      return *this;
+   pset s(compare);
+   s.root = blacken(insertBelow(root, t));
+   s.numElements = numElements + 1;
+   return s;
+}
+
+/*********************************************
+ * PSET :: ERASE
+ * A new version without t, or this version
+ * again if t was not there
+ ********************************************/
+template <typename T, typename Compare>
+pset <T, Compare> pset <T, Compare> :: erase(const T & t) const
+{
+   if (!contains(t))
+      return *this;
+   pset s(compare);
+   s.root = blacken(eraseBelow(root, t));
+   s.numElements = numElements - 1;
+   return s;
+}
+
+/*********************************************
+ * PSET :: INSERT BELOW
+ * A copy of the path down to where t goes, with
+ * t there as a red leaf. A black node on the way
+ * back up fixes a red child with a red child
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: insertBelow(const NodePtr & n, const T & t) const
+{
+   if (!n)
+      return red(NodePtr(), t, NodePtr());
+   if (compare(t, n->data))
+   {
+      NodePtr pLeft = insertBelow(n->pLeft, t);
+      return n->isRed ? red(std::move(pLeft), n->data, n->pRight) : balance(pLeft, n->data, n->pRight);
+   }
+   NodePtr pRight = insertBelow(n->pRight, t);
+   return n->isRed ? red(n->pLeft, n->data, std::move(pRight)) : balance(n->pLeft, n->data, pRight);
+}
+
+/*********************************************
+ * PSET :: ERASE BELOW
+ * A copy of the path down to t, with t's two
+ * subtrees joined in its place. Taking a black
+ * node out of a side leaves it one black short,
+ * which balanceLeft and balanceRight make up
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: eraseBelow(const NodePtr & n, const T & t) const
+{
+   if (!n)
+      return NodePtr();
+   if (compare(t, n->data))
+   {
+      NodePtr pLeft = eraseBelow(n->pLeft, t);
+      return isBlack(n->pLeft) ? balanceLeft(pLeft, n->data, n->pRight)
+                               : red(std::move(pLeft), n->data, n->pRight);
+   }
+   if (compare(n->data, t))
+   {
+      NodePtr pRight = eraseBelow(n->pRight, t);
+      return isBlack(n->pRight) ? balanceRight(n->pLeft, n->data, pRight)
+                                : red(n->pLeft, n->data, std::move(pRight));
+   }
+   return join(n->pLeft, n->pRight);
+}
+
+/*********************************************
+ * PSET :: BALANCE
+ * A black node over a and b, where one of them
+ * may be red with a red child. Any such pair is
+ * rotated into a red node with two black ones
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: balance(const NodePtr & a, const T & x, const NodePtr & b)
+{
+   if (isRed(a) && isRed(b))
+      return red(black(a->pLeft, a->data, a->pRight), x,
+                 black(b->pLeft, b->data, b->pRight));
+   if (isRed(a) && isRed(a->pLeft))
+      return red(black(a->pLeft->pLeft, a->pLeft->data, a->pLeft->pRight), a->data,
+                 black(a->pRight, x, b));
+   if (isRed(a) && isRed(a->pRight))
+      return red(black(a->pLeft, a->data, a->pRight->pLeft), a->pRight->data,
+                 black(a->pRight->pRight, x, b));
+   if (isRed(b) && isRed(b->pRight))
+      return red(black(a, x, b->pLeft), b->data,
+                 black(b->pRight->pLeft, b->pRight->data, b->pRight->pRight));
+   if (isRed(b) && isRed(b->pLeft))
+      return red(black(a, x, b->pLeft->pLeft), b->pLeft->data,
+                 black(b->pLeft->pRight, b->data, b->pRight));
+   return black(a, x, b);
+}
+
+/*********************************************
+ * PSET :: BALANCE LEFT
+ * a is one black short of b. Blacken a if it is
+ * red; otherwise take one from b's side
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: balanceLeft(const NodePtr & a, const T & x, const NodePtr & b)
+{
+   if (isRed(a))
+      return red(black(a->pLeft, a->data, a->pRight), x, b);
+   if (isBlack(b))
+      return balance(a, x, red(b->pLeft, b->data, b->pRight));
+   // b is red, so its left child is black
+   return red(black(a, x, b->pLeft->pLeft), b->pLeft->data,
+              balance(b->pLeft->pRight, b->data, redden(b->pRight)));
+}
+
+/*********************************************
+ * PSET :: BALANCE RIGHT
+ * The mirror: b is one black short of a
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: balanceRight(const NodePtr & a, const T & x, const NodePtr & b)
+{
+   if (isRed(b))
+      return red(a, x, black(b->pLeft, b->data, b->pRight));
+   if (isBlack(a))
+      return balance(red(a->pLeft, a->data, a->pRight), x, b);
+   // a is red, so its right child is black
+   return red(balance(redden(a->pLeft), a->data, a->pRight->pLeft), a->pRight->data,
+              black(a->pRight->pRight, x, b));
+}
+
+/*********************************************
+ * PSET :: REDDEN
+ * A black node turned red, one black shorter
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: redden(const NodePtr & n)
+{
+   return red(n->pLeft, n->data, n->pRight);
+}
+
+/*********************************************
+ * PSET :: BLACKEN
+ * The root is always black. A node nothing else
+ * points to yet is recolored rather than copied
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: blacken(NodePtr n)
+{
+   if (!isRed(n))
+      return n;
+   if (n->numRefs.load(std::memory_order_relaxed) == 1)
+   {
+      n->isRed = false;
+      return n;
+   }
+   return black(n->pLeft, n->data, n->pRight);
+}
+
+/*********************************************
+ * PSET :: JOIN
+ * One tree of a's elements then b's, where a
+ * and b have the same black height. It comes out
+ * one black shorter when both roots are black
+ ********************************************/
+template <typename T, typename Compare>
+typename pset <T, Compare> :: NodePtr
+pset <T, Compare> :: join(const NodePtr & a, const NodePtr & b)
+{
+   if (!a)
+      return b;
+   if (!b)
+      return a;
+   if (isRed(a) && isRed(b))
+   {
+      NodePtr middle = join(a->pRight, b->pLeft);
+      if (isRed(middle))
+         return red(red(a->pLeft, a->data, middle->pLeft), middle->data,
+                    red(middle->pRight, b->data, b->pRight));
+      return red(a->pLeft, a->data, red(middle, b->data, b->pRight));
+   }
+   if (!isRed(a) && !isRed(b))
+   {
+      NodePtr middle = join(a->pRight, b->pLeft);
+      if (isRed(middle))
+         return red(black(a->pLeft, a->data, middle->pLeft), middle->data,
+                    black(middle->pRight, b->data, b->pRight));
+      return balanceLeft(a->pLeft, a->data, black(middle, b->data, b->pRight));
+   }
+   if (isRed(b))
+      return red(join(a, b->pLeft), b->data, b->pRight);
+   return red(a->pLeft, a->data, join(a->pRight, b));
+}
+
+} // namespace custom
@@ -0,0 +1,519 @@
+/***********************************************************************
+ * Header:
+ *    POOL
+ * Summary:
+ *    A slab allocator for the nodes of our node-based containers
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        Pool                : A class that hands out nodes carved from slabs
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>  // for std::upper_bound, std::merge and std::unique
+#include <atomic>     // for std::atomic
+#include <cstddef>    // for size_t
+#include <new>        // for placement new and ::operator new
+#include <utility>    // for std::forward
+#include <iterator>   // for std::back_inserter
+#include <vector>     // for std::vector
+
+class TestPool; // forward declaration for unit tests
+class TestBST;
+
+namespace custom
+{
+
+/*****************************************************************
+ * POOL
+ * Nodes are carved out of large slabs rather than allocated one
+ * at a time. Destroyed nodes go on a free list and are handed out
+ * again before any new slab is touched. The slabs themselves are
+ * only returned to the system all at once with release().
+ *
+ * A node may also leave for another pool without being copied.
+ * Every slab counts the pools and node handles that hold it, and
+ * goes back to the system when the last of them lets go. A pool
+ * takes a hold only on the slabs its nodes came from. A node
+ * destroyed outside any pool hands its slot back to its slab, and
+ * the next pool to run out of room there picks it up.
+ *****************************************************************/
+template <typename T>
+class Pool
+{
+   friend class ::TestPool; // give unit tests access to the privates
+   friend class ::TestBST;
+   struct Slab;
+public:
+   // a hold on the one slab a node out of every pool lives in
+   class Lease;
+
+   //
+   // Construct
+   //
+
+   Pool() : pFree(nullptr), pNext(nullptr), pLast(nullptr),
+            numSlots(0), numLive(0) { }
+   Pool(Pool && rhs) noexcept : Pool() { swap(rhs); }
+   Pool(const Pool & rhs) = delete;
+   ~Pool() { release(); }
+
+   //
+   // Assign
+   //
+
+   Pool & operator = (Pool && rhs) noexcept
+   {
+      release();
+      swap(rhs);
+      return *this;
+   }
+   Pool & operator = (const Pool & rhs) = delete;
+   void swap(Pool & rhs) noexcept;
+
+   //
+   // Allocate
+   //
+
+   template <class ... Args>
+   T * construct(Args && ... args);
+   void destroy(T * p) noexcept;
+   static void destroy(T * p, Lease && lease) noexcept;
+   void reserve(size_t num);
+
+   //
+   // Lend
+   //
+
+   Lease lend(T * p) noexcept;          // p leaves for a node handle
+   void  keep(Lease && lease);          // a node handle's node moves in
+   void  take(Pool & rhs, T * p);       // p moves in from rhs
+   void  keep(const Pool & rhs);        // any node of rhs may move in
+   void  disown(size_t num = 1) noexcept { numLive -= num; }  // nodes left for another pool
+   void  adopt (size_t num = 1) noexcept { numLive += num; }  // nodes came from another pool
+
+   //
+   // Remove
+   //
+
+   void release() noexcept;
+
+   //
+   // Status
+   //
+
+   size_t capacity() const noexcept { return numSlots; }
+   size_t live()     const noexcept { return numLive;  }
+
+private:
+
+   // a free slot either holds a T or is a link in the free list
+   union Slot
+   {
+      Slot * pNextFree;
+      alignas(T) unsigned char storage[sizeof(T)];
+   };
+
+   // a slab is a header followed by an array of slots
+   struct Slab
+   {
+      std::atomic<size_t> numRefs;     // pools and leases holding it
+      std::atomic<Slot *> pReturned;   // slots handed back from outside any pool
+      size_t numSlots;
+
+      void giveBack(Slot * pSlot) noexcept;
+   };
+
+   static const size_t minSlab = 16;     // first slab holds this many nodes
+   static const size_t maxSlab = 65536;  // slabs stop doubling here
+   static const size_t header = (sizeof(Slab) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+   void * allocate();
+   void   grow(size_t num);
+   bool   reclaim() noexcept;
+   Slab * find(const void * p) const noexcept;
+   void   hold(Slab * pSlab);
+   static void unref(Slab * pSlab) noexcept;
+   static Slot * first(Slab * pSlab) noexcept
+   {
+      return reinterpret_cast<Slot *>(reinterpret_cast<unsigned char *>(pSlab) + header);
+   }
+
+   std::vector<Slab *> slabs;   // every slab we hold, in address order
+   Slot * pFree;                // nodes that were destroyed and can be recycled
+   Slot * pNext;                // next never-used slot in the newest slab
+   Slot * pLast;                // one past the last slot in the newest slab
+   size_t numSlots;             // total slots across the slabs we made
+   size_t numLive;              // slots currently holding a T
+};
+
+/*********************************************
+ * POOL LEASE
+ * Keeps one slab alive; lets go when destroyed
+ ********************************************/
+template <typename T>
+class Pool <T> :: Lease
+{
+   friend class Pool <T>;
+   friend class ::TestPool;
+public:
+   Lease() noexcept : pSlab(nullptr) { }
+   Lease(Lease && rhs) noexcept : pSlab(rhs.pSlab) { rhs.pSlab = nullptr; }
+   Lease & operator = (Lease && rhs) noexcept
+   {
+      if (this != &rhs)
+      {
+         reset();
+         pSlab = rhs.pSlab;
+         rhs.pSlab = nullptr;
+      }
+      return *this;
+   }
+   Lease(const Lease & rhs) = delete;
+   Lease & operator = (const Lease & rhs) = delete;
+   ~Lease() { reset(); }
+
+   void swap(Lease & rhs) noexcept { std::swap(pSlab, rhs.pSlab); }
+   void reset() noexcept
+   {
+      if (pSlab)
+         unref(pSlab);
+      pSlab = nullptr;
+   }
+
+private:
+   explicit Lease(Slab * pSlab) noexcept : pSlab(pSlab) { }
+   Slab * pSlab;
+};
+
+/*********************************************
+ * POOL :: SWAP
+ * Trade slabs and free lists with another pool
+ ********************************************/
+template <typename T>
+void Pool <T> :: swap(Pool <T> & rhs) noexcept
+{
+   slabs.swap(rhs.slabs);
+   std::swap(pFree,    rhs.pFree);
+   std::swap(pNext,    rhs.pNext);
+   std::swap(pLast,    rhs.pLast);
+   std::swap(numSlots, rhs.numSlots);
+   std::swap(numLive,  rhs.numLive);
+}
+
+/*********************************************
+ * POOL :: CONSTRUCT
+ * Build a new T in a recycled or fresh slot
+ ********************************************/
+template <typename T>
+template <class ... Args>
+T * Pool <T> :: construct(Args && ... args)
+{
+   void * p = allocate();
+   try
+   {
+      T * pNew = new (p) T(std::forward<Args>(args)...);
+      numLive++;
+      return pNew;
+   }
+   catch (...)
+   {
+      // hand the slot back so nothing leaks
+      Slot * pSlot = static_cast<Slot *>(p);
+      pSlot->pNextFree = pFree;
+      pFree = pSlot;
+      throw;
+   }
+}
+
+/*********************************************
+ * POOL :: DESTROY
+ * Destroy a T and put its slot on the free list
+ ********************************************/
+template <typename T>
+void Pool <T> :: destroy(T * p) noexcept
+{
+   if (p == nullptr)
+      return;
+   p->~T();
+   Slot * pSlot = reinterpret_cast<Slot *>(p);
+   pSlot->pNextFree = pFree;
+   pFree = pSlot;
+   numLive--;
+}
+
+/*********************************************
+ * POOL :: DESTROY with a LEASE
+ * Destroy a T that is in no pool, and give its
+ * slot back to its slab before letting go of it
+ ********************************************/
+template <typename T>
+void Pool <T> :: destroy(T * p, Lease && lease) noexcept
+{
+   p->~T();
+   lease.pSlab->giveBack(reinterpret_cast<Slot *>(p));
+   lease.reset();
+}
+
+/*********************************************
+ * POOL :: RESERVE
+ * Make sure there is room for num more nodes
+ * without touching the system allocator
+ ********************************************/
+template <typename T>
+void Pool <T> :: reserve(size_t num)
+{
+   reclaim();
+   size_t numAvailable = static_cast<size_t>(pLast - pNext);
+   for (Slot * p = pFree; p && numAvailable < num; p = p->pNextFree)
+      numAvailable++;
+   if (numAvailable < num)
+      grow(num - numAvailable);
+}
+
+/*********************************************
+ * POOL :: RELEASE
+ * Let go of every slab at once. Any T still
+ * living in them must already have been destroyed
+ * or moved to another pool. Free slots in slabs
+ * someone else still holds are given back to them
+ ********************************************/
+template <typename T>
+void Pool <T> :: release() noexcept
+{
+   bool shared = false;
+   for (Slab * pSlab : slabs)
+      shared = shared || pSlab->numRefs.load() > 1;
+   if (shared)
+   {
+      while (pNext != pLast)
+      {
+         Slot * p = pNext++;
+         p->pNextFree = pFree;
+         pFree = p;
+      }
+      while (pFree)
+      {
+         Slot * pSlot = pFree;
+         pFree = pFree->pNextFree;
+         Slab * pSlab = find(pSlot);
+         if (pSlab->numRefs.load() > 1)
+            pSlab->giveBack(pSlot);
+      }
+   }
+
+   for (Slab * pSlab : slabs)
+      unref(pSlab);
+   slabs.clear();
+   pFree = pNext = pLast = nullptr;
+   numSlots = numLive = 0;
+}
+
+/*********************************************
+ * POOL :: LEND
+ * p is about to leave for a node handle: hold
+ * its slab for as long as the handle has it
+ ********************************************/
+template <typename T>
+typename Pool <T> :: Lease Pool <T> :: lend(T * p) noexcept
+{
+   Slab * pSlab = find(p);
+   pSlab->numRefs++;
+   numLive--;
+   return Lease(pSlab);
+}
+
+/*********************************************
+ * POOL :: KEEP a LEASE
+ * A node handle's node moves in: its hold on the
+ * slab becomes ours, unless we already have one
+ ********************************************/
+template <typename T>
+void Pool <T> :: keep(Lease && lease)
+{
+   auto it = std::upper_bound(slabs.begin(), slabs.end(), lease.pSlab);
+   if (it != slabs.begin() && *(it - 1) == lease.pSlab)
+      lease.reset();
+   else
+   {
+      slabs.insert(it, lease.pSlab);
+      lease.pSlab = nullptr;
+   }
+   numLive++;
+}
+
+/*********************************************
+ * POOL :: TAKE
+ * p moves in from rhs: hold its slab too
+ ********************************************/
+template <typename T>
+void Pool <T> :: take(Pool & rhs, T * p)
+{
+   hold(rhs.find(p));
+   rhs.numLive--;
+   numLive++;
+}
+
+/*********************************************
+ * POOL :: KEEP a POOL
+ * Any number of rhs's nodes may move in, too many
+ * to look up one by one: hold every slab it does
+ ********************************************/
+template <typename T>
+void Pool <T> :: keep(const Pool & rhs)
+{
+   std::vector<Slab *> both;
+   both.reserve(slabs.size() + rhs.slabs.size());
+   std::merge(slabs.begin(), slabs.end(), rhs.slabs.begin(), rhs.slabs.end(),
+              std::back_inserter(both));
+   both.erase(std::unique(both.begin(), both.end()), both.end());
+   for (Slab * pSlab : rhs.slabs)
+      if (!std::binary_search(slabs.begin(), slabs.end(), pSlab))
+         pSlab->numRefs++;
+   slabs.swap(both);
+}
+
+/*********************************************
+ * POOL :: HOLD
+ * Add pSlab to the slabs we hold, once
+ ********************************************/
+template <typename T>
+void Pool <T> :: hold(Slab * pSlab)
+{
+   auto it = std::upper_bound(slabs.begin(), slabs.end(), pSlab);
+   if (it != slabs.begin() && *(it - 1) == pSlab)
+      return;
+   slabs.insert(it, pSlab);
+   pSlab->numRefs++;
+}
+
+/*********************************************
+ * POOL :: FIND
+ * The slab p is in. It must be one we hold
+ ********************************************/
+template <typename T>
+typename Pool <T> :: Slab * Pool <T> :: find(const void * p) const noexcept
+{
+   auto it = std::upper_bound(slabs.begin(), slabs.end(), p,
+      [](const void * p, const Slab * pSlab) { return p < static_cast<const void *>(pSlab); });
+   return *(it - 1);
+}
+
+/*********************************************
+ * POOL :: UNREF
+ * Let go of a slab; the last one out frees it
+ ********************************************/
+template <typename T>
+void Pool <T> :: unref(Slab * pSlab) noexcept
+{
+   if (pSlab->numRefs.fetch_sub(1) == 1)
+   {
+      pSlab->~Slab();
+      ::operator delete(static_cast<void *>(pSlab));
+   }
+}
+
+/*********************************************
+ * POOL :: SLAB :: GIVE BACK
+ * A slot freed outside any pool goes on the
+ * slab's own list, from any thread
+ ********************************************/
+template <typename T>
+void Pool <T> :: Slab :: giveBack(Slot * pSlot) noexcept
+{
+   Slot * pHead = pReturned.load(std::memory_order_relaxed);
+   do
+      pSlot->pNextFree = pHead;
+   while (!pReturned.compare_exchange_weak(pHead, pSlot, std::memory_order_release,
+                                           std::memory_order_relaxed));
+}
+
+/*********************************************
+ * POOL :: RECLAIM
+ * Move every slot given back to our slabs onto
+ * our free list. Returns whether there were any
+ ********************************************/
+template <typename T>
+bool Pool <T> :: reclaim() noexcept
+{
+   for (Slab * pSlab : slabs)
+   {
+      Slot * p = pSlab->pReturned.exchange(nullptr, std::memory_order_acquire);
+      while (p)
+      {
+         Slot * pNextSlot = p->pNextFree;
+         p->pNextFree = pFree;
+         pFree = p;
+         p = pNextSlot;
+      }
+   }
+   return pFree != nullptr;
+}
+
+/*********************************************
+ * POOL :: ALLOCATE
+ * Find a slot: the free list first, then the
+ * newest slab, then anything given back to our
+ * slabs, then a brand new slab
+ ********************************************/
+template <typename T>
+void * Pool <T> :: allocate()
+{
+   if (pFree || (pNext == pLast && reclaim()))
+   {
+      Slot * p = pFree;
+      pFree = pFree->pNextFree;
+      return p;
+   }
+
+   if (pNext == pLast)
+   {
+      // each slab is as big as everything before it
+      size_t num = numSlots < minSlab ? minSlab : numSlots;
+      grow(num < maxSlab ? num : maxSlab);
+   }
+   return pNext++;
+}
+
+/*********************************************
+ * POOL :: GROW
+ * Add a slab of num slots. Whatever was left of
+ * the previous slab goes on the free list.
+ ********************************************/
+template <typename T>
+void Pool <T> :: grow(size_t num)
+{
+   static_assert(alignof(Slot) <= alignof(std::max_align_t),
+                 "Pool slots must not be over-aligned");
+
+   // make room to list it first, so nothing leaks if that throws
+   slabs.reserve(slabs.size() + 1);
+   void * pRaw = ::operator new(header + num * sizeof(Slot));
+
+   Slab * pSlab = static_cast<Slab *>(pRaw);
+   new (&pSlab->numRefs) std::atomic<size_t>(1);
+   new (&pSlab->pReturned) std::atomic<Slot *>(nullptr);
+   pSlab->numSlots = num;
+   slabs.insert(std::upper_bound(slabs.begin(), slabs.end(), pSlab), pSlab);
+
+   while (pNext != pLast)
+   {
+      Slot * p = pNext++;
+      p->pNextFree = pFree;
+      pFree = p;
+   }
+
+   pNext = first(pSlab);
+   pLast = pNext + num;
+   numSlots += num;
+}
+
+} // namespace custom
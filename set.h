@@ -12,6 +12,7 @@
  *    This will contain the class definition of:
 *        set                 : A class that represents a Set
 *        set::iterator       : An iterator through Set
+*        set::node_type      : A node taken out of a Set
 * Author
 *    Daniel Carr, Jarom Anderson, Arlo Jolly
 ************************************************************************/
@@ -23,6 +24,8 @@
 #include "bst.h"
 #include <memory>     // for std::allocator
 #include <functional> // for std::less
+#include <algorithm>  // for std::adjacent_find
+#include <iterator>   // for std::iterator_traits and std::reverse_iterator
 
 class TestSet;        // forward declaration for unit tests
 
@@ -35,16 +38,30 @@ namespace custom
  * SET
  * A class that represents a Set
  ***********************************************/
-template <typename T>
+template <typename T, typename Compare = std::less<T>, bool Ranked = false>
 class set
 {
    friend class ::TestSet; // give unit tests access to the privates
+
+   template <class TT, class CC, bool RR>
+   friend set<TT, CC, RR> set_union       (const set<TT, CC, RR> & lhs, const set<TT, CC, RR> & rhs);
+   template <class TT, class CC, bool RR>
+   friend set<TT, CC, RR> set_intersection(const set<TT, CC, RR> & lhs, const set<TT, CC, RR> & rhs);
+   template <class TT, class CC, bool RR>
+   friend set<TT, CC, RR> set_difference  (const set<TT, CC, RR> & lhs, const set<TT, CC, RR> & rhs);
+   template <class TT, class CC, bool RR>
+   friend set<TT, CC, RR> set_union       (set<TT, CC, RR> && lhs, set<TT, CC, RR> && rhs);
+   template <class TT, class CC, bool RR>
+   friend set<TT, CC, RR> set_intersection(set<TT, CC, RR> && lhs, set<TT, CC, RR> && rhs);
+   template <class TT, class CC, bool RR>
+   friend set<TT, CC, RR> set_difference  (set<TT, CC, RR> && lhs, set<TT, CC, RR> && rhs);
 public:
 
    //
    // Construct
    //
    set() : bst() {}
+   explicit set(const Compare & compare) : bst(compare) {}
    set(const set& rhs) : bst(rhs.bst) {}
    set(set&& rhs) : bst(std::move(rhs.bst)) {}
    set(const std::initializer_list<T>& il) : bst()
@@ -55,9 +72,11 @@ public:
    template <class Iterator>
    set(Iterator first, Iterator last)
    {
-      for (auto it = first; it != last; it++)
-         insert(*it);
+      insert(first, last);
    }
+   template <class Iterator>
+   set(from_sorted_t, Iterator first, Iterator last, const Compare & compare = Compare())
+      : bst(from_sorted, first, last, compare) {}
    ~set() {}
 
    //
@@ -91,27 +110,130 @@ public:
       bst.swap(rhs.bst);
    }
 
+   //
+   // Snapshot: a read-only view of the set as it is now, that any
+   // thread can read while this one goes on changing the set. Taking
+   // one is a reference count: it shares every node with the set, and
+   // while it is held a change copies only the nodes it would write.
+   // Those elements move to the copies, so iterators to them are no
+   // longer valid. Merge, split, join and the set algebra relink nodes
+   // in bulk, and first copy whatever a snapshot still shares, O(n)
+   //
+   typedef typename custom::BST<T, Compare, Ranked>::snapshot_type snapshot_type;
+   snapshot_type snapshot();
+
    //
    // Iterator
    //
 
    class iterator;
+   typedef std::reverse_iterator<iterator> reverse_iterator;
+   using node_type = typename custom::BST<T, Compare, Ranked>::node_type;
+   struct insert_return_type;
    iterator begin() const noexcept
    {
       return iterator(bst.begin());
    }
+   iterator last() const noexcept
+   {
+      return iterator(bst.last());
+   }
    iterator end() const noexcept
    {
       return iterator(bst.end());
    }
+   reverse_iterator rbegin() const noexcept
+   {
+      return reverse_iterator(end());
+   }
+   reverse_iterator rend() const noexcept
+   {
+      return reverse_iterator(begin());
+   }
 
    //
    // Access
    //
-   iterator find(const T& t)
+   //
+   // With a transparent Compare such as std::less<>, each of these
+   // also takes anything Compare orders against T, with no temporary T
+   //
+   iterator find(const T& t) const
    {
       return iterator(bst.find(t));
    }
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator find(const K& key) const
+   {
+      return iterator(bst.find(key));
+   }
+   iterator lower_bound(const T& t) const
+   {
+      return iterator(bst.lowerBound(t));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator lower_bound(const K& key) const
+   {
+      return iterator(bst.lowerBound(key));
+   }
+   iterator upper_bound(const T& t) const
+   {
+      return iterator(bst.upperBound(t));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   iterator upper_bound(const K& key) const
+   {
+      return iterator(bst.upperBound(key));
+   }
+   std::pair<iterator, iterator> equal_range(const T& t) const
+   {
+      auto bst_pair = bst.equalRange(t);
+      return std::pair<iterator, iterator>(iterator(bst_pair.first), iterator(bst_pair.second));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   std::pair<iterator, iterator> equal_range(const K& key) const
+   {
+      auto bst_pair = bst.equalRange(key);
+      return std::pair<iterator, iterator>(iterator(bst_pair.first), iterator(bst_pair.second));
+   }
+   size_t count(const T& t) const
+   {
+      return find(t) != end() ? 1 : 0;  // no duplicates in a set
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   size_t count(const K& key) const
+   {
+      return bst.count(key);            // a transparent key may match several
+   }
+   bool contains(const T& t) const
+   {
+      return find(t) != end();
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   bool contains(const K& key) const
+   {
+      return find(key) != end();
+   }
+
+   //
+   // Order statistics: only for a Ranked set
+   //
+   size_t rank(const T& t) const
+   {
+      return bst.rank(t);
+   }
+   iterator select(size_t k) const
+   {
+      return iterator(bst.select(k));
+   }
+   size_t count_range(const T& lo, const T& hi) const
+   {
+      return bst.countRange(lo, hi);
+   }
+   iterator advance(iterator it, std::ptrdiff_t n) const
+   {
+      return iterator(bst.advance(it.it, n));
+   }
 
    //
    // Status
@@ -125,6 +247,18 @@ public:
       return bst.size();
    }
 
+   //
+   // Memory
+   //
+   void reserve(size_t num)
+   {
+      bst.reserve(num);
+   }
+   size_t capacity() const noexcept
+   {
+      return bst.capacity();
+   }
+
    //
    // Insert
    //
@@ -140,6 +274,44 @@ public:
       return std::pair<iterator, bool>(iterator(bst_pair.first), bst_pair.second);
    }
 
+   iterator insert(iterator hint, const T& t)
+   {
+      return iterator(bst.insert(hint.it, t, true).first);
+   }
+
+   iterator insert(iterator hint, T&& t)
+   {
+      return iterator(bst.insert(hint.it, std::move(t), true).first);
+   }
+
+   insert_return_type insert(node_type&& nh)
+   {
+      auto bst_pair = bst.insert(std::move(nh), true); // Ensure keepUnique is true
+      return insert_return_type{ iterator(bst_pair.first), bst_pair.second, std::move(nh) };
+   }
+
+   void merge(set& source)
+   {
+      bst.merge(source.bst, true); // duplicates stay in source
+   }
+   void merge(set&& source)
+   {
+      merge(source);
+   }
+
+   template <class ... Args>
+   std::pair<iterator, bool> emplace(Args && ... args)
+   {
+      auto bst_pair = bst.emplaceUnique(std::forward<Args>(args)...);
+      return std::pair<iterator, bool>(iterator(bst_pair.first), bst_pair.second);
+   }
+
+   template <class ... Args>
+   iterator emplace_hint(iterator hint, Args && ... args)
+   {
+      return iterator(bst.emplaceHintUnique(hint.it, std::forward<Args>(args)...).first);
+   }
+
    void insert(const std::initializer_list<T>& il)
    {
       for (auto it = il.begin(); it != il.end(); it++)
@@ -149,8 +321,22 @@ public:
    template <class Iterator>
    void insert(Iterator first, Iterator last)
    {
-      for (auto it = first; it != last; it++)
-         insert(*it);
+      // filling an empty set from a sorted range takes one linear pass
+      if (empty() && isSortedUnique(first, last))
+         bst.assignSorted(first, last);
+      else
+         for (auto it = first; it != last; it++)
+            insert(*it);
+   }
+
+   template <class Iterator>
+   void insert(from_sorted_t, Iterator first, Iterator last)
+   {
+      if (empty())
+         bst.assignSorted(first, last);
+      else
+         for (auto it = first; it != last; it++)
+            insert(*it);
    }
 
    //
@@ -174,31 +360,122 @@ public:
       }
       return 0;
    }
+   template <class K, class = enableLookup<K, T, Compare>,
+             class = typename std::enable_if<!std::is_convertible<K, iterator>::value>::type>
+   size_t erase(const K& key)
+   {
+      // a transparent key may be equivalent to several elements
+      auto range = bst.equalRange(key);
+      size_t num = size();
+      bst.erase(range.first, range.second);
+      return num - size();
+   }
    iterator erase(iterator& itBegin, iterator& itEnd)
    {
-      while (itBegin != itEnd)
-         itBegin = erase(itBegin);
+      // the whole range comes out as a few subtrees, not one at a time
+      itBegin = iterator(bst.erase(itBegin.it, itEnd.it));
       return itEnd;
    }
+   node_type extract(iterator it)
+   {
+      return bst.extract(it.it);
+   }
+   node_type extract(const T& t)
+   {
+      return bst.extract(t);
+   }
+
+   //
+   // Split and join: relink nodes in O(log n) rather than
+   // erasing and inserting them one at a time. Unless Ranked, a
+   // set that was split counts itself the first time size() is asked
+   //
+
+   // keep what is less than t, and return the rest
+   set split(const T& t)
+   {
+      return set(bst.split(t));
+   }
+   template <class K, class = enableLookup<K, T, Compare>>
+   set split(const K& key)
+   {
+      return set(bst.split(key));
+   }
+   // take in a set that lies wholly after or wholly before this one.
+   // Sets that interleave are merged instead, duplicates staying in rhs
+   void join(set& rhs)
+   {
+      bst.join(rhs.bst, true);
+   }
+   void join(set&& rhs)
+   {
+      join(rhs);
+   }
 
 private:
-   custom::BST<T> bst;
+
+   typedef custom::BST<T, Compare, Ranked> Tree;
+
+   explicit set(Tree&& rhs) : bst(std::move(rhs)) {}
+
+   // let op fold rhs into lhs, relinking nodes rather than copying them
+   static set combine(set && lhs, set && rhs, void (Tree :: * op)(Tree &))
+   {
+      (lhs.bst.*op)(rhs.bst);
+      return std::move(lhs);
+   }
+
+   // is the range strictly ascending? Only a multi-pass range can be
+   // checked without consuming it, so single-pass ranges say no
+   template <class Iterator>
+   bool isSortedUnique(Iterator first, Iterator last) const
+   {
+      using Category = typename std::iterator_traits<Iterator>::iterator_category;
+      if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value)
+         return std::adjacent_find(first, last, [this](const T & lhs, const T & rhs)
+                                   { return !bst.compare(lhs, rhs); }) == last;
+      else
+         return false;
+   }
+
+   custom::BST<T, Compare, Ranked> bst;
 };
 
+/**************************************************
+ * SET :: SNAPSHOT
+ * The set as it is now: a reference count on its
+ * root, nothing copied. Call it from the thread that
+ * changes the set
+ *************************************************/
+template <typename T, typename Compare, bool Ranked>
+typename set <T, Compare, Ranked> ::snapshot_type set <T, Compare, Ranked> ::snapshot()
+{
+   static_assert(std::is_copy_constructible<T>::value,
+                 "a change copies the elements a snapshot shares, so T must be copy constructible");
+   return bst.snapshot();
+}
+
 
 /**************************************************
  * SET ITERATOR
  * An iterator through Set
  *************************************************/
-template <typename T>
-class set <T> :: iterator
+template <typename T, typename Compare, bool Ranked>
+class set <T, Compare, Ranked> :: iterator
 {
    friend class ::TestSet; // give unit tests access to the privates
-   friend class custom::set<T>;
+   friend class custom::set<T, Compare, Ranked>;
 public:
+   // so the standard algorithms can use it
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
    // constructors, destructors, and assignment operator
    iterator() :it(nullptr) {}
-   iterator(const typename custom::BST<T>::iterator& itRHS) : it(itRHS) { }
+   iterator(const typename custom::BST<T, Compare, Ranked>::iterator& itRHS) : it(itRHS) { }
    iterator(const iterator & rhs) : it(rhs.it) {}
    iterator & operator = (const iterator & rhs)
    {
@@ -221,6 +498,10 @@ public:
    {
       return *it;
    }
+   const T * operator -> () const
+   {
+      return &*it;
+   }
 
    // prefix increment
    iterator & operator ++ ()
@@ -254,9 +535,80 @@ public:
 
 private:
 
-   typename custom::BST<T>::iterator it;
+   typename custom::BST<T, Compare, Ranked>::iterator it;
 };
 
+/**************************************************
+ * SET INSERT RETURN TYPE
+ * What inserting a node handle did: where the
+ * element is, and the node back if it was a duplicate
+ *************************************************/
+template <typename T, typename Compare, bool Ranked>
+struct set <T, Compare, Ranked> :: insert_return_type
+{
+   iterator  position;
+   bool      inserted;
+   node_type node;
+};
+
+/**************************************************
+ * SET UNION
+ * Everything in either set, as a new set. Both ways
+ * split and join the trees, forking the halves onto
+ * other threads when they are big enough. Sets passed
+ * by reference are left alone and only the elements of
+ * the result are copied; sets passed as rvalues have
+ * their nodes relinked rather than copied.
+ * Where both hold an equivalent element, lhs's is kept
+ *************************************************/
+template <typename T, typename Compare, bool Ranked>
+set <T, Compare, Ranked> set_union(const set <T, Compare, Ranked> & lhs,
+                                   const set <T, Compare, Ranked> & rhs)
+{
+   return set <T, Compare, Ranked> (custom::BST<T, Compare, Ranked>::unionOf(lhs.bst, rhs.bst));
+}
+template <typename T, typename Compare, bool Ranked>
+set <T, Compare, Ranked> set_union(set <T, Compare, Ranked> && lhs,
+                                   set <T, Compare, Ranked> && rhs)
+{
+   return set <T, Compare, Ranked> ::combine(std::move(lhs), std::move(rhs),
+                                             &custom::BST<T, Compare, Ranked>::unionWith);
+}
+
+/**************************************************
+ * SET INTERSECTION
+ * Only what is in both sets, as a new set
+ *************************************************/
+template <typename T, typename Compare, bool Ranked>
+set <T, Compare, Ranked> set_intersection(const set <T, Compare, Ranked> & lhs,
+                                          const set <T, Compare, Ranked> & rhs)
+{
+   return set <T, Compare, Ranked> (custom::BST<T, Compare, Ranked>::intersectionOf(lhs.bst, rhs.bst));
+}
+template <typename T, typename Compare, bool Ranked>
+set <T, Compare, Ranked> set_intersection(set <T, Compare, Ranked> && lhs,
+                                          set <T, Compare, Ranked> && rhs)
+{
+   return set <T, Compare, Ranked> ::combine(std::move(lhs), std::move(rhs),
+                                             &custom::BST<T, Compare, Ranked>::intersectWith);
+}
 
+/**************************************************
+ * SET DIFFERENCE
+ * What is in lhs but not in rhs, as a new set
+ *************************************************/
+template <typename T, typename Compare, bool Ranked>
+set <T, Compare, Ranked> set_difference(const set <T, Compare, Ranked> & lhs,
+                                        const set <T, Compare, Ranked> & rhs)
+{
+   return set <T, Compare, Ranked> (custom::BST<T, Compare, Ranked>::differenceOf(lhs.bst, rhs.bst));
+}
+template <typename T, typename Compare, bool Ranked>
+set <T, Compare, Ranked> set_difference(set <T, Compare, Ranked> && lhs,
+                                        set <T, Compare, Ranked> && rhs)
+{
+   return set <T, Compare, Ranked> ::combine(std::move(lhs), std::move(rhs),
+                                             &custom::BST<T, Compare, Ranked>::differenceWith);
+}
 
 }; // namespace custom
@@ -20,6 +20,8 @@
 #include <iostream>
 #include <string>
 #include <functional> // for std::less and std::greater
+#include <vector>     // for std::vector
+#include <cstddef>    // for offsetof
 
  /***********************************************
   * TEST BST
@@ -51,6 +53,7 @@ public:
       test_assign_oneToStandard();
       test_assign_standardToOne();
       test_assign_standardToStandard();
+      test_assign_skewed();
       test_assignMove_emptyToEmpty();
       test_assignMove_standardToEmpty();
       test_assignMove_emptyToStandard();
@@ -67,6 +70,12 @@ public:
       // Iterator
       test_begin_empty();
       test_begin_standard();
+      test_begin_afterErase();
+      test_last_empty();
+      test_last_standard();
+      test_last_afterErase();
+      test_rbegin_empty();
+      test_rbegin_standard();
       test_end_standard();
       test_iterator_increment_standardToParent();
       test_iterator_increment_standardToChild();
@@ -74,6 +83,10 @@ public:
       test_iterator_increment_standardToGrandchild();
       test_iterator_increment_standardToDone();
       test_iterator_increment_standardEnd();
+      test_iterator_decrement_standardEnd();
+      test_iterator_decrement_emptyEnd();
+      test_iterator_decrement_endNoWalk();
+      test_iterator_decrement_standardBegin();
       test_iterator_dereference_standardRead();
 
       // Find
@@ -81,6 +94,12 @@ public:
       test_find_standardBegin();
       test_find_standardLast();
       test_find_standardMissing();
+      test_lowerBound_standard();
+      test_upperBound_standard();
+      test_equalRange_duplicates();
+      test_equalRange_missing();
+      test_count_duplicates();
+      test_find_transparent();
 
       // Insert
       test_insert_oneLeft();
@@ -102,6 +121,34 @@ public:
       test_insert_case4bComplex();
       test_insert_case4cComplex();
       test_insert_case4dComplex();
+      test_insertHint_append();
+      test_insertHint_before();
+      test_assignSorted_standard();
+      test_assignSorted_redBlack();
+      test_emplace_inPlace();
+      test_emplaceUnique_duplicateBuilt();
+      test_emplaceUnique_duplicateKey();
+      test_emplaceHint_middle();
+      test_emplaceHint_append();
+      test_emplaceHint_wrong();
+      test_extract_leaf();
+      test_extract_root();
+      test_extract_missing();
+      test_extract_outlivesTree();
+      test_extract_dropReusesSlot();
+      test_insertNode_otherTree();
+      test_insertNode_duplicate();
+      test_merge_disjoint();
+      test_merge_oneSlab();
+      test_merge_duplicates();
+      test_ranked_nodeSize();
+      test_node_compact();
+      test_rank_standard();
+      test_select_standard();
+      test_countRange_standard();
+      test_advance_standard();
+      test_ranked_stress();
+      test_ranked_copyAndMerge();
 
       // Remove
       test_erase_empty();
@@ -109,8 +156,49 @@ public:
       test_erase_noChildren();
       test_erase_oneChild();
       test_erase_twoChildren();
+      test_erase_blackLeafCase4();
+      test_erase_redBlackStress();
       test_clear_empty();
       test_clear_standard();
+      test_clear_releasesPool();
+      test_clear_skewed();
+      test_erase_recyclesNode();
+      test_eraseRange_middle();
+      test_eraseRange_ends();
+      test_eraseRange_duplicates();
+      test_eraseRange_ranked();
+
+      // Set algebra
+      test_join_uneven();
+      test_split_standard();
+      test_unionWith_interleaved();
+      test_unionWith_keepsOurs();
+      test_unionWith_self();
+      test_intersectWith_standard();
+      test_differenceWith_standard();
+      test_differenceWith_self();
+      test_setAlgebra_ranked();
+      test_setAlgebra_parallel();
+      test_setAlgebra_copies();
+      test_setAlgebra_copiesParallel();
+
+      // Split and join
+      test_split_middle();
+      test_split_ends();
+      test_split_duplicates();
+      test_split_thenChange();
+      test_split_ranked();
+      test_join_append();
+      test_join_prepend();
+      test_join_interleaved();
+      test_join_splitRoundTrip();
+
+      // Snapshot
+      test_snapshot_pathCopy();
+      test_snapshot_manyVersions();
+      test_snapshot_dropped();
+      test_snapshot_outlivesTree();
+      test_snapshot_bulk();
 
       // Status
       test_empty_empty();
@@ -178,10 +266,11 @@ public:
       // setup
       //            (50b)
       custom::BST <Spy> bstSrc;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bstSrc.pool.construct(Spy(50));
       p50->isRed = false;
       bstSrc.root = p50;
       bstSrc.numElements = 1;
+      bstSrc.relink();
       Spy::reset();
       // exercise
       custom::BST <Spy> bstDest(bstSrc);
@@ -203,7 +292,7 @@ public:
          assertUnit(bstSrc.root->isRed == false);
          assertUnit(bstSrc.root->pLeft == nullptr);
          assertUnit(bstSrc.root->pRight == nullptr);
-         assertUnit(bstSrc.root->pParent == nullptr);
+         assertUnit(bstSrc.root->pParent == bstSrc.pHeader());
       }
       //            (50b)
       assertUnit(bstDest.numElements == 1);
@@ -214,15 +303,15 @@ public:
          assertUnit(bstDest.root->isRed == false);
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->pParent == bstDest.pHeader());
       }
       // teardown
       if (bstSrc.root)
-         delete bstSrc.root;
+         bstSrc.pool.destroy(bstSrc.root);
       bstSrc.root = nullptr;
       bstSrc.numElements = 0;
       if (bstDest.root)
-         delete bstDest.root;
+         bstDest.pool.destroy(bstDest.root);
       bstDest.root = nullptr;
       bstDest.numElements = 0;
    }
@@ -301,10 +390,11 @@ public:
       // setup
       //            (50b)
       custom::BST <Spy> bstSrc;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bstSrc.pool.construct(Spy(50));
       p50->isRed = false;
       bstSrc.root = p50;
       bstSrc.numElements = 1;
+      bstSrc.relink();
       Spy::reset();
       // exercise
       custom::BST <Spy> bstDest(std::move(bstSrc));
@@ -334,11 +424,11 @@ public:
          assertUnit(bstDest.root->isRed == false);
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->pParent == bstDest.pHeader());
       }
       // teardown
       if (bstDest.root)
-         delete bstDest.root;
+         bstDest.pool.destroy(bstDest.root);
       bstDest.root = nullptr;
       bstDest.numElements = 0;
    }
@@ -650,10 +740,11 @@ public:
       setupStandardFixture(bstSrc);
       //                (99) = bstDest
       custom::BST <Spy> bstDest;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = bstDest.pool.construct(Spy(99));
       p99->isRed = false;
       bstDest.root = p99;
       bstDest.numElements = 1;
+      bstDest.relink();
       Spy::reset();
       // exercise
       bstDest = bstSrc;
@@ -692,10 +783,11 @@ public:
    {  // setup
       //                (99) = bstSrc
       custom::BST <Spy> bstSrc;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = bstSrc.pool.construct(Spy(99));
       p99->isRed = false;
       bstSrc.root = p99;
       bstSrc.numElements = 1;
+      bstSrc.relink();
       //                (50b) = bstSrc
       //          +-------+-------+
       //        (30b)           (70b)
@@ -725,7 +817,7 @@ public:
       {
          assertUnit(bstSrc.root->data == Spy(99));
          assertUnit(bstSrc.root->isRed == false);
-         assertUnit(bstSrc.root->pParent == nullptr);
+         assertUnit(bstSrc.root->pParent == bstSrc.pHeader());
          assertUnit(bstSrc.root->pLeft == nullptr);
          assertUnit(bstSrc.root->pRight == nullptr);
       }
@@ -735,7 +827,7 @@ public:
       {
          assertUnit(bstDest.root->data == Spy(99));
          assertUnit(bstDest.root->isRed == false);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->pParent == bstDest.pHeader());
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
       }
@@ -794,6 +886,35 @@ public:
       teardownStandardFixture(bstDest);
    }
 
+   // assignment operator : a long vine copies without recursing
+   void test_assign_skewed()
+   {  // setup
+      //   (0)
+      //     +--(1)
+      //          +--(2) ... (199999)
+      custom::BST <int> bstSrc;
+      setupVine(bstSrc, 200000);
+      custom::BST <int> bstDest;
+      for (int i = 0; i < 10; i++)
+         bstDest.insert(-i);
+      // exercise
+      bstDest = bstSrc;
+      // verify
+      assertUnit(bstDest.numElements == 200000);
+      assertUnit(bstDest.root != nullptr);
+      bool valid = true;
+      int expected = 0;
+      const custom::BST <int> ::BNode * pParent = bstDest.pHeader();
+      for (auto p = bstDest.root; p && valid; p = p->pRight)
+      {
+         valid = p->data == expected++ && p->pLeft == nullptr && p->pParent == pParent;
+         pParent = p;
+      }
+      assertUnit(valid);
+      assertUnit(expected == 200000);
+      assertUnit(bstDest.pool.live() == 200000);
+   }  // teardown
+
 
    /***************************************
     * Assignment-Move
@@ -896,10 +1017,11 @@ public:
       setupStandardFixture(bstSrc);
       //                (99) = bstDest
       custom::BST <Spy> bstDest;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = bstDest.pool.construct(Spy(99));
       p99->isRed = false;
       bstDest.root = p99;
       bstDest.numElements = 1;
+      bstDest.relink();
       Spy::reset();
       // exercise
       bstDest = std::move(bstSrc);
@@ -931,10 +1053,11 @@ public:
    {  // setup
       //                (99) = bstSrc
       custom::BST <Spy> bstSrc;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = bstSrc.pool.construct(Spy(99));
       p99->isRed = false;
       bstSrc.root = p99;
       bstSrc.numElements = 1;
+      bstSrc.relink();
       //                (50b) = bstDest
       //          +-------+-------+
       //        (30b)           (70b)
@@ -964,7 +1087,7 @@ public:
       {
          assertUnit(bstDest.root->data == Spy(99));
          assertUnit(bstDest.root->isRed == false);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->pParent == bstDest.pHeader());
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
       }
@@ -1050,10 +1173,11 @@ public:
       std::initializer_list<Spy> ilSrc{ Spy(50), Spy(30), Spy(70), Spy(20), Spy(40), Spy(60), Spy(80) };
       //                (99) = bstDest
       custom::BST <Spy> bstDest;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = bstDest.pool.construct(Spy(99));
       p99->isRed = false;
       bstDest.root = p99;
       bstDest.numElements = 1;
+      bstDest.relink();
       Spy::reset();
       // exercise
       bstDest = ilSrc;
@@ -1265,6 +1389,837 @@ public:
       assertEmptyFixture(bst);
    }  // teardown
 
+   // clear hands every slab back instead of keeping the nodes around
+   void test_clear_releasesPool()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy::reset();
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 7);  // destroy  [20][30][40][50][60][70][80]
+      assertUnit(bst.pool.capacity() == 0);
+      assertUnit(bst.pool.live() == 0);
+      assertEmptyFixture(bst);
+   }  // teardown
+
+   // clearing a long vine does not recurse
+   void test_clear_skewed()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupVine(bst, 200000);
+      Spy::reset();
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 200000);
+      assertUnit(bst.pool.capacity() == 0);
+      assertEmptyFixture(bst);
+   }  // teardown
+
+   // an erased node is reused by the next insert
+   void test_erase_recyclesNode()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p60 = bst.root->pRight->pLeft;
+      auto it = custom::BST <Spy> ::iterator(p60);
+      bst.erase(it);
+      size_t capacity = bst.pool.capacity();
+      Spy::reset();
+      // exercise
+      auto pairReturn = bst.insert(Spy(60));
+      // verify
+      assertUnit(Spy::numAlloc() == 1);       // allocate [60]
+      assertUnit(pairReturn.second == true);
+      assertUnit(pairReturn.first == custom::BST <Spy> ::iterator(p60));
+      assertUnit(bst.pool.capacity() == capacity);
+      assertUnit(bst.pool.live() == 7);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   /***************************************
+    * ERASE RANGE
+    *    BST::erase(first, last)
+    ***************************************/
+
+   // a long range comes out whole and goes back to the pool
+   void test_eraseRange_middle()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 10000; i++)
+         bst.insert(i);
+      auto first = bst.find(1000);
+      auto last = bst.find(9000);
+      size_t capacity = bst.pool.capacity();
+      // exercise
+      auto it = bst.erase(first, last);
+      // verify
+      assertUnit(it == last);
+      assertUnit(bst.numElements == 2000);
+      assertUnit(bst.pool.live() == 2000);
+      assertUnit(bst.pool.capacity() == capacity);
+      assertUnit(bst.root->computeSize() == 2000);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      bst.root->verifyBTree();
+      assertUnit(bst.find(999) != bst.end());
+      assertUnit(bst.find(1000) == bst.end());
+      assertUnit(bst.find(8999) == bst.end());
+      assertUnit(*(--custom::BST <int> ::iterator(it)) == 999);
+      bst.insert(5000);
+      assertUnit(bst.pool.capacity() == capacity);  // the slot was recycled
+   }  // teardown
+
+   // a range reaching either end of the tree
+   void test_eraseRange_ends()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      // exercise
+      auto itEnd = bst.erase(bst.find(800), bst.end());
+      auto itBegin = bst.erase(bst.begin(), bst.find(200));
+      // verify
+      assertUnit(itEnd == bst.end());
+      assertUnit(itBegin == bst.begin());
+      assertUnit(bst.numElements == 600);
+      assertUnit(bst.pLeftmost->data == 200);
+      assertUnit(bst.rightmost()->data == 799);
+      assertUnit(bst.root->computeSize() == 600);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      bst.erase(bst.begin(), bst.end());
+      assertUnit(bst.empty());
+      assertUnit(bst.begin() == bst.end());
+   }  // teardown
+
+   // equal keys are cut exactly where the iterators are
+   void test_eraseRange_duplicates()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 2000; i++)
+         bst.insert(i % 7);
+      auto range = bst.equalRange(3);
+      auto first = range.first;
+      for (int i = 0; i < 50; i++)
+         ++first;
+      // exercise
+      bst.erase(first, range.second);
+      // verify
+      assertUnit(bst.count(3) == 50);
+      assertUnit(bst.count(2) == 286);
+      assertUnit(bst.count(4) == 286);
+      assertUnit(bst.numElements == 2000 - 286 + 50);
+      assertUnit(bst.root->computeSize() == (int)bst.numElements);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+   }  // teardown
+
+   // a Ranked tree knows its sizes after a range erase
+   void test_eraseRange_ranked()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      // exercise
+      bst.erase(bst.find(100), bst.find(700));
+      // verify
+      assertUnit(bst.numElements == 400);
+      assertUnit(bst.root->verifySize());
+      assertUnit(bst.root->size == 400);
+      assertUnit(bst.rank(700) == 100);
+      assertUnit(*bst.select(100) == 700);
+   }  // teardown
+
+   /***************************************
+    * SET ALGEBRA
+    *    BST::unionWith(BST &)
+    *    BST::intersectWith(BST &)
+    *    BST::differenceWith(BST &)
+    ***************************************/
+
+   // joining a short tree onto a tall one keeps it red-black
+   void test_join_uneven()
+   {  // setup
+      typedef custom::BST <int, std::less <int>, true> Tree;
+      Tree bstTall;
+      Tree bstShort;
+      for (int i = 0; i < 1000; i++)
+         bstTall.insert(i);
+      for (int i = 1001; i < 1004; i++)
+         bstShort.insert(i);
+      Tree::BNode * pMiddle = bstShort.pool.construct(1000);
+      bstShort.pool.adopt(bstTall.numElements + 3);
+      bstShort.pool.keep(bstTall.pool);
+      bstTall.pool.disown(bstTall.numElements);
+      Tree::Subtree left = bstTall.takeTree();
+      Tree::Subtree right = bstShort.takeTree();
+      // exercise
+      Tree::Subtree tree = Tree::join(left, pMiddle, right);
+      bstShort.pool.disown(3);
+      bstShort.putTree(tree, 1004);
+      // verify
+      assertUnit(tree.blackHeight == Tree::blackHeight(tree.pRoot));
+      assertUnit(bstShort.root->verifyRedBlack(bstShort.root->findDepth()));
+      assertUnit(bstShort.root->verifySize());
+      assertUnit(bstShort.root->size == 1004);
+      assertUnit(bstShort.rank(1000) == 1000);
+      assertUnit(bstShort.pLeftmost->data == 0);
+      assertUnit(bstShort.rightmost()->data == 1003);
+      bstShort.root->verifyBTree();
+   }  // teardown
+
+   // split takes a tree apart around a key
+   void test_split_standard()
+   {  // setup
+      typedef custom::BST <int, std::less <int>, true> Tree;
+      Tree bst;
+      for (int i = 0; i < 500; i++)
+         bst.insert(i * 2);
+      Tree bstLeft;
+      bstLeft.pool.keep(bst.pool);
+      bstLeft.pool.adopt(bst.numElements);
+      bst.pool.disown(bst.numElements);
+      // exercise
+      Tree::Split parts = bst.split(bst.takeTree(), 300);
+      // verify
+      assertUnit(parts.pMatch != nullptr);
+      if (parts.pMatch)
+         assertUnit(parts.pMatch->data == 300 && parts.pMatch->pLeft == nullptr);
+      assertUnit(parts.left.blackHeight == Tree::blackHeight(parts.left.pRoot));
+      assertUnit(parts.right.blackHeight == Tree::blackHeight(parts.right.pRoot));
+      bstLeft.putTree(parts.left, 150);
+      bst.putTree(parts.right, 349);
+      bstLeft.pool.disown(350);
+      bst.pool.adopt(349);
+      assertUnit(bstLeft.root->verifyRedBlack(bstLeft.root->findDepth()));
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bstLeft.root->verifySize() && bstLeft.root->size == 150);
+      assertUnit(bst.root->verifySize() && bst.root->size == 349);
+      assertUnit(bstLeft.rightmost()->data == 298);
+      assertUnit(bst.pLeftmost->data == 302);
+      // teardown
+      bstLeft.pool.adopt();
+      bstLeft.pool.destroy(parts.pMatch);
+   }
+
+   // two interleaved trees come out as one
+   void test_unionWith_interleaved()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 2000; i += 2)
+         bst.insert(i);
+      for (int i = 0; i < 3000; i += 3)
+         bstRHS.insert(i);
+      // exercise
+      bst.unionWith(bstRHS);
+      // verify
+      assertUnit(bst.numElements == 1000 + 1000 - 334); // multiples of 6 under 2000
+      assertUnit(bst.pool.live() == bst.numElements);
+      assertUnit(bstRHS.empty());
+      assertUnit(bstRHS.root == nullptr);
+      assertUnit(bstRHS.pool.live() == 0);
+      assertUnit(bst.pLeftmost->data == 0);
+      assertUnit(bst.rightmost()->data == 2997);
+      assertUnit(bst.root->computeSize() == (int)bst.numElements);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      bst.root->verifyBTree();
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+      {
+         while (expected % 2 != 0 && (expected % 3 != 0 || expected >= 3000))
+            expected++;
+         if (expected >= 2000)
+            while (expected % 3 != 0)
+               expected++;
+         inOrder = inOrder && *it == expected;
+         expected++;
+      }
+      assertUnit(inOrder);
+   }  // teardown
+
+   // where both trees hold a key, our node is the one kept
+   void test_unionWith_keepsOurs()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 100; i++)
+      {
+         bst.insert(i);
+         bstRHS.insert(i + 50);
+      }
+      auto * p75 = bst.find(75).pNode;
+      // exercise
+      bst.unionWith(bstRHS);
+      // verify
+      assertUnit(bst.numElements == 150);
+      assertUnit(bst.find(75).pNode == p75);
+      assertUnit(bst.find(149) != bst.end());
+      assertUnit(bst.pool.live() == 150);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+   }  // teardown
+
+   // a tree united with itself is unchanged
+   void test_unionWith_self()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 10; i++)
+         bst.insert(i);
+      // exercise
+      bst.unionWith(bst);
+      // verify
+      assertUnit(bst.numElements == 10);
+      assertUnit(bst.root->computeSize() == 10);
+   }  // teardown
+
+   // only what both hold is left
+   void test_intersectWith_standard()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 2000; i += 2)
+         bst.insert(i);
+      for (int i = 0; i < 3000; i += 3)
+         bstRHS.insert(i);
+      // exercise
+      bst.intersectWith(bstRHS);
+      // verify
+      assertUnit(bst.numElements == 334);
+      assertUnit(bst.pool.live() == 334);
+      assertUnit(bstRHS.empty());
+      assertUnit(bst.pLeftmost->data == 0);
+      assertUnit(bst.rightmost()->data == 1998);
+      assertUnit(bst.root->computeSize() == 334);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      bool allSixes = true;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         allSixes = allSixes && *it % 6 == 0;
+      assertUnit(allSixes);
+   }  // teardown
+
+   // only what rhs does not hold is left
+   void test_differenceWith_standard()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 2000; i += 2)
+         bst.insert(i);
+      for (int i = 0; i < 3000; i += 3)
+         bstRHS.insert(i);
+      // exercise
+      bst.differenceWith(bstRHS);
+      // verify
+      assertUnit(bst.numElements == 1000 - 334);
+      assertUnit(bst.pool.live() == 1000 - 334);
+      assertUnit(bstRHS.empty());
+      assertUnit(bst.pLeftmost->data == 2);
+      assertUnit(bst.rightmost()->data == 1996);
+      assertUnit(bst.root->computeSize() == 1000 - 334);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      bool noSixes = true;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         noSixes = noSixes && *it % 6 != 0 && *it % 2 == 0;
+      assertUnit(noSixes);
+   }  // teardown
+
+   // a tree less itself is empty
+   void test_differenceWith_self()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 10; i++)
+         bst.insert(i);
+      // exercise
+      bst.differenceWith(bst);
+      // verify
+      assertUnit(bst.empty());
+      assertUnit(bst.root == nullptr);
+      assertUnit(bst.begin() == bst.end());
+   }  // teardown
+
+   // every node of the result knows its subtree size
+   void test_setAlgebra_ranked()
+   {  // setup
+      typedef custom::BST <int, std::less <int>, true> Tree;
+      Tree bstUnion, bstIntersect, bstDifference;
+      Tree bstRHS;
+      for (int i = 0; i < 1500; i += 3)
+         bstRHS.insert(i);
+      for (int i = 0; i < 1000; i++)
+         if (i % 5 != 0)
+            bstUnion.insert(i);
+      bstIntersect = bstUnion;
+      bstDifference = bstUnion;
+      Tree bstRHS2(bstRHS), bstRHS3(bstRHS);
+      // exercise
+      bstUnion.unionWith(bstRHS);
+      bstIntersect.intersectWith(bstRHS2);
+      bstDifference.differenceWith(bstRHS3);
+      // verify
+      assertUnit(bstUnion.root->verifySize());
+      assertUnit(bstUnion.root->size == bstUnion.numElements);
+      assertUnit(bstUnion.numElements == 800 + 500 - 267);
+      assertUnit(bstIntersect.root->verifySize());
+      assertUnit(bstIntersect.numElements == 267);
+      assertUnit(*bstIntersect.select(1) == 6);  // [0] is a multiple of 5
+      assertUnit(bstDifference.root->verifySize());
+      assertUnit(bstDifference.numElements == 800 - 267);
+      assertUnit(bstDifference.rank(4) == 2);   // after [1] and [2]
+   }  // teardown
+
+   // forking the recursion gives the same answer
+   void test_setAlgebra_parallel()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 20000; i += 2)
+         bst.insert(i);
+      for (int i = 0; i < 30000; i += 3)
+         bstRHS.insert(i);
+      custom::BST <int> bstCopy(bst);
+      custom::BST <int> bstCopyRHS(bstRHS);
+      // exercise
+      bst.combine(bstRHS, &custom::BST <int> ::unite, 4);
+      bstCopy.combine(bstCopyRHS, &custom::BST <int> ::subtract, 4);
+      // verify
+      assertUnit(bst.numElements == 10000 + 10000 - 3334);
+      assertUnit(bst.root->computeSize() == (int)bst.numElements);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bstCopy.numElements == 10000 - 3334);
+      assertUnit(bstCopy.root->computeSize() == (int)bstCopy.numElements);
+      assertUnit(bstCopy.root->verifyRedBlack(bstCopy.root->findDepth()));
+      assertUnit(bstCopy.find(6) == bstCopy.end());
+      assertUnit(bstCopy.find(8) != bstCopy.end());
+   }  // teardown
+
+   // the copying set algebra leaves both trees alone, and gives a
+   // balanced, sized tree whose pool counts only what it kept
+   void test_setAlgebra_copies()
+   {  // setup
+      typedef custom::BST <int, std::less <int>, true> Tree;
+      Tree bst;
+      Tree bstRHS;
+      for (int i = 0; i < 1000; i++)
+         if (i % 5 != 0)
+            bst.insert(i);
+      for (int i = 0; i < 1500; i += 3)
+         bstRHS.insert(i);
+      // exercise
+      Tree bstUnion      = Tree::unionOf(bst, bstRHS);
+      Tree bstIntersect  = Tree::intersectionOf(bst, bstRHS);
+      Tree bstDifference = Tree::differenceOf(bst, bstRHS);
+      // verify
+      assertUnit(bst.numElements == 800);
+      assertUnit(bstRHS.numElements == 500);
+      assertUnit(bst.root->verifySize());
+      assertUnit(bstUnion.numElements == 800 + 500 - 267);
+      assertUnit(bstUnion.pool.live() == bstUnion.numElements);
+      assertUnit(bstUnion.root->verifySize());
+      assertUnit(bstUnion.root->verifyRedBlack(bstUnion.root->findDepth()));
+      assertUnit(*bstUnion.begin() == 0);
+      assertUnit(*bstUnion.rbegin() == 1497);
+      assertUnit(bstIntersect.numElements == 267);
+      assertUnit(bstIntersect.pool.live() == 267);
+      assertUnit(bstIntersect.root->verifySize());
+      assertUnit(bstIntersect.root->verifyRedBlack(bstIntersect.root->findDepth()));
+      assertUnit(*bstIntersect.select(1) == 6);  // [0] is a multiple of 5
+      assertUnit(bstDifference.numElements == 800 - 267);
+      assertUnit(bstDifference.pool.live() == 800 - 267);
+      assertUnit(bstDifference.root->verifySize());
+      assertUnit(bstDifference.root->verifyRedBlack(bstDifference.root->findDepth()));
+      assertUnit(bstDifference.rank(4) == 2);   // after [1] and [2]
+   }  // teardown
+
+   // forking the copying recursion gives the same answer, whatever
+   // the forked halves built in pools of their own
+   void test_setAlgebra_copiesParallel()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 20000; i += 2)
+         bst.insert(i);
+      for (int i = 0; i < 30000; i += 3)
+         bstRHS.insert(i);
+      // exercise
+      custom::BST <int> bstUnion = custom::BST <int> ::combined(bst, bstRHS,
+                                      custom::BST <int> ::KEEP_EITHER, 4);
+      custom::BST <int> bstDifference = custom::BST <int> ::combined(bst, bstRHS,
+                                      custom::BST <int> ::KEEP_LHS_ONLY, 4);
+      // verify
+      assertUnit(bst.numElements == 10000);
+      assertUnit(bstRHS.numElements == 10000);
+      assertUnit(bstUnion.numElements == 10000 + 10000 - 3334);
+      assertUnit(bstUnion.pool.live() == bstUnion.numElements);
+      assertUnit(bstUnion.root->computeSize() == (int)bstUnion.numElements);
+      assertUnit(bstUnion.root->verifyRedBlack(bstUnion.root->findDepth()));
+      assertUnit(bstDifference.numElements == 10000 - 3334);
+      assertUnit(bstDifference.pool.live() == bstDifference.numElements);
+      assertUnit(bstDifference.root->verifyRedBlack(bstDifference.root->findDepth()));
+      assertUnit(bstDifference.find(6) == bstDifference.end());
+      assertUnit(bstDifference.find(8) != bstDifference.end());
+   }  // teardown
+
+   /***************************************
+    * SPLIT and JOIN
+    *    BST::split(key)
+    *    BST::join(BST &)
+    ***************************************/
+
+   // a tree split in the middle keeps the bottom half, and counts
+   // it only when asked
+   void test_split_middle()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      // exercise
+      custom::BST <int> bstRight = bst.split(300);
+      // verify
+      assertUnit(bst.numElements == custom::BST <int> ::unknownSize);
+      assertUnit(bstRight.numElements == custom::BST <int> ::unknownSize);
+      assertUnit(!bst.empty() && !bstRight.empty());
+      assertUnit(bst.size() == 300);
+      assertUnit(bstRight.size() == 700);
+      assertUnit(bst.numElements == 300);
+      assertUnit(bst.pool.live() == 300);
+      assertUnit(bstRight.pool.live() == 700);
+      assertUnit(bst.pLeftmost->data == 0);
+      assertUnit(bst.rightmost()->data == 299);
+      assertUnit(bstRight.pLeftmost->data == 300);
+      assertUnit(bstRight.rightmost()->data == 999);
+      assertUnit(bst.root->computeSize() == 300);
+      assertUnit(bstRight.root->computeSize() == 700);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bstRight.root->verifyRedBlack(bstRight.root->findDepth()));
+      bst.root->verifyBTree();
+      bstRight.root->verifyBTree();
+   }  // teardown
+
+   // splitting before the first or after the last moves all or nothing
+   void test_split_ends()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 10; i < 20; i++)
+         bst.insert(i);
+      custom::BST <int> bstEmpty;
+      // exercise
+      custom::BST <int> bstNone = bst.split(20);
+      custom::BST <int> bstAll = bst.split(0);
+      custom::BST <int> bstFromEmpty = bstEmpty.split(5);
+      // verify
+      assertUnit(bstNone.empty());
+      assertUnit(bstNone.begin() == bstNone.end());
+      assertUnit(bst.empty());
+      assertUnit(bst.begin() == bst.end());
+      assertUnit(bstAll.numElements == 10);
+      assertUnit(bstAll.pLeftmost->data == 10);
+      assertUnit(bstFromEmpty.empty());
+   }  // teardown
+
+   // every element equal to the key goes right
+   void test_split_duplicates()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(i % 7);
+      // exercise
+      custom::BST <int> bstRight = bst.split(3);
+      // verify
+      assertUnit(bst.size() == 15 + 15 + 14);     // the 0s, 1s and 2s
+      assertUnit(bstRight.size() == 100 - 44);
+      assertUnit(bst.count(3) == 0);
+      assertUnit(bstRight.count(3) == 14);
+      assertUnit(bst.rightmost()->data == 2);
+      assertUnit(bstRight.pLeftmost->data == 3);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bstRight.root->verifyRedBlack(bstRight.root->findDepth()));
+   }  // teardown
+
+   // changes before the first size() still add up
+   void test_split_thenChange()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(i);
+      custom::BST <int> bstRight = bst.split(40);
+      // exercise
+      bst.insert(-1);
+      auto it = bst.find(10);
+      bst.erase(it);
+      bstRight.insert(100);
+      auto itFirst = bstRight.find(50);
+      auto itLast = bstRight.find(80);
+      bstRight.erase(itFirst, itLast);
+      // verify
+      assertUnit(bst.size() == 40);
+      assertUnit(bst.pool.live() == 40);
+      assertUnit(bstRight.size() == 61 - 30);
+      assertUnit(bstRight.pool.live() == 61 - 30);
+      assertUnit(bstRight.root->computeSize() == 31);
+   }  // teardown
+
+   // a Ranked tree keeps its sizes on both sides
+   void test_split_ranked()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      for (int i = 0; i < 1000; i += 2)
+         bst.insert(i);
+      // exercise
+      auto bstRight = bst.split(501);
+      // verify
+      assertUnit(bst.numElements == 251);
+      assertUnit(bstRight.numElements == 249);
+      assertUnit(bst.pool.live() == 251);
+      assertUnit(bstRight.pool.live() == 249);
+      assertUnit(bst.root->verifySize() && bst.root->size == 251);
+      assertUnit(bstRight.root->verifySize() && bstRight.root->size == 249);
+      assertUnit(*bstRight.select(0) == 502);
+      assertUnit(bst.rank(500) == 250);
+   }  // teardown
+
+   // a tree that comes after ours is appended
+   void test_join_append()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      for (int i = 1000; i < 1010; i++)
+         bstRHS.insert(i);
+      // exercise
+      bst.join(bstRHS, true);
+      // verify
+      assertUnit(bst.numElements == 1010);
+      assertUnit(bst.pool.live() == 1010);
+      assertUnit(bstRHS.empty());
+      assertUnit(bstRHS.pool.live() == 0);
+      assertUnit(bst.rightmost()->data == 1009);
+      assertUnit(bst.root->computeSize() == 1010);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      bst.root->verifyBTree();
+   }  // teardown
+
+   // a tree that comes before ours is prepended
+   void test_join_prepend()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      custom::BST <int, std::less <int>, true> bstRHS;
+      for (int i = 100; i < 110; i++)
+         bst.insert(i);
+      for (int i = 0; i < 100; i++)
+         bstRHS.insert(i);
+      // exercise
+      bst.join(bstRHS, true);
+      // verify
+      assertUnit(bst.numElements == 110);
+      assertUnit(bstRHS.empty());
+      assertUnit(bst.pLeftmost->data == 0);
+      assertUnit(bst.rightmost()->data == 109);
+      assertUnit(bst.root->verifySize() && bst.root->size == 110);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.rank(100) == 100);
+   }  // teardown
+
+   // trees that interleave are merged, leaving duplicates behind
+   void test_join_interleaved()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int> bstRHS;
+      for (int i = 0; i < 10; i++)
+         bst.insert(i * 2);
+      for (int i = 0; i < 10; i++)
+         bstRHS.insert(i * 3);
+      // exercise
+      bst.join(bstRHS, true);
+      // verify
+      assertUnit(bst.numElements == 16);       // gained 3 9 15 21 24 27
+      assertUnit(bstRHS.numElements == 4);     // 0 6 12 18
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+   }  // teardown
+
+   // splitting and joining back gives the tree we started with
+   void test_join_splitRoundTrip()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 5000; i++)
+         bst.insert((i * 7919) % 5000);
+      // exercise
+      custom::BST <int> bstHigh = bst.split(4000);
+      custom::BST <int> bstMiddle = bst.split(1000);
+      bstHigh.join(bstMiddle);
+      bst.join(bstHigh);
+      // verify
+      assertUnit(bst.size() == 5000);
+      assertUnit(bst.pool.live() == 5000);
+      assertUnit(bstHigh.empty());
+      assertUnit(bstMiddle.empty());
+      assertUnit(bst.root->computeSize() == 5000);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         inOrder = inOrder && *it == expected++;
+      assertUnit(inOrder);
+   }  // teardown
+
+   /***************************************
+    * SNAPSHOT
+    *    BST::snapshot()
+    ***************************************/
+
+   // an insert and an erase while a snapshot is held copy the nodes
+   // they write, a path or two, and the snapshot does not see them
+   void test_snapshot_pathCopy()
+   {  // setup
+      custom::BST <Spy> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(Spy(i * 2));
+      auto view = bst.snapshot();
+      Spy::reset();
+      // exercise
+      bst.insert(Spy(1001));
+      auto it = bst.find(Spy(500));
+      bst.erase(it);
+      // verify
+      assertUnit(Spy::numCopy() > 1);
+      assertUnit(Spy::numCopy() < 50);           // about two paths of 10 to 20
+      assertUnit(view.size() == 1000);
+      assertUnit(view.contains(Spy(500)));
+      assertUnit(!view.contains(Spy(1001)));
+      assertUnit(bst.size() == 1000);
+      assertUnit(bst.pool.live() == 1000);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.find(Spy(1001)) != bst.end());
+      assertUnit(bst.find(Spy(500)) == bst.end());
+   }  // teardown
+
+   // every snapshot stays as it was while the tree goes on changing
+   // under all of them, and the tree stays a valid red-black tree
+   void test_snapshot_manyVersions()
+   {  // setup
+      custom::BST <int, std::less<int>, true> bst;
+      for (int i = 0; i < 2000; i += 2)
+         bst.insert(i);
+      std::vector <custom::BST <int, std::less<int>, true> ::snapshot_type> views;
+      std::vector <std::vector <int>> expected;
+      // exercise
+      for (int i = 0; i < 3000; i++)
+      {
+         if (i % 250 == 0)
+         {
+            views.push_back(bst.snapshot());
+            expected.push_back(std::vector<int>(bst.begin(), bst.end()));
+         }
+         int value = (i * 7919) % 2000;
+         auto it = bst.find(value);
+         if (it == bst.end())
+            bst.insert(value);
+         else
+            bst.erase(it);
+      }
+      // verify
+      bool allMatch = true;
+      for (size_t i = 0; i < views.size(); i++)
+         allMatch = allMatch && views[i].size() == expected[i].size() &&
+            std::vector<int>(views[i].begin(), views[i].end()) == expected[i];
+      assertUnit(allMatch);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->verifySize());
+      assertUnit(bst.root->computeSize() == (int)bst.size());
+      assertUnit(bst.pool.live() == bst.size());
+      bool linked = true;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+      {
+         auto p = it.pNode;
+         linked = linked && (p->pLeft == nullptr || p->pLeft->pParent == p)
+                         && (p->pRight == nullptr || p->pRight->pParent == p);
+      }
+      assertUnit(linked);
+      assertUnit(bst.pLeftmost->pLeft == nullptr && bst.rightmost()->pRight == nullptr);
+   }  // teardown
+
+   // once the last snapshot is let go, the tree copies nothing
+   void test_snapshot_dropped()
+   {  // setup
+      custom::BST <Spy> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(Spy(i));
+      {
+         auto view = bst.snapshot();
+         bst.insert(Spy(200));
+      }
+      Spy::reset();
+      // exercise
+      bst.insert(Spy(300));
+      auto it = bst.find(Spy(50));
+      bst.erase(it);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(bst.pSharing == nullptr);
+      assertUnit(bst.pVersion == nullptr);
+      assertUnit(bst.pool.live() == 101);
+   }  // teardown
+
+   // a snapshot can outlive its tree, and whoever lets go last
+   // destroys each element exactly once
+   void test_snapshot_outlivesTree()
+   {  // setup
+      Spy::reset();
+      custom::BST <Spy> ::snapshot_type view;
+      {
+         custom::BST <Spy> bst;
+         for (int i = 0; i < 100; i++)
+            bst.insert(Spy(i));
+         view = bst.snapshot();
+         for (int i = 0; i < 100; i += 3)
+         {
+            auto it = bst.find(Spy(i));
+            bst.erase(it);
+         }
+         // exercise
+      }
+      // verify
+      assertUnit(view.size() == 100);
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = view.begin(); it != view.end(); ++it)
+         inOrder = inOrder && *it == Spy(expected++);
+      assertUnit(inOrder);
+      assertUnit(expected == 100);
+      view.clear();
+      assertUnit(view.empty());
+      assertUnit(Spy::numAlloc() == Spy::numDelete());   // nothing leaked, nothing freed twice
+   }  // teardown
+
+   // relinking a tree in bulk copies what a snapshot still shares
+   // first, so the snapshot never sees its nodes move
+   void test_snapshot_bulk()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      custom::BST <int> bstOther;
+      for (int i = 1000; i < 1200; i++)
+         bstOther.insert(i);
+      auto view = bst.snapshot();
+      auto viewOther = bstOther.snapshot();
+      // exercise
+      custom::BST <int> bstHigh = bst.split(500);
+      bst.erase(bst.find(100), bst.find(400));
+      bstHigh.join(bstOther);
+      bst.unionWith(bstHigh);
+      // verify
+      assertUnit(std::vector<int>(view.begin(), view.end()).size() == 1000);
+      assertUnit(*view.begin() == 0 && *view.rbegin() == 999);
+      assertUnit(std::vector<int>(viewOther.begin(), viewOther.end()).size() == 200);
+      assertUnit(bst.size() == 900);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.find(250) == bst.end());
+      assertUnit(bst.find(1100) != bst.end());
+   }  // teardown
+
    /***************************************
     * Iterator
     *     BST::begin()
@@ -1293,7 +2248,7 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(it.pNode == nullptr);
+      assertUnit(it.pNode == bst.pHeader());
       assertUnit(it == bst.end());
       assertEmptyFixture(bst);
    }  // teardown
@@ -1335,23 +2290,148 @@ public:
       teardownStandardFixture(bst);
    }
 
-   // end() from the standard fixture.
-   void test_end_standard()
+   // erasing the smallest element moves begin() to the next one
+   void test_begin_afterErase()
    {  // setup
-      //                 50
-      //          +-------+-------+
-      //         30              70
-      //     +----+----+     +----+----+
-      //    20        40    60        80
       custom::BST <Spy> bst;
       setupStandardFixture(bst);
-      custom::BST<Spy>::iterator it;
+      custom::BST<Spy>::iterator it = bst.begin();
+      bst.erase(it);
       Spy::reset();
       // exercise
-      it = bst.end();
+      it = bst.begin();
       // verify
       assertUnit(Spy::numLessthan() == 0);    // does not look at any element
-      assertUnit(Spy::numEquals() == 0);      // does not look at any element
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(it.pNode != nullptr);
+      if (it.pNode)
+         assertUnit(it.pNode->data == Spy(30));
+      assertUnit(bst.pLeftmost == it.pNode);
+   }  // teardown
+
+   // last() from an empty BST
+   void test_last_empty()
+   {  // setup
+      custom::BST <Spy> bst;
+      Spy::reset();
+      // exercise
+      auto it = bst.last();
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(it == bst.end());
+      assertEmptyFixture(bst);
+   }  // teardown
+
+   // last() from the standard fixture
+   void test_last_standard()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy::reset();
+      // exercise
+      auto it = bst.last();
+      // verify
+      assertUnit(Spy::numLessthan() == 0);    // does not look at any element
+      assertUnit(Spy::numEquals() == 0);      // does not look at any element
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it.pNode != nullptr);
+      if (it.pNode && bst.root && bst.root->pRight)
+         assertUnit(it.pNode == bst.root->pRight->pRight);
+      if (it.pNode)
+         assertUnit(it.pNode->data == Spy(80));
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // erasing the largest elements moves last() back each time
+   void test_last_afterErase()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert((i * 37) % 100);
+      bool valid = true;
+      // exercise
+      for (int i = 99; i >= 0 && valid; i--)
+      {
+         auto it = bst.last();
+         valid = it != bst.end() && *it == i && *bst.begin() == 0;
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(bst.last() == bst.end());
+      assertUnit(bst.begin() == bst.end());
+      assertUnit(bst.root == nullptr);
+      assertUnit(bst.pLeftmost == bst.pHeader());
+      assertUnit(bst.rightmost() == bst.pHeader());
+   }  // teardown
+
+   // rbegin() to rend() of an empty BST is empty
+   void test_rbegin_empty()
+   {  // setup
+      custom::BST <int> bst;
+      // exercise
+      auto it = bst.rbegin();
+      // verify
+      assertUnit(it == bst.rend());
+      assertUnit(it.base() == bst.end());
+   }  // teardown
+
+   // rbegin() to rend() visits the standard fixture largest first
+   void test_rbegin_standard()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      int expected = 80;
+      bool valid = true;
+      Spy::reset();
+      // exercise
+      for (auto it = bst.rbegin(); it != bst.rend() && valid; ++it)
+      {
+         valid = *it == Spy(expected);
+         expected -= 10;
+      }
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(valid);
+      assertUnit(expected == 10);
+      assertUnit(bst.rbegin().base() == bst.end());
+      assertUnit(bst.rend().base() == bst.begin());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // end() from the standard fixture.
+   void test_end_standard()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it;
+      Spy::reset();
+      // exercise
+      it = bst.end();
+      // verify
+      assertUnit(Spy::numLessthan() == 0);    // does not look at any element
+      assertUnit(Spy::numEquals() == 0);      // does not look at any element
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1361,7 +2441,7 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(it.pNode == nullptr);
+      assertUnit(it.pNode == bst.pHeader());
       assertStandardFixture(bst);
       // teardown
       teardownStandardFixture(bst);
@@ -1569,7 +2649,7 @@ public:
       //         30              70
       //     +----+----+     +----+----+
       //    20        40    60        80
-      assertUnit(it.pNode == nullptr);
+      assertUnit(it.pNode == bst.pHeader());
       assertUnit(it == bst.end());
       assertStandardFixture(bst);
       // teardown
@@ -1587,7 +2667,7 @@ public:
       custom::BST <Spy> bst;
       setupStandardFixture(bst);
       custom::BST<Spy>::iterator it;
-      it.pNode = nullptr;
+      it = bst.end();
       Spy::reset();
       // exercise
       ++it;
@@ -1608,8 +2688,103 @@ public:
       //         30              70
       //     +----+----+     +----+----+
       //    20        40    60        80
-      assertUnit(it.pNode == nullptr);
+      assertUnit(it.pNode == bst.pHeader());
+      assertUnit(it == bst.end());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // decrement from end() lands on the largest element
+   void test_iterator_decrement_standardEnd()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it = bst.end();
+      Spy::reset();
+      // exercise
+      --it;
+      // verify
+      assertUnit(Spy::numLessthan() == 0);    // does not look at any element
+      assertUnit(Spy::numEquals() == 0);      // does not look at any element
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it == bst.last());
+      if (it.pNode && bst.root && bst.root->pRight)
+         assertUnit(it.pNode == bst.root->pRight->pRight);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // decrement from end() of an empty tree stays at end()
+   void test_iterator_decrement_emptyEnd()
+   {  // setup
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::iterator it = bst.end();
+      // exercise
+      --it;
+      // verify
       assertUnit(it == bst.end());
+      assertUnit(it == bst.begin());
+      assertEmptyFixture(bst);
+   }  // teardown
+
+   // decrement from end() reads the header's right link rather than
+   // walking down the right spine: with the spine cut, a walk would
+   // stop at the root
+   void test_iterator_decrement_endNoWalk()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it = bst.end();
+      auto pSpine = bst.root->pRight;
+      bst.root->pRight = nullptr;
+      // exercise
+      --it;
+      // verify
+      bst.root->pRight = pSpine;
+      assertUnit(bst.pHeader()->pRight == bst.rightmost());
+      assertUnit(it.pNode == bst.rightmost());
+      assertUnit(it.pNode && *it == Spy(80));
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // walk the whole tree backwards from end() to begin()
+   void test_iterator_decrement_standardBegin()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it = bst.end();
+      int expected = 80;
+      bool valid = true;
+      // exercise
+      while (it != bst.begin() && valid)
+      {
+         --it;
+         valid = *it == Spy(expected);
+         expected -= 10;
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(expected == 10);
+      assertUnit(it == bst.begin());
       assertStandardFixture(bst);
       // teardown
       teardownStandardFixture(bst);
@@ -1695,8 +2870,8 @@ public:
       // exercise
       it = bst.find(s);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][30][20]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][20], then [20] back
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1738,8 +2913,8 @@ public:
       // exercise
       it = bst.find(s);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][70][80]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][80], then [80] back
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1781,8 +2956,8 @@ public:
       // exercise
       it = bst.find(s);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][30][40]
-      assertUnit(Spy::numLessthan() == 3);    // compare [50][30][40]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40], then [40] back
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1798,7 +2973,146 @@ public:
       teardownStandardFixture(bst);
    }
 
+   /***************************************
+    * BOUNDS
+    *    BST::lowerBound(t)
+    *    BST::upperBound(t)
+    *    BST::equalRange(t)
+    *    BST::count(t)
+    ***************************************/
+
+   // the first element not less than t, one comparison per level
+   void test_lowerBound_standard()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy s40(40);
+      Spy s45(45);
+      Spy s90(90);
+      Spy::reset();
+      // exercise
+      auto it40 = bst.lowerBound(s40);
+      auto it45 = bst.lowerBound(s45);
+      auto it90 = bst.lowerBound(s90);
+      // verify
+      assertUnit(Spy::numLessthan() == 3 * 3);   // three levels each
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(it40.pNode == bst.root->pLeft->pRight);
+      assertUnit(it45.pNode == bst.root);
+      assertUnit(it90 == bst.end());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // the first element greater than t
+   void test_upperBound_standard()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      const custom::BST <Spy> & bstConst = bst;
+      Spy s10(10);
+      Spy s40(40);
+      Spy s80(80);
+      Spy::reset();
+      // exercise
+      auto it10 = bstConst.upperBound(s10);
+      auto it40 = bstConst.upperBound(s40);
+      auto it80 = bstConst.upperBound(s80);
+      // verify
+      assertUnit(Spy::numLessthan() == 3 * 3);
+      assertUnit(it10.pNode == bst.root->pLeft->pLeft);
+      assertUnit(it40.pNode == bst.root);
+      assertUnit(it80 == bst.end());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // every copy of a duplicated key, wherever the copies ended up
+   void test_equalRange_duplicates()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 50; i++)
+      {
+         bst.insert(i % 10);
+         bst.insert(100);
+      }
+      // exercise
+      auto range = bst.equalRange(7);
+      // verify
+      int num = 0;
+      bool valid = true;
+      for (auto it = range.first; it != range.second; ++it, ++num)
+         valid = valid && *it == 7;
+      assertUnit(valid);
+      assertUnit(num == 5);
+      assertUnit(range.first == bst.lowerBound(7));
+      assertUnit(range.second == bst.upperBound(7));
+      assertUnit(*range.second == 8);
+      assertUnit(*(--range.first) == 6);
+      range = bst.equalRange(100);
+      assertUnit(range.first == bst.lowerBound(100));
+      assertUnit(range.second == bst.end());
+   }  // teardown
+
+   // a missing key gives an empty range where it would go
+   void test_equalRange_missing()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy s65(65);
+      Spy::reset();
+      // exercise
+      auto range = bst.equalRange(s65);
+      // verify
+      assertUnit(Spy::numLessthan() == 4);      // [50], [70] both ways, [60]
+      assertUnit(range.first == range.second);
+      assertUnit(range.first.pNode == bst.root->pRight);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // count duplicates with and without subtree sizes
+   void test_count_duplicates()
+   {  // setup
+      custom::BST <int> bst;
+      custom::BST <int, std::less <int>, true> bstRanked;
+      for (int i = 0; i < 100; i++)
+      {
+         bst.insert(i % 7);
+         bstRanked.insert(i % 7);
+      }
+      // exercise and verify
+      assertUnit(bst.count(1) == 15);
+      assertUnit(bst.count(2) == 14);
+      assertUnit(bst.count(9) == 0);
+      assertUnit(bstRanked.count(1) == 15);
+      assertUnit(bstRanked.count(2) == 14);
+      assertUnit(bstRanked.count(-1) == 0);
+   }  // teardown
 
+   // a transparent comparator finds strings from C strings as is
+   void test_find_transparent()
+   {  // setup
+      custom::BST <std::string, std::less <>> bst;
+      for (const char * word : { "pear", "fig", "plum", "date", "lime", "kiwi", "apple" })
+         bst.insert(std::string(word));
+      // exercise and verify
+      assertUnit(bst.find("kiwi") != bst.end());
+      assertUnit(bst.find("grape") == bst.end());
+      assertUnit(*bst.lowerBound("grape") == "kiwi");
+      assertUnit(*bst.upperBound("lime") == "pear");
+      assertUnit(bst.count("fig") == 1);
+      auto range = bst.equalRange("plum");
+      assertUnit(range.first != range.second && *range.first == "plum");
+   }  // teardown
 
    /***************************************
     * Insert
@@ -1810,10 +3124,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(60);
       Spy::reset();
       // exercise
@@ -1848,7 +3163,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
       if (p50 && p50->pRight)
       {
@@ -1860,9 +3175,9 @@ public:
       }
       // teardown
       if (p50 && p50->pRight && p50->pRight != p50)
-         delete p50->pRight;
+         bst.pool.destroy(p50->pRight);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -1872,10 +3187,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(40);
       Spy::reset();
       // exercise
@@ -1911,7 +3227,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft != nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p50 && p50->pLeft)
@@ -1925,9 +3241,9 @@ public:
 
       // teardown
       if (p50 && p50->pLeft && p50->pLeft != p50)
-         delete p50->pLeft;
+         bst.pool.destroy(p50->pLeft);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -1937,10 +3253,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(50);
       Spy::reset();
       // exercise
@@ -1975,7 +3292,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p50 && p50->pRight)
@@ -1989,9 +3306,9 @@ public:
 
       // teardown
       if (p50 && p50->pRight && p50->pRight != p50)
-         delete p50->pRight;
+         bst.pool.destroy(p50->pRight);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2011,8 +3328,8 @@ public:
       // exercise
       auto pairBST = bst.insert(s, true /* keepUnique */);
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
-      assertUnit(Spy::numEquals() == 3);      // compare [50][30][40]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40], then [40] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2047,10 +3364,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(60);
       Spy::reset();
       // exercise
@@ -2085,7 +3403,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
       if (p50 && p50->pRight)
       {
@@ -2097,9 +3415,9 @@ public:
       }
       // teardown
       if (p50 && p50->pRight && p50->pRight != p50)
-         delete p50->pRight;
+         bst.pool.destroy(p50->pRight);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2109,10 +3427,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(40);
       Spy::reset();
       // exercise
@@ -2149,7 +3468,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft != nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p50 && p50->pLeft)
@@ -2163,9 +3482,9 @@ public:
 
       // teardown
       if (p50 && p50->pLeft && p50->pLeft != p50)
-         delete p50->pLeft;
+         bst.pool.destroy(p50->pLeft);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2175,10 +3494,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(50);
       Spy::reset();
       // exercise
@@ -2214,7 +3534,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p50 && p50->pRight)
@@ -2228,9 +3548,9 @@ public:
 
       // teardown
       if (p50 && p50->pRight && p50->pRight != p50)
-         delete p50->pRight;
+         bst.pool.destroy(p50->pRight);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2250,8 +3570,8 @@ public:
       // exercise
       auto pairBST = bst.insert(std::move(s), true /* keepUnique */);
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
-      assertUnit(Spy::numEquals() == 3);      // compare [50][30][40]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40], then [40] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2311,10 +3631,10 @@ public:
          assertUnit(bst.root->isRed == false);
          assertUnit(bst.root->pLeft == nullptr);
          assertUnit(bst.root->pRight == nullptr);
-         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->pParent == bst.pHeader());
       }
       // teardown
-      delete bst.root;
+      bst.pool.destroy(bst.root);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2324,10 +3644,11 @@ public:
    {  // setup
       //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode *p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST<Spy>::BNode *p50 = bst.pool.construct(Spy(50));
       p50->isRed = false;
       bst.root = p50;
       bst.numElements = 1;
+      bst.relink();
       Spy s(30);
       Spy::reset();
       // exercise
@@ -2358,7 +3679,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft != nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p50 && p50->pLeft)
@@ -2372,9 +3693,9 @@ public:
 
       // teardown
       if (p50 && p50->pLeft && p50->pLeft != p50)
-         delete p50->pLeft;
+         bst.pool.destroy(p50->pLeft);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2385,9 +3706,10 @@ public:
       //           (50b)
       //        +----+----+
       //      (30r)     (70r)
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
 
       p50->pLeft  = p30;
       p50->pRight = p70;
@@ -2396,9 +3718,9 @@ public:
       p50->isRed = false;
       p30->isRed = p70->isRed = true;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 3;
+      bst.relink();
 
       Spy s(20);
       Spy::reset();
@@ -2434,7 +3756,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == p30);
          assertUnit(p50->pRight == p70);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p30)
@@ -2465,13 +3787,13 @@ public:
       }
       // teardown
       if (p30->pLeft && p30->pLeft != p30)
-         delete p30->pLeft;
+         bst.pool.destroy(p30->pLeft);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2482,8 +3804,9 @@ public:
       //              (50b)
       //           +----+
       //         (30r)
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
 
       p50->pLeft   = p30;
       p30->pParent = p50;
@@ -2491,9 +3814,9 @@ public:
       p50->isRed = false;
       p30->isRed = true;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 2;
+      bst.relink();
 
       Spy s(10);
       Spy::reset();
@@ -2527,7 +3850,7 @@ public:
          assertUnit(p30->isRed == false);
          assertUnit(p30->pLeft != nullptr);
          assertUnit(p30->pRight == p50);
-         assertUnit(p30->pParent == nullptr);
+         assertUnit(p30->pParent == bst.pHeader());
       }
 
       if (p30 && p30->pLeft)
@@ -2550,11 +3873,11 @@ public:
 
       // teardown
       if (p30 && p30->pLeft && p30->pLeft != p30)
-         delete p30->pLeft;
+         bst.pool.destroy(p30->pLeft);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2565,8 +3888,9 @@ public:
       //              (50b)
       //                +----+
       //                   (70r)
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
 
       p50->pRight = p70;
       p70->pParent = p50;
@@ -2574,9 +3898,9 @@ public:
       p50->isRed = false;
       p70->isRed = true;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 2;
+      bst.relink();
 
       Spy s(90);
       Spy::reset();
@@ -2610,7 +3934,7 @@ public:
          assertUnit(p70->isRed == false);
          assertUnit(p70->pLeft == p50);
          assertUnit(p70->pRight != nullptr);
-         assertUnit(p70->pParent == nullptr);
+         assertUnit(p70->pParent == bst.pHeader());
       }
 
       if (p70->pRight)
@@ -2633,11 +3957,11 @@ public:
 
       // teardown
       if (p70->pRight && p70->pRight != p70)
-         delete p70->pRight;
+         bst.pool.destroy(p70->pRight);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2648,8 +3972,9 @@ public:
       //                   (50b)
       //           +---------+
       //         (30r)
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
 
       p50->pLeft = p30;
       p30->pParent = p50;
@@ -2657,9 +3982,9 @@ public:
       p30->isRed = true;
       p50->isRed = false;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 2;
+      bst.relink();
 
       Spy s(40);
       Spy::reset();
@@ -2693,7 +4018,7 @@ public:
          assertUnit(bst.root->isRed == false);
          assertUnit(bst.root->pLeft == p30);
          assertUnit(bst.root->pRight == p50);
-         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->pParent == bst.pHeader());
       }
 
       if (p30)
@@ -2716,9 +4041,9 @@ public:
 
       // teardown
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       bst.numElements = 0;
       bst.root = nullptr;
    }
@@ -2729,8 +4054,9 @@ public:
       //         (50b)
       //           +---------+
       //                   (70r)
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
 
       p50->pRight = p70;
       p70->pParent = p50;
@@ -2738,9 +4064,9 @@ public:
       p70->isRed = true;
       p50->isRed = false;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 2;
+      bst.relink();
 
       Spy s(60);
       Spy::reset();
@@ -2774,7 +4100,7 @@ public:
          assertUnit(bst.root->isRed == false);
          assertUnit(bst.root->pLeft == p50);
          assertUnit(bst.root->pRight == p70);
-         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->pParent == bst.pHeader());
       }
 
       if (p50)
@@ -2797,9 +4123,9 @@ public:
       }
       // teardown
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       bst.numElements = 0;
       bst.root = nullptr;
    }
@@ -2812,10 +4138,11 @@ public:
       //         (30b)     (70b)
       //       +---+
       //     (20r)
-      custom::BST<Spy>::BNode* p20 = new custom::BST<Spy>::BNode(Spy(20));
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p20 = bst.pool.construct(Spy(20));
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
 
       p50->pLeft  = p30;
       p50->pRight = p70;
@@ -2826,9 +4153,9 @@ public:
       p20->isRed = true;
       p30->isRed = p70->isRed = p50->isRed = false;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 4;
+      bst.relink();
 
       Spy s(10);
       Spy::reset();
@@ -2864,7 +4191,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == p20);
          assertUnit(p50->pRight == p70);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p20)
@@ -2905,15 +4232,15 @@ public:
 
       // teardown
       if (p20 && p20->pLeft && p20->pLeft != p20)
-        delete p20->pLeft;
+        bst.pool.destroy(p20->pLeft);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       if (p20)
-         delete p20;
+         bst.pool.destroy(p20);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -2926,10 +4253,11 @@ public:
       //         (30b)     (70b)
       //                     +---+
       //                       (80r)
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
-      custom::BST<Spy>::BNode* p80 = new custom::BST<Spy>::BNode(Spy(80));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
+      custom::BST<Spy>::BNode* p80 = bst.pool.construct(Spy(80));
 
       p50->pLeft = p30;
       p50->pRight = p70;
@@ -2940,9 +4268,9 @@ public:
       p80->isRed = true;
       p30->isRed = p70->isRed = p50->isRed = false;
 
-      custom::BST <Spy> bst;
       bst.root = p50;
       bst.numElements = 4;
+      bst.relink();
 
       Spy s(90);
       Spy::reset();
@@ -2978,7 +4306,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == p30);
          assertUnit(p50->pRight == p80);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p30)
@@ -3019,15 +4347,15 @@ public:
 
       // teardown
       if (p80 && p80->pRight && p80->pRight != p80)
-         delete p80->pRight;
+         bst.pool.destroy(p80->pRight);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       if (p80)
-         delete p80;
+         bst.pool.destroy(p80);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       bst.root = nullptr;
       bst.numElements = 0;
    }
@@ -3042,13 +4370,14 @@ public:
       //   (10b)       (50b)
       //            +----+----+
       //          (30r)     (60r)
-      custom::BST<Spy>::BNode* p10 = new custom::BST<Spy>::BNode(Spy(10));
-      custom::BST<Spy>::BNode* p20 = new custom::BST<Spy>::BNode(Spy(20));
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p60 = new custom::BST<Spy>::BNode(Spy(60));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
-      custom::BST<Spy>::BNode* p80 = new custom::BST<Spy>::BNode(Spy(80));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p10 = bst.pool.construct(Spy(10));
+      custom::BST<Spy>::BNode* p20 = bst.pool.construct(Spy(20));
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p60 = bst.pool.construct(Spy(60));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
+      custom::BST<Spy>::BNode* p80 = bst.pool.construct(Spy(80));
 
       p20->pLeft  = p10;
       p20->pRight = p50;
@@ -3063,9 +4392,9 @@ public:
       p20->isRed = p30->isRed = p60->isRed = true;
       p10->isRed = p50->isRed = p70->isRed = p80->isRed = false;
 
-      custom::BST <Spy> bst;
       bst.root = p70;
       bst.numElements = 7;
+      bst.relink();
 
       Spy s(40);
       Spy::reset();
@@ -3139,7 +4468,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == p20);
          assertUnit(p50->pRight == p70);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p60)
@@ -3170,21 +4499,21 @@ public:
       }
       // teardown
       if (p30 && p30->pRight && p30->pRight != p30)
-         delete p30->pRight;
+         bst.pool.destroy(p30->pRight);
       if (p10)
-         delete p10;
+         bst.pool.destroy(p10);
       if (p20)
-         delete p20;
+         bst.pool.destroy(p20);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       if (p60)
-         delete p60;
+         bst.pool.destroy(p60);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       if (p80)
-         delete p80;
+         bst.pool.destroy(p80);
       bst.numElements = 0;
       bst.root = nullptr;
    }
@@ -3199,13 +4528,14 @@ public:
       //                       (50b)       (90b)
       //                    +----+----+
       //                  (40r)     (70r)
-      custom::BST<Spy>::BNode* p20 = new custom::BST<Spy>::BNode(Spy(20));
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p40 = new custom::BST<Spy>::BNode(Spy(40));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
-      custom::BST<Spy>::BNode* p80 = new custom::BST<Spy>::BNode(Spy(80));
-      custom::BST<Spy>::BNode* p90 = new custom::BST<Spy>::BNode(Spy(90));
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p20 = bst.pool.construct(Spy(20));
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p40 = bst.pool.construct(Spy(40));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
+      custom::BST<Spy>::BNode* p80 = bst.pool.construct(Spy(80));
+      custom::BST<Spy>::BNode* p90 = bst.pool.construct(Spy(90));
 
       p30->pLeft  = p20;
       p30->pRight = p80;
@@ -3220,9 +4550,9 @@ public:
       p40->isRed = p70->isRed = p80->isRed = true;
       p20->isRed = p30->isRed = p50->isRed = p90->isRed = false;
 
-      custom::BST <Spy> bst;
       bst.root = p30;
       bst.numElements = 7;
+      bst.relink();
 
       Spy s(60);
       Spy::reset();
@@ -3287,7 +4617,7 @@ public:
          assertUnit(p50->isRed == false);
          assertUnit(p50->pLeft == p30);
          assertUnit(p50->pRight == p80);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->pParent == bst.pHeader());
       }
 
       if (p70 && p70->pLeft)
@@ -3328,54 +4658,754 @@ public:
 
       // teardown
       if (p70 && p70->pLeft && p70->pLeft != p70)
-         delete p70->pLeft;
+         bst.pool.destroy(p70->pLeft);
       if (p20)
-         delete p20;
+         bst.pool.destroy(p20);
       if (p30)
-         delete p30;
+         bst.pool.destroy(p30);
       if (p40)
-         delete p40;
+         bst.pool.destroy(p40);
       if (p50)
-         delete p50;
+         bst.pool.destroy(p50);
       if (p70)
-         delete p70;
+         bst.pool.destroy(p70);
       if (p80)
-         delete p80;
+         bst.pool.destroy(p80);
       if (p90)
-         delete p90;
+         bst.pool.destroy(p90);
       bst.numElements = 0;
       bst.root = nullptr;
    }
 
    /***************************************
-    * Erase
-    *    BST::erase(it)
+    * INSERT with a HINT
+    *    BST::insert(hint, t)
     ***************************************/
 
-   // erase from an empty BST
-   void test_erase_empty()
+   // appending in order at end() compares only with the largest element
+   void test_insertHint_append()
    {  // setup
       custom::BST <Spy> bst;
-      auto it = bst.end();
+      std::vector <Spy> keys;
+      for (int i = 0; i < 1000; i++)
+         keys.push_back(Spy(i));
       Spy::reset();
       // exercise
-      auto itReturn = bst.erase(it);
+      for (const Spy & key : keys)
+         bst.insert(bst.end(), key, true);
       // verify
-      assertUnit(Spy::numLessthan() == 0);
-      assertUnit(Spy::numCopy() == 0);
-      assertUnit(Spy::numAlloc() == 0);
-      assertUnit(Spy::numEquals() == 0);
-      assertUnit(Spy::numDestructor() == 0);
-      assertUnit(Spy::numDelete() == 0);
-      assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numDefault() == 0);
-      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 1000);
       assertUnit(Spy::numCopyMove() == 0);
-      assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(itReturn == bst.end());
-      assertEmptyFixture(bst);
-   }  // teardown
-
+      assertUnit(Spy::numLessthan() == 999);  // compare each with [rightmost] only
+      assertUnit(bst.numElements == 1000);
+      assertUnit(bst.pLeftmost != nullptr && bst.pLeftmost->data == Spy(0));
+      assertUnit(bst.rightmost() != nullptr && bst.rightmost()->data == Spy(999));
+      if (bst.root)
+      {
+         bst.root->verifyBTree();
+         assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      }
+   }  // teardown
+
+   // a hint at the element just after the new one
+   void test_insertHint_before()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p40 = bst.root->pLeft->pRight;
+      Spy s45(45);
+      Spy::reset();
+      // exercise
+      auto pairReturn = bst.insert(custom::BST <Spy> ::iterator(bst.root), s45);
+      // verify
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numLessthan() == 2);    // compare [50] then [40]
+      assertUnit(pairReturn.second == true);
+      assertUnit(pairReturn.first != bst.end());
+      if (pairReturn.first != bst.end())
+         assertUnit(*pairReturn.first == Spy(45));
+      assertUnit(p40->pRight == pairReturn.first.pNode);
+      assertUnit(bst.numElements == 8);
+   }  // teardown
+
+   /***************************************
+    * ASSIGN SORTED
+    *    BST::assignSorted(first, last)
+    ***************************************/
+
+   // a sorted range is laid down without comparing or rotating
+   void test_assignSorted_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      std::initializer_list<Spy> ilSrc{Spy(20), Spy(30), Spy(40), Spy(50), Spy(60), Spy(70), Spy(80)};
+      custom::BST <Spy> bst;
+      Spy::reset();
+      // exercise
+      bst.assignSorted(ilSrc.begin(), ilSrc.end());
+      // verify
+      assertUnit(Spy::numCopy() == 7);
+      assertUnit(Spy::numAlloc() == 7);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(bst.pool.capacity() == 7);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // every size comes out balanced with a valid coloring
+   void test_assignSorted_redBlack()
+   {  // setup
+      std::vector<int> v;
+      custom::BST <int> bst;
+      bool valid = true;
+      // exercise
+      for (int num = 0; num <= 300 && valid; num++)
+      {
+         bst.assignSorted(v.begin(), v.end());
+         if (bst.root)
+         {
+            bst.root->verifyBTree();
+            valid = !bst.root->isRed &&
+                    bst.root->pParent == bst.pHeader() &&
+                    bst.root->verifyRedBlack(bst.root->findDepth()) &&
+                    bst.root->computeSize() == (int)bst.numElements;
+         }
+         valid = valid && bst.numElements == v.size();
+         v.push_back(num);
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(bst.numElements == 300);
+   }  // teardown
+
+   /***************************************
+    * EMPLACE
+    *    BST::emplace(args...)
+    *    BST::emplaceUnique(args...)
+    ***************************************/
+
+   // the new element is built inside its node: no copy, no move
+   void test_emplace_inPlace()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p60 = bst.root->pRight->pLeft;
+      Spy::reset();
+      // exercise
+      auto pairReturn = bst.emplace(65);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [65] in place
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][70][60]
+      assertUnit(pairReturn.second == true);
+      assertUnit(pairReturn.first != bst.end());
+      if (pairReturn.first != bst.end())
+         assertUnit(*pairReturn.first == Spy(65));
+      assertUnit(p60->pRight == pairReturn.first.pNode);
+      assertUnit(bst.numElements == 8);
+   }  // teardown
+
+   // a duplicate that cannot be compared before it is built is thrown away
+   void test_emplaceUnique_duplicateBuilt()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p60 = bst.root->pRight->pLeft;
+      Spy::reset();
+      // exercise
+      auto pairReturn = bst.emplaceUnique(60);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [60] to learn its key
+      assertUnit(Spy::numDestructor() == 1);  // and throw it away
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pairReturn.second == false);
+      assertUnit(pairReturn.first.pNode == p60);
+      assertUnit(bst.pool.live() == 7);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // a duplicate that is already a key is found before anything is built
+   void test_emplaceUnique_duplicateKey()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p60 = bst.root->pRight->pLeft;
+      Spy s60(60);
+      Spy::reset();
+      // exercise
+      auto pairReturn = bst.emplaceUnique(std::move(s60));
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][60] then equal? [60]
+      assertUnit(pairReturn.second == false);
+      assertUnit(pairReturn.first.pNode == p60);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   /***************************************
+    * EMPLACE HINT
+    *    BST::emplaceHint(hint, args...)
+    *    BST::emplaceHintUnique(hint, args...)
+    ***************************************/
+
+   // a good hint in the middle takes two comparisons
+   void test_emplaceHint_middle()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p60 = bst.root->pRight->pLeft;
+      Spy::reset();
+      // exercise
+      auto pairReturn = bst.emplaceHintUnique(custom::BST <Spy> ::iterator(p60), 55);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [55] in place
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numLessthan() == 2);    // compare [60] then [50]
+      assertUnit(pairReturn.second == true);
+      assertUnit(p60->pLeft == pairReturn.first.pNode);
+      assertUnit(bst.numElements == 8);
+   }  // teardown
+
+   // appending in order with end() as the hint never searches
+   void test_emplaceHint_append()
+   {  // setup
+      custom::BST <Spy> bst;
+      Spy::reset();
+      // exercise
+      for (int i = 0; i < 100; i++)
+         bst.emplaceHint(bst.end(), i);
+      // verify
+      assertUnit(Spy::numNondefault() == 100);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numLessthan() == 99);   // compare each with the largest
+      assertUnit(bst.numElements == 100);
+      assertUnit(bst.root != nullptr);
+      if (bst.root)
+      {
+         bst.root->verifyBTree();
+         assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      }
+      assertUnit(bst.rightmost() != nullptr && bst.rightmost()->data == Spy(99));
+   }  // teardown
+
+   // a hint in the wrong place still puts the element in the right place
+   void test_emplaceHint_wrong()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 100; i += 2)
+         bst.insert(i);
+      // exercise
+      for (int i = 1; i < 100; i += 2)
+      {
+         bst.emplaceHintUnique(bst.begin(), i);
+         bst.emplaceHintUnique(bst.end(), i);
+      }
+      // verify
+      assertUnit(bst.numElements == 100);
+      int expected = 0;
+      bool valid = true;
+      for (auto it = bst.begin(); it != bst.end() && valid; ++it)
+         valid = *it == expected++;
+      assertUnit(valid);
+      assertUnit(expected == 100);
+      if (bst.root)
+         assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+   }  // teardown
+
+   /***************************************
+    * EXTRACT
+    *    BST::extract(it)
+    *    BST::extract(t)
+    ***************************************/
+
+   // a leaf comes out without being copied or destroyed
+   void test_extract_leaf()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p20 = bst.root->pLeft->pLeft;
+      Spy::reset();
+      // exercise
+      custom::BST <Spy> ::node_type nh = bst.extract(custom::BST <Spy> ::iterator(p20));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(!nh.empty());
+      assertUnit(nh.pNode == p20);
+      assertUnit(nh.value() == Spy(20));
+      assertUnit(p20->pParent == nullptr);
+      assertUnit(bst.numElements == 6);
+      assertUnit(bst.pool.live() == 6);
+      assertUnit(bst.root->pLeft->pLeft == nullptr);
+      assertUnit(bst.pLeftmost == bst.root->pLeft);
+      // exercise: put it back
+      Spy::reset();
+      auto pairReturn = bst.insert(std::move(nh));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(nh.empty());
+      assertUnit(pairReturn.second == true);
+      assertUnit(pairReturn.first.pNode == p20);
+      assertUnit(bst.pool.live() == 7);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // taking the root out keeps the tree red-black
+   void test_extract_root()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST <Spy> ::BNode * p50 = bst.root;
+      // exercise
+      auto nh = bst.extract(Spy(50));
+      // verify
+      assertUnit(nh.pNode == p50);
+      assertUnit(bst.numElements == 6);
+      assertUnit(bst.root != nullptr && bst.root != p50);
+      if (bst.root)
+      {
+         bst.root->verifyBTree();
+         assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      }
+   }  // teardown
+
+   // there is nothing to take out of end() or a missing key
+   void test_extract_missing()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      // exercise
+      auto nhEnd = bst.extract(bst.end());
+      auto nhMissing = bst.extract(Spy(99));
+      // verify
+      assertUnit(nhEnd.empty());
+      assertUnit(!nhMissing);
+      assertUnit(bst.numElements == 7);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // a handle keeps its node alive after the tree is gone
+   void test_extract_outlivesTree()
+   {  // setup
+      custom::BST <Spy> ::node_type nh;
+      {
+         custom::BST <Spy> bst;
+         for (int i = 0; i < 100; i++)
+            bst.insert(Spy(i));
+         nh = bst.extract(Spy(42));
+      }
+      Spy::reset();
+      // verify
+      assertUnit(!nh.empty());
+      assertUnit(nh.value() == Spy(42));
+      // exercise
+      nh = custom::BST <Spy> ::node_type();
+      // verify
+      assertUnit(Spy::numDestructor() == 1 + 1); // [42] and the Spy(42) above
+      assertUnit(nh.empty());
+   }
+
+   // a dropped handle's slot goes back to the tree it came from
+   void test_extract_dropReusesSlot()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 16; i++)
+         bst.insert(i);
+      size_t capacity = bst.pool.capacity();
+      custom::BST <int> ::node_type nh = bst.extract(7);
+      custom::BST <int> ::BNode * pDropped = nh.pNode;
+      // exercise
+      nh = custom::BST <int> ::node_type();
+      auto pairBST = bst.insert(99);
+      // verify
+      assertUnit(pairBST.first.pNode == pDropped);
+      assertUnit(bst.pool.capacity() == capacity);
+      assertUnit(bst.pool.live() == 16);
+   }  // teardown
+
+   /***************************************
+    * INSERT a NODE HANDLE
+    *    BST::insert(nh)
+    *    BST::merge(source)
+    ***************************************/
+
+   // a node moves to another tree at the same address
+   void test_insertNode_otherTree()
+   {  // setup
+      custom::BST <Spy> bstDest;
+      custom::BST <Spy> ::BNode * pNode;
+      {
+         custom::BST <Spy> bstSrc;
+         for (int i = 0; i < 100; i++)
+            bstSrc.insert(Spy(i));
+         auto nh = bstSrc.extract(Spy(42));
+         pNode = nh.pNode;
+         Spy::reset();
+         // exercise
+         auto pairReturn = bstDest.insert(std::move(nh));
+         // verify
+         assertUnit(Spy::numCopy() == 0);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAlloc() == 0);
+         assertUnit(pairReturn.second == true);
+         assertUnit(pairReturn.first.pNode == pNode);
+         assertUnit(bstSrc.pool.live() == 99);
+      }  // the source tree and its pool go away
+      // verify
+      assertUnit(bstDest.numElements == 1);
+      assertUnit(bstDest.pool.live() == 1);
+      assertUnit(bstDest.root == pNode);
+      assertUnit(bstDest.root->data == Spy(42));
+      bstDest.insert(Spy(41));
+      bstDest.insert(Spy(43));
+      assertUnit(bstDest.root->data == Spy(42));
+   }  // teardown
+
+   // a duplicate stays in its handle
+   void test_insertNode_duplicate()
+   {  // setup
+      custom::BST <Spy> bstSrc;
+      custom::BST <Spy> bstDest;
+      setupStandardFixture(bstDest);
+      bstSrc.insert(Spy(40));
+      auto nh = bstSrc.extract(bstSrc.begin());
+      custom::BST <Spy> ::BNode * pNode = nh.pNode;
+      // exercise
+      auto pairReturn = bstDest.insert(std::move(nh), true);
+      // verify
+      assertUnit(pairReturn.second == false);
+      assertUnit(pairReturn.first.pNode == bstDest.root->pLeft->pRight);
+      assertUnit(nh.pNode == pNode);
+      assertStandardFixture(bstDest);
+      // teardown
+      teardownStandardFixture(bstDest);
+   }
+
+   // merging ranges that do not overlap relinks every node
+   void test_merge_disjoint()
+   {  // setup
+      custom::BST <Spy> bstDest;
+      for (int i = 0; i < 500; i++)
+         bstDest.insert(Spy(i));
+      std::vector <custom::BST <Spy> ::BNode *> nodes;
+      {
+         custom::BST <Spy> bstSrc;
+         for (int i = 500; i < 1000; i++)
+            nodes.push_back(bstSrc.insert(Spy(i)).first.pNode);
+         Spy::reset();
+         // exercise
+         bstDest.merge(bstSrc, true);
+         // verify
+         assertUnit(Spy::numCopy() == 0);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAlloc() == 0);
+         assertUnit(Spy::numDestructor() == 0);
+         assertUnit(Spy::numLessthan() < 2 * 500 + 20); // one search, then the hint
+         assertUnit(bstSrc.empty());
+         assertUnit(bstSrc.pool.live() == 0);
+      }
+      // verify
+      assertUnit(bstDest.numElements == 1000);
+      assertUnit(bstDest.pool.live() == 1000);
+      int expected = 0;
+      bool valid = true;
+      for (auto it = bstDest.begin(); it != bstDest.end() && valid; ++it, ++expected)
+         valid = *it == Spy(expected) && (expected < 500 || it.pNode == nodes[expected - 500]);
+      assertUnit(valid);
+      assertUnit(expected == 1000);
+      if (bstDest.root)
+      {
+         bstDest.root->verifyBTree();
+         assertUnit(bstDest.root->verifyRedBlack(bstDest.root->findDepth()));
+      }
+   }  // teardown
+
+   // merging one node holds only the slab it is in
+   void test_merge_oneSlab()
+   {  // setup
+      custom::BST <int> bstSrc;
+      custom::BST <int> bstDest;
+      for (int i = 0; i < 100; i++)
+         bstSrc.insert(i);
+      for (int i = 0; i < 99; i++)
+      {
+         auto it = bstSrc.find(i);
+         bstSrc.erase(it);
+      }
+      // exercise
+      bstDest.merge(bstSrc);
+      // verify
+      assertUnit(bstSrc.pool.slabs.size() > 1);
+      assertUnit(bstDest.pool.slabs.size() == 1);
+      assertUnit(bstDest.numElements == 1);
+      assertUnit(bstDest.pool.live() == 1);
+      assertUnit(bstSrc.pool.live() == 0);
+   }  // teardown
+
+   // with keepUnique, duplicates stay behind
+   void test_merge_duplicates()
+   {  // setup
+      custom::BST <int> bstSrc;
+      custom::BST <int> bstDest;
+      for (int i = 0; i < 100; i += 2)
+         bstDest.insert(i);
+      for (int i = 0; i < 100; i += 3)
+         bstSrc.insert(i);
+      // exercise
+      bstDest.merge(bstSrc, true);
+      // verify
+      assertUnit(bstSrc.numElements == 17);  // 0, 6, 12, ..., 96
+      bool valid = true;
+      for (auto it = bstSrc.begin(); it != bstSrc.end(); ++it)
+         valid = valid && *it % 6 == 0;
+      assertUnit(valid);
+      assertUnit(bstDest.numElements == 50 + 34 - 17);
+      int previous = -1;
+      for (auto it = bstDest.begin(); it != bstDest.end(); ++it)
+      {
+         valid = valid && previous < *it && (*it % 2 == 0 || *it % 3 == 0);
+         previous = *it;
+      }
+      assertUnit(valid);
+      if (bstSrc.root)
+         assertUnit(bstSrc.root->verifyRedBlack(bstSrc.root->findDepth()));
+      if (bstDest.root)
+         assertUnit(bstDest.root->verifyRedBlack(bstDest.root->findDepth()));
+   }  // teardown
+
+   /***************************************
+    * ORDER STATISTICS
+    *    BST::rank(t)
+    *    BST::select(k)
+    *    BST::countRange(lo, hi)
+    *    BST::advance(it, n)
+    ***************************************/
+
+   // only a Ranked tree pays for the subtree size
+   void test_ranked_nodeSize()
+   {
+      assertUnit(sizeof(custom::BST <int> ::BNode) <
+                 sizeof(custom::BST <int, std::less <int>, true> ::BNode));
+   }
+
+   // the color sits in the padding after a small key, so a node of
+   // ints is four words on a 64-bit build, not five
+   void test_node_compact()
+   {
+      typedef custom::BST <int> ::BNode Node;
+      assertUnit(offsetof(Node, isRed) < offsetof(Node, pLeft));
+      if (sizeof(void *) == 8)
+         assertUnit(sizeof(Node) == 32);
+   }
+
+   // how many are smaller, for keys in and out of the tree
+   void test_rank_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <int, std::less <int>, true> bst;
+      for (int i : { 50, 30, 70, 20, 40, 60, 80 })
+         bst.insert(i);
+      // exercise and verify
+      assertUnit(bst.rank(10) == 0);
+      assertUnit(bst.rank(20) == 0);
+      assertUnit(bst.rank(25) == 1);
+      assertUnit(bst.rank(50) == 3);
+      assertUnit(bst.rank(65) == 5);
+      assertUnit(bst.rank(80) == 6);
+      assertUnit(bst.rank(99) == 7);
+      assertUnit(bst.root->size == 7);
+      assertUnit(bst.root->verifySize());
+   }  // teardown
+
+   // the k-th element, and end() past the last
+   void test_select_standard()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      for (int i : { 50, 30, 70, 20, 40, 60, 80 })
+         bst.insert(i);
+      // exercise and verify
+      bool valid = true;
+      for (size_t k = 0; k < 7; k++)
+         valid = valid && *bst.select(k) == 20 + 10 * (int)k;
+      assertUnit(valid);
+      assertUnit(bst.select(7) == bst.end());
+      custom::BST <int, std::less <int>, true> bstEmpty;
+      assertUnit(bstEmpty.select(0) == bstEmpty.end());
+   }  // teardown
+
+   // count the half-open range [lo, hi)
+   void test_countRange_standard()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      for (int i : { 50, 30, 70, 20, 40, 60, 80 })
+         bst.insert(i);
+      // exercise and verify
+      assertUnit(bst.countRange(0, 100) == 7);
+      assertUnit(bst.countRange(30, 70) == 4);   // 30 40 50 60
+      assertUnit(bst.countRange(31, 39) == 0);
+      assertUnit(bst.countRange(70, 30) == 0);
+      assertUnit(bst.countRange(50, 50) == 0);
+   }  // teardown
+
+   // jump either way, falling off either end to end()
+   void test_advance_standard()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      for (int i : { 50, 30, 70, 20, 40, 60, 80 })
+         bst.insert(i);
+      // exercise and verify
+      assertUnit(*bst.advance(bst.begin(), 3) == 50);
+      assertUnit(*bst.advance(bst.find(60), -3) == 30);
+      assertUnit(*bst.advance(bst.end(), -1) == 80);
+      assertUnit(*bst.advance(bst.end(), -7) == 20);
+      assertUnit(bst.advance(bst.begin(), 7) == bst.end());
+      assertUnit(bst.advance(bst.begin(), -1) == bst.end());
+      assertUnit(bst.advance(bst.end(), -8) == bst.end());
+      assertUnit(bst.indexOf(bst.find(70)) == 5);
+      assertUnit(bst.indexOf(bst.end()) == 7);
+   }  // teardown
+
+   // sizes stay right through every kind of insert and erase
+   void test_ranked_stress()
+   {  // setup
+      custom::BST <int, std::less <int>, true> bst;
+      unsigned int seed = 12345;
+      auto random = [&seed]() { seed = seed * 1103515245 + 12345; return (int)((seed >> 8) % 500); };
+      bool valid = true;
+      // exercise
+      for (int i = 0; i < 3000 && valid; i++)
+      {
+         int key = random();
+         if (i % 3 == 2)
+         {
+            auto it = bst.find(key);
+            bst.erase(it);
+         }
+         else if (i % 7 == 0)
+            bst.emplaceHintUnique(bst.end(), key);
+         else
+            bst.insert(key, true);
+         valid = bst.root == nullptr || bst.root->verifySize();
+      }
+      // verify
+      assertUnit(valid);
+      size_t k = 0;
+      for (auto it = bst.begin(); it != bst.end() && valid; ++it, ++k)
+         valid = bst.select(k) == it && bst.rank(*it) == k && bst.indexOf(it) == k;
+      assertUnit(valid);
+      assertUnit(k == bst.numElements);
+   }  // teardown
+
+   // copies, bulk loads, extracts, and merges keep the sizes
+   void test_ranked_copyAndMerge()
+   {  // setup
+      std::vector <int> sorted;
+      for (int i = 0; i < 200; i += 2)
+         sorted.push_back(i);
+      custom::BST <int, std::less <int>, true> bstSrc(custom::from_sorted, sorted.begin(), sorted.end());
+      custom::BST <int, std::less <int>, true> bstDest;
+      for (int i = 1; i < 200; i += 4)
+         bstDest.insert(i);
+      // exercise
+      custom::BST <int, std::less <int>, true> bstCopy(bstSrc);
+      auto nh = bstCopy.extract(bstCopy.find(100));
+      bstDest.insert(std::move(nh));
+      bstDest.merge(bstSrc, true);
+      // verify
+      assertUnit(bstSrc.numElements == 1);      // [100] was already there
+      assertUnit(bstSrc.root->verifySize());
+      assertUnit(bstCopy.root->verifySize());
+      assertUnit(bstCopy.root->size == 99);
+      assertUnit(bstDest.root->verifySize());
+      assertUnit(bstDest.root->size == 150);
+      assertUnit(bstDest.rank(100) == 50 + 25);
+   }  // teardown
+
+   /***************************************
+    * Erase
+    *    BST::erase(it)
+    ***************************************/
+
+   // erase from an empty BST
+   void test_erase_empty()
+   {  // setup
+      custom::BST <Spy> bst;
+      auto it = bst.end();
+      Spy::reset();
+      // exercise
+      auto itReturn = bst.erase(it);
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(itReturn == bst.end());
+      assertEmptyFixture(bst);
+   }  // teardown
+
    // erase with an empty iterator
    void test_erase_standardMissing()
    {  // setup
@@ -3442,7 +5472,7 @@ public:
       assertUnit(itReturn == custom::BST <Spy> ::iterator(bst.root->pRight));
       assertUnit(bst.root->pRight->pLeft == nullptr);
       assertUnit(bst.numElements == 6);
-      bst.root->pRight->pLeft = new custom::BST<Spy>::BNode(Spy(60));
+      bst.root->pRight->pLeft = bst.pool.construct(Spy(60));
       bst.root->pRight->pLeft->pParent = bst.root->pRight;
       bst.numElements = 7;
       assertStandardFixture(bst);
@@ -3460,12 +5490,12 @@ public:
       //            +--+--+
       //           20    40
       custom :: BST <int> bst;
-      auto p10 = new custom::BST<int>::BNode(10);
-      auto p20 = new custom::BST<int>::BNode(20);
-      auto p30 = new custom::BST<int>::BNode(30);
-      auto p40 = new custom::BST<int>::BNode(40);
-      auto p60 = new custom::BST<int>::BNode(60);
-      auto p50 = new custom::BST<int>::BNode(50);
+      auto p10 = bst.pool.construct(10);
+      auto p20 = bst.pool.construct(20);
+      auto p30 = bst.pool.construct(30);
+      auto p40 = bst.pool.construct(40);
+      auto p60 = bst.pool.construct(60);
+      auto p50 = bst.pool.construct(50);
       bst.root = p10->pParent = p60->pParent = p50;
       p50->pLeft = p30->pParent = p10;
       p50->pRight = p60;
@@ -3473,6 +5503,7 @@ public:
       p30->pLeft = p20;
       p30->pRight = p40;
       bst.numElements = 6;
+      bst.relink();
       auto it = custom::BST <int> :: iterator(p10);
       // exercise
       auto itReturn = bst.erase(it);
@@ -3499,11 +5530,11 @@ public:
       assertUnit(p50->data == 50);
       assertUnit(p60->data == 60);
       // teardown
-      delete p20;
-      delete p30;
-      delete p40;
-      delete p50;
-      delete p60;
+      bst.pool.destroy(p20);
+      bst.pool.destroy(p30);
+      bst.pool.destroy(p40);
+      bst.pool.destroy(p50);
+      bst.pool.destroy(p60);
       bst.numElements = 0;
       bst.root = nullptr;
    }
@@ -3520,14 +5551,14 @@ public:
       //            +-+
       //              40
       custom::BST <int> bst;
-      auto p10 = new custom::BST<int>::BNode(10);
-      auto p20 = new custom::BST<int>::BNode(20);
-      auto p30 = new custom::BST<int>::BNode(30);
-      auto p40 = new custom::BST<int>::BNode(40);
-      auto p50 = new custom::BST<int>::BNode(50);
-      auto p60 = new custom::BST<int>::BNode(60);
-      auto p70 = new custom::BST<int>::BNode(70);
-      auto p80 = new custom::BST<int>::BNode(80);
+      auto p10 = bst.pool.construct(10);
+      auto p20 = bst.pool.construct(20);
+      auto p30 = bst.pool.construct(30);
+      auto p40 = bst.pool.construct(40);
+      auto p50 = bst.pool.construct(50);
+      auto p60 = bst.pool.construct(60);
+      auto p70 = bst.pool.construct(70);
+      auto p80 = bst.pool.construct(80);
       bst.root = p20->pParent = p80->pParent = p70;
       p10->pParent = p50->pParent = p70->pLeft = p20;
       p70->pRight = p80;
@@ -3537,6 +5568,7 @@ public:
       p50->pRight = p60;
       p30->pRight = p40;
       bst.numElements = 8;
+      bst.relink();
       auto it = custom::BST <int> ::iterator(p20);
       // exercise
       auto itReturn = bst.erase(it);
@@ -3571,17 +5603,133 @@ public:
       assertUnit(p70->data == 70);
       assertUnit(p80->data == 80);
       // teardown
-      delete p10;
-      delete p30;
-      delete p40;
-      delete p50;
-      delete p60;
-      delete p70;
-      delete p80;
+      bst.pool.destroy(p10);
+      bst.pool.destroy(p30);
+      bst.pool.destroy(p40);
+      bst.pool.destroy(p50);
+      bst.pool.destroy(p60);
+      bst.pool.destroy(p70);
+      bst.pool.destroy(p80);
       bst.numElements = 0;
       bst.root = nullptr;
    }
 
+   // remove a black leaf: the far nephew is red so we rotate once
+   void test_erase_blackLeafCase4()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //      [[30b]]           (70b)
+      //                     +----+----+
+      //                   (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto it20 = custom::BST <Spy> ::iterator(bst.root->pLeft->pLeft);
+      bst.erase(it20);
+      auto it40 = custom::BST <Spy> ::iterator(bst.root->pLeft->pRight);
+      bst.erase(it40);
+      custom::BST <Spy> ::BNode* p50 = bst.root;
+      custom::BST <Spy> ::BNode* p60 = bst.root->pRight->pLeft;
+      custom::BST <Spy> ::BNode* p70 = bst.root->pRight;
+      custom::BST <Spy> ::BNode* p80 = bst.root->pRight->pRight;
+      auto it = custom::BST <Spy> ::iterator(bst.root->pLeft);
+      Spy::reset();
+      // exercise
+      auto itReturn = bst.erase(it);
+      // verify
+      assertUnit(Spy::numDestructor() == 1);  // destroy [30]
+      assertUnit(Spy::numDelete() == 1);      // delete  [30]
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      //                (70b)
+      //          +-------+-------+
+      //       [[50b]]          (80b)
+      //          +----+
+      //             (60r)
+      assertUnit(itReturn == custom::BST <Spy> ::iterator(p50));
+      assertUnit(bst.numElements == 4);
+      assertUnit(bst.root == p70);
+      assertUnit(p70->isRed == false);
+      assertUnit(p70->pParent == bst.pHeader());
+      assertUnit(p70->pLeft == p50);
+      assertUnit(p70->pRight == p80);
+      assertUnit(p50->isRed == false);
+      assertUnit(p50->pParent == p70);
+      assertUnit(p50->pLeft == nullptr);
+      assertUnit(p50->pRight == p60);
+      assertUnit(p60->isRed == true);
+      assertUnit(p60->pParent == p50);
+      assertUnit(p80->isRed == false);
+      assertUnit(p80->pParent == p70);
+      assertUnit(p80->pLeft == nullptr);
+      assertUnit(p80->pRight == nullptr);
+      // teardown
+      bst.clear();
+   }
+
+   // many inserts and erases never break the red-black rules
+   void test_erase_redBlackStress()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert((i * 7919) % 1000);
+      bool valid = true;
+      // exercise
+      for (int i = 0; i < 1000 && valid; i += 2)
+      {
+         auto it = bst.find((i * 104729) % 1000);
+         bst.erase(it);
+         if (bst.root)
+         {
+            bst.root->verifyBTree();
+            valid = bst.root->verifyRedBlack(bst.root->findDepth()) &&
+                    bst.root->computeSize() == (int)bst.numElements;
+
+            // the cached ends still match the ends of the spines
+            auto pLeft = bst.root;
+            auto pRight = bst.root;
+            while (pLeft->pLeft)
+               pLeft = pLeft->pLeft;
+            while (pRight->pRight)
+               pRight = pRight->pRight;
+            valid = valid && bst.pLeftmost == pLeft && bst.rightmost() == pRight;
+         }
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(bst.numElements == 500);
+      assertUnit(bst.root != nullptr);
+      if (bst.root)
+         assertUnit(bst.root->pParent == bst.pHeader());
+   }  // teardown
+
+   /**************************************************************
+    * SETUP VINE
+    * A degenerate tree of 0, 1, 2, ... num-1 where every node
+    * is the right child of the one before. Nothing the BST does
+    * builds one, but it is the worst case for a recursive walk.
+    *************************************************************/
+   template <class T>
+   void setupVine(custom::BST <T>& bst, int num)
+   {
+      typename custom::BST <T> ::BNode * pPrev = nullptr;
+      for (int i = 0; i < num; i++)
+      {
+         auto pNode = bst.pool.construct(T(i));
+         pNode->isRed = false;
+         if (pPrev)
+            pPrev->addRight(pNode);
+         else
+            bst.root = pNode;
+         pPrev = pNode;
+      }
+      bst.numElements = num;
+      bst.relink();
+            bst.relink();
+   }
+
    /**************************************************************
     * SETUP STANDARD FIXTURE
     *                (50b)
@@ -3597,13 +5745,13 @@ public:
       assertUnit(bst.root == nullptr);
 
       // allocate
-      custom::BST<Spy>::BNode* p20 = new custom::BST<Spy>::BNode(Spy(20));
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p40 = new custom::BST<Spy>::BNode(Spy(40));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p60 = new custom::BST<Spy>::BNode(Spy(60));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
-      custom::BST<Spy>::BNode* p80 = new custom::BST<Spy>::BNode(Spy(80));
+      custom::BST<Spy>::BNode* p20 = bst.pool.construct(Spy(20));
+      custom::BST<Spy>::BNode* p30 = bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p40 = bst.pool.construct(Spy(40));
+      custom::BST<Spy>::BNode* p50 = bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p60 = bst.pool.construct(Spy(60));
+      custom::BST<Spy>::BNode* p70 = bst.pool.construct(Spy(70));
+      custom::BST<Spy>::BNode* p80 = bst.pool.construct(Spy(80));
 
       // hook up the pointers down
       p30->pLeft  = p20;
@@ -3625,6 +5773,7 @@ public:
       // now assign everything to the bst
       bst.root = p50;
       bst.numElements = 7;
+      bst.relink();
    }
 
    /**************************************************************
@@ -3634,6 +5783,8 @@ public:
    {
       assertUnit(bst.root == nullptr);
       assertUnit(bst.numElements == 0);
+      assertUnit(bst.pLeftmost == bst.pHeader());
+      assertUnit(bst.rightmost() == bst.pHeader());
    }
 
    /**************************************************************
@@ -3649,6 +5800,12 @@ public:
       // verify the member variables
       assertIndirect(bst.numElements == 7);
       assertIndirect(bst.root != nullptr);
+      assertIndirect(bst.pLeftmost != nullptr);
+      if (bst.pLeftmost)
+         assertIndirect(bst.pLeftmost->data == Spy(20));
+      assertIndirect(bst.rightmost() != nullptr);
+      if (bst.rightmost())
+         assertIndirect(bst.rightmost()->data == Spy(80));
 
       // verify the pointers down
       assertIndirect(bst.root != nullptr);
@@ -3656,7 +5813,7 @@ public:
       {
          assertIndirect(bst.root->data == Spy(50));
          assertIndirect(bst.root->isRed == false);
-         assertIndirect(bst.root->pParent == nullptr);
+         assertIndirect(bst.root->pParent == bst.pHeader());
          assertIndirect(bst.root->pLeft != nullptr);
          if (bst.root->pLeft)
          {
@@ -3726,21 +5883,21 @@ public:
          if (bst.root->pLeft && bst.root->pLeft != bst.root)
          {
             if (bst.root->pLeft->pLeft && bst.root->pLeft->pLeft != bst.root->pLeft && bst.root->pLeft->pLeft != bst.root)
-               delete bst.root->pLeft->pLeft;
+               bst.pool.destroy(bst.root->pLeft->pLeft);
             if (bst.root->pLeft->pRight && bst.root->pLeft->pRight != bst.root->pLeft && bst.root->pLeft->pRight != bst.root)
-               delete bst.root->pLeft->pRight;
-            delete bst.root->pLeft;
+               bst.pool.destroy(bst.root->pLeft->pRight);
+            bst.pool.destroy(bst.root->pLeft);
          }
          if (bst.root->pRight && bst.root->pRight != bst.root)
          {
             if (bst.root->pRight->pLeft && bst.root->pRight->pLeft != bst.root->pRight && bst.root->pRight->pLeft != bst.root)
-               delete bst.root->pRight->pLeft;
+               bst.pool.destroy(bst.root->pRight->pLeft);
             if (bst.root->pRight->pRight && bst.root->pRight->pRight != bst.root->pRight && bst.root->pRight->pRight != bst.root)
-               delete bst.root->pRight->pRight;
+               bst.pool.destroy(bst.root->pRight->pRight);
 
-            delete bst.root->pRight;
+            bst.pool.destroy(bst.root->pRight);
          }
-         delete bst.root;
+         bst.pool.destroy(bst.root);
       }
       bst.root = nullptr;
       bst.numElements = 0;
@@ -0,0 +1,680 @@
+/***********************************************************************
+ * Header:
+ *    TEST BTREE SET
+ * Summary:
+ *    Unit tests for the B+ tree set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "btreeSet.h"   // class under test
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // for Spy
+#include <iterator>     // for std::distance
+#include <set>          // for std::set, to check against
+#include <string>       // for std::string
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST BTREE SET
+ * Unit tests for the btree_set class
+ ***********************************************/
+class TestBTreeSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_slots();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_constructInit_standard();
+
+      // Insert
+      test_insert_oneLeaf();
+      test_insert_splitsLeaf();
+      test_insert_growsRoot();
+      test_insert_duplicate();
+      test_insert_descending();
+      test_emplace_string();
+
+      // Access
+      test_find_standard();
+      test_lowerBound_acrossLeaves();
+      test_upperBound_standard();
+      test_equalRange_standard();
+
+      // Iterate
+      test_iterate_forward();
+      test_iterate_backward();
+
+      // Remove
+      test_erase_borrows();
+      test_erase_merges();
+      test_erase_shrinksRoot();
+      test_erase_everything();
+      test_eraseIterator_returnsNext();
+      test_eraseRange_middle();
+      test_eraseRange_noCopy();
+      test_clear_spy();
+
+      // Against std::set
+      test_random_matchesStdSet();
+
+      report("BTreeSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    btree_set::btree_set()
+    *    btree_set::btree_set(const btree_set &)
+    *    btree_set::btree_set(btree_set &&)
+    *    btree_set::btree_set(initializer_list)
+    ***************************************/
+
+   // a new set has no nodes at all
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::btree_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.pRoot == nullptr);
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find(3) == s.end());
+   }  // teardown
+
+   // nodes fill four cache lines, whatever the element
+   void test_construct_slots()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit((custom::btree_set <int> ::leafSlots == 58));
+      assertUnit((custom::btree_set <int> ::innerSlots == 19));
+      assertUnit((sizeof(custom::btree_set <int> ::Leaf) == 256));
+      assertUnit((sizeof(custom::btree_set <int> ::Inner) == 256));
+      assertUnit((sizeof(custom::btree_set <double> ::Leaf) == 256));
+      assertUnit((custom::btree_set <std::string> ::innerSlots % 2 == 1));
+      assertUnit((custom::btree_set <std::string> ::leafSlots >= 4));
+   }  // teardown
+
+   // a copy has its own nodes, with the same elements
+   void test_constructCopy_standard()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // exercise
+      custom::btree_set <int> sCopy(s);
+      // verify
+      assertUnit(sCopy.size() == 1000);
+      assertUnit(sCopy.pRoot != s.pRoot);
+      assertUnit(valid(sCopy));
+      assertUnit(same(sCopy, s));
+      s.erase(500);
+      assertUnit(sCopy.contains(500));
+   }  // teardown
+
+   // a move takes the nodes and leaves the source empty
+   void test_constructMove_standard()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      void * pRoot = s.pRoot;
+      // exercise
+      custom::btree_set <int> sMove(std::move(s));
+      // verify
+      assertUnit(sMove.size() == 1000);
+      assertUnit(sMove.pRoot == pRoot);
+      assertUnit(s.empty());
+      assertUnit(s.pRoot == nullptr);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // an initializer list goes in in order, duplicates dropped
+   void test_constructInit_standard()
+   {  // setup
+      // exercise
+      custom::btree_set <int> s{ 50, 30, 70, 30 };
+      // verify
+      assertUnit(s.size() == 3);
+      auto it = s.begin();
+      assertUnit(*it++ == 30);
+      assertUnit(*it++ == 50);
+      assertUnit(*it++ == 70);
+      assertUnit(it == s.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    *    btree_set::insert(t)
+    *    btree_set::emplace(args)
+    ***************************************/
+
+   // until it is full, everything lives in the one root leaf
+   void test_insert_oneLeaf()
+   {  // setup
+      custom::btree_set <int> s;
+      // exercise
+      for (int i = 0; i < 58; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.pRoot->isLeaf);
+      assertUnit(s.pRoot->count == 58);
+      assertUnit(s.pFirst == s.pRoot);
+      assertUnit(s.pLast == s.pRoot);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // one more splits the leaf in half under a new root
+   void test_insert_splitsLeaf()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 58; i++)
+         s.insert(i * 2);
+      // exercise
+      auto result = s.insert(31);
+      // verify
+      assertUnit(result.second);
+      assertUnit(*result.first == 31);
+      assertUnit(!s.pRoot->isLeaf);
+      assertUnit(s.pRoot->count == 1);
+      assertUnit(s.pFirst->count == 29);
+      assertUnit(s.pLast->count == 30);
+      assertUnit(s.pFirst->pNext == s.pLast);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // enough elements split the inner nodes too, and the tree stays level
+   void test_insert_growsRoot()
+   {  // setup
+      custom::btree_set <int> s;
+      // exercise
+      for (int i = 0; i < 20000; i++)
+         s.insert((i * 7919) % 20000);
+      // verify
+      assertUnit(s.size() == 20000);
+      assertUnit(depth(s) >= 3);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // a duplicate points at the one already there
+   void test_insert_duplicate()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 500; i++)
+         s.insert(i);
+      // exercise
+      auto result = s.insert(250);
+      // verify
+      assertUnit(!result.second);
+      assertUnit(result.first != s.end());
+      assertUnit(*result.first == 250);
+      assertUnit(s.size() == 500);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // inserting in reverse splits at the front every time
+   void test_insert_descending()
+   {  // setup
+      custom::btree_set <int> s;
+      // exercise
+      for (int i = 5000; i > 0; i--)
+         s.insert(i);
+      // verify
+      assertUnit(s.size() == 5000);
+      assertUnit(*s.begin() == 1);
+      assertUnit(*s.rbegin() == 5000);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // emplace builds the element, and strings move between nodes intact
+   void test_emplace_string()
+   {  // setup
+      custom::btree_set <std::string> s;
+      // exercise
+      for (int i = 0; i < 2000; i++)
+         s.emplace(std::to_string(i * 37 % 2000));
+      auto result = s.emplace(3, 'x');
+      // verify
+      assertUnit(result.second);
+      assertUnit(*result.first == "xxx");
+      assertUnit(s.size() == 2001);
+      assertUnit(s.contains("1999"));
+      assertUnit(!s.contains("2000"));
+      assertUnit(valid(s));
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    *    btree_set::find(t)
+    *    btree_set::lower_bound(t)
+    *    btree_set::upper_bound(t)
+    *    btree_set::equal_range(t)
+    ***************************************/
+
+   // every element is found, and nothing else is
+   void test_find_standard()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 10000; i += 2)
+         s.insert(i);
+      // exercise
+      bool allFound = true;
+      bool noneExtra = true;
+      for (int i = 0; i < 10000; i += 2)
+      {
+         auto it = s.find(i);
+         allFound = allFound && it != s.end() && *it == i;
+         noneExtra = noneExtra && s.find(i + 1) == s.end();
+      }
+      // verify
+      assertUnit(allFound);
+      assertUnit(noneExtra);
+      assertUnit(s.count(4) == 1);
+      assertUnit(s.count(5) == 0);
+   }  // teardown
+
+   // a bound past the last key of a leaf is the first of the next
+   void test_lowerBound_acrossLeaves()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 1000; i += 10)
+         s.insert(i);
+      s.erase(500);
+      // exercise
+      bool allRight = true;
+      for (int i = 0; i < 990; i++)
+      {
+         auto it = s.lower_bound(i);
+         int expected = (i + 9) / 10 * 10;
+         if (expected == 500)
+            expected = 510;
+         allRight = allRight && it != s.end() && *it == expected;
+      }
+      // verify
+      assertUnit(allRight);
+      assertUnit(s.lower_bound(991) == s.end());
+      assertUnit(*s.lower_bound(-5) == 0);
+   }  // teardown
+
+   // upper_bound skips an equal key
+   void test_upperBound_standard()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 1000; i += 10)
+         s.insert(i);
+      // exercise
+      auto itEqual = s.upper_bound(500);
+      auto itBetween = s.upper_bound(505);
+      auto itLast = s.upper_bound(990);
+      // verify
+      assertUnit(itEqual != s.end() && *itEqual == 510);
+      assertUnit(itBetween != s.end() && *itBetween == 510);
+      assertUnit(itLast == s.end());
+   }  // teardown
+
+   // equal_range holds one element or none
+   void test_equalRange_standard()
+   {  // setup
+      custom::btree_set <int> s{ 10, 20, 30 };
+      // exercise
+      auto found = s.equal_range(20);
+      auto missing = s.equal_range(25);
+      // verify
+      assertUnit(*found.first == 20);
+      assertUnit(*found.second == 30);
+      assertUnit(missing.first == missing.second);
+      assertUnit(*missing.first == 30);
+   }  // teardown
+
+   /***************************************
+    * ITERATE
+    *    btree_set::iterator::operator++()
+    *    btree_set::iterator::operator--()
+    ***************************************/
+
+   // forward through every leaf in order
+   void test_iterate_forward()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 9999; i >= 0; i--)
+         s.insert(i);
+      // exercise
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         inOrder = inOrder && *it == expected++;
+      // verify
+      assertUnit(inOrder);
+      assertUnit(expected == 10000);
+   }  // teardown
+
+   // backward from end() to begin()
+   void test_iterate_backward()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 10000; i++)
+         s.insert(i);
+      // exercise
+      int expected = 9999;
+      bool inOrder = true;
+      auto it = s.end();
+      while (it != s.begin())
+      {
+         --it;
+         inOrder = inOrder && *it == expected--;
+      }
+      // verify
+      assertUnit(inOrder);
+      assertUnit(expected == -1);
+      assertUnit(*s.last() == 9999);
+      assertUnit(*s.rbegin() == 9999);
+      assertUnit(std::distance(s.rbegin(), s.rend()) == 10000);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    *    btree_set::erase(t)
+    *    btree_set::erase(it)
+    *    btree_set::erase(itBegin, itEnd)
+    *    btree_set::clear()
+    ***************************************/
+
+   // a leaf left too empty takes a key from a fuller sibling
+   void test_erase_borrows()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 59; i++)
+         s.insert(i);                    // [0..29) and [29..59)
+      s.insert(59);
+      s.insert(60);                      // the right leaf has keys to spare
+      // exercise
+      for (int i = 0; i < 2; i++)
+         s.erase(i);                     // the left leaf drops below half twice
+      // verify
+      assertUnit(!s.pRoot->isLeaf);
+      assertUnit(s.pFirst->count == 29);
+      assertUnit(s.pLast->count == 30);
+      assertUnit(*s.begin() == 2);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // two leaves too empty to share become one
+   void test_erase_merges()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 200; i++)
+         s.insert(i);
+      size_t numLeaves = leaves(s);
+      // exercise
+      for (int i = 0; i < 200; i += 2)
+         s.erase(i);
+      // verify
+      assertUnit(leaves(s) < numLeaves);
+      assertUnit(s.size() == 100);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // as the tree empties, its root comes back down
+   void test_erase_shrinksRoot()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 20000; i++)
+         s.insert(i);
+      size_t deep = depth(s);
+      // exercise
+      for (int i = 0; i < 19990; i++)
+         s.erase(i);
+      // verify
+      assertUnit(deep >= 3);
+      assertUnit(depth(s) == 1);
+      assertUnit(s.pRoot->isLeaf);
+      assertUnit(s.size() == 10);
+      assertUnit(*s.begin() == 19990);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // erasing everything in random order leaves an empty leaf
+   void test_erase_everything()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 5000; i++)
+         s.insert(i);
+      // exercise
+      bool allErased = true;
+      for (int i = 0; i < 5000; i++)
+         allErased = allErased && s.erase((i * 2903) % 5000) == 1;
+      // verify
+      assertUnit(allErased);
+      assertUnit(s.empty());
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.erase(7) == 0);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // erasing through an iterator hands back the next element
+   void test_eraseIterator_returnsNext()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // exercise
+      auto it = s.find(100);
+      for (int i = 0; i < 300; i++)
+         it = s.erase(it);
+      // verify
+      assertUnit(it != s.end() && *it == 400);
+      assertUnit(s.size() == 700);
+      assertUnit(!s.contains(399));
+      assertUnit(s.contains(99));
+      it = s.erase(s.last());
+      assertUnit(it == s.end());
+      assertUnit(valid(s));
+   }  // teardown
+
+   // a range stops before the element it ends on
+   void test_eraseRange_middle()
+   {  // setup
+      custom::btree_set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // exercise
+      auto it = s.erase(s.find(200), s.find(800));
+      // verify
+      assertUnit(it != s.end() && *it == 800);
+      assertUnit(s.size() == 400);
+      assertUnit(s.contains(199));
+      assertUnit(!s.contains(200));
+      assertUnit(!s.contains(799));
+      assertUnit(valid(s));
+   }  // teardown
+
+   // erasing by position copies no element and compares only on the
+   // way down to each leaf, whatever it borrows or merges
+   void test_eraseRange_noCopy()
+   {  // setup
+      custom::btree_set <Spy> s;
+      for (int i = 0; i < 3000; i++)
+         s.insert(Spy(i));
+      auto itBegin = s.find(Spy(100));
+      auto itEnd = s.find(Spy(2900));
+      Spy::reset();
+      // exercise
+      auto it = s.erase(itBegin, itEnd);   // 100 to 2899
+      it = s.erase(s.find(Spy(99)));
+      it = s.erase(it);                    // 2900, next after 99
+      it = s.erase(s.find(Spy(2950)));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it != s.end() && *it == Spy(2951));
+      assertUnit(s.size() == 3000 - 2800 - 3);
+      assertUnit(s.contains(Spy(98)));
+      assertUnit(!s.contains(Spy(2900)));
+      assertUnit(s.contains(Spy(2901)));
+      assertUnit(valid(s));
+   }  // teardown
+
+   // clear destroys every element, and every separator copied from
+   // one, exactly once. There is one separator between each two leaves.
+   void test_clear_spy()
+   {  // setup
+      custom::btree_set <Spy> s;
+      for (int i = 0; i < 300; i++)
+         s.insert(Spy(i));
+      int numSeparators = (int)leaves(s) - 1;
+      Spy::reset();
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(numSeparators > 0);
+      assertUnit(Spy::numDestructor() == 300 + numSeparators);
+      assertUnit(Spy::numDelete() == 300 + numSeparators);
+      assertUnit(s.empty());
+      assertUnit(s.pRoot == nullptr);
+   }  // teardown
+
+   /***************************************
+    * AGAINST STD::SET
+    ***************************************/
+
+   // a long random run of inserts and erases agrees with std::set
+   void test_random_matchesStdSet()
+   {  // setup
+      custom::btree_set <int> s;
+      std::set <int> expected;
+      unsigned state = 12345;
+      bool agree = true;
+      // exercise
+      for (int i = 0; i < 50000; i++)
+      {
+         state = state * 1103515245 + 12345;
+         int key = (int)((state >> 8) % 3000);
+         if ((state >> 4) % 3 == 0)
+            agree = agree && s.erase(key) == expected.erase(key);
+         else
+            agree = agree && s.insert(key).second == expected.insert(key).second;
+      }
+      // verify
+      assertUnit(agree);
+      assertUnit(s.size() == expected.size());
+      assertUnit(std::equal(expected.begin(), expected.end(), s.begin()));
+      assertUnit(valid(s));
+   }  // teardown
+
+private:
+
+   // how many levels from the root down to the leaves
+   template <class T>
+   static size_t depth(const custom::btree_set <T> & s)
+   {
+      size_t num = 1;
+      auto p = s.pRoot;
+      while (!p->isLeaf)
+      {
+         p = static_cast<const typename custom::btree_set <T> ::Inner *>(p)->children[0];
+         num++;
+      }
+      return num;
+   }
+
+   // how many leaves on the chain
+   template <class T>
+   static size_t leaves(const custom::btree_set <T> & s)
+   {
+      size_t num = 0;
+      for (auto p = s.pFirst; p; p = p->pNext)
+         num++;
+      return num;
+   }
+
+   // same elements in the same order
+   template <class T>
+   static bool same(const custom::btree_set <T> & lhs, const custom::btree_set <T> & rhs)
+   {
+      return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+   }
+
+   // every invariant of the tree: nodes hold enough keys and no more,
+   // every leaf is the same depth down, separators bound their children,
+   // the leaf chain visits everything in order, and size() is right
+   template <class T>
+   static bool valid(const custom::btree_set <T> & s)
+   {
+      typedef custom::btree_set <T> Set;
+      if (!s.pRoot)
+         return s.size() == 0 && !s.pFirst && !s.pLast;
+
+      std::vector <const typename Set::Leaf *> chain;
+      size_t leafDepth = 0;
+      if (!validNode<T>(s, s.pRoot, 1, nullptr, nullptr, leafDepth, chain))
+         return false;
+
+      // the chain matches the leaves, left to right, both ways
+      const typename Set::Leaf * pPrev = nullptr;
+      size_t i = 0;
+      size_t num = 0;
+      for (auto p = s.pFirst; p; pPrev = p, p = p->pNext, i++)
+      {
+         if (i >= chain.size() || chain[i] != p || p->pPrev != pPrev)
+            return false;
+         num += p->count;
+      }
+      return i == chain.size() && pPrev == s.pLast && num == s.size();
+   }
+
+   template <class T>
+   static bool validNode(const custom::btree_set <T> & s,
+                         const typename custom::btree_set <T> ::Node * p, size_t level,
+                         const T * pLow, const T * pHigh, size_t & leafDepth,
+                         std::vector <const typename custom::btree_set <T> ::Leaf *> & chain)
+   {
+      typedef custom::btree_set <T> Set;
+      bool isRoot = p == s.pRoot;
+      if (p->isLeaf)
+      {
+         auto pLeaf = static_cast<const typename Set::Leaf *>(p);
+         if (pLeaf->count > Set::leafSlots || (!isRoot && pLeaf->count < Set::minLeaf))
+            return false;
+         if (leafDepth != 0 && leafDepth != level)
+            return false;
+         leafDepth = level;
+         for (size_t i = 0; i < pLeaf->count; i++)
+         {
+            const T & key = pLeaf->keys()[i];
+            if (i > 0 && !(pLeaf->keys()[i - 1] < key))
+               return false;
+            if ((pLow && key < *pLow) || (pHigh && !(key < *pHigh)))
+               return false;
+         }
+         chain.push_back(pLeaf);
+         return true;
+      }
+
+      auto pInner = static_cast<const typename Set::Inner *>(p);
+      if (pInner->count > Set::innerSlots || pInner->count == 0 ||
+          (!isRoot && pInner->count < Set::minInner))
+         return false;
+      for (size_t i = 0; i <= pInner->count; i++)
+      {
+         const T * pChildLow  = i == 0 ? pLow : pInner->keys() + i - 1;
+         const T * pChildHigh = i == pInner->count ? pHigh : pInner->keys() + i;
+         if (i > 0 && i < pInner->count && !(pInner->keys()[i - 1] < pInner->keys()[i]))
+            return false;
+         if (!validNode<T>(s, pInner->children[i], level + 1, pChildLow, pChildHigh, leafDepth, chain))
+            return false;
+      }
+      return true;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,279 @@
+/***********************************************************************
+ * Header:
+ *    TEST CONCURRENT SET
+ * Summary:
+ *    Unit tests for the concurrent set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "concurrentSet.h"   // class under test
+#include "unitTest.h"        // unit test baseclass
+#include <string>            // for std::string
+#include <thread>            // for std::thread
+#include <vector>            // for std::vector
+#include <atomic>            // for std::atomic
+
+/***********************************************
+ * TEST CONCURRENT SET
+ * Unit tests for the concurrent_set class
+ ***********************************************/
+class TestConcurrentSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_roundsUp();
+
+      // Insert and find
+      test_insert_standard();
+      test_insert_duplicate();
+      test_emplace_string();
+      test_visit_found();
+
+      // Remove
+      test_erase_standard();
+      test_clear_standard();
+
+      // Snapshot
+      test_snapshot_ordered();
+
+      // Threads
+      test_threads_disjointInserts();
+      test_threads_readersAndWriters();
+
+      report("ConcurrentSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    concurrent_set::concurrent_set()
+    *    concurrent_set::concurrent_set(numStripes)
+    ***************************************/
+
+   // a new set is empty and has a power of two stripes
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::concurrent_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.stripes() >= 8);
+      assertUnit((s.stripes() & (s.stripes() - 1)) == 0);
+   }  // teardown
+
+   // asking for 100 stripes gets 128
+   void test_construct_roundsUp()
+   {  // setup
+      // exercise
+      custom::concurrent_set <int> s(100);
+      custom::concurrent_set <int> sOne(1);
+      // verify
+      assertUnit(s.stripes() == 128);
+      assertUnit(s.shift == 64 - 7);
+      assertUnit(sOne.stripes() == 1);
+      sOne.insert(5);
+      assertUnit(sOne.contains(5));
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    *    concurrent_set::insert(t)
+    *    concurrent_set::contains(t)
+    ***************************************/
+
+   // elements spread over the stripes and are all found
+   void test_insert_standard()
+   {  // setup
+      custom::concurrent_set <int> s(16);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.size() == 1000);
+      bool allFound = true;
+      for (int i = 0; i < 1000; i++)
+         allFound = allFound && s.contains(i);
+      assertUnit(allFound);
+      assertUnit(!s.contains(1000));
+      assertUnit(s.count(-1) == 0);
+      size_t numUsed = 0;
+      for (size_t i = 0; i < s.stripes(); i++)
+         if (s.pStripes[i].elements.size() > 30)
+            numUsed++;
+      assertUnit(numUsed == 16);   // no stripe is left out
+   }  // teardown
+
+   // a duplicate is not added
+   void test_insert_duplicate()
+   {  // setup
+      custom::concurrent_set <int> s;
+      s.insert(42);
+      // exercise
+      bool inserted = s.insert(42);
+      // verify
+      assertUnit(!inserted);
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // emplace builds the element before finding its stripe
+   void test_emplace_string()
+   {  // setup
+      custom::concurrent_set <std::string> s;
+      // exercise
+      bool first = s.emplace(3, 'x');
+      bool second = s.emplace("xxx");
+      // verify
+      assertUnit(first);
+      assertUnit(!second);
+      assertUnit(s.contains(std::string("xxx")));
+   }  // teardown
+
+   // visit sees the element itself
+   void test_visit_found()
+   {  // setup
+      custom::concurrent_set <std::string> s;
+      s.insert(std::string("kiwi"));
+      size_t length = 0;
+      // exercise
+      bool found = s.visit(std::string("kiwi"), [&](const std::string & t) { length = t.size(); });
+      size_t lengthFound = length;
+      bool missing = s.visit(std::string("fig"), [&](const std::string &) { length = 99; });
+      // verify
+      assertUnit(found);
+      assertUnit(lengthFound == 4);
+      assertUnit(!missing);
+      assertUnit(length == 4);                 // not called for the missing key
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    *    concurrent_set::erase(t)
+    *    concurrent_set::clear()
+    ***************************************/
+
+   // erase takes out one element
+   void test_erase_standard()
+   {  // setup
+      custom::concurrent_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // exercise
+      size_t numErased = s.erase(50);
+      size_t numMissing = s.erase(50);
+      // verify
+      assertUnit(numErased == 1);
+      assertUnit(numMissing == 0);
+      assertUnit(s.size() == 99);
+      assertUnit(!s.contains(50));
+      assertUnit(s.contains(51));
+   }  // teardown
+
+   // clear empties every stripe
+   void test_clear_standard()
+   {  // setup
+      custom::concurrent_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(!s.contains(7));
+   }  // teardown
+
+   /***************************************
+    * SNAPSHOT
+    *    concurrent_set::snapshot()
+    ***************************************/
+
+   // the stripes come back together in order
+   void test_snapshot_ordered()
+   {  // setup
+      custom::concurrent_set <int> s;
+      for (int i = 999; i >= 0; i--)
+         s.insert(i);
+      // exercise
+      custom::set <int> all = s.snapshot();
+      // verify
+      assertUnit(all.size() == 1000);
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = all.begin(); it != all.end(); ++it)
+         inOrder = inOrder && *it == expected++;
+      assertUnit(inOrder);
+      assertUnit(s.size() == 1000);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // threads adding different elements lose none
+   void test_threads_disjointInserts()
+   {  // setup
+      custom::concurrent_set <int> s;
+      std::vector <std::thread> threads;
+      // exercise
+      for (int t = 0; t < 8; t++)
+         threads.emplace_back([&s, t]()
+         {
+            for (int i = 0; i < 2000; i++)
+               s.insert(t * 2000 + i);
+         });
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      assertUnit(s.size() == 16000);
+      assertUnit(s.contains(0));
+      assertUnit(s.contains(15999));
+   }  // teardown
+
+   // readers never see an element that was never there, and
+   // writers adding and taking away the same elements net out
+   void test_threads_readersAndWriters()
+   {  // setup
+      custom::concurrent_set <int> s;
+      for (int i = 0; i < 1000; i += 2)
+         s.insert(i);
+      std::atomic <int> numWrong(0);
+      std::vector <std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&s, &numWrong]()
+         {
+            for (int round = 0; round < 20; round++)
+               for (int i = 0; i < 1000; i++)
+                  if (s.contains(i) && i % 2 != 0 && i >= 500)
+                     numWrong++;
+         });
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&s, t]()
+         {
+            for (int round = 0; round < 20; round++)
+               for (int i = 1 + 2 * t; i < 500; i += 8)
+               {
+                  s.insert(i);
+                  s.erase(i);
+               }
+         });
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      assertUnit(numWrong == 0);
+      assertUnit(s.size() == 500);
+      assertUnit(!s.contains(1));
+      assertUnit(s.contains(998));
+   }  // teardown
+};
+
+#endif // DEBUG
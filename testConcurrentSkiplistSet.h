@@ -0,0 +1,465 @@
+/***********************************************************************
+ * Header:
+ *    TEST CONCURRENT SKIPLIST SET
+ * Summary:
+ *    Unit tests for the lock-free skip list set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "concurrentSkiplistSet.h"   // class under test
+#include "unitTest.h"                // unit test baseclass
+#include "spy.h"                     // for Spy
+#include <string>                    // for std::string
+#include <thread>                    // for std::thread
+#include <vector>                    // for std::vector
+#include <atomic>                    // for std::atomic
+
+/***********************************************
+ * TEST CONCURRENT SKIPLIST SET
+ * Unit tests for the concurrent_skiplist_set class
+ ***********************************************/
+class TestConcurrentSkiplistSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert and find
+      test_insert_standard();
+      test_insert_duplicate();
+      test_emplace_string();
+      test_find_standard();
+      test_lowerBound_standard();
+      test_upperBound_standard();
+      test_equalRange_standard();
+
+      // Iterate
+      test_iterate_ordered();
+      test_iterate_skipsErased();
+
+      // Remove
+      test_erase_standard();
+      test_erase_unlinksEveryLevel();
+      test_erase_iterator();
+      test_clear_standard();
+      test_destructor_freesAll();
+
+      // Threads
+      test_threads_disjointInserts();
+      test_threads_sameElements();
+      test_threads_readersAndWriters();
+
+      report("ConcurrentSkiplistSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    concurrent_skiplist_set::concurrent_skiplist_set()
+    ***************************************/
+
+   // a new set is empty, and its head leads nowhere
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::concurrent_skiplist_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.begin() == s.end());
+      bool allNull = true;
+      for (int level = 0; level < s.maxHeight; level++)
+         allNull = allNull && s.pHead->next[level].load() == 0;
+      assertUnit(allNull);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    *    concurrent_skiplist_set::insert(t)
+    *    concurrent_skiplist_set::contains(t)
+    ***************************************/
+
+   // every element is found, and every level stays sorted
+   void test_insert_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert((i * 37) % 1000);
+      // verify
+      assertUnit(s.size() == 1000);
+      bool allFound = true;
+      for (int i = 0; i < 1000; i++)
+         allFound = allFound && s.contains(i);
+      assertUnit(allFound);
+      assertUnit(!s.contains(1000));
+      assertUnit(s.count(-1) == 0);
+      assertUnit(levelsSorted(s));
+      assertUnit(s.pHead->next[4].load() != 0);   // some nodes climbed
+   }  // teardown
+
+   // a duplicate is not added, and points at the one that is there
+   void test_insert_duplicate()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      s.insert(42);
+      // exercise
+      auto result = s.insert(42);
+      // verify
+      assertUnit(!result.second);
+      assertUnit(result.first != s.end());
+      assertUnit(*result.first == 42);
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // emplace builds the element in the node
+   void test_emplace_string()
+   {  // setup
+      custom::concurrent_skiplist_set <std::string> s;
+      // exercise
+      auto first = s.emplace(3, 'x');
+      auto second = s.emplace("xxx");
+      // verify
+      assertUnit(first.second);
+      assertUnit(!second.second);
+      assertUnit(*first.first == "xxx");
+      assertUnit(s.contains(std::string("xxx")));
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // find returns the element or end()
+   void test_find_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i += 2)
+         s.insert(i);
+      // exercise
+      auto itFound = s.find(50);
+      auto itMissing = s.find(51);
+      // verify
+      assertUnit(itFound != s.end());
+      if (itFound != s.end())
+         assertUnit(*itFound == 50);
+      assertUnit(itMissing == s.end());
+   }  // teardown
+
+   // lower_bound lands on the next element up
+   void test_lowerBound_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i += 2)
+         s.insert(i);
+      // exercise
+      auto itOdd = s.lower_bound(51);
+      auto itEven = s.lower_bound(52);
+      auto itPast = s.lower_bound(99);
+      // verify
+      assertUnit(itOdd != s.end() && *itOdd == 52);
+      assertUnit(itEven != s.end() && *itEven == 52);
+      assertUnit(itPast == s.end());
+   }  // teardown
+
+   // upper_bound steps past an equal element
+   void test_upperBound_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i += 2)
+         s.insert(i);
+      // exercise
+      auto itOdd = s.upper_bound(51);
+      auto itEven = s.upper_bound(52);
+      auto itLast = s.upper_bound(98);
+      // verify
+      assertUnit(itOdd != s.end() && *itOdd == 52);
+      assertUnit(itEven != s.end() && *itEven == 54);
+      assertUnit(itLast == s.end());
+   }  // teardown
+
+   // equal_range holds the one match, or is empty
+   void test_equalRange_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i += 2)
+         s.insert(i);
+      // exercise
+      auto found = s.equal_range(50);
+      auto missing = s.equal_range(51);
+      // verify
+      assertUnit(found.first != s.end() && *found.first == 50);
+      assertUnit(found.second != s.end() && *found.second == 52);
+      assertUnit(missing.first == missing.second);
+      assertUnit(missing.first != s.end() && *missing.first == 52);
+   }  // teardown
+
+   /***************************************
+    * ITERATE
+    *    concurrent_skiplist_set::begin()
+    *    concurrent_skiplist_set::iterator::operator++()
+    ***************************************/
+
+   // the bottom level visits every element in order
+   void test_iterate_ordered()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 999; i >= 0; i--)
+         s.insert(i);
+      // exercise
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         inOrder = inOrder && *it == expected++;
+      // verify
+      assertUnit(inOrder);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   // an element erased while an iterator sits on it is skipped,
+   // and the node stays readable until the iterator is gone
+   void test_iterate_skipsErased()
+   {  // setup
+      custom::concurrent_skiplist_set <Spy> s;
+      for (int i = 0; i < 5; i++)
+         s.insert(Spy(i));
+      auto it = s.find(Spy(1));
+      Spy::reset();
+      // exercise
+      s.erase(Spy(1));
+      s.erase(Spy(2));
+      // verify
+      assertUnit(Spy::numDestructor() == 2);   // the two temporaries
+      assertUnit(it->get() == 1);
+      ++it;
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit(it->get() == 3);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    *    concurrent_skiplist_set::erase(t)
+    *    concurrent_skiplist_set::erase(it)
+    *    concurrent_skiplist_set::clear()
+    ***************************************/
+
+   // erase takes out one element
+   void test_erase_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // exercise
+      size_t numErased = s.erase(50);
+      size_t numMissing = s.erase(50);
+      // verify
+      assertUnit(numErased == 1);
+      assertUnit(numMissing == 0);
+      assertUnit(s.size() == 99);
+      assertUnit(!s.contains(50));
+      assertUnit(s.contains(49));
+      assertUnit(s.contains(51));
+   }  // teardown
+
+   // no level still leads to an erased node
+   void test_erase_unlinksEveryLevel()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // exercise
+      for (int i = 0; i < 1000; i += 3)
+         s.erase(i);
+      // verify
+      bool noneMarked = true;
+      for (int level = 0; level < s.maxHeight; level++)
+         for (auto p = s.pointer(s.pHead->next[level].load()); p;
+              p = s.pointer(p->next[level].load()))
+            noneMarked = noneMarked && !s.marked(p->next[level].load()) && p->data % 3 != 0;
+      assertUnit(noneMarked);
+      assertUnit(levelsSorted(s));
+      assertUnit(s.size() == 666);
+   }  // teardown
+
+   // erase(it) takes out the node it is on and returns the next one;
+   // a second erase through a stale copy does nothing
+   void test_erase_iterator()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      auto it = s.find(50);
+      auto itStale = it;
+      // exercise
+      auto itNext = s.erase(it);
+      auto itAgain = s.erase(itStale);
+      // verify
+      assertUnit(itNext != s.end() && *itNext == 51);
+      assertUnit(itAgain != s.end() && *itAgain == 51);
+      assertUnit(s.size() == 99);
+      assertUnit(!s.contains(50));
+      assertUnit(levelsSorted(s));
+      bool noneMarked = true;
+      for (int level = 0; level < s.maxHeight; level++)
+         for (auto p = s.pointer(s.pHead->next[level].load()); p;
+              p = s.pointer(p->next[level].load()))
+            noneMarked = noneMarked && !s.marked(p->next[level].load());
+      assertUnit(noneMarked);
+   }  // teardown
+
+   // clear erases everything
+   void test_clear_standard()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(!s.contains(7));
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.pHead->next[0].load() == 0);
+   }  // teardown
+
+   // the destructor frees what is left at once
+   void test_destructor_freesAll()
+   {  // setup
+      Spy::reset();
+      {
+         custom::concurrent_skiplist_set <Spy> s;
+         for (int i = 0; i < 10; i++)
+            s.emplace(i);
+         // exercise
+      }
+      // verify
+      assertUnit(Spy::numNondefault() == 10);
+      assertUnit(Spy::numDestructor() == 10);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // threads adding different elements lose none
+   void test_threads_disjointInserts()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      std::vector <std::thread> threads;
+      // exercise
+      for (int t = 0; t < 8; t++)
+         threads.emplace_back([&s, t]()
+         {
+            for (int i = 0; i < 2000; i++)
+               s.insert(i * 8 + t);
+         });
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      assertUnit(s.size() == 16000);
+      assertUnit(s.contains(0));
+      assertUnit(s.contains(15999));
+      assertUnit(levelsSorted(s));
+   }  // teardown
+
+   // threads racing to add and erase the same elements agree on who won
+   void test_threads_sameElements()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      std::atomic <int> numInserted(0);
+      std::atomic <int> numErased(0);
+      std::vector <std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&]()
+         {
+            for (int round = 0; round < 10; round++)
+            {
+               for (int i = 0; i < 500; i++)
+                  if (s.insert(i).second)
+                     numInserted++;
+               for (int i = 0; i < 500; i += 2)
+                  numErased += (int)s.erase(i);
+            }
+         });
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      assertUnit(numInserted - numErased == 250);
+      assertUnit(s.size() == 250);
+      assertUnit(!s.contains(0));
+      assertUnit(s.contains(499));
+      assertUnit(levelsSorted(s));
+   }  // teardown
+
+   // readers never see an element that was never there, and
+   // writers adding and taking away the same elements net out
+   void test_threads_readersAndWriters()
+   {  // setup
+      custom::concurrent_skiplist_set <int> s;
+      for (int i = 0; i < 1000; i += 2)
+         s.insert(i);
+      std::atomic <int> numWrong(0);
+      std::vector <std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&s, &numWrong]()
+         {
+            for (int round = 0; round < 20; round++)
+            {
+               int previous = -1;
+               for (auto it = s.begin(); it != s.end(); ++it)
+               {
+                  if (*it <= previous || (*it % 2 != 0 && *it >= 500))
+                     numWrong++;
+                  previous = *it;
+               }
+            }
+         });
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&s, t]()
+         {
+            for (int round = 0; round < 20; round++)
+               for (int i = 1 + 2 * t; i < 500; i += 8)
+               {
+                  s.insert(i);
+                  s.erase(i);
+               }
+         });
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      assertUnit(numWrong == 0);
+      assertUnit(s.size() == 500);
+      assertUnit(!s.contains(1));
+      assertUnit(s.contains(998));
+   }  // teardown
+
+private:
+
+   // every level is in strictly increasing order
+   template <class T>
+   static bool levelsSorted(const custom::concurrent_skiplist_set <T> & s)
+   {
+      for (int level = 0; level < s.maxHeight; level++)
+      {
+         auto p = s.pointer(s.pHead->next[level].load());
+         while (p && s.pointer(p->next[level].load()))
+         {
+            auto pNext = s.pointer(p->next[level].load());
+            if (!(p->data < pNext->data))
+               return false;
+            p = pNext;
+         }
+      }
+      return true;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,153 @@
+/***********************************************************************
+ * Header:
+ *    TEST EPOCH
+ * Summary:
+ *    Unit tests for epoch-based reclamation
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "epoch.h"      // class under test
+#include "unitTest.h"   // unit test baseclass
+#include <thread>       // for std::thread
+
+/***********************************************
+ * TEST EPOCH
+ * Unit tests for the Epoch class
+ ***********************************************/
+class TestEpoch : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Guard
+      test_guard_nests();
+      test_guard_holdsEpoch();
+
+      // Retire
+      test_retire_waitsForGuard();
+      test_retire_collectsEventually();
+      test_retire_threadEnds();
+
+      report("Epoch");
+   }
+
+   /***************************************
+    * GUARD
+    *    Epoch::Guard::Guard()
+    *    Epoch::Guard::~Guard()
+    ***************************************/
+
+   // only the outermost guard announces this thread
+   void test_guard_nests()
+   {  // setup
+      custom::Epoch::Record & mine = custom::Epoch::record();
+      // exercise
+      {
+         custom::Epoch::Guard outer;
+         {
+            custom::Epoch::Guard inner(outer);
+            // verify
+            assertUnit(mine.depth == 2);
+            assertUnit(mine.local.load() == custom::Epoch::epoch());
+         }
+         assertUnit(mine.depth == 1);
+         assertUnit(mine.local.load() != custom::Epoch::idle);
+      }
+      assertUnit(mine.depth == 0);
+      assertUnit(mine.local.load() == custom::Epoch::idle);
+   }  // teardown
+
+   // the epoch moves once past a guard, but not twice
+   void test_guard_holdsEpoch()
+   {  // setup
+      custom::Epoch::Guard guard;
+      uint64_t epoch = custom::Epoch::epoch();
+      // exercise
+      bool first = custom::Epoch::advance();
+      bool second = custom::Epoch::advance();
+      // verify
+      assertUnit(first);
+      assertUnit(!second);
+      assertUnit(custom::Epoch::epoch() == epoch + 1);
+   }  // teardown
+
+   /***************************************
+    * RETIRE
+    *    Epoch::retire(p, destroy)
+    ***************************************/
+
+   // nothing is freed while a guard from before it was retired is held
+   void test_retire_waitsForGuard()
+   {  // setup
+      numFreed = 0;
+      custom::Epoch::Record & mine = custom::Epoch::record();
+      {
+         custom::Epoch::Guard guard;
+         custom::Epoch::retire(new int(7), &free);
+         // exercise
+         for (int i = 0; i < 5; i++)
+            custom::Epoch::advance();
+         custom::Epoch::collect(mine.retired, custom::Epoch::epoch());
+         // verify
+         assertUnit(numFreed == 0);
+      }
+      custom::Epoch::advance();
+      custom::Epoch::advance();
+      custom::Epoch::collect(mine.retired, custom::Epoch::epoch());
+      assertUnit(numFreed == 1);
+      assertUnit(mine.retired.empty());
+   }  // teardown
+
+   // retiring enough moves the epoch along and frees the old ones
+   void test_retire_collectsEventually()
+   {  // setup
+      numFreed = 0;
+      custom::Epoch::Record & mine = custom::Epoch::record();
+      // exercise
+      for (size_t i = 0; i < 4 * custom::Epoch::collectEvery; i++)
+         custom::Epoch::retire(new int(0), &free);
+      // verify
+      assertUnit(numFreed >= 2 * custom::Epoch::collectEvery);
+      assertUnit(mine.retired.size() < 2 * custom::Epoch::collectEvery);
+   }  // teardown
+
+   // a thread that ends gives back its record and leaves nothing behind
+   void test_retire_threadEnds()
+   {  // setup
+      numFreed = 0;
+      custom::Epoch::Record * pTheirs = nullptr;
+      // exercise
+      std::thread([&pTheirs]()
+      {
+         pTheirs = &custom::Epoch::record();
+         custom::Epoch::retire(new int(0), &free);
+      }).join();
+      for (size_t i = 0; i < custom::Epoch::collectEvery; i++)
+         custom::Epoch::retire(new int(0), &free);
+      // verify
+      assertUnit(pTheirs != nullptr);
+      if (pTheirs)
+         assertUnit(!pTheirs->inUse.load());
+      assertUnit(numFreed >= 1);
+   }  // teardown
+
+private:
+   static size_t numFreed;
+
+   static void free(void * p)
+   {
+      delete static_cast<int *>(p);
+      numFreed++;
+   }
+};
+
+size_t TestEpoch::numFreed = 0;
+
+#endif // DEBUG
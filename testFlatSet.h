@@ -0,0 +1,385 @@
+/***********************************************************************
+ * Header:
+ *    TEST FLAT SET
+ * Summary:
+ *    Unit tests for the sorted-vector set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "flatSet.h"    // class under test
+#include "set.h"        // to convert to and from
+#include "unitTest.h"   // unit test baseclass
+#include <cctype>       // for std::tolower
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST FLAT SET
+ * Unit tests for the flat_set class
+ ***********************************************/
+class TestFlatSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructRange_sortsAndDedups();
+      test_constructRange_keepsFirst();
+      test_constructSorted_standard();
+      test_constructSet_standard();
+
+      // Convert
+      test_toSet_standard();
+
+      // Access
+      test_find_standard();
+      test_find_empty();
+      test_lowerBound_everyPosition();
+      test_upperBound_everyPosition();
+      test_find_transparent();
+
+      // Iterate
+      test_iterate_likeSet();
+
+      // Insert
+      test_insert_standard();
+      test_insert_hint();
+      test_insertRange_merges();
+
+      // Remove
+      test_erase_standard();
+      test_eraseRange_standard();
+
+      report("FlatSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    flat_set::flat_set()
+    *    flat_set::flat_set(first, last)
+    *    flat_set::flat_set(from_sorted, first, last)
+    *    flat_set::flat_set(const set &)
+    ***************************************/
+
+   // a new set holds nothing
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::flat_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.elements.capacity() == 0);
+   }  // teardown
+
+   // a range in any order comes out sorted, each element once
+   void test_constructRange_sortsAndDedups()
+   {  // setup
+      std::vector <int> v { 50, 20, 70, 20, 10, 50, 50, 60 };
+      // exercise
+      custom::flat_set <int> s(v.begin(), v.end());
+      // verify
+      assertUnit(s.elements == std::vector <int>({ 10, 20, 50, 60, 70 }));
+      assertUnit(s.size() == 5);
+   }  // teardown
+
+   // of equivalent elements, the first one in the range stays, as it
+   // would if they were inserted one at a time
+   void test_constructRange_keepsFirst()
+   {  // setup
+      std::vector <std::string> v { "pear", "Apple", "apple", "PEAR", "fig" };
+      // exercise
+      custom::flat_set <std::string, NoCase> s(v.begin(), v.end());
+      // verify
+      assertUnit(s.elements == std::vector <std::string>({ "Apple", "fig", "pear" }));
+   }  // teardown
+
+   // a range known to be sorted is copied as is
+   void test_constructSorted_standard()
+   {  // setup
+      std::vector <int> v { 10, 20, 30 };
+      // exercise
+      custom::flat_set <int> s(custom::from_sorted, v.begin(), v.end());
+      // verify
+      assertUnit(s.elements == v);
+   }  // teardown
+
+   // a set converts in order, with room for exactly what it held
+   void test_constructSet_standard()
+   {  // setup
+      custom::set <int> sTree { 50, 30, 70, 20, 40 };
+      // exercise
+      custom::flat_set <int> s(sTree);
+      // verify
+      assertUnit(s.elements == std::vector <int>({ 20, 30, 40, 50, 70 }));
+      assertUnit(s.elements.capacity() == 5);
+      assertUnit(sTree.size() == 5);
+   }  // teardown
+
+   /***************************************
+    * CONVERT
+    *    flat_set::to_set()
+    ***************************************/
+
+   // back to a tree that holds the same
+   void test_toSet_standard()
+   {  // setup
+      custom::flat_set <int> s { 40, 10, 30, 20 };
+      // exercise
+      custom::set <int> sTree = s.to_set();
+      // verify
+      assertUnit(sTree.size() == 4);
+      std::vector <int> v;
+      for (auto it = sTree.begin(); it != sTree.end(); ++it)
+         v.push_back(*it);
+      assertUnit(v == s.elements);
+      assertUnit(sTree.insert(25).second);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    *    flat_set::find(t)
+    *    flat_set::lower_bound(t)
+    *    flat_set::upper_bound(t)
+    ***************************************/
+
+   // find returns the element or end()
+   void test_find_standard()
+   {  // setup
+      custom::flat_set <int> s { 10, 20, 30, 40, 50 };
+      // exercise
+      auto itFound = s.find(30);
+      auto itMissing = s.find(35);
+      // verify
+      assertUnit(itFound != s.end());
+      if (itFound != s.end())
+         assertUnit(*itFound == 30);
+      assertUnit(itMissing == s.end());
+      assertUnit(s.contains(10));
+      assertUnit(s.contains(50));
+      assertUnit(!s.contains(5));
+      assertUnit(!s.contains(55));
+      assertUnit(s.count(40) == 1);
+   }  // teardown
+
+   // nothing is found in nothing
+   void test_find_empty()
+   {  // setup
+      custom::flat_set <int> s;
+      // exercise
+      auto it = s.find(7);
+      // verify
+      assertUnit(it == s.end());
+      assertUnit(s.lower_bound(7) == s.end());
+      assertUnit(s.upper_bound(7) == s.end());
+   }  // teardown
+
+   // at every size, the branchless search lands where a linear one does
+   void test_lowerBound_everyPosition()
+   {  // setup
+      bool allRight = true;
+      for (int num = 0; num < 40; num++)
+      {
+         std::vector <int> v;
+         for (int i = 0; i < num; i++)
+            v.push_back(i * 2);
+         custom::flat_set <int> s(custom::from_sorted, v.begin(), v.end());
+         // exercise
+         for (int key = -1; key <= num * 2; key++)
+         {
+            size_t expected = 0;
+            while (expected < v.size() && v[expected] < key)
+               expected++;
+            allRight = allRight && s.lower_bound(key).p == s.elements.data() + expected;
+         }
+      }
+      // verify
+      assertUnit(allRight);
+   }  // teardown
+
+   // and likewise for the first element after
+   void test_upperBound_everyPosition()
+   {  // setup
+      bool allRight = true;
+      for (int num = 0; num < 40; num++)
+      {
+         std::vector <int> v;
+         for (int i = 0; i < num; i++)
+            v.push_back(i * 2);
+         custom::flat_set <int> s(custom::from_sorted, v.begin(), v.end());
+         // exercise
+         for (int key = -1; key <= num * 2; key++)
+         {
+            size_t expected = 0;
+            while (expected < v.size() && v[expected] <= key)
+               expected++;
+            allRight = allRight && s.upper_bound(key).p == s.elements.data() + expected;
+         }
+      }
+      // verify
+      assertUnit(allRight);
+   }  // teardown
+
+   // a transparent compare probes with a string_view as is
+   void test_find_transparent()
+   {  // setup
+      custom::flat_set <std::string, std::less <>> s { "cherry", "apple", "banana" };
+      std::string_view key("banana");
+      // exercise
+      auto it = s.find(key);
+      // verify
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit(*it == "banana");
+      assertUnit(s.contains(std::string_view("apple")));
+      assertUnit(s.count(std::string_view("grape")) == 0);
+   }  // teardown
+
+   /***************************************
+    * ITERATE
+    *    flat_set::iterator
+    ***************************************/
+
+   // the iterator is used exactly as set's is, so a typedef switches
+   void test_iterate_likeSet()
+   {  // setup
+      std::vector <int> v { 30, 10, 20 };
+      custom::flat_set <int> sFlat(v.begin(), v.end());
+      custom::set <int> sTree(v.begin(), v.end());
+      // exercise
+      std::vector <int> forwardFlat = walk(sFlat);
+      std::vector <int> forwardTree = walk(sTree);
+      auto itFlat = sFlat.last();
+      auto itTree = sTree.last();
+      itFlat--;
+      itTree--;
+      // verify
+      assertUnit(forwardFlat == forwardTree);
+      assertUnit(*itFlat == *itTree);
+      assertUnit(*--itFlat == 10);
+      assertUnit(itFlat == sFlat.begin());
+      assertUnit(std::vector<int>(sFlat.rbegin(), sFlat.rend()) ==
+                 std::vector<int>(sTree.rbegin(), sTree.rend()));
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    *    flat_set::insert(t)
+    *    flat_set::insert(hint, t)
+    *    flat_set::insert(first, last)
+    ***************************************/
+
+   // the element goes in its place, once
+   void test_insert_standard()
+   {  // setup
+      custom::flat_set <int> s { 10, 30 };
+      // exercise
+      auto result = s.insert(20);
+      auto duplicate = s.insert(30);
+      // verify
+      assertUnit(result.second);
+      assertUnit(*result.first == 20);
+      assertUnit(!duplicate.second);
+      assertUnit(*duplicate.first == 30);
+      assertUnit(s.elements == std::vector <int>({ 10, 20, 30 }));
+   }  // teardown
+
+   // a right hint is used, and a wrong one is ignored
+   void test_insert_hint()
+   {  // setup
+      custom::flat_set <int> s;
+      // exercise
+      for (int i = 0; i < 5; i++)
+         s.insert(s.end(), i * 10);
+      auto itWrong = s.insert(s.begin(), 25);
+      auto itDuplicate = s.insert(s.end(), 40);
+      // verify
+      assertUnit(s.elements == std::vector <int>({ 0, 10, 20, 25, 30, 40 }));
+      assertUnit(*itWrong == 25);
+      assertUnit(itDuplicate.p == s.elements.data() + 5);
+   }  // teardown
+
+   // a range is sorted and merged in, and what was there already stays
+   void test_insertRange_merges()
+   {  // setup
+      std::vector <std::string> v { "fig", "apple" };
+      custom::flat_set <std::string, NoCase> s(v.begin(), v.end());
+      std::vector <std::string> more { "Kiwi", "FIG", "banana", "kiwi" };
+      // exercise
+      s.insert(more.begin(), more.end());
+      // verify
+      assertUnit(s.elements == std::vector <std::string>({ "apple", "banana", "fig", "Kiwi" }));
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    *    flat_set::erase(t)
+    *    flat_set::erase(it)
+    *    flat_set::erase(itBegin, itEnd)
+    ***************************************/
+
+   // erase by value or by iterator, which lands on the next one
+   void test_erase_standard()
+   {  // setup
+      custom::flat_set <int> s { 10, 20, 30, 40 };
+      // exercise
+      size_t numErased = s.erase(20);
+      size_t numMissing = s.erase(25);
+      auto it = s.erase(s.find(30));
+      // verify
+      assertUnit(numErased == 1);
+      assertUnit(numMissing == 0);
+      assertUnit(it != s.end() && *it == 40);
+      assertUnit(s.elements == std::vector <int>({ 10, 40 }));
+   }  // teardown
+
+   // a range comes out in one shift
+   void test_eraseRange_standard()
+   {  // setup
+      custom::flat_set <int> s { 10, 20, 30, 40, 50 };
+      // exercise
+      auto it = s.erase(s.find(20), s.find(50));
+      // verify
+      assertUnit(it != s.end() && *it == 50);
+      assertUnit(s.elements == std::vector <int>({ 10, 50 }));
+   }  // teardown
+
+private:
+
+   // orders strings ignoring case, so different strings can be equivalent
+   struct NoCase
+   {
+      bool operator () (const std::string & lhs, const std::string & rhs) const
+      {
+         return lower(lhs) < lower(rhs);
+      }
+      static std::string lower(std::string s)
+      {
+         for (char & c : s)
+            c = (char)std::tolower((unsigned char)c);
+         return s;
+      }
+   };
+
+   // the elements in order, through nothing but the shared iterator API
+   template <class Set>
+   static std::vector <int> walk(const Set & s)
+   {
+      std::vector <int> v;
+      for (typename Set::iterator it = s.begin(); it != s.end(); it++)
+         v.push_back(*it);
+      return v;
+   }
+};
+
+#endif // DEBUG
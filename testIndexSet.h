@@ -0,0 +1,572 @@
+/***********************************************************************
+ * Header:
+ *    TEST INDEX SET
+ * Summary:
+ *    Unit tests for the index-linked red-black set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "indexSet.h"   // class under test
+#include "spy.h"        // for Spy
+#include "unitTest.h"   // unit test baseclass
+#include <cstddef>      // for offsetof
+#include <cstring>      // for std::memcpy
+#include <functional>   // for std::greater
+#include <stdexcept>    // for std::invalid_argument
+#include <string>       // for std::string
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST INDEX SET
+ * Unit tests for the index_set class
+ ***********************************************/
+class TestIndexSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructInitializer_sorts();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_assign_standard();
+
+      // Node
+      test_node_compact();
+
+      // Access
+      test_find_standard();
+      test_lowerUpper_everyPosition();
+      test_compare_greater();
+
+      // Iterate
+      test_iterate_forwardBackward();
+      test_iterate_survivesGrowth();
+
+      // Insert
+      test_insert_balanced();
+      test_insert_duplicate();
+      test_insert_strings();
+
+      // Remove
+      test_erase_everyOrder();
+      test_erase_reusesSlots();
+      test_eraseRange_standard();
+      test_clear_spy();
+
+      // Relocate
+      test_serialize_roundTrip();
+      test_serialize_relocated();
+      test_deserialize_badSize();
+      test_deserialize_badLinks();
+
+      report("IndexSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    index_set::index_set()
+    *    index_set::index_set(initializer_list)
+    *    index_set::index_set(const index_set &)
+    *    index_set::index_set(index_set &&)
+    *    index_set::operator=(const index_set &)
+    ***************************************/
+
+   // a new set holds nothing and has only the nil slot
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::index_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.root == 0);
+      assertUnit(s.numSlots == 1);
+   }  // teardown
+
+   // the elements come out sorted, with no repeats
+   void test_constructInitializer_sorts()
+   {  // setup
+      // exercise
+      custom::index_set <int> s{ 50, 30, 70, 30, 10 };
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(toVector(s) == std::vector<int>({ 10, 30, 50, 70 }));
+      assertUnit(valid(s));
+   }  // teardown
+
+   // the copy has the same elements in the same slots
+   void test_constructCopy_standard()
+   {  // setup
+      custom::index_set <std::string> s{ "delta", "alpha", "charlie", "bravo" };
+      s.erase("charlie");
+      // exercise
+      custom::index_set <std::string> sCopy(s);
+      // verify
+      assertUnit(toVector(sCopy) == toVector(s));
+      assertUnit(sCopy.root == s.root);
+      assertUnit(sCopy.freeList == s.freeList);
+      assertUnit(valid(sCopy));
+      sCopy.insert("echo");
+      assertUnit(s.size() == 3);
+      assertUnit(sCopy.size() == 4);
+   }  // teardown
+
+   // the elements move over and the source is left empty
+   void test_constructMove_standard()
+   {  // setup
+      custom::index_set <int> s{ 3, 1, 2 };
+      // exercise
+      custom::index_set <int> sMoved(std::move(s));
+      // verify
+      assertUnit(toVector(sMoved) == std::vector<int>({ 1, 2, 3 }));
+      assertUnit(s.empty());
+      s.insert(9);
+      assertUnit(toVector(s) == std::vector<int>({ 9 }));
+   }  // teardown
+
+   // assignment replaces what was there
+   void test_assign_standard()
+   {  // setup
+      custom::index_set <int> s{ 1, 2, 3 };
+      custom::index_set <int> sOther{ 7, 8 };
+      // exercise
+      s = sOther;
+      // verify
+      assertUnit(toVector(s) == std::vector<int>({ 7, 8 }));
+      assertUnit(toVector(sOther) == std::vector<int>({ 7, 8 }));
+      // exercise
+      s = { 4, 5, 6 };
+      // verify
+      assertUnit(toVector(s) == std::vector<int>({ 4, 5, 6 }));
+   }  // teardown
+
+   /***************************************
+    * NODE
+    *    index_set::Node
+    ***************************************/
+
+   // three 4-byte links, a color, and the int
+   void test_node_compact()
+   {  // setup
+      typedef custom::index_set <int> ::Node Node;
+      // exercise
+      // verify
+      assertUnit(sizeof(Node) == 20);
+      assertUnit(sizeof(custom::index_set <int> ::Index) == 4);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    *    index_set::find(t)
+    *    index_set::lower_bound(t)
+    *    index_set::upper_bound(t)
+    ***************************************/
+
+   // find what is there, and end() for what is not
+   void test_find_standard()
+   {  // setup
+      custom::index_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i * 3);
+      // exercise
+      // verify
+      assertUnit(*s.find(0) == 0);
+      assertUnit(*s.find(150) == 150);
+      assertUnit(*s.find(297) == 297);
+      assertUnit(s.find(151) == s.end());
+      assertUnit(s.find(-1) == s.end());
+      assertUnit(s.contains(42));
+      assertUnit(s.count(43) == 0);
+   }  // teardown
+
+   // the bounds of every key, and between every key
+   void test_lowerUpper_everyPosition()
+   {  // setup
+      custom::index_set <int> s;
+      for (int i = 1; i <= 50; i++)
+         s.insert(i * 2);
+      bool allRight = true;
+      // exercise
+      for (int t = 0; t <= 102; t++)
+      {
+         int lower = (t % 2 == 0) ? t : t + 1;
+         int upper = (t % 2 == 0) ? t + 2 : t + 1;
+         auto itLower = s.lower_bound(t);
+         auto itUpper = s.upper_bound(t);
+         if (lower < 2)
+            lower = 2;
+         if (upper < 2)
+            upper = 2;
+         allRight = allRight &&
+                    (lower > 100 ? itLower == s.end() : *itLower == lower) &&
+                    (upper > 100 ? itUpper == s.end() : *itUpper == upper);
+      }
+      // verify
+      assertUnit(allRight);
+   }  // teardown
+
+   // the order is the one Compare gives
+   void test_compare_greater()
+   {  // setup
+      custom::index_set <int, std::greater<int>> s{ 1, 5, 3 };
+      // exercise
+      std::vector <int> v(s.begin(), s.end());
+      // verify
+      assertUnit(v == std::vector<int>({ 5, 3, 1 }));
+      assertUnit(*s.lower_bound(4) == 3);
+   }  // teardown
+
+   /***************************************
+    * ITERATE
+    *    index_set::iterator::operator++()
+    *    index_set::iterator::operator--()
+    ***************************************/
+
+   // forward from begin() and back from end() see the same elements
+   void test_iterate_forwardBackward()
+   {  // setup
+      custom::index_set <int> s;
+      for (int i = 0; i < 200; i++)
+         s.insert((i * 37) % 200);
+      std::vector <int> forward;
+      std::vector <int> backward;
+      // exercise
+      for (auto it = s.begin(); it != s.end(); it++)
+         forward.push_back(*it);
+      for (auto it = s.end(); it != s.begin(); )
+         backward.push_back(*--it);
+      // verify
+      assertUnit(forward.size() == 200);
+      assertUnit(forward.front() == 0);
+      assertUnit(forward.back() == 199);
+      assertUnit(std::vector<int>(backward.rbegin(), backward.rend()) == forward);
+      assertUnit(std::vector<int>(s.rbegin(), s.rend()) == backward);
+      assertUnit(*s.last() == 199);
+   }  // teardown
+
+   // an iterator is an index, so growing the array does not move it
+   void test_iterate_survivesGrowth()
+   {  // setup
+      custom::index_set <int> s{ 500 };
+      auto it = s.find(500);
+      size_t capacityBefore = s.capacity();
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.capacity() > capacityBefore);
+      assertUnit(*it == 500);
+      assertUnit(*++it == 501);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    *    index_set::insert(t)
+    ***************************************/
+
+   // ascending inserts still make a balanced tree
+   void test_insert_balanced()
+   {  // setup
+      custom::index_set <int> s;
+      // exercise
+      for (int i = 0; i < 1023; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.size() == 1023);
+      assertUnit(valid(s));
+      assertUnit(height(s, s.root) <= 2 * 10);
+      assertUnit(*s.begin() == 0);
+      assertUnit(*s.rbegin() == 1022);
+   }  // teardown
+
+   // a repeat is not added and points at what is there
+   void test_insert_duplicate()
+   {  // setup
+      custom::index_set <int> s{ 1, 2, 3 };
+      // exercise
+      auto result = s.insert(2);
+      // verify
+      assertUnit(!result.second);
+      assertUnit(*result.first == 2);
+      assertUnit(s.size() == 3);
+   }  // teardown
+
+   // elements that own memory are moved when the array grows
+   void test_insert_strings()
+   {  // setup
+      custom::index_set <std::string> s;
+      // exercise
+      for (int i = 0; i < 300; i++)
+         s.insert(std::string(40, 'a' + (char)(i % 26)) + std::to_string(i));
+      // verify
+      assertUnit(s.size() == 300);
+      assertUnit(valid(s));
+      assertUnit(s.contains(std::string(40, 'a') + "0"));
+      assertUnit(s.contains(std::string(40, 'a' + (char)(299 % 26)) + "299"));
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    *    index_set::erase(t)
+    *    index_set::erase(it)
+    *    index_set::erase(first, last)
+    *    index_set::clear()
+    ***************************************/
+
+   // erasing in a scrambled order keeps the tree valid all the way down
+   void test_erase_everyOrder()
+   {  // setup
+      custom::index_set <int> s;
+      for (int i = 0; i < 300; i++)
+         s.insert(i);
+      bool allValid = true;
+      // exercise
+      for (int i = 0; i < 300; i++)
+      {
+         int t = (i * 149) % 300;
+         allValid = allValid && s.erase(t) == 1 && s.erase(t) == 0 && valid(s);
+      }
+      // verify
+      assertUnit(allValid);
+      assertUnit(s.empty());
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // erased slots are taken again before the array grows
+   void test_erase_reusesSlots()
+   {  // setup
+      custom::index_set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      size_t slots = s.numSlots;
+      size_t capacity = s.capacity();
+      // exercise
+      for (int i = 0; i < 100; i += 2)
+         s.erase(i);
+      for (int i = 1000; i < 1050; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.numSlots == slots);
+      assertUnit(s.capacity() == capacity);
+      assertUnit(s.size() == 100);
+      assertUnit(valid(s));
+   }  // teardown
+
+   // erase a range, and get back what follows it
+   void test_eraseRange_standard()
+   {  // setup
+      custom::index_set <int> s{ 1, 2, 3, 4, 5, 6 };
+      // exercise
+      auto it = s.erase(s.find(2), s.find(5));
+      // verify
+      assertUnit(*it == 5);
+      assertUnit(toVector(s) == std::vector<int>({ 1, 5, 6 }));
+      assertUnit(s.erase(s.find(6)) == s.end());
+      assertUnit(valid(s));
+   }  // teardown
+
+   // every element is destroyed once, erased or cleared
+   void test_clear_spy()
+   {  // setup
+      Spy::reset();
+      {
+         custom::index_set <Spy> s;
+         for (int i = 0; i < 100; i++)
+            s.insert(Spy(i));
+         Spy::reset();
+         // exercise
+         s.erase(Spy(10));
+         s.clear();
+         // verify
+         assertUnit(s.empty());
+         assertUnit(Spy::numDestructor() == 101);   // 100 and the probe
+      }
+      assertUnit(Spy::numDestructor() == 101);
+   }  // teardown
+
+   /***************************************
+    * RELOCATE
+    *    index_set::serialize()
+    *    index_set::deserialize(p, n)
+    ***************************************/
+
+   // what is written out is read back the same
+   void test_serialize_roundTrip()
+   {  // setup
+      custom::index_set <int> s;
+      for (int i = 0; i < 500; i++)
+         s.insert((i * 7919) % 1000);
+      s.erase(3);
+      // exercise
+      std::vector <unsigned char> bytes = s.serialize();
+      custom::index_set <int> sCopy =
+         custom::index_set <int> ::deserialize(bytes.data(), bytes.size());
+      // verify
+      assertUnit(toVector(sCopy) == toVector(s));
+      assertUnit(valid(sCopy));
+      sCopy.insert(3);
+      assertUnit(sCopy.contains(3));
+      assertUnit(valid(sCopy));
+   }  // teardown
+
+   // the bytes still work copied somewhere else, unaligned
+   void test_serialize_relocated()
+   {  // setup
+      custom::index_set <double> s{ 2.5, -1.0, 7.25 };
+      std::vector <unsigned char> bytes = s.serialize();
+      std::vector <unsigned char> moved(bytes.size() + 3);
+      std::memcpy(moved.data() + 3, bytes.data(), bytes.size());
+      bytes.clear();
+      // exercise
+      custom::index_set <double> sCopy =
+         custom::index_set <double> ::deserialize(moved.data() + 3, moved.size() - 3);
+      // verify
+      assertUnit(std::vector<double>(sCopy.begin(), sCopy.end()) ==
+                 std::vector<double>({ -1.0, 2.5, 7.25 }));
+   }  // teardown
+
+   // bytes that are not a set of this type are refused
+   void test_deserialize_badSize()
+   {  // setup
+      custom::index_set <int> s{ 1, 2, 3 };
+      std::vector <unsigned char> bytes = s.serialize();
+      bool threwShort = false;
+      bool threwType = false;
+      // exercise
+      try
+      {
+         custom::index_set <int> ::deserialize(bytes.data(), bytes.size() - 1);
+      }
+      catch (const std::invalid_argument &)
+      {
+         threwShort = true;
+      }
+      try
+      {
+         custom::index_set <double> ::deserialize(bytes.data(), bytes.size());
+      }
+      catch (const std::invalid_argument &)
+      {
+         threwType = true;
+      }
+      // verify
+      assertUnit(threwShort);
+      assertUnit(threwType);
+   }  // teardown
+
+   // nodes whose links or colors do not make a tree are refused
+   void test_deserialize_badLinks()
+   {  // setup
+      typedef custom::index_set <int> Set;
+      Set s;
+      for (int i = 0; i < 20; i++)
+         s.insert(i);
+      s.erase(5);
+      s.erase(6);
+      const std::vector <unsigned char> bytes = s.serialize();
+      const size_t nodes = sizeof(Set::Image);
+      const size_t slot = sizeof(Set::Node);
+      const Set::Index outside = s.numSlots;
+      auto refused = [&](size_t offset, const void * pValue, size_t size)
+      {
+         std::vector <unsigned char> bad = bytes;
+         std::memcpy(bad.data() + offset, pValue, size);
+         try
+         {
+            Set::deserialize(bad.data(), bad.size());
+         }
+         catch (const std::invalid_argument &)
+         {
+            return true;
+         }
+         return false;
+      };
+      const uint8_t badColor = 7;
+      const Set::Index self = s.root;
+      const Set::Index loop = s.freeList;
+      const uint32_t tooMany = 30;
+      // exercise and verify
+      assertUnit(refused(offsetof(Set::Image, root), &outside, sizeof(outside)));
+      assertUnit(refused(offsetof(Set::Image, rightmost), &outside, sizeof(outside)));
+      assertUnit(refused(offsetof(Set::Image, numElements), &tooMany, sizeof(tooMany)));
+      assertUnit(refused(nodes + s.root * slot + offsetof(Set::Node, left),
+                         &outside, sizeof(outside)));
+      assertUnit(refused(nodes + s.root * slot + offsetof(Set::Node, left),
+                         &self, sizeof(self)));
+      assertUnit(refused(nodes + 3 * slot + offsetof(Set::Node, color),
+                         &badColor, sizeof(badColor)));
+      assertUnit(refused(nodes + s.freeList * slot + offsetof(Set::Node, left),
+                         &loop, sizeof(loop)));
+      assertUnit(!refused(0, bytes.data(), 0));
+   }  // teardown
+
+private:
+
+   template <class T, class C>
+   static std::vector <T> toVector(const custom::index_set <T, C> & s)
+   {
+      return std::vector <T>(s.begin(), s.end());
+   }
+
+   template <class T, class C>
+   static int height(const custom::index_set <T, C> & s, uint32_t i)
+   {
+      if (i == 0)
+         return 0;
+      int left = height(s, s.node(i).left);
+      int right = height(s, s.node(i).right);
+      return 1 + (left > right ? left : right);
+   }
+
+   // how many black nodes from i down to any leaf, or -1 if
+   // the subtree breaks a red-black rule or a link
+   template <class T, class C>
+   static int blackHeight(const custom::index_set <T, C> & s, uint32_t i)
+   {
+      if (i == 0)
+         return 1;
+      const auto & n = s.node(i);
+      if (n.color == custom::index_set <T, C> ::vacant)
+         return -1;
+      if (s.isRed(i) && (s.isRed(n.left) || s.isRed(n.right)))
+         return -1;
+      if ((n.left != 0 && s.node(n.left).parent != i) ||
+          (n.right != 0 && s.node(n.right).parent != i))
+         return -1;
+      int left = blackHeight(s, n.left);
+      int right = blackHeight(s, n.right);
+      if (left < 0 || left != right)
+         return -1;
+      return left + (s.isRed(i) ? 0 : 1);
+   }
+
+   // the root is black, the rules hold, and the ends and size agree
+   template <class T, class C>
+   static bool valid(const custom::index_set <T, C> & s)
+   {
+      if (s.isRed(s.root) || s.node(s.root).parent != 0 || blackHeight(s, s.root) < 0)
+         return false;
+      if (s.isRed(0))
+         return false;
+      size_t num = 0;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         num++;
+      if (num != s.size())
+         return false;
+      if (s.empty())
+         return s.root == 0 && s.leftmost == 0 && s.rightmost == 0;
+      return s.leftmost == s.minimum(s.root) && s.rightmost == s.maximum(s.root);
+   }
+};
+
+#endif // DEBUG
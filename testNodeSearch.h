@@ -0,0 +1,230 @@
+/***********************************************************************
+ * Header:
+ *    TEST NODE SEARCH
+ * Summary:
+ *    Unit tests for the vector in-node search kernels
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "nodeSearch.h"   // class under test
+#include "btreeSet.h"     // where the kernels are used
+#include "unitTest.h"     // unit test baseclass
+#include <cstdint>        // for int8_t through uint64_t
+#include <limits>         // for std::numeric_limits
+#include <string>         // for std::string
+#include <vector>         // for std::vector
+
+/***********************************************
+ * TEST NODE SEARCH
+ * Unit tests for the NodeSearch class
+ ***********************************************/
+class TestNodeSearch : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Which types
+      test_supports_numbers();
+      test_supports_others();
+
+      // Count
+      test_count_int32();
+      test_count_uint32();
+      test_count_bytes();
+      test_count_int16();
+      test_count_int64();
+      test_count_uint64();
+      test_count_float();
+      test_count_double();
+
+      // In the tree
+      test_btree_unsignedHighBit();
+
+      report("NodeSearch");
+   }
+
+   /***************************************
+    * SUPPORTS
+    *    NodeSearch::supports<T, Compare>()
+    ***************************************/
+
+   // numbers in their natural order can be counted
+   void test_supports_numbers()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit((custom::NodeSearch::supports<int, std::less<int>>()));
+      assertUnit((custom::NodeSearch::supports<uint8_t, std::less<uint8_t>>()));
+      assertUnit((custom::NodeSearch::supports<uint64_t, std::less<>>()));
+      assertUnit((custom::NodeSearch::supports<double, std::less<double>>()));
+   }  // teardown
+
+   // anything else needs the binary search
+   void test_supports_others()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit(!(custom::NodeSearch::supports<std::string, std::less<std::string>>()));
+      assertUnit(!(custom::NodeSearch::supports<int, std::greater<int>>()));
+      assertUnit(!(custom::NodeSearch::supports<bool, std::less<bool>>()));
+      assertUnit(!(custom::NodeSearch::supports<long double, std::less<long double>>()));
+   }  // teardown
+
+   /***************************************
+    * COUNT
+    *    NodeSearch::countLess(keys, num, t)
+    *    NodeSearch::countGreater(keys, num, t)
+    ***************************************/
+
+   // negatives, and both ends of the range
+   void test_count_int32()
+   {  // setup
+      std::vector <int32_t> keys = spread <int32_t>(-1000, 37, 70);
+      keys.front() = std::numeric_limits<int32_t>::min();
+      keys.back() = std::numeric_limits<int32_t>::max();
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   // keys with the top bit set are bigger, not negative
+   void test_count_uint32()
+   {  // setup
+      std::vector <uint32_t> keys = spread <uint32_t>(0x7FFFFF00u, 9, 70);
+      keys.back() = std::numeric_limits<uint32_t>::max();
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   // 32 keys to a compare, signed and unsigned
+   void test_count_bytes()
+   {  // setup
+      std::vector <int8_t> signedKeys = spread <int8_t>(-100, 2, 100);
+      std::vector <uint8_t> unsignedKeys = spread <uint8_t>(20, 2, 100);
+      // exercise and verify
+      assertUnit(agrees(signedKeys));
+      assertUnit(agrees(unsignedKeys));
+   }  // teardown
+
+   // 16 keys to a compare
+   void test_count_int16()
+   {  // setup
+      std::vector <int16_t> keys = spread <int16_t>(-300, 11, 70);
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   // 4 keys to a compare, or the loop without SSE4.2
+   void test_count_int64()
+   {  // setup
+      std::vector <int64_t> keys = spread <int64_t>(-(int64_t(1) << 40), int64_t(1) << 35, 40);
+      keys.front() = std::numeric_limits<int64_t>::min();
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   // the top bit again, at 64 bits
+   void test_count_uint64()
+   {  // setup
+      std::vector <uint64_t> keys = spread <uint64_t>(UINT64_MAX - 40 * 1000, 1000, 40);
+      keys.front() = 0;
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   // floats, either side of zero
+   void test_count_float()
+   {  // setup
+      std::vector <float> keys = spread <float>(-20.5f, 0.75f, 70);
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   // doubles, either side of zero
+   void test_count_double()
+   {  // setup
+      std::vector <double> keys = spread <double>(-3.25, 0.125, 50);
+      // exercise and verify
+      assertUnit(agrees(keys));
+   }  // teardown
+
+   /***************************************
+    * IN THE TREE
+    *    btree_set::lowerBoundIn()
+    *    btree_set::upperBoundIn()
+    ***************************************/
+
+   // a tree of unsigned keys around the top bit stays in order
+   void test_btree_unsignedHighBit()
+   {  // setup
+      custom::btree_set <uint32_t> s;
+      const uint32_t middle = 0x80000000u;
+      // exercise
+      for (uint32_t i = 0; i < 500; i++)
+      {
+         s.insert(middle + i * 7);
+         s.insert(middle - 1 - i * 7);
+      }
+      // verify
+      uint32_t previous = 0;
+      bool inOrder = true;
+      for (auto it = s.begin(); it != s.end(); ++it)
+      {
+         inOrder = inOrder && (it == s.begin() || previous < *it);
+         previous = *it;
+      }
+      assertUnit(inOrder);
+      assertUnit(s.size() == 1000);
+      assertUnit(*s.lower_bound(middle) == middle);
+      assertUnit(*s.upper_bound(middle) == middle + 7);
+      assertUnit(*s.begin() == middle - 1 - 499 * 7);
+   }  // teardown
+
+private:
+
+   // num ascending keys, step apart, starting from first
+   template <class T>
+   static std::vector <T> spread(T first, T step, size_t num)
+   {
+      std::vector <T> keys;
+      for (size_t i = 0; i < num; i++)
+         keys.push_back((T)(first + (T)(step * (T)i)));
+      return keys;
+   }
+
+   // for every length of the keys and every probe around them,
+   // the kernels count what a loop counts
+   template <class T>
+   static bool agrees(const std::vector <T> & keys)
+   {
+      std::vector <T> probes(keys);
+      for (size_t i = 0; i + 1 < keys.size(); i++)
+         probes.push_back((T)(keys[i] / 2 + keys[i + 1] / 2));   // between, without overflow
+      probes.push_back(std::numeric_limits<T>::lowest());
+      probes.push_back(std::numeric_limits<T>::max());
+
+      for (size_t num = 0; num <= keys.size(); num++)
+         for (T t : probes)
+         {
+            size_t numLess = 0;
+            size_t numGreater = 0;
+            for (size_t i = 0; i < num; i++)
+            {
+               numLess += keys[i] < t;
+               numGreater += t < keys[i];
+            }
+            if (custom::NodeSearch::countLess(keys.data(), num, t) != numLess ||
+                custom::NodeSearch::countGreater(keys.data(), num, t) != numGreater)
+               return false;
+         }
+      return true;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,477 @@
+/***********************************************************************
+ * Header:
+ *    TEST PERSISTENT SET
+ * Summary:
+ *    Unit tests for the immutable, path-copying red-black set
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "persistentSet.h" // class under test
+#include "spy.h"           // for Spy
+#include "unitTest.h"      // unit test baseclass
+#include <set>             // for std::set, to check against
+#include <string>          // for std::string
+#include <unordered_set>   // for std::unordered_set
+#include <vector>          // for std::vector
+
+/***********************************************
+ * TEST PERSISTENT SET
+ * Unit tests for the pset class
+ ***********************************************/
+class TestPersistentSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructInitializer_sorts();
+      test_constructRange_everySize();
+      test_constructCopy_shares();
+
+      // Access
+      test_find_standard();
+      test_lowerUpper_standard();
+
+      // Iterate
+      test_iterate_forwardBackward();
+
+      // Insert
+      test_insert_leavesOld();
+      test_insert_duplicate();
+      test_insert_balanced();
+      test_insert_sharesNodes();
+
+      // Erase
+      test_erase_leavesOld();
+      test_erase_missing();
+      test_erase_everyOrder();
+      test_erase_sharesNodes();
+
+      // Versions
+      test_versions_random();
+      test_versions_reclaimed();
+
+      report("PersistentSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    pset::pset()
+    *    pset::pset(initializer_list)
+    *    pset::pset(first, last)
+    *    pset::pset(const pset &)
+    ***************************************/
+
+   // a new set holds nothing
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::pset <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.begin() == s.end());
+      assertUnit(!s.root);
+   }  // teardown
+
+   // sorted, with the first of any repeats kept
+   void test_constructInitializer_sorts()
+   {  // setup
+      // exercise
+      custom::pset <int> s{ 50, 30, 70, 30, 10 };
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(toVector(s) == std::vector<int>({ 10, 30, 50, 70 }));
+      assertUnit(valid(s));
+   }  // teardown
+
+   // the tree built in one pass is a valid red-black tree, full or not
+   void test_constructRange_everySize()
+   {  // setup
+      bool allValid = true;
+      // exercise
+      for (int num = 0; num <= 70; num++)
+      {
+         std::vector <int> v;
+         for (int i = num; i > 0; i--)
+            v.push_back(i);
+         custom::pset <int> s(v.begin(), v.end());
+         allValid = allValid && valid(s) && s.size() == (size_t)num;
+      }
+      // verify
+      assertUnit(allValid);
+   }  // teardown
+
+   // a copy is the same version: the same root, no new nodes
+   void test_constructCopy_shares()
+   {  // setup
+      custom::pset <int> s{ 1, 2, 3 };
+      // exercise
+      custom::pset <int> sCopy(s);
+      // verify
+      assertUnit(sCopy.root.get() == s.root.get());
+      assertUnit(s.root->numRefs == 2);
+      assertUnit(s.use_count() == 2);
+      assertUnit(toVector(sCopy) == std::vector<int>({ 1, 2, 3 }));
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    *    pset::find(t)
+    *    pset::lower_bound(t)
+    *    pset::upper_bound(t)
+    ***************************************/
+
+   // find what is there, and end() for what is not
+   void test_find_standard()
+   {  // setup
+      custom::pset <int> s;
+      for (int i = 0; i < 100; i++)
+         s = s.insert(i * 3);
+      // exercise
+      // verify
+      assertUnit(*s.find(0) == 0);
+      assertUnit(*s.find(150) == 150);
+      assertUnit(*s.find(297) == 297);
+      assertUnit(s.find(151) == s.end());
+      assertUnit(s.contains(42));
+      assertUnit(s.count(43) == 0);
+   }  // teardown
+
+   // the bounds are where std::set puts them, and iterate on from there
+   void test_lowerUpper_standard()
+   {  // setup
+      std::set <int> model{ 2, 4, 6, 8, 10 };
+      custom::pset <int> s(model.begin(), model.end());
+      bool allRight = true;
+      // exercise
+      for (int t = 0; t <= 11; t++)
+      {
+         auto itLower = s.lower_bound(t);
+         auto itUpper = s.upper_bound(t);
+         auto itModelLower = model.lower_bound(t);
+         auto itModelUpper = model.upper_bound(t);
+         allRight = allRight &&
+            (itModelLower == model.end() ? itLower == s.end() : *itLower == *itModelLower) &&
+            (itModelUpper == model.end() ? itUpper == s.end() : *itUpper == *itModelUpper);
+         if (itLower != s.end() && ++itLower != s.end())
+            allRight = allRight && *itLower == *++itModelLower;
+      }
+      // verify
+      assertUnit(allRight);
+   }  // teardown
+
+   /***************************************
+    * ITERATE
+    *    pset::iterator::operator++()
+    *    pset::iterator::operator--()
+    ***************************************/
+
+   // forward from begin() and back from end() see the same elements
+   void test_iterate_forwardBackward()
+   {  // setup
+      custom::pset <int> s;
+      for (int i = 0; i < 200; i++)
+         s = s.insert((i * 37) % 200);
+      std::vector <int> forward;
+      std::vector <int> backward;
+      // exercise
+      for (auto it = s.begin(); it != s.end(); it++)
+         forward.push_back(*it);
+      for (auto it = s.end(); it != s.begin(); )
+         backward.push_back(*--it);
+      // verify
+      assertUnit(forward.size() == 200);
+      assertUnit(forward.front() == 0 && forward.back() == 199);
+      assertUnit(std::vector<int>(backward.rbegin(), backward.rend()) == forward);
+      assertUnit(std::vector<int>(s.rbegin(), s.rend()) == backward);
+      assertUnit(*s.last() == 199);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    *    pset::insert(t)
+    ***************************************/
+
+   // the new version has t and the old one is as it was
+   void test_insert_leavesOld()
+   {  // setup
+      custom::pset <std::string> s{ "alpha", "charlie" };
+      // exercise
+      custom::pset <std::string> sNew = s.insert("bravo");
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(!s.contains("bravo"));
+      assertUnit(sNew.size() == 3);
+      assertUnit(toVector(sNew) == std::vector<std::string>({ "alpha", "bravo", "charlie" }));
+      assertUnit(valid(s));
+      assertUnit(valid(sNew));
+   }  // teardown
+
+   // inserting what is there gives the same version back
+   void test_insert_duplicate()
+   {  // setup
+      custom::pset <int> s{ 1, 2, 3 };
+      // exercise
+      custom::pset <int> sNew = s.insert(2);
+      // verify
+      assertUnit(sNew.root.get() == s.root.get());
+      assertUnit(sNew.size() == 3);
+   }  // teardown
+
+   // ascending inserts still make a balanced tree
+   void test_insert_balanced()
+   {  // setup
+      custom::pset <int> s;
+      bool allValid = true;
+      // exercise
+      for (int i = 0; i < 1023; i++)
+      {
+         s = s.insert(i);
+         allValid = allValid && (i % 97 != 0 || valid(s));
+      }
+      // verify
+      assertUnit(allValid);
+      assertUnit(valid(s));
+      assertUnit(height(s.root.get()) <= 2 * 10);
+      assertUnit(s.size() == 1023);
+   }  // teardown
+
+   // an insert copies a path, not the tree
+   void test_insert_sharesNodes()
+   {  // setup
+      std::vector <int> v;
+      for (int i = 0; i < 4096; i++)
+         v.push_back(i * 2);
+      custom::pset <int> s(v.begin(), v.end());
+      // exercise
+      custom::pset <int> sNew = s.insert(4001);
+      // verify
+      size_t numNew = countNew(s, sNew);
+      assertUnit(numNew >= 1);
+      assertUnit(numNew <= 3 * (size_t)height(s.root.get()));
+      assertUnit(nodes(sNew).size() == 4097);
+   }  // teardown
+
+   /***************************************
+    * ERASE
+    *    pset::erase(t)
+    ***************************************/
+
+   // the new version lacks t and the old one is as it was
+   void test_erase_leavesOld()
+   {  // setup
+      custom::pset <int> s{ 1, 2, 3, 4 };
+      // exercise
+      custom::pset <int> sNew = s.erase(3);
+      // verify
+      assertUnit(toVector(s) == std::vector<int>({ 1, 2, 3, 4 }));
+      assertUnit(toVector(sNew) == std::vector<int>({ 1, 2, 4 }));
+      assertUnit(sNew.size() == 3);
+      assertUnit(valid(sNew));
+   }  // teardown
+
+   // erasing what is not there gives the same version back
+   void test_erase_missing()
+   {  // setup
+      custom::pset <int> s{ 1, 2, 3 };
+      custom::pset <int> sEmpty;
+      // exercise
+      custom::pset <int> sNew = s.erase(7);
+      custom::pset <int> sEmptyNew = sEmpty.erase(7);
+      // verify
+      assertUnit(sNew.root.get() == s.root.get());
+      assertUnit(sEmptyNew.empty());
+   }  // teardown
+
+   // erasing in a scrambled order keeps every version valid
+   void test_erase_everyOrder()
+   {  // setup
+      custom::pset <int> s;
+      for (int i = 0; i < 300; i++)
+         s = s.insert(i);
+      bool allValid = true;
+      // exercise
+      for (int i = 0; i < 300; i++)
+      {
+         s = s.erase((i * 149) % 300);
+         allValid = allValid && valid(s) && s.size() == (size_t)(299 - i);
+      }
+      // verify
+      assertUnit(allValid);
+      assertUnit(s.empty());
+      assertUnit(!s.root);
+   }  // teardown
+
+   // an erase copies a path, not the tree
+   void test_erase_sharesNodes()
+   {  // setup
+      std::vector <int> v;
+      for (int i = 0; i < 4096; i++)
+         v.push_back(i);
+      custom::pset <int> s(v.begin(), v.end());
+      // exercise
+      custom::pset <int> sNew = s.erase(2048);
+      // verify
+      size_t numNew = countNew(s, sNew);
+      assertUnit(numNew <= 3 * (size_t)height(s.root.get()));
+      assertUnit(nodes(sNew).size() == 4095);
+      assertUnit(valid(sNew));
+   }  // teardown
+
+   /***************************************
+    * VERSIONS
+    ***************************************/
+
+   // random inserts and erases, each from a random older version,
+   // and every version still holds what it held when it was made
+   void test_versions_random()
+   {  // setup
+      std::vector <custom::pset <int>> versions(1);
+      std::vector <std::set <int>> models(1);
+      unsigned state = 12345;
+      // exercise
+      for (int i = 0; i < 2000; i++)
+      {
+         state = state * 1103515245u + 12345u;
+         size_t from = (state >> 8) % versions.size();
+         int t = (int)((state >> 16) % 200);
+         std::set <int> model = models[from];
+         if ((state >> 4) % 3 == 0)
+         {
+            versions.push_back(versions[from].erase(t));
+            model.erase(t);
+         }
+         else
+         {
+            versions.push_back(versions[from].insert(t));
+            model.insert(t);
+         }
+         models.push_back(model);
+      }
+      // verify
+      bool allMatch = true;
+      for (size_t i = 0; i < versions.size(); i++)
+         allMatch = allMatch && valid(versions[i]) &&
+                    toVector(versions[i]) == std::vector<int>(models[i].begin(), models[i].end());
+      assertUnit(allMatch);
+   }  // teardown
+
+   // every node is freed once no version reaches it
+   void test_versions_reclaimed()
+   {  // setup
+      Spy::reset();
+      {
+         custom::pset <Spy> s;
+         std::vector <custom::pset <Spy>> versions;
+         for (int i = 0; i < 100; i++)
+         {
+            s = s.insert(Spy(i));
+            versions.push_back(s);
+         }
+         for (int i = 0; i < 100; i += 3)
+            versions.push_back(versions.back().erase(Spy(i)));
+         // exercise
+         versions.clear();
+         // verify
+         assertUnit(Spy::numAlloc() > Spy::numDelete());
+         assertUnit(s.size() == 100);
+      }
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+   }  // teardown
+
+private:
+
+   template <class T, class C>
+   static std::vector <T> toVector(const custom::pset <T, C> & s)
+   {
+      return std::vector <T>(s.begin(), s.end());
+   }
+
+   template <class Node>
+   static int height(const Node * p)
+   {
+      if (!p)
+         return 0;
+      int left = height(p->pLeft.get());
+      int right = height(p->pRight.get());
+      return 1 + (left > right ? left : right);
+   }
+
+   // every node a version can reach
+   template <class T, class C>
+   static std::unordered_set <const void *> nodes(const custom::pset <T, C> & s)
+   {
+      std::unordered_set <const void *> found;
+      std::vector <decltype(s.root.get())> todo;
+      if (s.root)
+         todo.push_back(s.root.get());
+      while (!todo.empty())
+      {
+         auto p = todo.back();
+         todo.pop_back();
+         found.insert(p);
+         if (p->pLeft)
+            todo.push_back(p->pLeft.get());
+         if (p->pRight)
+            todo.push_back(p->pRight.get());
+      }
+      return found;
+   }
+
+   // how many of the new version's nodes the old one does not have
+   template <class T, class C>
+   static size_t countNew(const custom::pset <T, C> & sOld, const custom::pset <T, C> & sNew)
+   {
+      std::unordered_set <const void *> old = nodes(sOld);
+      size_t num = 0;
+      for (const void * p : nodes(sNew))
+         num += old.count(p) == 0;
+      return num;
+   }
+
+   // how many black nodes from p down to any leaf, or -1 if
+   // the subtree breaks a red-black rule
+   template <class Node>
+   static int blackHeight(const Node * p)
+   {
+      if (!p)
+         return 1;
+      if (p->isRed && ((p->pLeft && p->pLeft->isRed) || (p->pRight && p->pRight->isRed)))
+         return -1;
+      int left = blackHeight(p->pLeft.get());
+      int right = blackHeight(p->pRight.get());
+      if (left < 0 || left != right)
+         return -1;
+      return left + (p->isRed ? 0 : 1);
+   }
+
+   // the root is black, the rules hold, and the order and size agree
+   template <class T, class C>
+   static bool valid(const custom::pset <T, C> & s)
+   {
+      if (s.root && s.root->isRed)
+         return false;
+      if (blackHeight(s.root.get()) < 0)
+         return false;
+      size_t num = 0;
+      C compare;
+      for (auto it = s.begin(); it != s.end(); ++it, num++)
+      {
+         auto itNext = it;
+         if (++itNext != s.end() && !compare(*it, *itNext))
+            return false;
+      }
+      return num == s.size();
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,294 @@
+/***********************************************************************
+ * Header:
+ *    TEST POOL
+ * Summary:
+ *    Unit tests for the node pool
+ * Author
+ *    Daniel Carr, Jarom Anderson, Arlo Jolly
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "pool.h"       // class under test
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // for Spy
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST POOL
+ * Unit tests for the Pool class
+ ***********************************************/
+class TestPool : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Allocate
+      test_construct_first();
+      test_construct_growsSlab();
+      test_destroy_recycles();
+      test_reserve_noGrowth();
+
+      // Lend
+      test_lend_outlivesRelease();
+      test_keep_noDuplicates();
+      test_take_oneSlab();
+      test_keep_pool();
+      test_destroy_lease();
+      test_release_givesBack();
+
+      // Remove
+      test_release_standard();
+
+      report("Pool");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    *    Pool::Pool()
+    ***************************************/
+
+   // a new pool does not touch the system allocator
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::Pool <Spy> pool;
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(pool.slabs.empty());
+      assertUnit(pool.pFree == nullptr);
+      assertUnit(pool.capacity() == 0);
+      assertUnit(pool.live() == 0);
+   }  // teardown
+
+   /***************************************
+    * CONSTRUCT
+    *    Pool::construct(args)
+    ***************************************/
+
+   // the first node allocates the first slab
+   void test_construct_first()
+   {  // setup
+      custom::Pool <Spy> pool;
+      Spy::reset();
+      // exercise
+      Spy * p = pool.construct(99);
+      // verify
+      assertUnit(Spy::numNondefault() == 1); // build [99] in place
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(p != nullptr);
+      if (p)
+         assertUnit(p->get() == 99);
+      assertUnit(pool.slabs.size() == 1);
+      assertUnit(pool.capacity() == custom::Pool <Spy> ::minSlab);
+      assertUnit(pool.live() == 1);
+      // teardown
+      pool.destroy(p);
+   }
+
+   // nodes are handed out next to each other until the slab fills
+   void test_construct_growsSlab()
+   {  // setup
+      custom::Pool <int> pool;
+      int * pFirst = pool.construct(0);
+      for (size_t i = 1; i < custom::Pool <int> ::minSlab; i++)
+         pool.construct((int)i);
+      // exercise
+      int * pNext = pool.construct(99);
+      // verify
+      assertUnit(pool.live() == custom::Pool <int> ::minSlab + 1);
+      assertUnit(pool.capacity() == 2 * custom::Pool <int> ::minSlab);
+      assertUnit(pool.slabs.size() == 2);
+      assertUnit(pNext != pFirst + custom::Pool <int> ::minSlab);
+   }  // teardown
+
+   // a destroyed node is the next one handed out
+   void test_destroy_recycles()
+   {  // setup
+      custom::Pool <Spy> pool;
+      Spy * p50 = pool.construct(50);
+      Spy * p60 = pool.construct(60);
+      Spy::reset();
+      // exercise
+      pool.destroy(p50);
+      Spy * p70 = pool.construct(70);
+      // verify
+      assertUnit(Spy::numDestructor() == 1); // destroy [50]
+      assertUnit(Spy::numDelete() == 1);     // delete  [50]
+      assertUnit(p70 == p50);
+      assertUnit(pool.live() == 2);
+      assertUnit(pool.capacity() == custom::Pool <Spy> ::minSlab);
+      // teardown
+      pool.destroy(p60);
+      pool.destroy(p70);
+   }
+
+   // reserving room we already have does nothing
+   void test_reserve_noGrowth()
+   {  // setup
+      custom::Pool <int> pool;
+      pool.reserve(100);
+      size_t capacity = pool.capacity();
+      // exercise
+      for (int i = 0; i < 100; i++)
+         pool.construct(i);
+      pool.reserve(0);
+      // verify
+      assertUnit(capacity >= 100);
+      assertUnit(pool.capacity() == capacity);
+      assertUnit(pool.live() == 100);
+   }  // teardown
+
+   /***************************************
+    * LEND
+    *    Pool::lend(p)
+    *    Pool::keep(lease)
+    *    Pool::take(rhs, p)
+    *    Pool::keep(rhs)
+    *    Pool::destroy(p, lease)
+    ***************************************/
+
+   // a lent node outlives the pool it came from
+   void test_lend_outlivesRelease()
+   {  // setup
+      custom::Pool <int> poolSrc;
+      custom::Pool <int> poolDest;
+      int * p = poolSrc.construct(99);
+      // exercise
+      poolDest.keep(poolSrc.lend(p));
+      poolSrc.release();
+      // verify
+      assertUnit(poolSrc.slabs.empty());
+      assertUnit(poolDest.slabs.size() == 1);
+      assertUnit(poolDest.live() == 1);
+      assertUnit(*p == 99);              // the slab is still there
+      poolDest.destroy(p);
+      assertUnit(poolDest.construct(42) == p);
+   }  // teardown
+
+   // keeping two nodes from the same slab holds it once
+   void test_keep_noDuplicates()
+   {  // setup
+      custom::Pool <int> poolSrc;
+      custom::Pool <int> poolDest;
+      int * p1 = poolSrc.construct(1);
+      int * p2 = poolSrc.construct(2);
+      poolDest.keep(poolSrc.lend(p1));
+      // exercise
+      poolDest.keep(poolSrc.lend(p2));
+      // verify
+      assertUnit(poolDest.slabs.size() == 1);
+      assertUnit(poolDest.slabs.front() == poolSrc.slabs.front());
+      assertUnit(poolSrc.slabs.front()->numRefs == 2);
+      assertUnit(poolSrc.live() == 0);
+      assertUnit(poolDest.live() == 2);
+   }  // teardown
+
+   // taking one node holds only the slab it is in
+   void test_take_oneSlab()
+   {  // setup
+      custom::Pool <int> poolSrc;
+      custom::Pool <int> poolDest;
+      int * p = nullptr;
+      for (size_t i = 0; i <= custom::Pool <int> ::minSlab; i++)
+         p = poolSrc.construct((int)i);
+      // exercise
+      poolDest.take(poolSrc, p);
+      // verify
+      assertUnit(poolSrc.slabs.size() == 2);
+      assertUnit(poolDest.slabs.size() == 1);
+      assertUnit(poolDest.slabs.front() == poolSrc.find(p));
+      assertUnit(poolSrc.live() == custom::Pool <int> ::minSlab);
+      assertUnit(poolDest.live() == 1);
+   }  // teardown
+
+   // keeping a whole pool holds each of its slabs once
+   void test_keep_pool()
+   {  // setup
+      custom::Pool <int> poolSrc;
+      custom::Pool <int> poolDest;
+      int * p = nullptr;
+      for (size_t i = 0; i <= custom::Pool <int> ::minSlab; i++)
+         p = poolSrc.construct((int)i);
+      poolDest.take(poolSrc, p);
+      // exercise
+      poolDest.keep(poolSrc);
+      // verify
+      assertUnit(poolDest.slabs == poolSrc.slabs);
+      assertUnit(poolSrc.slabs[0]->numRefs == 2);
+      assertUnit(poolSrc.slabs[1]->numRefs == 2);
+   }  // teardown
+
+   // a node dropped outside any pool gives its slot back to its slab
+   void test_destroy_lease()
+   {  // setup
+      custom::Pool <Spy> pool;
+      Spy * p = pool.construct(99);
+      custom::Pool <Spy> ::Lease lease = pool.lend(p);
+      std::vector <Spy *> others;
+      for (size_t i = 1; i < custom::Pool <Spy> ::minSlab; i++)
+         others.push_back(pool.construct((int)i));
+      Spy::reset();
+      // exercise
+      custom::Pool <Spy> ::destroy(p, std::move(lease));
+      Spy * pAgain = pool.construct(42);
+      // verify
+      assertUnit(Spy::numDestructor() == 1); // destroy [99]
+      assertUnit(pAgain == p);
+      assertUnit(pool.capacity() == custom::Pool <Spy> ::minSlab);
+      assertUnit(pool.slabs.front()->numRefs == 1);
+      // teardown
+      pool.destroy(pAgain);
+      for (Spy * pOther : others)
+         pool.destroy(pOther);
+   }
+
+   /***************************************
+    * RELEASE
+    *    Pool::release()
+    ***************************************/
+
+   // every slab goes back at once
+   void test_release_standard()
+   {  // setup
+      custom::Pool <int> pool;
+      for (int i = 0; i < 1000; i++)
+         pool.construct(i);
+      // exercise
+      pool.release();
+      // verify
+      assertUnit(pool.slabs.empty());
+      assertUnit(pool.pFree == nullptr);
+      assertUnit(pool.pNext == nullptr);
+      assertUnit(pool.capacity() == 0);
+      assertUnit(pool.live() == 0);
+   }  // teardown
+
+   // free slots in a slab someone else holds go back to it
+   void test_release_givesBack()
+   {  // setup
+      custom::Pool <int> poolSrc;
+      custom::Pool <int> poolDest;
+      int * p = poolSrc.construct(99);
+      poolDest.keep(poolSrc.lend(p));
+      // exercise
+      poolSrc.release();
+      int * pNew = poolDest.construct(42);
+      // verify
+      assertUnit(poolDest.capacity() == 0);   // no slab of its own
+      assertUnit(poolDest.slabs.size() == 1);
+      assertUnit(poolDest.find(pNew) == poolDest.find(p));
+      assertUnit(poolDest.live() == 2);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -15,6 +15,15 @@
 #include "testSet.h"        // for the set unit tests
 #include "testBST.h"        // for the BST unit tests
 #include "testSpy.h"        // for the spy unit tests
+#include "testPool.h"       // for the pool unit tests
+#include "testConcurrentSet.h" // for the concurrent set unit tests
+#include "testEpoch.h"      // for the epoch unit tests
+#include "testConcurrentSkiplistSet.h" // for the skip list set unit tests
+#include "testBTreeSet.h"   // for the B+ tree set unit tests
+#include "testFlatSet.h"    // for the flat set unit tests
+#include "testNodeSearch.h" // for the in-node search unit tests
+#include "testIndexSet.h"   // for the index-linked set unit tests
+#include "testPersistentSet.h" // for the persistent set unit tests
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -26,8 +35,17 @@ int main()
 #ifdef DEBUG
    // unit tests
    TestSpy().run();
+   TestPool().run();
    TestBST().run();
    TestSet().run();
+   TestConcurrentSet().run();
+   TestEpoch().run();
+   TestConcurrentSkiplistSet().run();
+   TestBTreeSet().run();
+   TestFlatSet().run();
+   TestNodeSearch().run();
+   TestIndexSet().run();
+   TestPersistentSet().run();
 #endif // DEBUG
    
    return 0;
@@ -22,6 +22,22 @@
 #include <iostream>
 #include <cassert>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/***********************************************
+ * SPY LESS
+ * A transparent comparator: orders Spys against
+ * plain ints without building a Spy for them
+ ***********************************************/
+struct SpyLess
+{
+   using is_transparent = void;
+   bool operator()(const Spy & lhs, const Spy & rhs) const { return lhs < rhs;  }
+   bool operator()(const Spy & lhs, int rhs) const { return lhs.get() < rhs; }
+   bool operator()(int lhs, const Spy & rhs) const { return lhs < rhs.get(); }
+};
 
 class TestSet : public UnitTest
 {
@@ -44,6 +60,9 @@ public:
       test_constructRange_empty();
       test_constructRange_one();
       test_constructRange_standard();
+      test_constructRange_sorted();
+      test_constructRange_fromSorted();
+      test_constructRange_sortedDuplicate();
       test_destructor_empty();
       test_destructor_standard();
 
@@ -74,6 +93,8 @@ public:
       // Iterator
       test_begin_empty();
       test_begin_standard();
+      test_last_standard();
+      test_rbegin_standard();
       test_end_standard();
       test_iterator_increment_standardToParent();
       test_iterator_increment_standardToChild();
@@ -81,6 +102,7 @@ public:
       test_iterator_increment_standardToGrandchild();
       test_iterator_increment_standardToDone();
       test_iterator_increment_standardEnd();
+      test_iterator_decrement_standardEnd();
       test_iterator_dereference_standardRead();
 
       // Access
@@ -88,6 +110,14 @@ public:
        test_find_standardBegin();
        test_find_standardLast();
        test_find_standardMissing();
+       test_find_comparisonsHalved();
+       test_find_compareGreater();
+       test_lowerBound_const();
+       test_equalRange_standard();
+       test_count_standard();
+       test_find_transparentNoTemporary();
+       test_erase_transparent();
+       test_find_stringView();
 
       // Insert
       test_insert_empty();
@@ -105,6 +135,16 @@ public:
        test_insertInit_standardInsertNone();
        test_insertInit_standardInsertDuplicates();
        test_insertInit_manyInsertMany();
+       test_insertHint_standardEnd();
+       test_insertHint_standardWrong();
+       test_insertNode_fromOther();
+       test_insertNode_duplicate();
+       test_merge_standard();
+       test_rankSelect_standard();
+       test_countRange_standard();
+       test_emplace_empty();
+       test_emplace_standardDuplicate();
+       test_emplaceHint_standardEnd();
 
       // Remove
       test_clear_empty();
@@ -125,6 +165,30 @@ public:
       test_eraseRange_standardMany();
       test_eraseRange_oneChild();
       test_eraseRange_twoChildren();
+      test_eraseRange_large();
+
+      // Set algebra
+      test_setUnion_standard();
+      test_setIntersection_standard();
+      test_setDifference_large();
+      test_setUnion_moved();
+      test_setIntersection_lopsided();
+      test_setDifference_lopsided();
+
+      // Split and join
+      test_split_standard();
+      test_join_standard();
+      test_join_overlapping();
+
+      // Snapshot
+      test_snapshot_empty();
+      test_snapshot_isolated();
+      test_snapshot_again();
+      test_snapshot_pathCopy();
+      test_snapshot_bulk();
+      test_snapshot_threaded();
+      test_snapshot_dropped();
+      test_snapshot_copy();
 
       // Status
       test_empty_empty();
@@ -182,9 +246,10 @@ public:
    {  // setup
       //            (50b)
       custom::set<Spy> sSrc;
-      sSrc.bst.root = new custom::BST<Spy>::BNode(Spy(50));
+      sSrc.bst.root = sSrc.bst.pool.construct(Spy(50));
       sSrc.bst.root->isRed = false;
       sSrc.bst.numElements = 1;
+      sSrc.bst.relink();
       Spy::reset();
       // exercise
       custom::set<Spy> sDest(sSrc);
@@ -205,7 +270,7 @@ public:
          assertUnit(sSrc.bst.root->isRed == false);
          assertUnit(sSrc.bst.root->pLeft == nullptr);
          assertUnit(sSrc.bst.root->pRight == nullptr);
-         assertUnit(sSrc.bst.root->pParent == nullptr);
+         assertUnit(sSrc.bst.root->pParent == sSrc.bst.pHeader());
       }
       //            (50b)
       assertUnit(sDest.bst.numElements == 1);
@@ -216,15 +281,15 @@ public:
          assertUnit(sDest.bst.root->isRed == false);
          assertUnit(sDest.bst.root->pLeft == nullptr);
          assertUnit(sDest.bst.root->pRight == nullptr);
-         assertUnit(sDest.bst.root->pParent == nullptr);
+         assertUnit(sDest.bst.root->pParent == sDest.bst.pHeader());
       }
       // teardown
       if (sSrc.bst.root)
-         delete sSrc.bst.root;
+         sSrc.bst.pool.destroy(sSrc.bst.root);
       sSrc.bst.root = nullptr;
       sSrc.bst.numElements = 0;
       if (sDest.bst.root)
-         delete sDest.bst.root;
+         sDest.bst.pool.destroy(sDest.bst.root);
       sDest.bst.root = nullptr;
       sDest.bst.numElements = 0;
    }
@@ -304,9 +369,10 @@ public:
       // setup
       //            (50b)
       custom::set <Spy> sSrc;
-      sSrc.bst.root = new custom::BST<Spy>::BNode(Spy(50));
+      sSrc.bst.root = sSrc.bst.pool.construct(Spy(50));
       sSrc.bst.root->isRed = false;
       sSrc.bst.numElements = 1;
+      sSrc.bst.relink();
       Spy::reset();
       // exercise
       custom::set <Spy> sDest(std::move(sSrc));
@@ -334,11 +400,11 @@ public:
          assertUnit(sDest.bst.root->isRed == false);
          assertUnit(sDest.bst.root->pLeft == nullptr);
          assertUnit(sDest.bst.root->pRight == nullptr);
-         assertUnit(sDest.bst.root->pParent == nullptr);
+         assertUnit(sDest.bst.root->pParent == sDest.bst.pHeader());
       }
       // teardown
       if (sDest.bst.root)
-         delete sDest.bst.root;
+         sDest.bst.pool.destroy(sDest.bst.root);
       sDest.bst.root = nullptr;
       sDest.bst.numElements = 0;
    }
@@ -394,8 +460,8 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 7);     // copy-create [50][30][70][20][40][60][80]
       assertUnit(Spy::numAlloc() == 7);    // allocate    [50][30][70][20][40][60][80]
-      assertUnit(Spy::numLessthan() == 10);// compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);  // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
+      assertUnit(Spy::numLessthan() == 15);   // sorted? 30:[50]  then 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
@@ -442,11 +508,11 @@ public:
          assertUnit(s.bst.root->isRed == false);
          assertUnit(s.bst.root->pLeft == nullptr);
          assertUnit(s.bst.root->pRight == nullptr);
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
       }
       // teardown
       if (s.bst.root)
-         delete s.bst.root;
+         s.bst.pool.destroy(s.bst.root);
       s.bst.root = nullptr;
       s.bst.numElements = 0;
    }
@@ -463,9 +529,38 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 7);      // copy-construct [50,30,70,20,40,60,80]
       assertUnit(Spy::numAlloc() == 7);     // allocate [50,30,70,20,40,60,80]
-      assertUnit(Spy::numLessthan() == 10); // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);   // equal   50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);
+      assertUnit(Spy::numLessthan() == 15);   // sorted? 30:[50]  then 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // create a new set from a range that is already sorted
+   void test_constructRange_sorted()
+   {  // setup
+      std::initializer_list<Spy> il{ Spy(20), Spy(30), Spy(40), Spy(50), Spy(60), Spy(70), Spy(80) };
+      Spy::reset();
+      // exercise
+      custom::set <Spy> s(il.begin(), il.end());
+      // verify
+      assertUnit(Spy::numCopy() == 7);      // copy-construct [20,30,40,50,60,70,80]
+      assertUnit(Spy::numAlloc() == 7);     // allocate [20,30,40,50,60,70,80]
+      assertUnit(Spy::numLessthan() == 6);  // sorted? [20][30] [30][40] [40][50] [50][60] [60][70] [70][80]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
@@ -483,6 +578,46 @@ public:
       teardownStandardFixture(s);
    }
 
+   // with the tag, the range is trusted and nothing is compared
+   void test_constructRange_fromSorted()
+   {  // setup
+      std::initializer_list<Spy> il{ Spy(20), Spy(30), Spy(40), Spy(50), Spy(60), Spy(70), Spy(80) };
+      Spy::reset();
+      // exercise
+      custom::set <Spy> s(custom::from_sorted, il.begin(), il.end());
+      // verify
+      assertUnit(Spy::numCopy() == 7);      // copy-construct [20,30,40,50,60,70,80]
+      assertUnit(Spy::numAlloc() == 7);     // allocate [20,30,40,50,60,70,80]
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // a sorted range with a duplicate is not bulk loaded
+   void test_constructRange_sortedDuplicate()
+   {  // setup
+      std::vector<int> v{ 10, 20, 20, 30 };
+      // exercise
+      custom::set <int> s(v.begin(), v.end());
+      // verify
+      assertUnit(s.size() == 3);
+      assertUnit(s.bst.root != nullptr);
+      if (s.bst.root)
+      {
+         assertUnit(s.bst.root->data == 20);
+         assertUnit(s.bst.root->isRed == false);
+      }
+   }  // teardown
+
    /***************************************
     * CONSTRUCTOR INITIALIZE LIST
     ***************************************/
@@ -534,11 +669,11 @@ public:
          assertUnit(s.bst.root->isRed == false);
          assertUnit(s.bst.root->pLeft == nullptr);
          assertUnit(s.bst.root->pRight == nullptr);
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
       }
       // teardown
       if (s.bst.root)
-         delete s.bst.root;
+         s.bst.pool.destroy(s.bst.root);
       s.bst.root = nullptr;
       s.bst.numElements = 0;
    }
@@ -553,9 +688,9 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 7);      // copy-construct [50,30,70,20,40,60,80]
       assertUnit(Spy::numAlloc() == 7);     // allocate [50,30,70,20,40,60,80]
-      assertUnit(Spy::numLessthan() == 10); // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);   // equal   50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);
+      assertUnit(Spy::numLessthan() == 14);   // compare 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
@@ -847,10 +982,11 @@ public:
       setupStandardFixture(sSrc);
       //                (99) = sDest
       custom::set <Spy> sDest;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = sDest.bst.pool.construct(Spy(99));
       p99->isRed = false;
       sDest.bst.root = p99;
       sDest.bst.numElements = 1;
+      sDest.bst.relink();
       Spy::reset();
       // exercise
       sDest = sSrc;
@@ -889,10 +1025,11 @@ public:
    {  // setup
       //                (99) = sSrc
       custom::set <Spy> sSrc;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = sSrc.bst.pool.construct(Spy(99));
       p99->isRed = false;
       sSrc.bst.root = p99;
       sSrc.bst.numElements = 1;
+      sSrc.bst.relink();
       //                (50b) = sDest
       //          +-------+-------+
       //        (30b)           (70b)
@@ -922,7 +1059,7 @@ public:
       {
          assertUnit(sSrc.bst.root->data == Spy(99));
          assertUnit(sSrc.bst.root->isRed == false);
-         assertUnit(sSrc.bst.root->pParent == nullptr);
+         assertUnit(sSrc.bst.root->pParent == sSrc.bst.pHeader());
          assertUnit(sSrc.bst.root->pLeft == nullptr);
          assertUnit(sSrc.bst.root->pRight == nullptr);
       }
@@ -932,7 +1069,7 @@ public:
       {
          assertUnit(sDest.bst.root->data == Spy(99));
          assertUnit(sDest.bst.root->isRed == false);
-         assertUnit(sDest.bst.root->pParent == nullptr);
+         assertUnit(sDest.bst.root->pParent == sDest.bst.pHeader());
          assertUnit(sDest.bst.root->pLeft == nullptr);
          assertUnit(sDest.bst.root->pRight == nullptr);
       }
@@ -1092,10 +1229,11 @@ public:
       setupStandardFixture(sSrc);
       //                (99) = bstDest
       custom::set <Spy> sDest;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = sDest.bst.pool.construct(Spy(99));
       p99->isRed = false;
       sDest.bst.root = p99;
       sDest.bst.numElements = 1;
+      sDest.bst.relink();
       Spy::reset();
       // exercise
       sDest = std::move(sSrc);
@@ -1127,10 +1265,11 @@ public:
    {  // setup
       //                (99) = sSrc
       custom::set <Spy> sSrc;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = sSrc.bst.pool.construct(Spy(99));
       p99->isRed = false;
       sSrc.bst.root = p99;
       sSrc.bst.numElements = 1;
+      sSrc.bst.relink();
       //                (50b) = sDest
       //          +-------+-------+
       //        (30b)           (70b)
@@ -1160,7 +1299,7 @@ public:
       {
          assertUnit(sDest.bst.root->data == Spy(99));
          assertUnit(sDest.bst.root->isRed == false);
-         assertUnit(sDest.bst.root->pParent == nullptr);
+         assertUnit(sDest.bst.root->pParent == sDest.bst.pHeader());
          assertUnit(sDest.bst.root->pLeft == nullptr);
          assertUnit(sDest.bst.root->pRight == nullptr);
       }
@@ -1249,8 +1388,8 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 7);      // copy     [20][30][40][50][60][70][80]
       assertUnit(Spy::numAlloc() == 7);     // allocate [20][30][40][50][60][70][80]
-      assertUnit(Spy::numLessthan() == 10); // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);   // equal   50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
+      assertUnit(Spy::numLessthan() == 14);   // compare 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numNondefault() == 0);
@@ -1303,10 +1442,11 @@ public:
       std::initializer_list<Spy> il{ Spy(50), Spy(30), Spy(70), Spy(20), Spy(40), Spy(60), Spy(80) };
       //                (99) = s
       custom::set <Spy> s;
-      custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
+      custom::BST <Spy>::BNode* p99 = s.bst.pool.construct(Spy(99));
       p99->isRed = false;
       s.bst.root = p99;
       s.bst.numElements = 1;
+      s.bst.relink();
       Spy::reset();
       // exercise
       s = il;
@@ -1315,8 +1455,8 @@ public:
       assertUnit(Spy::numDelete() == 1);      // delete [99]
       assertUnit(Spy::numCopy() == 7);        // copy     [20][30][40][50][60][70][80]
       assertUnit(Spy::numAlloc() == 7);       // allocate [20][30][40][50][60][70][80]
-      assertUnit(Spy::numLessthan() == 10);   // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);     // equal   50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
+      assertUnit(Spy::numLessthan() == 14);   // compare 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
@@ -1358,7 +1498,7 @@ public:
       {
          assertUnit(s.bst.root->data == Spy(99));
          assertUnit(s.bst.root->isRed == false);
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
          assertUnit(s.bst.root->pLeft == nullptr);
          assertUnit(s.bst.root->pRight == nullptr);
       }
@@ -1385,8 +1525,8 @@ public:
       assertUnit(Spy::numDelete() == 7);      // delete   [20][30][40][50][60][70][80]
       assertUnit(Spy::numCopy() == 7);        // copy     [20][30][40][50][60][70][80]
       assertUnit(Spy::numAlloc() == 7);       // allocate [20][30][40][50][60][70][80]
-      assertUnit(Spy::numLessthan() == 10);   // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);     // equal   50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
+      assertUnit(Spy::numLessthan() == 14);   // compare 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numAssign() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
@@ -1615,7 +1755,7 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(it.it.pNode == nullptr);
+      assertUnit(it.it.pNode == s.bst.pHeader());
       assertUnit(it == s.bst.end());
       assertEmptyFixture(s);
    }  // teardown
@@ -1657,6 +1797,55 @@ public:
       teardownStandardFixture(s);
    }
 
+   // last() from the standard fixture
+   void test_last_standard()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      custom::set <Spy> ::iterator it = s.last();
+      // verify
+      assertUnit(Spy::numLessthan() == 0);    // does not look at any element
+      assertUnit(Spy::numEquals() == 0);      // does not look at any element
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit(*it == Spy(80));
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // rbegin() to rend() visits the standard fixture largest first
+   void test_rbegin_standard()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      std::vector <Spy> visited;
+      // exercise
+      for (custom::set <Spy> ::reverse_iterator it = s.rbegin(); it != s.rend(); ++it)
+         visited.push_back(*it);
+      // verify
+      assertUnit(visited == std::vector <Spy>({ 80, 70, 60, 50, 40, 30, 20 }));
+      assertUnit(s.rbegin().base() == s.end());
+      assertUnit(s.rend().base() == s.begin());
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
    // end() from the standard fixture.
    void test_end_standard()
    {  // setup
@@ -1683,7 +1872,7 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(it.it.pNode == nullptr);
+      assertUnit(it.it.pNode == s.bst.pHeader());
       assertStandardFixture(s);
       // teardown
       teardownStandardFixture(s);
@@ -1891,7 +2080,7 @@ public:
       //         30              70
       //     +----+----+     +----+----+
       //    20        40    60        80
-      assertUnit(it.it.pNode == nullptr);
+      assertUnit(it.it.pNode == s.bst.pHeader());
       assertUnit(it == s.end());
       assertStandardFixture(s);
       // teardown
@@ -1909,7 +2098,7 @@ public:
       custom::set <Spy> s;
       setupStandardFixture(s);
       custom::set<Spy>::iterator it;
-      it.it.pNode = nullptr;
+      it = s.end();
       Spy::reset();
       // exercise
       ++it;
@@ -1930,13 +2119,38 @@ public:
       //         30              70
       //     +----+----+     +----+----+
       //    20        40    60        80
-      assertUnit(it.it.pNode == nullptr);
+      assertUnit(it.it.pNode == s.bst.pHeader());
       assertUnit(it == s.end());
       assertStandardFixture(s);
       // teardown
       teardownStandardFixture(s);
    }
 
+   // decrement from end() lands on the largest element
+   void test_iterator_decrement_standardEnd()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      custom::set <Spy> ::iterator it = s.end();
+      Spy::reset();
+      // exercise
+      --it;
+      // verify
+      assertUnit(Spy::numLessthan() == 0);    // does not look at any element
+      assertUnit(Spy::numEquals() == 0);      // does not look at any element
+      assertUnit(it == s.last());
+      if (it != s.end())
+         assertUnit(*it == Spy(80));
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
    // itereator dereference were we just read
    void test_iterator_dereference_standardRead()
    {  // setup
@@ -2017,8 +2231,8 @@ public:
       // exercise
       it = s.find(spy);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][30][20]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][20], then [20] back
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2060,8 +2274,8 @@ public:
       // exercise
       it = s.find(spy);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][70][80]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][80], then [80] back
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2103,8 +2317,8 @@ public:
       // exercise
       it = s.find(spy);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][30][40]
-      assertUnit(Spy::numLessthan() == 3);    // compare [50][30][40]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40], then [40] back
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2120,6 +2334,161 @@ public:
       teardownStandardFixture(s);
    }
 
+   // one comparison per level costs about half of asking "equal?" and "less?"
+   void test_find_comparisonsHalved()
+   {  // setup
+      custom::set <Spy> s;
+      for (int i = 0; i < 1023; i++)
+         s.insert(Spy((i * 37) % 1023));
+      // the old descent asked "equal?" at every level and "less?" above the match
+      int costOld = sumDepths(s.bst.root, 1) * 2 - 1023;
+      Spy::reset();
+      // exercise
+      for (int i = 0; i < 1023; i++)
+         s.find(Spy(i));
+      // verify
+      int costNew = Spy::numLessthan() + Spy::numEquals();
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(costNew * 3 < costOld * 2);
+      assertUnit(costNew * 2 > costOld);
+   }  // teardown
+
+   // the set follows the comparison it was given, not operator<
+   void test_find_compareGreater()
+   {  // setup
+      custom::set <int, std::greater<int>> s;
+      for (int i = 0; i < 10; i++)
+         s.insert(i);
+      // exercise
+      auto itFound = s.find(3);
+      auto itMissing = s.find(10);
+      // verify
+      assertUnit(itFound != s.end());
+      if (itFound != s.end())
+         assertUnit(*itFound == 3);
+      assertUnit(itMissing == s.end());
+      int expected = 9;
+      bool descending = true;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         descending = descending && *it == expected--;
+      assertUnit(descending);
+      assertUnit(expected == -1);
+   }  // teardown
+
+   // bounds work on a set we are only allowed to read
+   void test_lowerBound_const()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+----+
+      //    20        40    60        80
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      const custom::set <Spy> & sConst = s;
+      Spy s35(35);
+      Spy s60(60);
+      Spy::reset();
+      // exercise
+      auto itLower = sConst.lower_bound(s35);
+      auto itUpper = sConst.upper_bound(s60);
+      auto itFound = sConst.find(s60);
+      // verify
+      assertUnit(Spy::numLessthan() == 3 + 3 + 4);
+      assertUnit(itLower.it.pNode == s.bst.root->pLeft->pRight);
+      assertUnit(itUpper.it.pNode == s.bst.root->pRight);
+      assertUnit(itFound.it.pNode == s.bst.root->pRight->pLeft);
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // the range around a key that is there and one that is not
+   void test_equalRange_standard()
+   {  // setup
+      custom::set <int> s{ 50, 30, 70, 20, 40, 60, 80 };
+      // exercise
+      auto range40 = s.equal_range(40);
+      auto range45 = s.equal_range(45);
+      // verify
+      assertUnit(range40.first != s.end() && *range40.first == 40);
+      assertUnit(range40.second != s.end() && *range40.second == 50);
+      assertUnit(range45.first == range45.second);
+      assertUnit(*range45.first == 50);
+      assertUnit(s.equal_range(90).first == s.end());
+   }  // teardown
+
+   // a transparent comparator looks up ints without building a Spy
+   void test_find_transparentNoTemporary()
+   {  // setup
+      custom::set <Spy, SpyLess> s;
+      for (int i : { 50, 30, 70, 20, 40, 60, 80 })
+         s.emplace(i);
+      Spy::reset();
+      // exercise
+      auto itFind = s.find(40);
+      auto itLower = s.lower_bound(45);
+      auto itUpper = s.upper_bound(60);
+      auto range = s.equal_range(70);
+      bool contains = s.contains(20);
+      bool missing = s.contains(25);
+      size_t num = s.count(80);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);  // not one temporary Spy
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 0);    // SpyLess never calls Spy::operator<
+      assertUnit(itFind != s.end() && (*itFind).get() == 40);
+      assertUnit(itLower != s.end() && (*itLower).get() == 50);
+      assertUnit(itUpper != s.end() && (*itUpper).get() == 70);
+      assertUnit(range.first != range.second && (*range.first).get() == 70);
+      assertUnit(contains == true);
+      assertUnit(missing == false);
+      assertUnit(num == 1);
+   }  // teardown
+
+   // erase by a key that is not a T
+   void test_erase_transparent()
+   {  // setup
+      custom::set <Spy, SpyLess> s;
+      for (int i : { 50, 30, 70, 20, 40, 60, 80 })
+         s.emplace(i);
+      Spy::reset();
+      // exercise
+      size_t numErased = s.erase(40);
+      size_t numMissing = s.erase(45);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numDestructor() == 1);  // [40] itself
+      assertUnit(numErased == 1);
+      assertUnit(numMissing == 0);
+      assertUnit(s.size() == 6);
+      assertUnit(s.find(40) == s.end());
+   }  // teardown
+
+   // strings looked up by string_view and by C string
+   void test_find_stringView()
+   {  // setup
+      custom::set <std::string, std::less <>> s{ "cherry", "apple", "banana" };
+      // exercise and verify
+      assertUnit(s.find(std::string_view("banana")) != s.end());
+      assertUnit(s.contains("apple"));
+      assertUnit(!s.contains("durian"));
+      assertUnit(*s.lower_bound("b") == "banana");
+      assertUnit(s.erase("cherry") == 1);
+      assertUnit(s.size() == 2);
+   }  // teardown
+
+   // a set holds each key at most once
+   void test_count_standard()
+   {  // setup
+      const custom::set <int> s{ 50, 30, 70, 20, 40, 60, 80 };
+      // exercise and verify
+      assertUnit(s.count(20) == 1);
+      assertUnit(s.count(80) == 1);
+      assertUnit(s.count(55) == 0);
+   }  // teardown
+
 
    /***************************************
     * INSERT
@@ -2160,10 +2529,10 @@ public:
          assertUnit(s.bst.root->isRed == false);
          assertUnit(s.bst.root->pLeft == nullptr);
          assertUnit(s.bst.root->pRight == nullptr);
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
       }
       // teardown
-      delete s.bst.root;
+      s.bst.pool.destroy(s.bst.root);
       s.bst.root = nullptr;
       s.bst.numElements = 0;
    }
@@ -2178,7 +2547,7 @@ public:
       //    20        40    60
       custom::set <Spy> s;
       setupStandardFixture(s);
-      delete s.bst.root->pRight->pRight;
+      s.bst.pool.destroy(s.bst.root->pRight->pRight);
       s.bst.root->pRight->pRight = nullptr;
       s.bst.numElements = 6;
       Spy spy(80);
@@ -2188,8 +2557,8 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 1);        // copy-create [80]
       assertUnit(Spy::numAlloc() == 1);       // allocate [80]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 2);      // compare [50][70]
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][70], then [70] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2221,7 +2590,7 @@ public:
       //              40    60        80
       custom::set <Spy> s;
       setupStandardFixture(s);
-      delete s.bst.root->pLeft->pLeft;
+      s.bst.pool.destroy(s.bst.root->pLeft->pLeft);
       s.bst.root->pLeft->pLeft = nullptr;
       s.bst.numElements = 6;
       Spy spy(20);
@@ -2232,7 +2601,7 @@ public:
       assertUnit(Spy::numCopy() == 1);        // copy-create [20]
       assertUnit(Spy::numAlloc() == 1);       // allocate [20]
       assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
-      assertUnit(Spy::numEquals() == 2);      // compare [50][30]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2264,7 +2633,7 @@ public:
       //    20        40              80
       custom::set <Spy> s;
       setupStandardFixture(s);
-      delete s.bst.root->pRight->pLeft;
+      s.bst.pool.destroy(s.bst.root->pRight->pLeft);
       s.bst.root->pRight->pLeft = nullptr;
       s.bst.numElements = 6;
       Spy spy(60);
@@ -2274,8 +2643,8 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 1);        // copy-create [60]
       assertUnit(Spy::numAlloc() == 1);       // allocate [60]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 2);      // compare [50][70]
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][70], then [50] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2312,8 +2681,8 @@ public:
       // exercise
       auto pairSet = s.insert(spy);
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 3);      // compare [50][70][60]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][60], then [60] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2377,10 +2746,10 @@ public:
          assertUnit(s.bst.root->isRed == false);
          assertUnit(s.bst.root->pLeft == nullptr);
          assertUnit(s.bst.root->pRight == nullptr);
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
       }
       // teardown
-      delete s.bst.root;
+      s.bst.pool.destroy(s.bst.root);
       s.bst.root = nullptr;
       s.bst.numElements = 0;
    }
@@ -2395,7 +2764,7 @@ public:
       //    20        40    60
       custom::set <Spy> s;
       setupStandardFixture(s);
-      delete s.bst.root->pRight->pRight;
+      s.bst.pool.destroy(s.bst.root->pRight->pRight);
       s.bst.root->pRight->pRight = nullptr;
       s.bst.numElements = 6;
       Spy spy(80);
@@ -2404,8 +2773,8 @@ public:
       auto pairSet = s.insert(std::move(spy));
       // verify
       assertUnit(Spy::numCopyMove() == 1);    // copy-move [80]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 2);      // compare [50][70]
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][70], then [70] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2439,7 +2808,7 @@ public:
       //              40    60        80
       custom::set <Spy> s;
       setupStandardFixture(s);
-      delete s.bst.root->pLeft->pLeft;
+      s.bst.pool.destroy(s.bst.root->pLeft->pLeft);
       s.bst.root->pLeft->pLeft = nullptr;
       s.bst.numElements = 6;
       Spy spy(20);
@@ -2449,7 +2818,7 @@ public:
       // verify
       assertUnit(Spy::numCopyMove() == 1);    // copy-move [20]
       assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
-      assertUnit(Spy::numEquals() == 2);      // compare [50][30]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2483,7 +2852,7 @@ public:
       //    20        40              80
       custom::set <Spy> s;
       setupStandardFixture(s);
-      delete s.bst.root->pRight->pLeft;
+      s.bst.pool.destroy(s.bst.root->pRight->pLeft);
       s.bst.root->pRight->pLeft = nullptr;
       s.bst.numElements = 6;
       Spy spy(60);
@@ -2492,8 +2861,8 @@ public:
       auto pairSet = s.insert(std::move(spy));
       // verify
       assertUnit(Spy::numCopyMove() == 1);  // copy-move [60]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 2);      // compare [50][70]
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][70], then [50] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2532,8 +2901,8 @@ public:
       // exercise
       auto pairSet = s.insert(std::move(spy));
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 3);      // compare [50][70][60]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][60], then [60] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2595,8 +2964,8 @@ public:
       // verify
       assertUnit(Spy::numCopy() == 7);      // copy     [20][30][40][50][60][70][80]
       assertUnit(Spy::numAlloc() == 7);     // allocate [20][30][40][50][60][70][80]
-      assertUnit(Spy::numLessthan() == 10); // compare 50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 10);   // equal   50: 30:[50] 70:[50] 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
+      assertUnit(Spy::numLessthan() == 14);   // compare 50: 30:[50] 70:[50][50] 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numNondefault() == 0);
@@ -2659,8 +3028,8 @@ public:
       // exercise
       s.insert(il);
       // verify
-      assertUnit(Spy::numLessthan() == 2);   // compare 50: 40:[50][30]
-      assertUnit(Spy::numEquals() == 4);     // equal   50:[50] 40:[50][30][40]
+      assertUnit(Spy::numLessthan() == 8);    // compare 50:[50][70][80][50] 40:[50][30][40][40]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numCopy() == 0);
@@ -2681,22 +3050,23 @@ public:
       //          +-------+-------+
       //        (30b)           (70b)
       custom::set <Spy> s;
-      custom::BST <Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST <Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST <Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
+      custom::BST <Spy>::BNode* p50 = s.bst.pool.construct(Spy(50));
+      custom::BST <Spy>::BNode* p30 = s.bst.pool.construct(Spy(30));
+      custom::BST <Spy>::BNode* p70 = s.bst.pool.construct(Spy(70));
       p50->isRed = false;
       p30->isRed = p70->isRed = true;
       s.bst.root = p30->pParent = p70->pParent = p50;
       p50->pRight = p70;
       p50->pLeft  = p30;
       s.bst.numElements = 3;
+      s.bst.relink();
       std::initializer_list<Spy> il{ Spy(20), Spy(40), Spy(60), Spy(80) };
       Spy::reset();
       // exercise
       s.insert(il);
       // verify
-      assertUnit(Spy::numLessthan() == 8);   // compare 20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
-      assertUnit(Spy::numEquals() == 8);     // equal   20:[50][30] 40:[50][30] 60:[50][70] 80:[50][70]
+      assertUnit(Spy::numLessthan() == 11);   // compare 20:[50][30] 40:[50][30][30] 60:[50][70][50] 80:[50][70][70]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 4);       // create   [20][40][60][80]
       assertUnit(Spy::numAlloc() == 4);      // allocate [20][40][60][80]
       assertUnit(Spy::numDestructor() == 0);
@@ -2716,6 +3086,653 @@ public:
       teardownStandardFixture(s);
    }
 
+   /***************************************
+    * INSERT with a HINT
+    *    set::insert(hint, t)
+    ***************************************/
+
+   // append past the end with end() as the hint
+   void test_insertHint_standardEnd()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      Spy s90(90);
+      Spy::reset();
+      // exercise
+      auto it = s.insert(s.end(), s90);
+      // verify
+      assertUnit(Spy::numCopy() == 1);        // copy [90] into its node
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numLessthan() == 1);    // compare [80] only
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit(*it == Spy(90));
+      assertUnit(s.bst.rightmost() == it.it.pNode);
+      assertUnit(s.size() == 8);
+   }  // teardown
+
+   // a hint that is nowhere near still finds the right spot
+   void test_insertHint_standardWrong()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      Spy s40(40);
+      Spy s65(65);
+      // exercise
+      auto itDuplicate = s.insert(s.begin(), s40);
+      auto itNew = s.insert(s.begin(), s65);
+      // verify
+      assertUnit(itDuplicate.it.pNode == s.bst.root->pLeft->pRight);
+      assertUnit(itNew.it.pNode == s.bst.root->pRight->pLeft->pRight);
+      assertUnit(s.size() == 8);
+   }  // teardown
+
+   /***************************************
+    * NODE HANDLE
+    *    set::extract(t)
+    *    set::insert(nh)
+    *    set::merge(source)
+    ***************************************/
+
+   // move an element from one set to another without copying it
+   void test_insertNode_fromOther()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> sSrc;
+      custom::set <Spy> sDest;
+      setupStandardFixture(sSrc);
+      auto p80 = sSrc.bst.root->pRight->pRight;
+      Spy s80(80);
+      Spy::reset();
+      // exercise
+      auto result = sDest.insert(sSrc.extract(s80));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(result.inserted == true);
+      assertUnit(result.node.empty());
+      assertUnit(result.position.it.pNode == p80);
+      assertUnit(sSrc.size() == 6);
+      assertUnit(sDest.size() == 1);
+      assertUnit(sDest.bst.root == p80);
+   }  // teardown
+
+   // a duplicate comes back in the result
+   void test_insertNode_duplicate()
+   {  // setup
+      custom::set <Spy> sSrc;
+      custom::set <Spy> sDest;
+      setupStandardFixture(sSrc);
+      setupStandardFixture(sDest);
+      auto p80 = sSrc.bst.root->pRight->pRight;
+      // exercise
+      auto result = sDest.insert(sSrc.extract(sSrc.find(Spy(80))));
+      // verify
+      assertUnit(result.inserted == false);
+      assertUnit(result.position.it.pNode == sDest.bst.root->pRight->pRight);
+      assertUnit(result.node.pNode == p80);
+      assertUnit(result.node.value() == Spy(80));
+      assertUnit(sSrc.size() == 6);
+      assertStandardFixture(sDest);
+      // teardown
+      teardownStandardFixture(sDest);
+   }
+
+   // merge takes only the elements we do not already have
+   void test_merge_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> sSrc{ Spy(10), Spy(40), Spy(55), Spy(80), Spy(90) };
+      custom::set <Spy> sDest;
+      setupStandardFixture(sDest);
+      Spy::reset();
+      // exercise
+      sDest.merge(sSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(sDest.size() == 10);
+      assertUnit(sSrc.size() == 2);
+      assertUnit(sSrc.find(Spy(40)) != sSrc.end());
+      assertUnit(sSrc.find(Spy(80)) != sSrc.end());
+      assertUnit(sDest.find(Spy(10)) != sDest.end());
+      assertUnit(sDest.find(Spy(55)) != sDest.end());
+      assertUnit(sDest.find(Spy(90)) != sDest.end());
+   }  // teardown
+
+   /***************************************
+    * ORDER STATISTICS
+    *    set::rank(t)
+    *    set::select(k)
+    *    set::count_range(lo, hi)
+    *    set::advance(it, n)
+    ***************************************/
+
+   // rank and select undo each other
+   void test_rankSelect_standard()
+   {  // setup
+      custom::set <int, std::less <int>, true> s{ 50, 30, 70, 20, 40, 60, 80 };
+      // exercise and verify
+      assertUnit(s.rank(60) == 4);
+      assertUnit(*s.select(4) == 60);
+      assertUnit(s.rank(55) == 4);
+      assertUnit(s.select(7) == s.end());
+      assertUnit(*s.advance(s.begin(), 6) == 80);
+      assertUnit(*s.advance(s.end(), -2) == 70);
+   }  // teardown
+
+   // count what lies in [lo, hi)
+   void test_countRange_standard()
+   {  // setup
+      custom::set <int, std::less <int>, true> s{ 50, 30, 70, 20, 40, 60, 80 };
+      // exercise and verify
+      assertUnit(s.count_range(25, 65) == 4);  // 30 40 50 60
+      assertUnit(s.count_range(20, 80) == 6);
+      assertUnit(s.count_range(80, 20) == 0);
+      s.erase(50);
+      assertUnit(s.count_range(25, 65) == 3);
+   }  // teardown
+
+   /***************************************
+    * SET ALGEBRA
+    *    set_union(lhs, rhs)
+    *    set_intersection(lhs, rhs)
+    *    set_difference(lhs, rhs)
+    ***************************************/
+
+   // the union copies only what it keeps and leaves both inputs alone
+   void test_setUnion_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> sLHS;
+      setupStandardFixture(sLHS);
+      custom::set <Spy> sRHS{ Spy(10), Spy(40), Spy(55), Spy(80), Spy(90) };
+      Spy::reset();
+      // exercise
+      custom::set <Spy> s = custom::set_union(sLHS, sRHS);
+      // verify
+      assertUnit(Spy::numCopy() == 10);        // copy each element of the result
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(s.size() == 10);
+      assertUnit(sLHS.size() == 7);
+      assertUnit(sRHS.size() == 5);
+      assertUnit(*s.begin() == Spy(10));
+      assertUnit(*s.rbegin() == Spy(90));
+      assertUnit(s.find(Spy(55)) != s.end());
+      assertUnit(s.find(Spy(60)) != s.end());
+      assertUnit(s.bst.root->verifyRedBlack(s.bst.root->findDepth()));
+      // teardown
+      teardownStandardFixture(sLHS);
+   }
+
+   // only what both sets hold
+   void test_setIntersection_standard()
+   {  // setup
+      custom::set <int> sLHS{ 50, 30, 70, 20, 40, 60, 80 };
+      custom::set <int> sRHS{ 10, 40, 55, 80, 90 };
+      // exercise
+      custom::set <int> s = custom::set_intersection(sLHS, sRHS);
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(*s.begin() == 40);
+      assertUnit(*s.rbegin() == 80);
+      assertUnit(sLHS.size() == 7);
+      assertUnit(sRHS.size() == 5);
+   }  // teardown
+
+   // big enough to walk rather than look up
+   void test_setDifference_large()
+   {  // setup
+      custom::set <int> sLHS;
+      custom::set <int> sRHS;
+      for (int i = 0; i < 10000; i++)
+      {
+         sLHS.insert(i);
+         sRHS.insert(i * 2);
+      }
+      // exercise
+      custom::set <int> s = custom::set_difference(sLHS, sRHS);
+      // verify
+      assertUnit(s.size() == 5000);
+      assertUnit(*s.begin() == 1);
+      assertUnit(*s.rbegin() == 9999);
+      assertUnit(s.count(5000) == 0);
+      assertUnit(s.count(5001) == 1);
+      assertUnit(s.bst.pool.live() == 5000);
+      assertUnit(s.bst.root->verifyRedBlack(s.bst.root->findDepth()));
+   }  // teardown
+
+   // sets passed as rvalues are relinked, never copied
+   void test_setUnion_moved()
+   {  // setup
+      custom::set <Spy> sLHS;
+      setupStandardFixture(sLHS);
+      custom::set <Spy> sRHS{ Spy(10), Spy(40), Spy(55), Spy(80), Spy(90) };
+      Spy::reset();
+      // exercise
+      custom::set <Spy> s = custom::set_union(std::move(sLHS), std::move(sRHS));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 2);   // the extra [40] and [80]
+      assertUnit(s.size() == 10);
+      assertUnit(sRHS.empty());
+      assertUnit(*s.begin() == Spy(10));
+      assertUnit(*s.rbegin() == Spy(90));
+      assertUnit(s.bst.root->verifyRedBlack(s.bst.root->findDepth()));
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // a few elements against many: the recursion only visits the
+   // parts of the big set near them
+   void test_setIntersection_lopsided()
+   {  // setup
+      custom::set <Spy> sLHS;
+      custom::set <Spy> sRHS{ Spy(-1), Spy(500), Spy(999) };
+      for (int i = 0; i < 1000; i++)
+         sLHS.insert(Spy(i));
+      Spy::reset();
+      // exercise
+      custom::set <Spy> s = custom::set_intersection(sLHS, sRHS);
+      // verify
+      assertUnit(Spy::numCopy() == 2);         // [500] and [999]
+      assertUnit(Spy::numLessthan() < 100);
+      assertUnit(s.size() == 2);
+      assertUnit(*s.begin() == Spy(500));
+      assertUnit(*s.rbegin() == Spy(999));
+      assertUnit(sLHS.size() == 1000);
+      assertUnit(sRHS.size() == 3);
+   }  // teardown
+
+   // a few elements less many: each small one is looked up once
+   void test_setDifference_lopsided()
+   {  // setup
+      custom::set <int> sLHS{ -1, 500, 1000 };
+      custom::set <int> sRHS;
+      for (int i = 0; i < 1000; i++)
+         sRHS.insert(i);
+      // exercise
+      custom::set <int> s = custom::set_difference(sLHS, sRHS);
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(*s.begin() == -1);
+      assertUnit(*s.rbegin() == 1000);
+      assertUnit(s.bst.pool.live() == 2);
+   }  // teardown
+
+   /***************************************
+    * SPLIT and JOIN
+    *    set::split(t)
+    *    set::join(rhs)
+    ***************************************/
+
+   // split moves nodes, never copies them
+   void test_split_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      custom::set <Spy> sRight = s.split(Spy(45));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 1);        // the key [45]
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(sRight.size() == 4);
+      assertUnit(*s.rbegin() == Spy(40));
+      assertUnit(*sRight.begin() == Spy(50));
+      assertUnit(sRight.bst.root->verifyRedBlack(sRight.bst.root->findDepth()));
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // join puts a split set back together
+   void test_join_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      custom::set <int> sRight = s.split(60);
+      // exercise
+      sRight.join(s);
+      // verify
+      assertUnit(s.empty());
+      assertUnit(sRight.size() == 100);
+      assertUnit(*sRight.begin() == 0);
+      assertUnit(*sRight.rbegin() == 99);
+      assertUnit(sRight.find(60) != sRight.end());
+   }  // teardown
+
+   // a set touching ours at one key is merged, not joined
+   void test_join_overlapping()
+   {  // setup
+      custom::set <int> s{ 1, 2, 3 };
+      custom::set <int> sRHS{ 3, 4, 5 };
+      // exercise
+      s.join(sRHS);
+      // verify
+      assertUnit(s.size() == 5);
+      assertUnit(sRHS.size() == 1);             // [3] was already there
+      assertUnit(*sRHS.begin() == 3);
+   }  // teardown
+
+   /***************************************
+    * SNAPSHOT
+    *    set::snapshot()
+    ***************************************/
+
+   // a snapshot of nothing is empty
+   void test_snapshot_empty()
+   {  // setup
+      custom::set <int> s;
+      // exercise
+      custom::set <int> ::snapshot_type view = s.snapshot();
+      // verify
+      assertUnit(view.empty());
+      assertUnit(view.begin() == view.end());
+   }  // teardown
+
+   // changes after a snapshot are in the next one, not in it
+   void test_snapshot_isolated()
+   {  // setup
+      custom::set <int> s{ 10, 20, 30, 40 };
+      // exercise
+      auto viewBefore = s.snapshot();
+      s.insert(25);
+      s.erase(10);
+      s.emplace(50);
+      auto viewAfter = s.snapshot();
+      // verify
+      assertUnit(std::vector<int>(viewBefore.begin(), viewBefore.end()) ==
+                 std::vector<int>({ 10, 20, 30, 40 }));
+      assertUnit(std::vector<int>(viewAfter.begin(), viewAfter.end()) ==
+                 std::vector<int>({ 20, 25, 30, 40, 50 }));
+      assertUnit(viewAfter.size() == s.size());
+   }  // teardown
+
+   // a second snapshot with nothing changed copies nothing
+   void test_snapshot_again()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      auto viewFirst = s.snapshot();
+      Spy::reset();
+      // exercise
+      auto viewSecond = s.snapshot();
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(viewSecond.size() == 7);
+      assertUnit(*viewSecond.begin() == Spy(20));
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // a change after a snapshot copies a path, not the set
+   void test_snapshot_pathCopy()
+   {  // setup
+      custom::set <Spy> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(Spy(i * 2));
+      auto view = s.snapshot();
+      Spy::reset();
+      // exercise
+      s.insert(Spy(1001));
+      s.erase(Spy(500));
+      // verify
+      assertUnit(Spy::numCopy() > 1);
+      assertUnit(Spy::numCopy() < 100);          // a few paths of about 10, not 1000
+      assertUnit(view.size() == 1000);
+      assertUnit(view.contains(Spy(500)));
+      assertUnit(!view.contains(Spy(1001)));
+      auto viewNow = s.snapshot();
+      assertUnit(viewNow.contains(Spy(1001)));
+      assertUnit(!viewNow.contains(Spy(500)));
+   }  // teardown
+
+   // after clear, merge, split, erasing a range, and assignment
+   // the next snapshot still matches the set
+   void test_snapshot_bulk()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      custom::set <int> sOther{ 200, 201 };
+      s.snapshot();
+      sOther.snapshot();
+      bool allMatch = true;
+      auto matches = [](custom::set <int> & s)
+      {
+         auto view = s.snapshot();
+         std::vector <int> v;
+         for (auto it = s.begin(); it != s.end(); ++it)
+            v.push_back(*it);
+         return v == std::vector<int>(view.begin(), view.end());
+      };
+      // exercise
+      s.merge(sOther);
+      allMatch = allMatch && matches(s) && matches(sOther);
+      custom::set <int> sRight = s.split(50);
+      allMatch = allMatch && matches(s) && matches(sRight);
+      auto itBegin = s.find(10);
+      auto itEnd = s.find(20);
+      s.erase(itBegin, itEnd);
+      allMatch = allMatch && matches(s);
+      s.extract(30);
+      allMatch = allMatch && matches(s);
+      sRight = s;
+      allMatch = allMatch && matches(sRight);
+      s.clear();
+      s.insert(7);
+      allMatch = allMatch && matches(s);
+      // verify
+      assertUnit(allMatch);
+      assertUnit(sRight.size() == 39);
+   }  // teardown
+
+   // a reader walks its snapshot while the writer keeps changing the set
+   void test_snapshot_threaded()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 2000; i++)
+         s.insert(i);
+      auto view = s.snapshot();
+      long long sum = -1;
+      // exercise
+      std::thread reader([&]()
+      {
+         long long total = 0;
+         for (int pass = 0; pass < 20; pass++)
+         {
+            total = 0;
+            for (auto it = view.begin(); it != view.end(); ++it)
+               total += *it;
+         }
+         sum = total;
+         view.clear();      // let go here, while the set may still be changing
+      });
+      for (int i = 0; i < 2000; i += 2)
+      {
+         s.erase(i);
+         s.insert(i + 5000);
+         s.snapshot();
+      }
+      reader.join();
+      // verify
+      assertUnit(sum == 1999LL * 2000 / 2);
+      assertUnit(s.size() == 2000);
+      assertUnit(s.snapshot().size() == 2000);
+   }  // teardown
+
+   // once the last snapshot is let go, changes stop copying paths
+   void test_snapshot_dropped()
+   {  // setup
+      custom::set <Spy> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(Spy(i * 2));
+      {
+         auto view = s.snapshot();
+         s.insert(Spy(1));
+      }
+      Spy::reset();
+      // exercise
+      s.insert(Spy(3));
+      s.erase(Spy(500));
+      s.insert(Spy(5));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(s.bst.pSharing == nullptr);     // nothing is shared any more
+      assertUnit(s.bst.pVersion == nullptr);
+      auto viewNow = s.snapshot();
+      assertUnit(viewNow.size() == s.size());
+      assertUnit(viewNow.contains(Spy(5)));
+      assertUnit(!viewNow.contains(Spy(500)));
+   }  // teardown
+
+   // a copy of a set shares none of its snapshots
+   void test_snapshot_copy()
+   {  // setup
+      custom::set <int> s{ 10, 20, 30 };
+      auto view = s.snapshot();
+      // exercise
+      custom::set <int> sCopy(s);
+      sCopy.insert(40);
+      // verify
+      assertUnit(sCopy.bst.pSharing == nullptr);
+      assertUnit(s.bst.pSharing != nullptr);
+      assertUnit(view.use_count() == 2);     // view and s, not the copy
+      assertUnit(sCopy.snapshot().size() == 4);
+      assertUnit(s.snapshot().size() == 3);
+   }  // teardown
+
+   /***************************************
+    * EMPLACE
+    *    set::emplace(args...)
+    *    set::emplace_hint(hint, args...)
+    ***************************************/
+
+   // emplace into an empty set builds the element in place
+   void test_emplace_empty()
+   {  // setup
+      custom::set <Spy> s;
+      Spy::reset();
+      // exercise
+      auto pairReturn = s.emplace(99);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [99] in place
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pairReturn.second == true);
+      assertUnit(pairReturn.first != s.end());
+      if (pairReturn.first != s.end())
+         assertUnit(*pairReturn.first == Spy(99));
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // emplace a key that is already there
+   void test_emplace_standardDuplicate()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      Spy s40(40);
+      Spy::reset();
+      // exercise
+      auto pairReturn = s.emplace(s40);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);  // found before anything was built
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(pairReturn.second == false);
+      assertUnit(pairReturn.first.it.pNode == s.bst.root->pLeft->pRight);
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // emplace past the end with end() as the hint
+   void test_emplaceHint_standardEnd()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::set <Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      auto it = s.emplace_hint(s.end(), 90);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [90] in place
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numLessthan() == 1);    // compare [80] only
+      //                (50b)
+      //          +-------+-------+
+      //        (30r)           (70r)
+      //     +----+----+     +----+----+
+      //   (20b)     (40b) (60b)     (80b)
+      //                                 +----+
+      //                                    (90r)
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit(*it == Spy(90));
+      assertUnit(s.bst.root->pRight->pRight->pRight == it.it.pNode);
+      assertUnit(s.bst.rightmost() == it.it.pNode);
+      assertUnit(s.size() == 8);
+   }  // teardown
+
    /***************************************
     * Erase Range
     *    set::erase(itBegin, itBEnd)
@@ -2780,6 +3797,29 @@ public:
       // teardown
    }
 
+   // a long range is destroyed without a single copy or search
+   void test_eraseRange_large()
+   {  // setup
+      custom::set <Spy> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(Spy(i));
+      custom::set <Spy>::iterator itBegin = s.begin();
+      custom::set <Spy>::iterator itEnd = s.find(Spy(200));
+      Spy::reset();
+      // exercise
+      custom::set <Spy>::iterator itDone = s.erase(itBegin, itEnd);
+      // verify
+      assertUnit(Spy::numDestructor() == 200);
+      assertUnit(Spy::numDelete() == 200);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(itDone == itEnd);
+      assertUnit(itBegin == itEnd);
+      assertUnit(s.size() == 800);
+      assertUnit(s.begin() == itEnd);
+      assertUnit(s.bst.root->verifyRedBlack(s.bst.root->findDepth()));
+   }  // teardown
+
    /***************************************
     * Erase Iterator
     *    set::erase(it)
@@ -2878,7 +3918,7 @@ public:
       assertUnit(itReturn == it);
       assertUnit(s.bst.root->pRight->pLeft == nullptr);
       assertUnit(s.bst.numElements == 6);
-      s.bst.root->pRight->pLeft = new custom::BST<Spy>::BNode(Spy(60));
+      s.bst.root->pRight->pLeft = s.bst.pool.construct(Spy(60));
       s.bst.root->pRight->pLeft->pParent = s.bst.root->pRight;
       s.bst.numElements = 7;
       assertStandardFixture(s);
@@ -2896,12 +3936,12 @@ public:
       //            +--+--+
       //           20    40
       custom::set <int> s;
-      auto p10 = new custom::BST<int>::BNode(10);
-      auto p20 = new custom::BST<int>::BNode(20);
-      auto p30 = new custom::BST<int>::BNode(30);
-      auto p40 = new custom::BST<int>::BNode(40);
-      auto p60 = new custom::BST<int>::BNode(60);
-      auto p50 = new custom::BST<int>::BNode(50);
+      auto p10 = s.bst.pool.construct(10);
+      auto p20 = s.bst.pool.construct(20);
+      auto p30 = s.bst.pool.construct(30);
+      auto p40 = s.bst.pool.construct(40);
+      auto p60 = s.bst.pool.construct(60);
+      auto p50 = s.bst.pool.construct(50);
       s.bst.root = p10->pParent = p60->pParent = p50;
       p50->pLeft = p30->pParent = p10;
       p50->pRight = p60;
@@ -2909,6 +3949,7 @@ public:
       p30->pLeft = p20;
       p30->pRight = p40;
       s.bst.numElements = 6;
+      s.bst.relink();
       auto itBST = custom::BST <int> ::iterator(p10);
       auto it = custom::set <int> ::iterator(itBST);
       // exercise
@@ -2938,11 +3979,11 @@ public:
       assertUnit(p50->data == 50);
       assertUnit(p60->data == 60);
       // teardown
-      delete p20;
-      delete p30;
-      delete p40;
-      delete p50;
-      delete p60;
+      s.bst.pool.destroy(p20);
+      s.bst.pool.destroy(p30);
+      s.bst.pool.destroy(p40);
+      s.bst.pool.destroy(p50);
+      s.bst.pool.destroy(p60);
       s.bst.numElements = 0;
       s.bst.root = nullptr;
    }
@@ -2959,14 +4000,14 @@ public:
       //            +-+
       //              40
       custom::set <int> s;
-      auto p10 = new custom::BST<int>::BNode(10);
-      auto p20 = new custom::BST<int>::BNode(20);
-      auto p30 = new custom::BST<int>::BNode(30);
-      auto p40 = new custom::BST<int>::BNode(40);
-      auto p50 = new custom::BST<int>::BNode(50);
-      auto p60 = new custom::BST<int>::BNode(60);
-      auto p70 = new custom::BST<int>::BNode(70);
-      auto p80 = new custom::BST<int>::BNode(80);
+      auto p10 = s.bst.pool.construct(10);
+      auto p20 = s.bst.pool.construct(20);
+      auto p30 = s.bst.pool.construct(30);
+      auto p40 = s.bst.pool.construct(40);
+      auto p50 = s.bst.pool.construct(50);
+      auto p60 = s.bst.pool.construct(60);
+      auto p70 = s.bst.pool.construct(70);
+      auto p80 = s.bst.pool.construct(80);
       s.bst.root = p20->pParent = p80->pParent = p70;
       p10->pParent = p50->pParent = p70->pLeft = p20;
       p70->pRight = p80;
@@ -2976,6 +4017,7 @@ public:
       p50->pRight = p60;
       p30->pRight = p40;
       s.bst.numElements = 8;
+      s.bst.relink();
       auto itBST = custom::BST <int> ::iterator(p20);
       auto it = custom::set <int> ::iterator(itBST);
       // exercise
@@ -3013,13 +4055,13 @@ public:
       assertUnit(p70->data == 70);
       assertUnit(p80->data == 80);
       // teardown
-      delete p10;
-      delete p30;
-      delete p40;
-      delete p50;
-      delete p60;
-      delete p70;
-      delete p80;
+      s.bst.pool.destroy(p10);
+      s.bst.pool.destroy(p30);
+      s.bst.pool.destroy(p40);
+      s.bst.pool.destroy(p50);
+      s.bst.pool.destroy(p60);
+      s.bst.pool.destroy(p70);
+      s.bst.pool.destroy(p80);
       s.bst.numElements = 0;
       s.bst.root = nullptr;
    }
@@ -3069,8 +4111,8 @@ public:
       // exercise
       size_t num = s.erase(spy);
       // verify
-      assertUnit(Spy::numLessthan() == 3);  // compare [50][70][60]
-      assertUnit(Spy::numEquals() == 3);    // check [50][70][60]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][60], then [60] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -3101,8 +4143,8 @@ public:
       // exercise
       size_t num = s.erase(spy);
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
-      assertUnit(Spy::numEquals() == 3);      // check [50][70][60]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][60], then [60] back
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numDestructor() == 1);  // destroy [60]
       assertUnit(Spy::numDelete() == 1);      // delete [60]
       assertUnit(Spy::numCopy() == 0);
@@ -3119,7 +4161,7 @@ public:
       assertUnit(num == 1);
       assertUnit(s.bst.root->pRight->pLeft == nullptr);
       assertUnit(s.bst.numElements == 6);
-      s.bst.root->pRight->pLeft = new custom::BST<Spy>::BNode(Spy(60));
+      s.bst.root->pRight->pLeft = s.bst.pool.construct(Spy(60));
       s.bst.root->pRight->pLeft->pParent = s.bst.root->pRight;
       s.bst.numElements = 7;
       assertStandardFixture(s);
@@ -3137,12 +4179,12 @@ public:
       //            +--+--+
       //           20    40
       custom::set <int> s;
-      auto p10 = new custom::BST<int>::BNode(10);
-      auto p20 = new custom::BST<int>::BNode(20);
-      auto p30 = new custom::BST<int>::BNode(30);
-      auto p40 = new custom::BST<int>::BNode(40);
-      auto p50 = new custom::BST<int>::BNode(50);
-      auto p60 = new custom::BST<int>::BNode(60);
+      auto p10 = s.bst.pool.construct(10);
+      auto p20 = s.bst.pool.construct(20);
+      auto p30 = s.bst.pool.construct(30);
+      auto p40 = s.bst.pool.construct(40);
+      auto p50 = s.bst.pool.construct(50);
+      auto p60 = s.bst.pool.construct(60);
       s.bst.root = p10->pParent = p60->pParent = p50;
       p50->pLeft = p30->pParent = p10;
       p50->pRight = p60;
@@ -3150,6 +4192,7 @@ public:
       p30->pLeft = p20;
       p30->pRight = p40;
       s.bst.numElements = 6;
+      s.bst.relink();
       // exercise
       size_t num = s.erase(10);
       // verify
@@ -3175,11 +4218,11 @@ public:
       assertUnit(p50->data == 50);
       assertUnit(p60->data == 60);
       // teardown
-      delete p20;
-      delete p30;
-      delete p40;
-      delete p50;
-      delete p60;
+      s.bst.pool.destroy(p20);
+      s.bst.pool.destroy(p30);
+      s.bst.pool.destroy(p40);
+      s.bst.pool.destroy(p50);
+      s.bst.pool.destroy(p60);
       s.bst.numElements = 0;
       s.bst.root = nullptr;
    }
@@ -3196,14 +4239,14 @@ public:
       //            +-+
       //              40
       custom::set <int> s;
-      auto p10 = new custom::BST<int>::BNode(10);
-      auto p20 = new custom::BST<int>::BNode(20);
-      auto p30 = new custom::BST<int>::BNode(30);
-      auto p40 = new custom::BST<int>::BNode(40);
-      auto p50 = new custom::BST<int>::BNode(50);
-      auto p60 = new custom::BST<int>::BNode(60);
-      auto p70 = new custom::BST<int>::BNode(70);
-      auto p80 = new custom::BST<int>::BNode(80);
+      auto p10 = s.bst.pool.construct(10);
+      auto p20 = s.bst.pool.construct(20);
+      auto p30 = s.bst.pool.construct(30);
+      auto p40 = s.bst.pool.construct(40);
+      auto p50 = s.bst.pool.construct(50);
+      auto p60 = s.bst.pool.construct(60);
+      auto p70 = s.bst.pool.construct(70);
+      auto p80 = s.bst.pool.construct(80);
       s.bst.root = p20->pParent = p80->pParent = p70;
       p10->pParent = p50->pParent = p70->pLeft = p20;
       p70->pRight = p80;
@@ -3213,6 +4256,7 @@ public:
       p50->pRight = p60;
       p30->pRight = p40;
       s.bst.numElements = 8;
+      s.bst.relink();
       // exercise
       size_t num = s.erase(20);
       // verify
@@ -3246,13 +4290,13 @@ public:
       assertUnit(p70->data == 70);
       assertUnit(p80->data == 80);
       // teardown
-      delete p10;
-      delete p30;
-      delete p40;
-      delete p50;
-      delete p60;
-      delete p70;
-      delete p80;
+      s.bst.pool.destroy(p10);
+      s.bst.pool.destroy(p30);
+      s.bst.pool.destroy(p40);
+      s.bst.pool.destroy(p50);
+      s.bst.pool.destroy(p60);
+      s.bst.pool.destroy(p70);
+      s.bst.pool.destroy(p80);
       s.bst.numElements = 0;
       s.bst.root = nullptr;
    }
@@ -3334,7 +4378,7 @@ public:
       if (s.bst.root)
       {
          assertUnit(s.bst.root->data == Spy(50));
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
          assertUnit(s.bst.root->pLeft != nullptr);
          if (s.bst.root->pLeft)
          {
@@ -3409,7 +4453,7 @@ public:
       if (s.bst.root)
       {
          assertUnit(s.bst.root->data == Spy(70));
-         assertUnit(s.bst.root->pParent == nullptr);
+         assertUnit(s.bst.root->pParent == s.bst.pHeader());
          assertUnit(s.bst.root->pLeft != nullptr);
          if (s.bst.root->pLeft)
          {
@@ -3440,6 +4484,18 @@ public:
 
    }
 
+   /*************************************************************
+    * SUM DEPTHS
+    * Add up how deep every node is, the root being at depth 1
+    *************************************************************/
+   template <class Node>
+   int sumDepths(const Node* p, int depth)
+   {
+      if (p == nullptr)
+         return 0;
+      return depth + sumDepths(p->pLeft, depth + 1) + sumDepths(p->pRight, depth + 1);
+   }
+
    /*************************************************************
     * SETUP STANDARD FIXTURE
     *                (50b)
@@ -3455,13 +4511,13 @@ public:
       assertUnit(s.bst.root == nullptr);
 
       // allocate
-      custom::BST<Spy>::BNode* p20 = new custom::BST<Spy>::BNode(Spy(20));
-      custom::BST<Spy>::BNode* p30 = new custom::BST<Spy>::BNode(Spy(30));
-      custom::BST<Spy>::BNode* p40 = new custom::BST<Spy>::BNode(Spy(40));
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      custom::BST<Spy>::BNode* p60 = new custom::BST<Spy>::BNode(Spy(60));
-      custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
-      custom::BST<Spy>::BNode* p80 = new custom::BST<Spy>::BNode(Spy(80));
+      custom::BST<Spy>::BNode* p20 = s.bst.pool.construct(Spy(20));
+      custom::BST<Spy>::BNode* p30 = s.bst.pool.construct(Spy(30));
+      custom::BST<Spy>::BNode* p40 = s.bst.pool.construct(Spy(40));
+      custom::BST<Spy>::BNode* p50 = s.bst.pool.construct(Spy(50));
+      custom::BST<Spy>::BNode* p60 = s.bst.pool.construct(Spy(60));
+      custom::BST<Spy>::BNode* p70 = s.bst.pool.construct(Spy(70));
+      custom::BST<Spy>::BNode* p80 = s.bst.pool.construct(Spy(80));
 
       // hook up the pointers down
       p30->pLeft = p20;
@@ -3483,6 +4539,7 @@ public:
       // now assign everything to the bst
       s.bst.root = p50;
       s.bst.numElements = 7;
+      s.bst.relink();
    }
 
    /*************************************************************
@@ -3500,6 +4557,8 @@ public:
    {
       assertIndirect(s.bst.root == nullptr);
       assertIndirect(s.bst.numElements == 0);
+      assertIndirect(s.bst.pLeftmost == s.bst.pHeader());
+      assertIndirect(s.bst.rightmost() == s.bst.pHeader());
    }
 
 
@@ -3516,6 +4575,12 @@ public:
       // verify the member variables
       assertIndirect(s.bst.numElements == 7);
       assertIndirect(s.bst.root != nullptr);
+      assertIndirect(s.bst.pLeftmost != nullptr);
+      if (s.bst.pLeftmost)
+         assertIndirect(s.bst.pLeftmost->data == Spy(20));
+      assertIndirect(s.bst.rightmost() != nullptr);
+      if (s.bst.rightmost())
+         assertIndirect(s.bst.rightmost()->data == Spy(80));
 
       // verify the pointers down
       assertIndirect(s.bst.root != nullptr);
@@ -3523,7 +4588,7 @@ public:
       {
          assertIndirect(s.bst.root->data == Spy(50));
          assertIndirect(s.bst.root->isRed == false);
-         assertIndirect(s.bst.root->pParent == nullptr);
+         assertIndirect(s.bst.root->pParent == s.bst.pHeader());
          assertIndirect(s.bst.root->pLeft != nullptr);
          if (s.bst.root->pLeft)
          {